@@ -62,6 +62,7 @@ set cmake_options {
     use-busy-waiting "Enable more accurate sending times at a cost of potentially higher CPU load (default: OFF)"
     use-gnustl "Get c++ library/headers from the gnustl.pc"
     enable-sock-cloexec "Enable setting SOCK_CLOEXEC on a socket (default: ON)"
+    enable-iouring "Enable io_uring backend for UDP socket I/O, Linux only (default: ON)"
     enable-show-project-config "Enables use of ShowProjectConfig() in cmake (default: OFF)"
     enable-new-rcvbuffer "Enables the new receiver buffer implementation (default: ON)"
     enable-clang-tsa "Enable Clang's Thread-Safety-Analysis (default: OFF)"
@@ -109,6 +109,22 @@ int  HaiCrypt_Tx_ManageKeys(HaiCrypt_Handle hhc, void *out_p[], size_t out_len_p
 int  HaiCrypt_Tx_Data(HaiCrypt_Handle hhc, unsigned char *pfx, unsigned char *data, size_t data_len);
 int  HaiCrypt_Rx_Data(HaiCrypt_Handle hhc, unsigned char *pfx, unsigned char *data, size_t data_len);
 
+/* AES-CTR keystream generator of a sender.
+ * It has its own cipher context, so it can prepare the keystream of the next
+ * packets in another thread than the one calling HaiCrypt_Tx_Data.
+ * HaiCrypt_KsGen_SetKey must not run concurrently with the key management
+ * (HaiCrypt_Tx_ManageKeys) of the sender. It returns the key id, which
+ * HaiCrypt_Tx_DataKs checks against the key currently used by the sender.
+ */
+typedef struct hcrypt_KsGen_str* HaiCrypt_KsGen;
+
+int  HaiCrypt_KsGen_Create(HaiCrypt_Handle hhcTx, HaiCrypt_KsGen *phks);
+int  HaiCrypt_KsGen_Close(HaiCrypt_KsGen hks);
+int  HaiCrypt_KsGen_SetKey(HaiCrypt_KsGen hks, HaiCrypt_Handle hhcTx);
+int  HaiCrypt_KsGen_Generate(HaiCrypt_KsGen hks, uint32_t pki, unsigned char *out, size_t len);
+int  HaiCrypt_Tx_DataKs(HaiCrypt_Handle hhc, unsigned char *pfx, unsigned char *data, size_t data_len,
+                        const unsigned char *keystream, int key_id);
+
 /// @brief Check if the crypto service provider supports AES GCM.
 /// @return returns 1 if AES GCM is supported, 0 otherwise.
 int  HaiCrypt_IsAESGCM_Supported(void);
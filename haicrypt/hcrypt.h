@@ -91,6 +91,17 @@ typedef struct hcrypt_Session_str {
         }km;
 } hcrypt_Session;
 
+typedef struct hcrypt_KsGen_str {
+        CRYSPR_methods *    cryspr;
+        CRYSPR_cb *         cryspr_cb;      /* Own cipher context, SEK in aes_sek[0] */
+
+        int                 key_id;         /* (sek_serial << 1) | key index, 0 if not keyed */
+        unsigned char       salt[HAICRYPT_SALT_SZ];
+
+        unsigned char *     buf;            /* Zeros to encrypt, or the counter stream */
+        size_t              buf_siz;
+} hcrypt_KsGen;
+
 #if ENABLE_HAICRYPT_LOGGING
 #include "haicrypt_log.h"
 #else
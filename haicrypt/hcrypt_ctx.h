@@ -82,6 +82,7 @@ typedef struct tag_hcrypt_Ctx {
 
         size_t           sek_len;
         unsigned char    sek[HAICRYPT_KEY_MAX_SZ];
+        unsigned         sek_serial; /* Changed with every new SEK (see HaiCrypt_KsGen) */
 
         hcrypt_MsgInfo * msg_info;  /* Transport message handler */
         unsigned         pkt_cnt;   /* Key usage counter */
@@ -69,6 +69,7 @@ int hcryptCtx_Tx_Rekey(hcrypt_Session *crypto, hcrypt_Ctx *ctx)
 		HCRYPT_LOG(LOG_ERR, "cryspr setkey(sek[%zd]) failed\n", ctx->sek_len);
 		return(-1);
 	}
+	ctx->sek_serial++;
 
 	HCRYPT_LOG(LOG_NOTICE, "rekeyed crypto context[%d]\n", (ctx->flags & HCRYPT_CTX_F_xSEK)/2);
 	HCRYPT_PRINTKEY(ctx->sek, ctx->sek_len, "sek");
@@ -129,6 +130,7 @@ int hcryptCtx_Tx_CloneKey(hcrypt_Session *crypto, hcrypt_Ctx *ctx, const hcrypt_
 		HCRYPT_LOG(LOG_ERR, "cryspr setkey(sek[%zd]) failed\n", ctx->sek_len);
 		return(-1);
 	}
+	ctx->sek_serial++;
 
 	HCRYPT_LOG(LOG_NOTICE, "clone-keyed crypto context[%d]\n", (ctx->flags & HCRYPT_CTX_F_xSEK)/2);
 	HCRYPT_PRINTKEY(ctx->sek, ctx->sek_len, "sek");
@@ -204,6 +206,7 @@ int hcryptCtx_Tx_Refresh(hcrypt_Session *crypto)
 		HCRYPT_LOG(LOG_ERR, "refresh cryspr setkey(sek[%d]) failed\n", new_ctx->sek_len);
 		return(-1);
 	}
+	new_ctx->sek_serial++;
 
 	HCRYPT_PRINTKEY(new_ctx->sek, new_ctx->sek_len, "sek");
 
@@ -173,3 +173,161 @@ int HaiCrypt_Tx_Process(HaiCrypt_Handle hhc,
 
 	return(nbout);
 }
+
+/* XOR of the keystream in 64-bit words, which the compilers vectorize */
+static void hcryptKs_Xor(unsigned char *data, const unsigned char *ks, size_t len)
+{
+	size_t i = 0;
+
+	for (; i + 8 <= len; i += 8) {
+		uint64_t d, k;
+		memcpy(&d, &data[i], 8);
+		memcpy(&k, &ks[i], 8);
+		d ^= k;
+		memcpy(&data[i], &d, 8);
+	}
+	for (; i < len; i++) {
+		data[i] ^= ks[i];
+	}
+}
+
+int HaiCrypt_KsGen_Create(HaiCrypt_Handle hhcTx, HaiCrypt_KsGen *phks)
+{
+	hcrypt_Session *crypto = (hcrypt_Session *)hhcTx;
+	hcrypt_KsGen *ksgen;
+
+	*phks = NULL;
+	if ((NULL == crypto)
+	||  (NULL == crypto->ctx)
+	||  (HCRYPT_CTX_MODE_AESCTR != crypto->ctx->mode)
+	||  !(crypto->ctx->flags & HCRYPT_CTX_F_ENCRYPT)) {
+		HCRYPT_LOG(LOG_ERR, "%s", "KsGen_Create: not an AES-CTR sender\n");
+		return(-1);
+	}
+
+	/* Room for the keystream of the longest packet, up to the next block */
+	size_t buf_siz = hcryptMsg_PaddedLen(crypto->cfg.data_max_len, CRYSPR_AESBLKSZ);
+
+	ksgen = calloc(1, sizeof(*ksgen) + buf_siz);
+	if (NULL == ksgen) {
+		HCRYPT_LOG(LOG_ERR, "%s\n", "malloc failed");
+		return(-1);
+	}
+	ksgen->buf = (unsigned char *)&ksgen[1];
+	ksgen->buf_siz = buf_siz;
+
+	ksgen->cryspr = crypto->cryspr;
+	ksgen->cryspr_cb = crypto->cryspr->open(crypto->cryspr, crypto->cfg.data_max_len);
+	if (NULL == ksgen->cryspr_cb) {
+		free(ksgen);
+		return(-1);
+	}
+
+	*phks = ksgen;
+	return(0);
+}
+
+int HaiCrypt_KsGen_Close(HaiCrypt_KsGen hks)
+{
+	hcrypt_KsGen *ksgen = (hcrypt_KsGen *)hks;
+
+	if (NULL == ksgen)
+		return(-1);
+
+	if (ksgen->cryspr->close) ksgen->cryspr->close(ksgen->cryspr_cb);
+	/* Wipeout the salt */
+	memset(ksgen, 0, sizeof(*ksgen));
+	free(ksgen);
+	return(0);
+}
+
+int HaiCrypt_KsGen_SetKey(HaiCrypt_KsGen hks, HaiCrypt_Handle hhcTx)
+{
+	hcrypt_KsGen *ksgen = (hcrypt_KsGen *)hks;
+	hcrypt_Session *crypto = (hcrypt_Session *)hhcTx;
+	hcrypt_Ctx *ctx = NULL;
+
+	if ((NULL == ksgen)
+	||  (NULL == crypto)
+	||  (NULL == (ctx = crypto->ctx))) {
+		HCRYPT_LOG(LOG_ERR, "KsGen_SetKey: invalid params: ksgen=%p crypto=%p crypto->ctx=%p\n", ksgen, crypto, ctx);
+		return(-1);
+	}
+
+	const int key_id = (int)((ctx->sek_serial << 1) | hcryptCtx_GetKeyIndex(ctx));
+	if (key_id == ksgen->key_id)
+		return(key_id);
+
+	if (ksgen->cryspr->aes_set_key(HCRYPT_CTX_MODE_AESCTR, true, ctx->sek, ctx->sek_len,
+			CRYSPR_GETSEK(ksgen->cryspr_cb, 0))) {
+		HCRYPT_LOG(LOG_ERR, "%s", "KsGen_SetKey: CRYSPR->set_encrypt_key(sek) failed\n");
+		ksgen->key_id = 0;
+		return(-1);
+	}
+	memcpy(ksgen->salt, ctx->salt, sizeof(ksgen->salt));
+	ksgen->key_id = key_id;
+	return(key_id);
+}
+
+int HaiCrypt_KsGen_Generate(HaiCrypt_KsGen hks, uint32_t pki, unsigned char *out, size_t len)
+{
+	hcrypt_KsGen *ksgen = (hcrypt_KsGen *)hks;
+	unsigned char iv[CRYSPR_AESBLKSZ];
+	hcrypt_Pki npki = htonl(pki);
+
+	if ((NULL == ksgen)
+	||  (0 == ksgen->key_id)
+	||  (len > ksgen->buf_siz)) {
+		return(-1);
+	}
+
+	/* The same IV as for the packet in crysprFallback_MsEncrypt */
+	hcrypt_SetCtrIV((unsigned char *)&npki, ksgen->salt, iv);
+
+#if CRYSPR_HAS_AESCTR
+	/* The keystream is the encrypted zeros */
+	return ksgen->cryspr->aes_ctr_cipher(true, CRYSPR_GETSEK(ksgen->cryspr_cb, 0), iv,
+			ksgen->buf, len, out);
+#else /* CRYSPR_HAS_AESCTR */
+	{
+		/* Encrypt the counter stream, as _crysprFallback_AES_SetCtrStream does */
+		size_t nblk = (len + (CRYSPR_AESBLKSZ-1))/CRYSPR_AESBLKSZ;
+		size_t blk, out_len = 0;
+		unsigned char *csp = ksgen->buf;
+
+		for (blk = 0; blk < nblk; blk++) {
+			memcpy(csp, iv, CRYSPR_AESBLKSZ);
+			csp += CRYSPR_AESBLKSZ;
+			if (0 == ++(iv[CRYSPR_AESBLKSZ-1])) ++(iv[CRYSPR_AESBLKSZ-2]);
+		}
+		return ksgen->cryspr->aes_ecb_cipher(true, CRYSPR_GETSEK(ksgen->cryspr_cb, 0),
+				ksgen->buf, nblk * CRYSPR_AESBLKSZ, out, &out_len);
+	}
+#endif /* CRYSPR_HAS_AESCTR */
+}
+
+int HaiCrypt_Tx_DataKs(HaiCrypt_Handle hhc,
+	unsigned char *in_pfx, unsigned char *in_data, size_t in_len,
+	const unsigned char *keystream, int key_id)
+{
+	hcrypt_Session *crypto = (hcrypt_Session *)hhc;
+	hcrypt_Ctx *ctx = NULL;
+
+	if ((NULL == crypto)
+	||  (NULL == (ctx = crypto->ctx))) {
+		HCRYPT_LOG(LOG_ERR, "Tx_DataKs: invalid params: crypto=%p crypto->ctx=%p\n", crypto, ctx);
+		return(-1);
+	}
+
+	/* The keystream is of an older key, the caller has to use HaiCrypt_Tx_Data */
+	if (key_id != (int)((ctx->sek_serial << 1) | hcryptCtx_GetKeyIndex(ctx)))
+		return(-1);
+
+	/* Get/Set packet index */
+	ctx->msg_info->indexMsg(in_pfx, ctx->MSpfx_cache);
+
+	hcryptKs_Xor(in_data, keystream, in_len);
+	ctx->pkt_cnt++;
+
+	return(0);
+}
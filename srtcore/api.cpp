@@ -174,7 +174,11 @@ srt::CUDTUnited::CUDTUnited()
     , m_GlobControlLock()
     , m_IDLock()
     , m_mMultiplexer()
+    , m_iShardMuxID(-1)
     , m_MultiplexerLock()
+    , m_iIoThreads(0)
+    , m_iTsbPdThreads(0)
+    , m_iCryptoThreads(0)
     , m_pCache(NULL)
     , m_bClosing(false)
     , m_GCStopCond()
@@ -195,6 +199,7 @@ srt::CUDTUnited::CUDTUnited()
     setupMutex(m_GlobControlLock, "GlobControl");
     setupMutex(m_IDLock, "ID");
     setupMutex(m_InitLock, "Init");
+    setupMutex(m_CryptoWorkersLock, "CryptoWorkers");
 
     m_pCache = new CCache<CInfoBlock>;
 }
@@ -212,6 +217,7 @@ srt::CUDTUnited::~CUDTUnited()
     releaseMutex(m_GlobControlLock);
     releaseMutex(m_IDLock);
     releaseMutex(m_InitLock);
+    releaseMutex(m_CryptoWorkersLock);
     // XXX There's some weird bug here causing this
     // to hangup on Windows. This might be either something
     // bigger, or some problem in pthread-win32. As this is
@@ -302,6 +308,50 @@ int srt::CUDTUnited::cleanup()
     CSync::notify_one_relaxed(m_GCStopCond);
     m_GCThread.join();
 
+#ifdef SRT_ENABLE_IOPOOL
+    {
+        // All multiplexers have been deleted together with the sockets.
+        ScopedLock cg(m_GlobControlLock);
+        vector<CIoWorker*> busy;
+        for (size_t i = 0; i < m_vIoWorkers.size(); ++i)
+        {
+            if (m_vIoWorkers[i]->load() == 0)
+                delete m_vIoWorkers[i];
+            else
+                busy.push_back(m_vIoWorkers[i]);
+        }
+        m_vIoWorkers.swap(busy);
+    }
+#endif
+
+    {
+        // All sockets have been removed from them when closed.
+        ScopedLock cg(m_GlobControlLock);
+        vector<CTsbPdWorker*> busy;
+        for (size_t i = 0; i < m_vTsbPdWorkers.size(); ++i)
+        {
+            if (m_vTsbPdWorkers[i]->load() == 0)
+                delete m_vTsbPdWorkers[i];
+            else
+                busy.push_back(m_vTsbPdWorkers[i]);
+        }
+        m_vTsbPdWorkers.swap(busy);
+    }
+
+    {
+        // All sockets have been removed from them when closed.
+        ScopedLock cg(m_CryptoWorkersLock);
+        vector<CKeystreamWorker*> busy;
+        for (size_t i = 0; i < m_vCryptoWorkers.size(); ++i)
+        {
+            if (m_vCryptoWorkers[i]->load() == 0)
+                delete m_vCryptoWorkers[i];
+            else
+                busy.push_back(m_vCryptoWorkers[i]);
+        }
+        m_vCryptoWorkers.swap(busy);
+    }
+
     m_bGCStatus = false;
 
     // Global destruction code
@@ -312,6 +362,41 @@ int srt::CUDTUnited::cleanup()
     return 0;
 }
 
+void srt::CUDTUnited::setIoThreads(int nthreads)
+{
+    if (nthreads < 0 || nthreads > MAX_IO_THREADS)
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+#ifndef SRT_ENABLE_IOPOOL
+    if (nthreads > 0)
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+#endif
+
+    // The multiplexers already using the threads keep them.
+    ScopedLock cg(m_GlobControlLock);
+    m_iIoThreads = nthreads;
+}
+
+void srt::CUDTUnited::setTsbPdThreads(int nthreads)
+{
+    if (nthreads < 0 || nthreads > MAX_TSBPD_THREADS)
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+    // The sockets already using the threads keep them.
+    ScopedLock cg(m_GlobControlLock);
+    m_iTsbPdThreads = nthreads;
+}
+
+void srt::CUDTUnited::setCryptoThreads(int nthreads)
+{
+    if (nthreads < 0 || nthreads > MAX_CRYPTO_THREADS)
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+    // The sockets already using the threads keep them.
+    ScopedLock cg(m_CryptoWorkersLock);
+    m_iCryptoThreads = nthreads;
+}
+
 SRTSOCKET srt::CUDTUnited::generateSocketID(bool for_group)
 {
     ScopedLock guard(m_IDLock);
@@ -1010,6 +1095,14 @@ int srt::CUDTUnited::listen(const SRTSOCKET u, int backlog)
 
     s->core().setListenState(); // propagates CUDTException,
                                 // if thrown, remains in OPENED state if so.
+
+    // The connection requests may be delivered to any of the shards.
+    if (!setShardListener(s, true))
+    {
+        setShardListener(s, false);
+        s->core().notListening();
+        throw CUDTException(MJ_NOTSUP, MN_BUSY, 0);
+    }
     s->m_Status = SRTS_LISTENING;
 
     return 0;
@@ -1992,6 +2085,7 @@ int srt::CUDTUnited::close(CUDTSocket* s)
 
         HLOGC(smlog.Debug, log << s->core().CONID() << "CLOSING (removing listener immediately)");
         s->core().notListening();
+        setShardListener(s, false);
         s->m_Status = SRTS_CLOSING;
 
         // broadcast all "accept" waiting
@@ -2384,10 +2478,20 @@ int srt::CUDTUnited::epoll_add_usock(const int eid, const SRTSOCKET u, const int
 // NOTE: WILL LOCK (serially):
 // - CEPoll::m_EPollLock
 // - CUDT::m_RecvLock
+// - CUDTSocket::m_AcceptLock (with CEPoll::m_EPollLock inside)
 int srt::CUDTUnited::epoll_add_usock_INTERNAL(const int eid, CUDTSocket* s, const int* events)
 {
     int ret = m_EPoll.update_usock(eid, s->m_SocketID, events);
     s->core().addEPoll(eid);
+
+    // The connections queued before the listener was added
+    // would be otherwise reported only with the next one.
+    if (s->core().m_bListening)
+    {
+        ScopedLock acceptcg(s->m_AcceptLock);
+        if (!s->m_QueuedSockets.empty())
+            m_EPoll.update_events(s->m_SocketID, s->core().m_sPollID, SRT_EPOLL_ACCEPT, true);
+    }
     return ret;
 }
 
@@ -2679,6 +2783,8 @@ void srt::CUDTUnited::checkBrokenSockets()
                 u.m_tsLingerExpiration = steady_clock::time_point();
                 u.m_bClosing           = true;
                 ps->m_tsClosureTimeStamp        = steady_clock::now();
+                if (u.m_pRcvQueue)
+                    u.m_pRcvQueue->requestTimersCheck(&u);
             }
         }
 
@@ -2728,11 +2834,11 @@ void srt::CUDTUnited::removeSocket(const SRTSOCKET u)
     // threads. If that's the case, SKIP IT THIS TIME. The
     // socket will be checked next time the GC rollover starts.
     CSNode* sn = s->core().m_pSNode;
-    if (sn && sn->m_iHeapLoc != -1)
+    if (sn && sn->m_iSlot != -1)
         return;
 
     CRNode* rn = s->core().m_pRNode;
-    if (rn && rn->m_bOnList)
+    if (rn && (rn->m_bOnList || rn->m_bCheckRequested))
         return;
 
 #if ENABLE_BONDING
@@ -2826,6 +2932,34 @@ void srt::CUDTUnited::removeSocket(const SRTSOCKET u)
 
     mx.m_iRefCount--;
     HLOGC(smlog.Debug, log << "unrefing underlying muxer " << mid << " for @" << u << ", ref=" << mx.m_iRefCount);
+
+    if (!mx.m_vShards.empty())
+    {
+        // The shards are bound to the same port and are deleted
+        // all together when the last socket of them is gone.
+        const vector<int> shards = mx.m_vShards;
+        int refcount = 0;
+        for (size_t n = 0; n < shards.size(); ++n)
+            refcount += m_mMultiplexer[shards[n]].m_iRefCount;
+        if (refcount > 0)
+            return;
+
+        HLOGC(smlog.Debug, log << "MUXER id=" << mid << " lost last socket @" << u << " - deleting "
+                << shards.size() << " shards bound to port " << mx.m_iPort);
+        for (size_t n = 0; n < shards.size(); ++n)
+        {
+            CMultiplexer& sh = m_mMultiplexer[shards[n]];
+            sh.m_pSndQueue->setClosing();
+            sh.m_pRcvQueue->setClosing();
+        }
+        for (size_t n = 0; n < shards.size(); ++n)
+        {
+            m_mMultiplexer[shards[n]].destroy();
+            m_mMultiplexer.erase(shards[n]);
+        }
+        return;
+    }
+
     if (0 == mx.m_iRefCount)
     {
         HLOGC(smlog.Debug,
@@ -2862,6 +2996,166 @@ uint16_t srt::CUDTUnited::installMuxer(CUDTSocket* w_s, CMultiplexer& fw_sm)
     return sa.hport();
 }
 
+// Start the threads of a shared pool as needed, up to @a nthreads, then use
+// the least busy one. Returns NULL if the pool isn't used, or if the thread
+// failed to start, in which case the user does without the pool.
+template <class Worker>
+static Worker* selectPoolWorker(vector<Worker*>& w_workers, int nthreads, srt_logging::Logger& lg SRT_ATR_UNUSED)
+{
+    if (nthreads == 0)
+        return NULL;
+
+    if (w_workers.size() < size_t(nthreads))
+    {
+        Worker* w = new Worker;
+        try
+        {
+            w->start((int)w_workers.size() + 1);
+        }
+        catch (const srt::CUDTException& e)
+        {
+            LOGC(lg.Error, log << "Failed to start the shared thread: " << e.getErrorMessage());
+            delete w;
+            return NULL;
+        }
+        w_workers.push_back(w);
+        return w;
+    }
+
+    // Only the first nthreads ones are used after their number is lowered.
+    Worker* w = w_workers[0];
+    for (int i = 1; i < nthreads; ++i)
+    {
+        if (w_workers[i]->load() < w->load())
+            w = w_workers[i];
+    }
+    return w;
+}
+
+srt::CIoWorker* srt::CUDTUnited::selectIoWorker()
+{
+#ifdef SRT_ENABLE_IOPOOL
+    // The multiplexers without it have their own threads.
+    return selectPoolWorker(m_vIoWorkers, m_iIoThreads, smlog);
+#else
+    return NULL;
+#endif
+}
+
+srt::CTsbPdWorker* srt::CUDTUnited::selectTsbPdWorker()
+{
+    ScopedLock cg(m_GlobControlLock);
+    // The socket without it uses its own thread.
+    return selectPoolWorker(m_vTsbPdWorkers, m_iTsbPdThreads, tslog);
+}
+
+srt::CKeystreamWorker* srt::CUDTUnited::selectKeystreamWorker()
+{
+    ScopedLock cg(m_CryptoWorkersLock);
+    // The socket without it encrypts on the sending thread.
+    return selectPoolWorker(m_vCryptoWorkers, m_iCryptoThreads, cnlog);
+}
+
+// Open the multiplexers for the other shards bound to the same
+// port as @a w_m, with the same settings and own threads.
+void srt::CUDTUnited::createMuxerShards(CMultiplexer& w_m, int payload_size)
+{
+    const int nshards = w_m.m_mcfg.iUDPShards;
+    if (!w_m.m_pChannel->setShardSteering(nshards))
+    {
+        LOGC(smlog.Warn, log << "bind: packet steering not supported, SRTO_UDP_SHARDS ignored");
+        return;
+    }
+
+    sockaddr_any bound;
+    w_m.m_pChannel->getSockAddr((bound));
+
+    vector<CMultiplexer> shards;
+    shards.reserve(nshards);
+    w_m.m_vShards.push_back(w_m.m_iID);
+    try
+    {
+        for (int n = 1; n < nshards; ++n)
+        {
+            CMultiplexer shard;
+            shard.m_mcfg       = w_m.m_mcfg;
+            shard.m_iIPversion = w_m.m_iIPversion;
+            shard.m_iPort      = w_m.m_iPort;
+            shard.m_iRefCount  = 0;
+            shard.m_iID        = --m_iShardMuxID;
+            shards.push_back(shard);
+            CMultiplexer& sh = shards.back();
+
+            // The sockets must be bound in the order of the shard index.
+            sh.m_pChannel = new CChannel();
+            sh.m_pChannel->setConfig(sh.m_mcfg);
+            sh.m_pChannel->open(bound);
+
+            CIoWorker* const worker = selectIoWorker();
+            sh.m_pTimer    = new CTimer;
+            sh.m_pSndQueue = new CSndQueue;
+            sh.m_pSndQueue->init(sh.m_pChannel, sh.m_pTimer, worker);
+            sh.m_pRcvQueue = new CRcvQueue;
+            sh.m_pRcvQueue->init(128, payload_size, sh.m_iIPversion, 1024, sh.m_pChannel, sh.m_pTimer, worker);
+            w_m.m_vShards.push_back(sh.m_iID);
+        }
+    }
+    catch (...)
+    {
+        for (size_t n = 0; n < shards.size(); ++n)
+            shards[n].destroy();
+        w_m.m_vShards.clear();
+        throw;
+    }
+
+    for (size_t n = 0; n < shards.size(); ++n)
+    {
+        shards[n].m_vShards             = w_m.m_vShards;
+        m_mMultiplexer[shards[n].m_iID] = shards[n];
+    }
+
+    HLOGC(smlog.Debug, log << "bind: created " << nshards << " shards for port " << w_m.m_iPort);
+}
+
+// The system delivers the packets for the socket @a id to the shard with
+// index id % N (see CChannel::setShardSteering()).
+srt::CMultiplexer& srt::CUDTUnited::selectMuxerShard(CMultiplexer& m, SRTSOCKET id)
+{
+    if (m.m_vShards.empty())
+        return m;
+    return m_mMultiplexer[m.m_vShards[id % m.m_vShards.size()]];
+}
+
+// Set or remove the listener @a s in the receiver queues of all
+// the other shards of its multiplexer, if it's sharded.
+bool srt::CUDTUnited::setShardListener(CUDTSocket* s, bool listen)
+{
+    vector<CRcvQueue*> queues;
+    {
+        ScopedLock cg(m_GlobControlLock);
+        CMultiplexer* mux = map_getp(m_mMultiplexer, s->m_iMuxID);
+        if (!mux)
+            return true;
+
+        for (size_t n = 0; n < mux->m_vShards.size(); ++n)
+        {
+            CRcvQueue* q = m_mMultiplexer[mux->m_vShards[n]].m_pRcvQueue;
+            if (q != s->core().m_pRcvQueue)
+                queues.push_back(q);
+        }
+    }
+
+    // The listener lock of the queue is ordered before m_GlobControlLock.
+    for (size_t n = 0; n < queues.size(); ++n)
+    {
+        if (!listen)
+            queues[n]->removeListener(&s->core());
+        else if (queues[n]->setListener(&s->core()) < 0)
+            return false;
+    }
+    return true;
+}
+
 bool srt::CUDTUnited::inet6SettingsCompat(const sockaddr_any& muxaddr, const CSrtMuxerConfig& cfgMuxer,
         const sockaddr_any& reqaddr, const CSrtMuxerConfig& cfgSocket)
 {
@@ -2931,6 +3225,10 @@ void srt::CUDTUnited::updateMux(CUDTSocket* s, const sockaddr_any& reqaddr, cons
         {
             CMultiplexer const& m = i->second;
 
+            // Shards of a multiplexer are represented by the first one.
+            if (!m.m_vShards.empty() && m.m_vShards[0] != m.m_iID)
+                continue;
+
             // First, we need to find a multiplexer with the same port.
             if (m.m_iPort != port)
             {
@@ -3104,8 +3402,9 @@ void srt::CUDTUnited::updateMux(CUDTSocket* s, const sockaddr_any& reqaddr, cons
                 {
                     HLOGC(smlog.Debug, log << "bind: reusing multiplexer for port " << port);
                     // reuse the existing multiplexer
-                    ++i->second.m_iRefCount;
-                    installMuxer((s), (i->second));
+                    CMultiplexer& shard = selectMuxerShard(i->second, s->m_SocketID);
+                    ++shard.m_iRefCount;
+                    installMuxer((s), (shard));
                     return;
                 }
                 else
@@ -3174,15 +3473,29 @@ void srt::CUDTUnited::updateMux(CUDTSocket* s, const sockaddr_any& reqaddr, cons
         }
 
         m.m_pTimer    = new CTimer;
+        CIoWorker* const worker = selectIoWorker();
         m.m_pSndQueue = new CSndQueue;
-        m.m_pSndQueue->init(m.m_pChannel, m.m_pTimer);
+        m.m_pSndQueue->init(m.m_pChannel, m.m_pTimer, worker);
         m.m_pRcvQueue = new CRcvQueue;
-        m.m_pRcvQueue->init(128, s->core().maxPayloadSize(), m.m_iIPversion, 1024, m.m_pChannel, m.m_pTimer);
+        m.m_pRcvQueue->init(128, s->core().maxPayloadSize(), m.m_iIPversion, 1024, m.m_pChannel, m.m_pTimer, worker);
 
         // Rewrite the port here, as it might be only known upon return
         // from CChannel::open.
-        m.m_iPort               = installMuxer((s), m);
+        m.m_iPort = installMuxer((s), m);
+
+        if (m.m_mcfg.iUDPShards > 1 && !udpsock)
+            createMuxerShards((m), s->core().maxPayloadSize());
+
         m_mMultiplexer[m.m_iID] = m;
+
+        if (!m.m_vShards.empty())
+        {
+            // Install the socket in the shard that receives its packets.
+            CMultiplexer& shard = selectMuxerShard(m_mMultiplexer[m.m_iID], s->m_SocketID);
+            --m_mMultiplexer[m.m_iID].m_iRefCount;
+            ++shard.m_iRefCount;
+            installMuxer((s), (shard));
+        }
     }
     catch (const CUDTException&)
     {
@@ -3279,6 +3592,9 @@ bool srt::CUDTUnited::updateListenerMux(CUDTSocket* s, const CUDTSocket* ls)
     // Checking again because the above procedure could have set it
     if (mux)
     {
+        // With shards, the packets for this socket are delivered to one of them.
+        mux = &selectMuxerShard(*mux, s->m_SocketID);
+
         // reuse the existing multiplexer
         ++mux->m_iRefCount;
         s->core().m_pSndQueue = mux->m_pSndQueue;
@@ -3382,6 +3698,45 @@ int srt::CUDT::cleanup()
     return uglobal().cleanup();
 }
 
+int srt::CUDT::setIoThreads(int nthreads)
+{
+    try
+    {
+        uglobal().setIoThreads(nthreads);
+        return 0;
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+}
+
+int srt::CUDT::setTsbPdThreads(int nthreads)
+{
+    try
+    {
+        uglobal().setTsbPdThreads(nthreads);
+        return 0;
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+}
+
+int srt::CUDT::setCryptoThreads(int nthreads)
+{
+    try
+    {
+        uglobal().setCryptoThreads(nthreads);
+        return 0;
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+}
+
 SRTSOCKET srt::CUDT::socket()
 {
     if (!uglobal().m_bGCStatus)
@@ -3859,7 +4214,8 @@ int srt::CUDT::sendmsg(SRTSOCKET u, const char* buf, int len, int ttl, bool inor
     return sendmsg2(u, buf, len, (mctrl));
 }
 
-int srt::CUDT::sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& w_m)
+int srt::CUDT::sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& w_m,
+                        srt_send_release_fn* release, void* opaque)
 {
     try
     {
@@ -3867,11 +4223,15 @@ int srt::CUDT::sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& w_m)
         if (u & SRTGROUP_MASK)
         {
             CUDTUnited::GroupKeeper k(uglobal(), u, CUDTUnited::ERH_THROW);
-            return k.group->send(buf, len, (w_m));
+            // The group members copy the data, so they are released right away.
+            const int sent = k.group->send(buf, len, (w_m));
+            if (release && sent > 0)
+                release(opaque, buf, sent);
+            return sent;
         }
 #endif
 
-        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().sendmsg2(buf, len, (w_m));
+        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().sendmsg2(buf, len, (w_m), release, opaque);
     }
     catch (const CUDTException& e)
     {
@@ -3928,6 +4288,53 @@ int srt::CUDT::recvmsg2(SRTSOCKET u, char* buf, int len, SRT_MSGCTRL& w_m)
     }
 }
 
+int srt::CUDT::recvmsgViews(SRTSOCKET u, SRT_MSGVIEW* views, int nviews)
+{
+    try
+    {
+#if ENABLE_BONDING
+        if (u & SRTGROUP_MASK)
+        {
+            LOGC(aclog.Error, log << "recvmsg_zc: not supported for groups, use srt_recvmsg2.");
+            return APIError(MJ_NOTSUP, MN_INVAL, 0);
+        }
+#endif
+
+        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().recvmsgViews(views, nviews);
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+    catch (bad_alloc&)
+    {
+        return APIError(MJ_SYSTEMRES, MN_MEMORY, 0);
+    }
+    catch (const std::exception& ee)
+    {
+        LOGC(aclog.Fatal, log << "recvmsg_zc: UNEXPECTED EXCEPTION: " << typeid(ee).name() << ": " << ee.what());
+        return APIError(MJ_UNKNOWN, MN_NONE, 0);
+    }
+}
+
+int srt::CUDT::releaseMsgViews(SRTSOCKET u, const SRT_MSGVIEW* views, int nviews)
+{
+    try
+    {
+        uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().releaseMsgViews(views, nviews);
+        return 0;
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+    catch (const std::exception& ee)
+    {
+        LOGC(aclog.Fatal, log << "recvmsg_zc_release: UNEXPECTED EXCEPTION: " << typeid(ee).name() << ": " << ee.what());
+        return APIError(MJ_UNKNOWN, MN_NONE, 0);
+    }
+}
+
 int64_t srt::CUDT::sendfile(SRTSOCKET u, fstream& ifs, int64_t& offset, int64_t size, int block)
 {
     try
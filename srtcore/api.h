@@ -233,6 +233,9 @@ public:
 
     // Public constants
     static const int32_t MAX_SOCKET_VAL = SRTGROUP_MASK - 1; // maximum value for a regular socket
+    static const int     MAX_IO_THREADS = 256;               // maximum value for srt_setiothreads()
+    static const int     MAX_TSBPD_THREADS = 256;            // maximum value for srt_settsbpdthreads()
+    static const int     MAX_CRYPTO_THREADS = 256;           // maximum value for srt_setcryptothreads()
 
 public:
     enum ErrorHandling
@@ -251,6 +254,18 @@ public:
     /// @return 0 if success, otherwise -1 is returned.
     int cleanup();
 
+    /// Set the number of shared threads for the multiplexers created since now.
+    /// @param [in] nthreads number of threads, 0 to use own threads for every multiplexer
+    void setIoThreads(int nthreads);
+
+    /// Set the number of shared threads for the TSBPD of the sockets starting to receive since now.
+    /// @param [in] nthreads number of threads, 0 to use an own thread for every socket
+    void setTsbPdThreads(int nthreads);
+
+    /// Set the number of shared threads preparing the AES-CTR keystream of the sockets starting to send since now.
+    /// @param [in] nthreads number of threads, 0 to encrypt the packets entirely on the sending thread
+    void setCryptoThreads(int nthreads);
+
     /// Create a new UDT socket.
     /// @param [out] pps Variable (optional) to which the new socket will be written, if succeeded
     /// @return The new UDT socket ID, or INVALID_SOCK.
@@ -451,6 +466,20 @@ private:
     void     configureMuxer(CMultiplexer& w_m, const CUDTSocket* s, int af);
     uint16_t installMuxer(CUDTSocket* w_s, CMultiplexer& sm);
 
+    // Get the shared thread for a new multiplexer, NULL if not used.
+    CIoWorker* selectIoWorker();
+
+    // Get the shared TSBPD thread for a socket, NULL if not used.
+    CTsbPdWorker* selectTsbPdWorker();
+
+    // Get the shared keystream thread for a sending socket, NULL if not used.
+    CKeystreamWorker* selectKeystreamWorker();
+
+    // Utility functions for the sharded multiplexers (SRTO_UDP_SHARDS)
+    void          createMuxerShards(CMultiplexer& w_m, int payload_size);
+    CMultiplexer& selectMuxerShard(CMultiplexer& m, SRTSOCKET id);
+    bool          setShardListener(CUDTSocket* s, bool listen);
+
     /// @brief Checks if channel configuration matches the socket configuration.
     /// @param cfgMuxer multiplexer configuration.
     /// @param cfgSocket socket configuration.
@@ -461,8 +490,27 @@ private:
 
 private:
     std::map<int, CMultiplexer> m_mMultiplexer; // UDP multiplexer
+    int                         m_iShardMuxID;  // Last ID given to a multiplexer shard (negative)
     sync::Mutex                 m_MultiplexerLock;
 
+    // The shared threads of the multiplexers (srt_setiothreads()),
+    // protected by m_GlobControlLock. Only the first m_iIoThreads
+    // are used for new multiplexers.
+    int                     m_iIoThreads;
+    std::vector<CIoWorker*> m_vIoWorkers;
+
+    // The shared TSBPD threads (srt_settsbpdthreads()), protected
+    // by m_GlobControlLock in the same way as the ones above.
+    int                        m_iTsbPdThreads;
+    std::vector<CTsbPdWorker*> m_vTsbPdWorkers;
+
+    // The shared keystream threads (srt_setcryptothreads()). They are selected
+    // when sending the first packet, with the m_ConnectionLock of the socket
+    // locked, so they have their own lock instead of m_GlobControlLock.
+    sync::Mutex                    m_CryptoWorkersLock;
+    int                            m_iCryptoThreads;
+    std::vector<CKeystreamWorker*> m_vCryptoWorkers;
+
 private:
     CCache<CInfoBlock>* m_pCache; // UDT network information cache
 
@@ -146,6 +146,10 @@ CRcvBuffer::~CRcvBuffer()
         m_pUnitQueue->makeUnitFree(it->pUnit);
         it->pUnit = NULL;
     }
+
+    // The units that were not returned can't be used any longer.
+    for (std::set<CUnit*>::iterator it = m_setLentUnits.begin(); it != m_setLentUnits.end(); ++it)
+        m_pUnitQueue->makeUnitFree(*it);
 }
 
 int CRcvBuffer::insert(CUnit* unit)
@@ -391,6 +395,44 @@ int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, Dro
 }
 
 int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
+{
+    return extractMessage(data, len, msgctrl, NULL);
+}
+
+int CRcvBuffer::lendMessage(std::vector<CUnit*>& w_units, size_t maxunits, SRT_MSGCTRL* msgctrl)
+{
+    const bool canReadInOrder = hasReadableInorderPkts();
+    if (!canReadInOrder && m_iFirstReadableOutOfOrder < 0)
+        return 0;
+
+    // The message is lent as a whole, so check first if it fits.
+    size_t msgunits = 1;
+    for (int i = canReadInOrder ? m_iStartPos : m_iFirstReadableOutOfOrder;
+         m_entries[i].pUnit && !(packetAt(i).getMsgBoundary() & PB_LAST);
+         i = incPos(i))
+    {
+        ++msgunits;
+    }
+
+    if (msgunits > maxunits)
+        return -1;
+
+    if (m_setLentUnits.size() + msgunits > capacity())
+        return -2;
+
+    return extractMessage(NULL, 0, msgctrl, &w_units);
+}
+
+bool CRcvBuffer::releaseLent(CUnit* unit)
+{
+    if (m_setLentUnits.erase(unit) == 0)
+        return false;
+
+    m_pUnitQueue->makeUnitFree(unit);
+    return true;
+}
+
+int CRcvBuffer::extractMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl, std::vector<CUnit*>* w_lent)
 {
     const bool canReadInOrder = hasReadableInorderPkts();
     if (!canReadInOrder && m_iFirstReadableOutOfOrder < 0)
@@ -422,11 +464,14 @@ int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
         const size_t   pktsize = packet.getLength();
         const int32_t pktseqno = packet.getSeqNo();
 
-        // unitsize can be zero
-        const size_t unitsize = std::min(remain, pktsize);
-        memcpy(dst, packet.m_pcData, unitsize);
-        remain -= unitsize;
-        dst += unitsize;
+        if (!w_lent)
+        {
+            // unitsize can be zero
+            const size_t unitsize = std::min(remain, pktsize);
+            memcpy(dst, packet.m_pcData, unitsize);
+            remain -= unitsize;
+            dst += unitsize;
+        }
 
         ++pkts_read;
         bytes_extracted += (int) pktsize;
@@ -449,7 +494,18 @@ int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
         if (msgctrl)
             msgctrl->pktseq = pktseqno;
 
-        releaseUnitInPos(i);
+        if (w_lent)
+        {
+            // The unit stays taken until returned by releaseLent().
+            w_lent->push_back(m_entries[i].pUnit);
+            m_setLentUnits.insert(m_entries[i].pUnit);
+            m_entries[i] = Entry();
+        }
+        else
+        {
+            releaseUnitInPos(i);
+        }
+
         if (updateStartPos)
         {
             m_iStartPos = incPos(i);
@@ -486,6 +542,9 @@ int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
         // incase readable inorder packets are all read out.
         updateFirstReadableOutOfOrder();
 
+    if (w_lent)
+        return bytes_extracted;
+
     const int bytes_read = int(dst - data);
     if (bytes_read < bytes_extracted)
     {
@@ -11,6 +11,8 @@
 #ifndef INC_SRT_BUFFER_RCV_H
 #define INC_SRT_BUFFER_RCV_H
 
+#include <set>
+#include <vector>
 #include "buffer_tools.h" // AvgBufSize
 #include "common.h"
 #include "queue.h"
@@ -109,6 +111,30 @@ public:
     ///         -1 on failure.
     int readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl = NULL);
 
+    /// Read the whole message like readMessage(), but instead of copying the payload
+    /// lend the units of the message. The units remain taken and still occupy the
+    /// buffer space (see getAvailSize()) until they are returned with releaseLent().
+    ///
+    /// @param [out] w_units the units of the message are appended here, in order.
+    /// @param [in] maxunits the maximum number of units to lend.
+    /// @param [in,out] message control data
+    ///
+    /// The units lent and not yet returned can't take up more than the capacity of
+    /// the buffer, as they are taken from the unit queue shared with other sockets.
+    ///
+    /// @return size of the message in bytes.
+    ///          0 if nothing to read.
+    ///         -1 if the message consists of more than @a maxunits packets (nothing is lent then).
+    ///         -2 if the units lent with this message would exceed the capacity (nothing is lent then).
+    int lendMessage(std::vector<CUnit*>& w_units, size_t maxunits, SRT_MSGCTRL* msgctrl = NULL);
+
+    /// Return a unit lent by lendMessage() to the unit queue.
+    /// @return false if the unit is not currently lent by this buffer.
+    bool releaseLent(CUnit* unit);
+
+    /// The number of units lent by lendMessage() and not yet returned.
+    size_t countLent() const { return m_setLentUnits.size(); }
+
     /// Read acknowledged data into a user buffer.
     /// @param [in, out] dst pointer to the target user buffer.
     /// @param [in] len length of user buffer.
@@ -131,7 +157,8 @@ public:
 
     /// Given the sequence number of the first unacknowledged packet
     /// tells the size of the buffer available for packets.
-    /// Effective returns capacity of the buffer minus acknowledged packet still kept in it.
+    /// Effective returns capacity of the buffer minus acknowledged packet still kept in it
+    /// and minus the units lent by lendMessage() and not yet returned.
     // TODO: Maybe does not need to return minus one slot now to distinguish full and empty buffer.
     size_t getAvailSize(int iFirstUnackSeqNo) const
     {
@@ -140,14 +167,16 @@ public:
         // then it does not have acknowledged packets and its full capacity is available.
         // Otherwise subtract the number of acknowledged but not yet read packets from its capacity.
         const int iRBufSeqNo  = getStartSeqNo();
-        if (CSeqNo::seqcmp(iRBufSeqNo, iFirstUnackSeqNo) >= 0) // iRBufSeqNo >= iFirstUnackSeqNo
+        size_t    avail       = capacity();
+        if (CSeqNo::seqcmp(iRBufSeqNo, iFirstUnackSeqNo) < 0) // iRBufSeqNo < iFirstUnackSeqNo
         {
-            // Full capacity is available.
-            return capacity();
+            // Note: CSeqNo::seqlen(n, n) returns 1.
+            avail -= CSeqNo::seqlen(iRBufSeqNo, iFirstUnackSeqNo) - 1;
         }
 
-        // Note: CSeqNo::seqlen(n, n) returns 1.
-        return capacity() - CSeqNo::seqlen(iRBufSeqNo, iFirstUnackSeqNo) + 1;
+        // The lent units are still in use, the sender must not fill them up.
+        const size_t lent = m_setLentUnits.size();
+        return avail > lent ? avail - lent : 0;
     }
 
     /// @brief Checks if the buffer has packets available for reading regardless of the TSBPD.
@@ -275,6 +304,11 @@ private:
 private:
     void countBytes(int pkts, int bytes);
     void updateNonreadPos();
+
+    /// Implementation of readMessage() and lendMessage(): if @a w_lent is not NULL,
+    /// the units are appended there instead of copying the payload into @a data.
+    /// @return the number of bytes copied, or extracted if lent.
+    int extractMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl, std::vector<CUnit*>* w_lent);
     void releaseUnitInPos(int pos);
 
     /// @brief Drop a unit from the buffer.
@@ -353,6 +387,8 @@ private:
     const size_t m_szSize;     // size of the array of units (buffer)
     CUnitQueue*  m_pUnitQueue; // the shared unit queue
 
+    std::set<CUnit*> m_setLentUnits; // units lent by lendMessage() and not returned yet
+
     int m_iStartSeqNo;
     int m_iStartPos;        // the head position for I/O (inclusive)
     int m_iFirstNonreadPos; // First position that can't be read (<= m_iLastAckPos)
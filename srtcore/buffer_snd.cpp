@@ -64,61 +64,68 @@ using namespace std;
 using namespace srt_logging;
 using namespace sync;
 
+const int CSndBuffer::READ_NONE;
+const int CSndBuffer::READ_DROP;
+
 CSndBuffer::CSndBuffer(int ip_family, int size, int maxpld, int authtag)
     : m_BufLock()
-    , m_pBlock(NULL)
-    , m_pFirstBlock(NULL)
-    , m_pCurrBlock(NULL)
-    , m_pLastBlock(NULL)
+    , m_pBlocks(NULL)
+    , m_iFirst(0)
+    , m_iCurr(0)
+    , m_iLast(0)
     , m_pBuffer(NULL)
+    , m_pRetired(NULL)
+    , m_iReclaimMinSize(0)
+    , m_iPeakCount(0)
+    , m_llPeakMemory(0)
+    , m_bFilling(false)
     , m_iNextMsgNo(1)
-    , m_iSize(size)
+    , m_iSize(1)
     , m_iBlockLen(maxpld)
     , m_iAuthTagSize(authtag)
     , m_iCount(0)
+    , m_iExtMessages(0)
     , m_iBytesCount(0)
+    , m_ullBytesAdded(0)
     , m_rateEstimator(ip_family)
 {
+    // The ring size must be a power of 2.
+    while (m_iSize < size)
+        m_iSize <<= 1;
+
     // initial physical buffer of "size"
     m_pBuffer           = new Buffer;
     m_pBuffer->m_pcData = new char[m_iSize * m_iBlockLen];
     m_pBuffer->m_iSize  = m_iSize;
     m_pBuffer->m_pNext  = NULL;
 
-    // circular linked list for out bound packets
-    m_pBlock  = new Block;
-    Block* pb = m_pBlock;
+    // ring of blocks for out bound packets, with the payloads laid out in order
+    m_pBlocks = new Block[m_iSize];
     char* pc  = m_pBuffer->m_pcData;
-
     for (int i = 0; i < m_iSize; ++i)
     {
-        pb->m_iMsgNoBitset = 0;
-        pb->m_pcData       = pc;
-        pc                += m_iBlockLen;
-
-        if (i < m_iSize - 1)
-        {
-            pb->m_pNext        = new Block;
-            pb                 = pb->m_pNext;
-        }
+        m_pBlocks[i].m_iMsgNoBitset = 0;
+        m_pBlocks[i].m_pcData       = pc;
+        m_pBlocks[i].m_pcExtData    = NULL;
+        m_pBlocks[i].m_pRelease     = NULL;
+        pc                         += m_iBlockLen;
     }
-    pb->m_pNext = m_pBlock;
-
-    m_pFirstBlock = m_pCurrBlock = m_pLastBlock = m_pBlock;
+    m_llPeakMemory = memoryUse();
 
     setupMutex(m_BufLock, "Buf");
 }
 
 CSndBuffer::~CSndBuffer()
 {
-    Block* pb = m_pBlock->m_pNext;
-    while (pb != m_pBlock)
-    {
-        Block* temp = pb;
-        pb          = pb->m_pNext;
-        delete temp;
-    }
-    delete m_pBlock;
+    // The user data blocks still referred to are no longer needed,
+    // and the sending threads no longer read this buffer.
+    releaseFirst(m_iCount, steady_clock::now());
+    vector<ExtRelease*> released;
+    for (size_t i = 0; i < m_qDeferredRelease.size(); ++i)
+        released.push_back(m_qDeferredRelease[i].second);
+    callRelease(released);
+
+    delete[] m_pBlocks;
 
     while (m_pBuffer != NULL)
     {
@@ -128,10 +135,17 @@ CSndBuffer::~CSndBuffer()
         delete temp;
     }
 
+    if (m_pRetired)
+    {
+        delete[] m_pRetired->m_pcData;
+        delete m_pRetired;
+    }
+
     releaseMutex(m_BufLock);
 }
 
-void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
+void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl,
+                           srt_send_release_fn* release, void* opaque)
 {
     int32_t& w_msgno     = w_mctrl.msgno;
     int32_t& w_seqno     = w_mctrl.pktseq;
@@ -153,6 +167,17 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
         increase();
     }
 
+    ExtRelease* ext = NULL;
+    if (release)
+    {
+        ext         = new ExtRelease;
+        ext->fn     = release;
+        ext->opaque = opaque;
+        ext->data   = data;
+        ext->len    = len;
+        ++m_iExtMessages;
+    }
+
     const int32_t inorder = w_mctrl.inorder ? MSGNO_PACKET_INORDER::mask : 0;
     HLOGC(bslog.Debug,
           log << CONID() << "addBuffer: adding " << iNumBlocks << " packets (" << len << " bytes) to send, msgno="
@@ -169,7 +194,7 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
     // If there's more than one packet, this function must increase it by itself
     // and then return the accordingly modified sequence number in the reference.
 
-    Block* s = m_pLastBlock;
+    int idx = m_iLast;
 
     if (w_msgno == SRT_MSGNO_NONE) // DEFAULT-UNCHANGED msgno supplied
     {
@@ -188,11 +213,24 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
         if (pktlen > iPktLen)
             pktlen = iPktLen;
 
+        Block* s = &m_pBlocks[idx];
         HLOGC(bslog.Debug,
               log << "addBuffer: %" << w_seqno << " #" << w_msgno << " offset=" << (i * iPktLen)
                   << " size=" << pktlen << " TO BUFFER:" << (void*)s->m_pcData);
-        memcpy((s->m_pcData), data + i * iPktLen, pktlen);
-        s->m_iLength = pktlen;
+        if (release)
+        {
+            s->m_pcExtData = const_cast<char*>(data) + i * iPktLen;
+        }
+        else
+        {
+            memcpy((s->m_pcData), data + i * iPktLen, pktlen);
+            s->m_pcExtData = NULL;
+        }
+        // The user data block is released together with the last packet.
+        s->m_pRelease = (i == iNumBlocks - 1) ? ext : NULL;
+        s->m_iLength  = pktlen;
+        m_ullBytesAdded += pktlen;
+        s->m_ullBytesEnd = m_ullBytesAdded;
 
         s->m_iSeqNo = w_seqno;
         w_seqno     = CSeqNo::incseq(w_seqno);
@@ -212,15 +250,16 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
         s->m_iTTL = ttl;
         s->m_tsRexmitTime = time_point();
         s->m_tsOriginTime = m_tsLastOriginTime;
-        
-        // Should never happen, as the call to increase() should ensure enough buffers.
-        SRT_ASSERT(s->m_pNext);
-        s = s->m_pNext;
+
+        // The call to increase() has ensured enough blocks.
+        idx = next(idx);
     }
-    m_pLastBlock = s;
+    m_iLast = idx;
 
     m_iCount = m_iCount + iNumBlocks;
     m_iBytesCount += len;
+    if (m_iCount > m_iPeakCount)
+        m_iPeakCount = m_iCount;
 
     m_rateEstimator.updateInputRate(m_tsLastOriginTime, iNumBlocks, len);
     updAvgBufSize(m_tsLastOriginTime);
@@ -246,21 +285,29 @@ int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
               << " buffers for " << len << " bytes");
 
     // dynamically increase sender buffer
-    while (iNumBlocks + m_iCount >= m_iSize)
     {
-        HLOGC(bslog.Debug,
-              log << "addBufferFromFile: ... still lacking " << (iNumBlocks + m_iCount - m_iSize) << " buffers...");
-        increase();
+        // The blocks are moved to a new ring, which must not be accessed meanwhile.
+        ScopedLock bufferguard(m_BufLock);
+        while (iNumBlocks + m_iCount >= m_iSize)
+        {
+            HLOGC(bslog.Debug,
+                  log << "addBufferFromFile: ... still lacking " << (iNumBlocks + m_iCount - m_iSize) << " buffers...");
+            increase();
+        }
+        // The blocks are filled outside the lock, so they must stay in place.
+        m_bFilling = true;
     }
 
     HLOGC(bslog.Debug,
           log << CONID() << "addBufferFromFile: adding " << iPktLen << " packets (" << len
               << " bytes) to send, msgno=" << m_iNextMsgNo);
 
-    Block* s     = m_pLastBlock;
-    int    total = 0;
+    int      idx   = m_iLast;
+    int      total = 0;
+    uint64_t added = m_ullBytesAdded;
     for (int i = 0; i < iNumBlocks; ++i)
     {
+        Block* s = &m_pBlocks[idx];
         if (ifs.bad() || ifs.fail() || ifs.eof())
             break;
 
@@ -284,17 +331,25 @@ int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
         // NOTE: PB_FIRST | PB_LAST == PB_SOLO.
         // none of PB_FIRST & PB_LAST == PB_SUBSEQUENT.
 
-        s->m_iLength = pktlen;
-        s->m_iTTL    = SRT_MSGTTL_INF;
-        s            = s->m_pNext;
+        s->m_pcExtData = NULL;
+        s->m_pRelease  = NULL;
+        s->m_iLength   = pktlen;
+        s->m_iTTL      = SRT_MSGTTL_INF;
+        added += pktlen;
+        s->m_ullBytesEnd = added;
+        idx              = next(idx);
 
         total += pktlen;
     }
-    m_pLastBlock = s;
+    m_iLast = idx;
 
     enterCS(m_BufLock);
     m_iCount = m_iCount + iNumBlocks;
     m_iBytesCount += total;
+    m_ullBytesAdded = added;
+    if (m_iCount > m_iPeakCount)
+        m_iPeakCount = m_iCount;
+    m_bFilling = false;
 
     leaveCS(m_BufLock);
 
@@ -311,13 +366,15 @@ int CSndBuffer::readData(CPacket& w_packet, steady_clock::time_point& w_srctime,
     w_seqnoinc = 0;
 
     ScopedLock bufferguard(m_BufLock);
-    while (m_pCurrBlock != m_pLastBlock)
+    while (m_iCurr != m_iLast)
     {
+        Block* p = &m_pBlocks[m_iCurr];
+
         // Make the packet REFLECT the data stored in the buffer.
-        w_packet.m_pcData = m_pCurrBlock->m_pcData;
-        readlen = m_pCurrBlock->m_iLength;
+        w_packet.m_pcData = p->payload();
+        readlen = p->m_iLength;
         w_packet.setLength(readlen, m_iBlockLen);
-        w_packet.set_seqno(m_pCurrBlock->m_iSeqNo);
+        w_packet.set_seqno(p->m_iSeqNo);
 
         // 1. On submission (addBuffer), the KK flag is set to EK_NOENC (0).
         // 2. The readData() is called to get the original (unique) payload not ever sent yet.
@@ -339,13 +396,14 @@ int CSndBuffer::readData(CPacket& w_packet, steady_clock::time_point& w_srctime,
         }
         else
         {
-            m_pCurrBlock->m_iMsgNoBitset |= MSGNO_ENCKEYSPEC::wrap(kflgs);
+            // The payload in a user data block must not be encrypted in place.
+            SRT_ASSERT(kflgs == EK_NOENC || !p->m_pcExtData);
+            p->m_iMsgNoBitset |= MSGNO_ENCKEYSPEC::wrap(kflgs);
         }
 
-        Block* p = m_pCurrBlock;
-        w_packet.set_msgflags(m_pCurrBlock->m_iMsgNoBitset);
-        w_srctime = m_pCurrBlock->m_tsOriginTime;
-        m_pCurrBlock = m_pCurrBlock->m_pNext;
+        w_packet.set_msgflags(p->m_iMsgNoBitset);
+        w_srctime = p->m_tsOriginTime;
+        m_iCurr = next(m_iCurr);
 
         if ((p->m_iTTL >= 0) && (count_milliseconds(steady_clock::now() - w_srctime) > p->m_iTTL))
         {
@@ -370,25 +428,16 @@ int CSndBuffer::readData(CPacket& w_packet, steady_clock::time_point& w_srctime,
 CSndBuffer::time_point CSndBuffer::peekNextOriginal() const
 {
     ScopedLock bufferguard(m_BufLock);
-    if (m_pCurrBlock == m_pLastBlock)
+    if (m_iCurr == m_iLast)
         return time_point();
 
-    return m_pCurrBlock->m_tsOriginTime;
+    return m_pBlocks[m_iCurr].m_tsOriginTime;
 }
 
 int32_t CSndBuffer::getMsgNoAt(const int offset)
 {
     ScopedLock bufferguard(m_BufLock);
 
-    Block* p = m_pFirstBlock;
-
-    if (p)
-    {
-        HLOGC(bslog.Debug,
-              log << "CSndBuffer::getMsgNoAt: FIRST MSG: size=" << p->m_iLength << " %" << p->m_iSeqNo << " #"
-                  << p->getMsgSeq() << " !" << BufferStamp(p->m_pcData, p->m_iLength));
-    }
-
     if (offset >= m_iCount)
     {
         // Prevent accessing the last "marker" block
@@ -397,27 +446,11 @@ int32_t CSndBuffer::getMsgNoAt(const int offset)
         return SRT_MSGNO_CONTROL;
     }
 
-    // XXX Suboptimal procedure to keep the blocks identifiable
-    // by sequence number. Consider using some circular buffer.
-    int       i;
-    Block* ee SRT_ATR_UNUSED = 0;
-    for (i = 0; i < offset && p; ++i)
-    {
-        ee = p;
-        p  = p->m_pNext;
-    }
-
-    if (!p)
-    {
-        LOGC(bslog.Error,
-             log << "CSndBuffer::getMsgNoAt: IPE: offset=" << offset << " not found, stopped at " << i << " with #"
-                 << (ee ? ee->getMsgSeq() : SRT_MSGNO_NONE));
-        return SRT_MSGNO_CONTROL;
-    }
+    Block* p = &blockAt(offset);
 
     HLOGC(bslog.Debug,
           log << "CSndBuffer::getMsgNoAt: offset=" << offset << " found, size=" << p->m_iLength << " %" << p->m_iSeqNo
-              << " #" << p->getMsgSeq() << " !" << BufferStamp(p->m_pcData, p->m_iLength));
+              << " #" << p->getMsgSeq() << " !" << BufferStamp(p->payload(), p->m_iLength));
 
     return p->getMsgSeq();
 }
@@ -429,19 +462,12 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
 
     ScopedLock bufferguard(m_BufLock);
 
-    Block* p = m_pFirstBlock;
-
-    // XXX Suboptimal procedure to keep the blocks identifiable
-    // by sequence number. Consider using some circular buffer.
-    for (int i = 0; i < offset && p != m_pLastBlock; ++i)
-    {
-        p = p->m_pNext;
-    }
-    if (p == m_pLastBlock)
+    if (offset >= m_iCount)
     {
         LOGC(qslog.Error, log << "CSndBuffer::readData: offset " << offset << " too large!");
         return READ_NONE;
     }
+    Block* p = &blockAt(offset);
 #if ENABLE_HEAVY_LOGGING
     const int32_t first_seq = p->m_iSeqNo;
     int32_t last_seq = p->m_iSeqNo;
@@ -451,10 +477,10 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
     // already set when it was once sent uniquely.
     SRT_ASSERT(p->m_iSeqNo == w_packet.seqno());
 
-    // Check if the block that is the next candidate to send (m_pCurrBlock pointing) is stale.
+    // Check if the block that is the next candidate to send (m_iCurr pointing) is stale.
 
     // If so, then inform the caller that it should first take care of the whole
-    // message (all blocks with that message id). Shift the m_pCurrBlock pointer
+    // message (all blocks with that message id). Shift the m_iCurr index
     // to the position past the last of them. Then return -1 and set the
     // msgno bitset packet field to the message id that should be dropped as
     // a whole.
@@ -470,20 +496,21 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
     {
         w_drop.msgno = p->getMsgSeq();
         int msglen   = 1;
-        p            = p->m_pNext;
+        int idx      = (m_iFirst + offset + 1) & (m_iSize - 1);
         bool move    = false;
-        while (p != m_pLastBlock && w_drop.msgno == p->getMsgSeq())
+        while (idx != m_iLast && w_drop.msgno == m_pBlocks[idx].getMsgSeq())
         {
 #if ENABLE_HEAVY_LOGGING
-            last_seq = p->m_iSeqNo;
+            last_seq = m_pBlocks[idx].m_iSeqNo;
 #endif
-            if (p == m_pCurrBlock)
+            if (idx == m_iCurr)
                 move = true;
-            p = p->m_pNext;
+            idx = next(idx);
             if (move)
-                m_pCurrBlock = p;
+                m_iCurr = idx;
             msglen++;
         }
+        p = &m_pBlocks[idx];
 
         HLOGC(qslog.Debug,
               log << "CSndBuffer::readData: due to TTL exceeded, %(" << first_seq << " - " << last_seq << "), "
@@ -499,13 +526,13 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
         // Note the rules: here `p` is pointing to the first block AFTER the
         // message to be dropped, so the end sequence should be one behind
         // the one for p. Note that the loop rolls until hitting the first
-        // packet that doesn't belong to the message or m_pLastBlock, which
+        // packet that doesn't belong to the message or m_iLast, which
         // is past-the-end for the occupied range in the sender buffer.
         SRT_ASSERT(w_drop.seqno[DropRange::END] == CSeqNo::decseq(p->m_iSeqNo));
         return READ_DROP;
     }
 
-    w_packet.m_pcData = p->m_pcData;
+    w_packet.m_pcData = p->payload();
     const int readlen = p->m_iLength;
     w_packet.setLength(readlen, m_iBlockLen);
 
@@ -532,38 +559,46 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
 sync::steady_clock::time_point CSndBuffer::getPacketRexmitTime(const int offset)
 {
     ScopedLock bufferguard(m_BufLock);
-    const Block* p = m_pFirstBlock;
-
-    // XXX Suboptimal procedure to keep the blocks identifiable
-    // by sequence number. Consider using some circular buffer.
-    for (int i = 0; i < offset; ++i)
-    {
-        SRT_ASSERT(p);
-        p = p->m_pNext;
-    }
-
-    SRT_ASSERT(p);
-    return p->m_tsRexmitTime;
+    SRT_ASSERT(offset < m_iCount);
+    return blockAt(offset).m_tsRexmitTime;
 }
 
 void CSndBuffer::ackData(int offset)
 {
     ScopedLock bufferguard(m_BufLock);
 
-    bool move = false;
-    for (int i = 0; i < offset; ++i)
+    const steady_clock::time_point tnow = steady_clock::now();
+    releaseFirst(offset, tnow);
+
+    updAvgBufSize(tnow);
+}
+
+void CSndBuffer::releaseFirst(int count, const time_point& tnow)
+{
+    if (count <= 0)
+        return;
+
+    for (int i = 0; m_iExtMessages > 0 && i < count; ++i)
     {
-        m_iBytesCount -= m_pFirstBlock->m_iLength;
-        if (m_pFirstBlock == m_pCurrBlock)
-            move = true;
-        m_pFirstBlock = m_pFirstBlock->m_pNext;
+        Block& b = blockAt(i);
+        if (b.m_pRelease)
+        {
+            m_qDeferredRelease.push_back(make_pair(tnow, b.m_pRelease));
+            b.m_pRelease = NULL;
+            --m_iExtMessages;
+        }
+        b.m_pcExtData = NULL;
     }
-    if (move)
-        m_pCurrBlock = m_pFirstBlock;
 
-    m_iCount = m_iCount - offset;
+    // The current block stays at the same place in the ring, unless removed.
+    const int curr_offset = (m_iCurr - m_iFirst) & (m_iSize - 1);
+    const Block& last = blockAt(count - 1);
+    m_iFirst = (m_iFirst + count) & (m_iSize - 1);
+    if (curr_offset < count)
+        m_iCurr = m_iFirst;
 
-    updAvgBufSize(steady_clock::now());
+    m_iCount      = m_iCount - count;
+    m_iBytesCount = int(m_ullBytesAdded - last.m_ullBytesEnd);
 }
 
 int CSndBuffer::getCurrBufSize() const
@@ -629,7 +664,7 @@ int CSndBuffer::getCurrBufSize(int& w_bytes, int& w_timespan) const
      * Also, if there is only one pkt in buffer, the time difference will be 0.
      * Therefore, always add 1 ms if not empty.
      */
-    w_timespan = 0 < m_iCount ? (int) count_milliseconds(m_tsLastOriginTime - m_pFirstBlock->m_tsOriginTime) + 1 : 0;
+    w_timespan = 0 < m_iCount ? (int) count_milliseconds(m_tsLastOriginTime - m_pBlocks[m_iFirst].m_tsOriginTime) + 1 : 0;
 
     return m_iCount;
 }
@@ -637,64 +672,56 @@ int CSndBuffer::getCurrBufSize(int& w_bytes, int& w_timespan) const
 CSndBuffer::duration CSndBuffer::getBufferingDelay(const time_point& tnow) const
 {
     ScopedLock lck(m_BufLock);
-    SRT_ASSERT(m_pFirstBlock);
     if (m_iCount == 0)
         return duration(0);
 
-    return tnow - m_pFirstBlock->m_tsOriginTime;
+    return tnow - m_pBlocks[m_iFirst].m_tsOriginTime;
 }
 
 int CSndBuffer::dropLateData(int& w_bytes, int32_t& w_first_msgno, const steady_clock::time_point& too_late_time)
 {
     int     dpkts  = 0;
-    int     dbytes = 0;
-    bool    move   = false;
     int32_t msgno  = 0;
 
     ScopedLock bufferguard(m_BufLock);
-    for (int i = 0; i < m_iCount && m_pFirstBlock->m_tsOriginTime < too_late_time; ++i)
+    for (int i = m_iFirst; dpkts < m_iCount && m_pBlocks[i].m_tsOriginTime < too_late_time; i = next(i))
     {
         dpkts++;
-        dbytes += m_pFirstBlock->m_iLength;
-        msgno = m_pFirstBlock->getMsgSeq();
-
-        if (m_pFirstBlock == m_pCurrBlock)
-            move = true;
-        m_pFirstBlock = m_pFirstBlock->m_pNext;
+        msgno = m_pBlocks[i].getMsgSeq();
     }
 
-    if (move)
-    {
-        m_pCurrBlock = m_pFirstBlock;
-    }
-    m_iCount = m_iCount - dpkts;
-
-    m_iBytesCount -= dbytes;
-    w_bytes = dbytes;
+    const steady_clock::time_point tnow = steady_clock::now();
+    const int bytes = m_iBytesCount;
+    releaseFirst(dpkts, tnow);
+    w_bytes = bytes - m_iBytesCount;
 
     // We report the increased number towards the last ever seen
     // by the loop, as this last one is the last received. So remained
     // (even if "should remain") is the first after the last removed one.
     w_first_msgno = ++MsgNo(msgno);
 
-    updAvgBufSize(steady_clock::now());
-
+    updAvgBufSize(tnow);
     return (dpkts);
 }
 
 void CSndBuffer::increase()
 {
-    int unitsize = m_pBuffer->m_iSize;
+    // The ring is doubled, so that its size stays a power of 2.
+    const int unitsize = m_iSize;
 
     // new physical buffer
     Buffer* nbuf = NULL;
+    Block*  nblk = NULL;
     try
     {
         nbuf           = new Buffer;
         nbuf->m_pcData = new char[unitsize * m_iBlockLen];
+        nblk           = new Block[m_iSize + unitsize];
     }
     catch (...)
     {
+        if (nbuf)
+            delete[] nbuf->m_pcData;
         delete nbuf;
         throw CUDTException(MJ_SYSTEMRES, MN_MEMORY, 0);
     }
@@ -707,43 +734,200 @@ void CSndBuffer::increase()
         p = p->m_pNext;
     p->m_pNext = nbuf;
 
-    // new packet blocks
+    // Move the blocks so that the first one is at index 0, with the
+    // free ones following, then the new blocks in the new buffer.
+    for (int i = 0; i < m_iSize; ++i)
+        nblk[i] = m_pBlocks[(m_iFirst + i) & (m_iSize - 1)];
+
+    char* pc = nbuf->m_pcData;
+    for (int i = m_iSize; i < m_iSize + unitsize; ++i)
+    {
+        nblk[i].m_iMsgNoBitset = 0;
+        nblk[i].m_pcData       = pc;
+        nblk[i].m_pcExtData    = NULL;
+        nblk[i].m_pRelease     = NULL;
+        pc += m_iBlockLen;
+    }
+
+    m_iCurr = (m_iCurr - m_iFirst) & (m_iSize - 1);
+    m_iLast = m_iCount;
+    m_iFirst = 0;
+
+    delete[] m_pBlocks;
+    m_pBlocks = nblk;
+    m_iSize += unitsize;
+    m_llPeakMemory = max(m_llPeakMemory, memoryUse());
+
+    HLOGC(bslog.Debug,
+          log << "CSndBuffer: BUFFER FULL - adding " << (unitsize * m_iBlockLen) << " bytes spread to " << unitsize
+              << " blocks"
+              << " (total size: " << m_iSize << " bytes)");
+}
+
+void CSndBuffer::setReclaimMinSize(int bytes)
+{
+    // The size is rounded up to whole blocks.
+    m_iReclaimMinSize = bytes > 0 ? (bytes + m_iBlockLen - 1) / m_iBlockLen : 0;
+}
+
+bool CSndBuffer::reclaim(const time_point& tnow)
+{
+    if (m_iReclaimMinSize == 0)
+        return false;
+
+    ScopedLock bufferguard(m_BufLock);
+    if (is_zero(m_tsReclaimCheck))
+    {
+        m_tsReclaimCheck = tnow;
+        m_iPeakCount     = m_iCount;
+        return false;
+    }
+
+    if (tnow - m_tsReclaimCheck < milliseconds_from(RECLAIM_PERIOD_MS))
+        return false;
+
+    m_tsReclaimCheck = tnow;
+    const int peak   = m_iPeakCount;
+    m_iPeakCount     = m_iCount;
+
+    // The packets read from the retired buffer have been sent long ago.
+    if (m_pRetired)
+    {
+        delete[] m_pRetired->m_pcData;
+        delete m_pRetired;
+        m_pRetired = NULL;
+    }
+
+    // The first buffer is never released. Every next one was added by
+    // increase() and holds the half of the ring.
+    if (m_bFilling || m_pBuffer->m_pNext == NULL)
+        return false;
+
+    if (peak >= m_iSize / 4 || m_iSize / 2 < m_iReclaimMinSize)
+        return false;
+
+    return shrink();
+}
+
+bool CSndBuffer::shrink()
+{
+    Buffer* prev = m_pBuffer;
+    while (prev->m_pNext->m_pNext != NULL)
+        prev = prev->m_pNext;
+    Buffer* const last = prev->m_pNext;
+
+    const char* const lbegin  = last->m_pcData;
+    const char* const lend    = lbegin + last->m_iSize * m_iBlockLen;
+    const int         newsize = m_iSize - last->m_iSize;
+
     Block* nblk = NULL;
     try
     {
-        nblk = new Block;
+        nblk = new Block[newsize];
     }
     catch (...)
     {
-        delete nblk;
-        throw CUDTException(MJ_SYSTEMRES, MN_MEMORY, 0);
+        // Not shrinking is not an error; try again next time.
+        return false;
+    }
+
+    // The blocks in use are moved to the beginning of the new ring, and
+    // those with the payload in the released buffer get the payload of a
+    // free block from the remaining buffers. These free payloads are
+    // found past the used ones in the ring, and the rest of them make
+    // up the free blocks of the new ring.
+    int free_idx = m_iCount;
+    for (int i = 0; i < m_iCount; ++i)
+    {
+        nblk[i] = blockAt(i);
+        if (nblk[i].m_pcData < lbegin || nblk[i].m_pcData >= lend)
+            continue;
+
+        while (blockAt(free_idx).m_pcData >= lbegin && blockAt(free_idx).m_pcData < lend)
+            ++free_idx;
+        // With AES-GCM the authentication tag, written in place when the
+        // packet was encrypted, follows the payload and is retransmitted too.
+        char* pc = blockAt(free_idx++).m_pcData;
+        if (!nblk[i].m_pcExtData)
+            memcpy((pc), nblk[i].m_pcData, nblk[i].m_iLength + m_iAuthTagSize);
+        nblk[i].m_pcData = pc;
     }
-    Block* pb = nblk;
-    for (int i = 1; i < unitsize; ++i)
+
+    for (int i = m_iCount; i < newsize; ++i)
     {
-        pb->m_pNext = new Block;
-        pb          = pb->m_pNext;
+        while (blockAt(free_idx).m_pcData >= lbegin && blockAt(free_idx).m_pcData < lend)
+            ++free_idx;
+        nblk[i].m_iMsgNoBitset = 0;
+        nblk[i].m_pcData       = blockAt(free_idx++).m_pcData;
+        nblk[i].m_pcExtData    = NULL;
+        nblk[i].m_pRelease     = NULL;
     }
 
-    // insert the new blocks onto the existing one
-    pb->m_pNext           = m_pLastBlock->m_pNext;
-    m_pLastBlock->m_pNext = nblk;
+    m_iCurr  = (m_iCurr - m_iFirst) & (m_iSize - 1);
+    m_iLast  = m_iCount;
+    m_iFirst = 0;
 
-    pb       = nblk;
-    char* pc = nbuf->m_pcData;
-    for (int i = 0; i < unitsize; ++i)
+    delete[] m_pBlocks;
+    m_pBlocks = nblk;
+    m_iSize   = newsize;
+
+    prev->m_pNext = NULL;
+    m_pRetired    = last;
+
+    HLOGC(bslog.Debug,
+          log << "CSndBuffer: releasing " << (last->m_iSize * m_iBlockLen) << " bytes spread to " << last->m_iSize
+              << " blocks (remaining size: " << m_iSize << " blocks)");
+    return true;
+}
+
+void CSndBuffer::releaseDeferred(const time_point& tnow)
+{
+    vector<ExtRelease*> released;
     {
-        pb->m_pcData = pc;
-        pb           = pb->m_pNext;
-        pc += m_iBlockLen;
+        ScopedLock bufferguard(m_BufLock);
+        const steady_clock::duration delay = milliseconds_from(RELEASE_DELAY_MS);
+        while (!m_qDeferredRelease.empty() && tnow - m_qDeferredRelease.front().first >= delay)
+        {
+            released.push_back(m_qDeferredRelease.front().second);
+            m_qDeferredRelease.pop_front();
+        }
     }
 
-    m_iSize += unitsize;
+    // Outside the lock, as the application may wait for other locks there.
+    callRelease(released);
+}
 
-    HLOGC(bslog.Debug,
-          log << "CSndBuffer: BUFFER FULL - adding " << (unitsize * m_iBlockLen) << " bytes spread to " << unitsize
-              << " blocks"
-              << " (total size: " << m_iSize << " bytes)");
+CSndBuffer::time_point CSndBuffer::nextDeferredRelease() const
+{
+    ScopedLock bufferguard(m_BufLock);
+    if (m_qDeferredRelease.empty())
+        return time_point();
+    return m_qDeferredRelease.front().first + milliseconds_from(RELEASE_DELAY_MS);
+}
+
+void CSndBuffer::callRelease(const vector<ExtRelease*>& released)
+{
+    for (size_t i = 0; i < released.size(); ++i)
+    {
+        const ExtRelease* r = released[i];
+        r->fn(r->opaque, r->data, r->len);
+        delete r;
+    }
+}
+
+int64_t CSndBuffer::memoryUse() const
+{
+    int64_t bytes = int64_t(m_iSize) * (m_iBlockLen + sizeof(Block));
+    if (m_pRetired)
+        bytes += int64_t(m_pRetired->m_iSize) * m_iBlockLen;
+    return bytes;
+}
+
+int64_t CSndBuffer::getMemoryUse(int64_t& w_peak) const
+{
+    ScopedLock bufferguard(m_BufLock);
+    w_peak = m_llPeakMemory;
+    return memoryUse();
 }
 
 } // namespace srt
@@ -56,6 +56,8 @@ modified by
 #include "srt.h"
 #include "packet.h"
 #include "buffer_tools.h"
+#include <deque>
+#include <vector>
 
 // The notation used for "circular numbers" in comments:
 // The "cicrular numbers" are numbers that when increased up to the
@@ -103,11 +105,19 @@ public:
     /// - srctime: local time stamped on the packet (same as input, if input wasn't 0)
     /// - pktseq: sequence number to be stamped on the next packet
     /// - msgno: message number stamped on the packet
+    /// When @a release is given, the data are not copied, but the packets
+    /// refer to the user data block, which must stay unchanged until @a release
+    /// is called, RELEASE_DELAY_MS after the last packet of the message is
+    /// removed from the buffer (see releaseDeferred()).
+    /// This can't be used with encryption, as the payload is encrypted in place.
     /// @param [in] data pointer to the user data block.
     /// @param [in] len size of the block.
     /// @param [inout] w_mctrl Message control data
+    /// @param [in] release function to call when the data are no longer used (NULL to copy the data)
+    /// @param [in] opaque first argument for @a release
     SRT_ATTR_EXCLUDES(m_BufLock)
-    void addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl);
+    void addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl,
+                   srt_send_release_fn* release = NULL, void* opaque = NULL);
 
     /// Read a block of data from file and insert it into the sending list.
     /// @param [in] ifs input file stream.
@@ -213,8 +223,64 @@ public:
 
     void setRateEstimator(const CRateEstimator& other) { m_rateEstimator = other; }
 
+    // The period over which the buffer must be used below a quarter of its
+    // capacity before its last grown part is released.
+    static const int RECLAIM_PERIOD_MS = 1000;
+
+    /// Set the size below which the buffer is not shrunk by reclaim().
+    /// @param bytes the low watermark in bytes, or 0 to never shrink the buffer.
+    void setReclaimMinSize(int bytes);
+
+    /// Release the part of the buffer added by the last growth, if the buffer
+    /// was used below a quarter of its capacity for the whole last period.
+    /// To be called periodically; the period is checked inside.
+    /// @param [in] tnow current time
+    /// @return true if the buffer has been shrunk.
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    bool reclaim(const time_point& tnow);
+
+    // The time the user data blocks are still kept after the last packet of
+    // their message has been removed from the buffer. The packets read from
+    // them may be still in the sending path (a retransmission, or a batch
+    // not yet passed to the system), so they are released only then.
+    static const int RELEASE_DELAY_MS = 100;
+
+    /// Call the release function of the user data blocks removed from the
+    /// buffer at least RELEASE_DELAY_MS ago. To be called periodically.
+    /// @param [in] tnow current time
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    void releaseDeferred(const time_point& tnow);
+
+    /// Get the time when releaseDeferred() has the next release to call.
+    /// @return the time, or zero if no release is deferred.
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    time_point nextDeferredRelease() const;
+
+    /// Get the memory allocated by the buffer for the packet payloads and blocks.
+    /// @param [out] w_peak the highest value since the buffer was created
+    /// @return currently allocated memory in bytes.
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    int64_t getMemoryUse(int64_t& w_peak) const;
+
 private:
     void increase();
+    bool shrink();
+    int64_t memoryUse() const;
+
+    // The owner of a user data block referred to by the packets of a message.
+    struct ExtRelease
+    {
+        srt_send_release_fn* fn;
+        void*                opaque;
+        const char*          data;
+        int                  len;
+    };
+
+    static void callRelease(const std::vector<ExtRelease*>& released);
+
+    // The user data blocks no longer referred to by the packets, waiting
+    // for RELEASE_DELAY_MS since the time they were removed.
+    std::deque<std::pair<time_point, ExtRelease*> > m_qDeferredRelease;
 
 private:
     mutable sync::Mutex m_BufLock; // used to synchronize buffer operation
@@ -229,8 +295,12 @@ private:
         time_point m_tsOriginTime; // block origin time (either provided from above or equals the time a message was submitted for sending.
         time_point m_tsRexmitTime; // packet retransmission time
         int        m_iTTL; // time to live (milliseconds)
+        uint64_t   m_ullBytesEnd;  // number of payload bytes ever added, up to this block
 
-        Block* m_pNext; // next block
+        char*       m_pcExtData; // payload in the user data block, NULL if it's copied to m_pcData
+        ExtRelease* m_pRelease;  // set in the last block of a message with the payload in a user data block
+
+        char* payload() const { return m_pcExtData ? m_pcExtData : m_pcData; }
 
         int32_t getMsgSeq()
         {
@@ -240,13 +310,23 @@ private:
             // for the peer that it uses LESS bits to represent the message.
             return m_iMsgNoBitset & MSGNO_SEQ::mask;
         }
+    };
+
+    // The blocks form a ring of m_iSize entries (a power of 2), so the block
+    // at a given offset from the first one (that is, at a sequence number
+    // relative to the last ACK) is found directly. The ring is never full:
+    // m_iLast is the past-the-end index of the occupied range.
+    Block* m_pBlocks;
+    int    m_iFirst; // The first block (if first == last, buffer is empty)
+    int    m_iCurr;  // The block to be sent next
+    int    m_iLast;  // The block past the last one
 
-    } * m_pBlock, *m_pFirstBlock, *m_pCurrBlock, *m_pLastBlock;
+    int next(int i) const { return (i + 1) & (m_iSize - 1); }
+    Block& blockAt(int offset) const { return m_pBlocks[(m_iFirst + offset) & (m_iSize - 1)]; }
 
-    // m_pBlock:         The head pointer
-    // m_pFirstBlock:    The first block
-    // m_pCurrBlock:	 The current block
-    // m_pLastBlock:     The last block (if first == last, buffer is empty)
+    // Remove the first @a count blocks, with the current block if among them.
+    // The user data blocks no longer used are queued for releaseDeferred().
+    void releaseFirst(int count, const time_point& tnow);
 
     struct Buffer
     {
@@ -255,6 +335,16 @@ private:
         Buffer* m_pNext;  // next buffer
     } * m_pBuffer;        // physical buffer
 
+    // The buffer released by the last shrink(). The packets read from it
+    // may still be in the sending path, so it is deleted one period later.
+    Buffer* m_pRetired;
+
+    int        m_iReclaimMinSize; // the size (in blocks) not to shrink below, 0: never shrink
+    int        m_iPeakCount;      // the highest number of used blocks since the last reclaim check
+    time_point m_tsReclaimCheck;  // the time of the last reclaim check
+    int64_t    m_llPeakMemory;    // the highest memory allocated
+    bool       m_bFilling;        // addBufferFromFile() is writing to the free blocks without the lock
+
     int32_t m_iNextMsgNo; // next message number
 
     int m_iSize; // buffer size (number of packets)
@@ -266,7 +356,9 @@ private:
     // a lock.
     sync::atomic<int> m_iCount; // number of used blocks
 
+    int        m_iExtMessages; // number of messages with the payload in user data blocks
     int        m_iBytesCount; // number of payload bytes in queue
+    uint64_t   m_ullBytesAdded; // number of payload bytes ever added
     time_point m_tsLastOriginTime;
 
     AvgBufSize m_mavg;
@@ -63,6 +63,154 @@ modified by
 #include "netinet_any.h"
 #include "utilities.h"
 
+#if defined(SRT_ENABLE_SENDMMSG) || defined(SRT_ENABLE_RECVMMSG)
+#include <netinet/udp.h>
+#endif
+
+#if defined(SRT_ENABLE_RECVMMSG) && defined(UDP_GRO)
+// UDP generic receive offload is supported by the system headers.
+#define SRT_ENABLE_GRO 1
+#endif
+
+#if defined(SRT_ENABLE_SENDMMSG) && defined(UDP_SEGMENT)
+// UDP generic segmentation offload is supported by the system headers.
+#define SRT_ENABLE_GSO 1
+
+namespace
+{
+// Limits for the number of segments and the total size of a GSO message,
+// as in the Linux kernel (UDP_MAX_SEGMENTS and the maximum IPv6 UDP payload).
+const int    GSO_MAX_SEGMENTS = 64;
+const size_t GSO_MAX_SIZE     = 65535 - 40 - 8;
+
+// Only the IP address of the source is used (in IP_PKTINFO),
+// and there's none set for packets with an unspecified source.
+bool sameSourceAddress(const srt::sockaddr_any& a, const srt::sockaddr_any& b)
+{
+    if (a.family() != b.family())
+        return false;
+    return a.family() == AF_UNSPEC || a.equal_address(b);
+}
+} // namespace
+#endif
+
+#ifdef SRT_ENABLE_UDP_SHARDS
+#include <linux/filter.h>
+#endif
+
+#ifdef SRT_ENABLE_TXTIME
+#include <linux/net_tstamp.h>
+
+namespace
+{
+// The send time is passed to the system as CLOCK_MONOTONIC time,
+// converted from the steady clock at the moment of sending.
+struct TxTimeClock
+{
+    srt::sync::steady_clock::time_point steady;
+    uint64_t                            mono_ns;
+
+    TxTimeClock()
+        : steady(srt::sync::steady_clock::now())
+    {
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        mono_ns = uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    // Append SCM_TXTIME to the ancillary data in @a buf, unless the packet is due
+    // already. The buffer must have space for it after the data set in @a mh so far.
+    // Returns true if the send time was set.
+    bool setSendTime(msghdr& mh, char* buf, const srt::sync::steady_clock::time_point& send_time) const
+    {
+        if (srt::sync::is_zero(send_time) || send_time <= steady)
+            return false;
+
+        const uint64_t txtime = mono_ns + uint64_t(srt::sync::count_microseconds(send_time - steady)) * 1000;
+        cmsghdr*       cmsg   = (cmsghdr*)(buf + mh.msg_controllen);
+        cmsg->cmsg_level      = SOL_SOCKET;
+        cmsg->cmsg_type       = SCM_TXTIME;
+        cmsg->cmsg_len        = CMSG_LEN(sizeof txtime);
+        memcpy(CMSG_DATA(cmsg), &txtime, sizeof txtime);
+        mh.msg_control = buf;
+        mh.msg_controllen += CMSG_SPACE(sizeof txtime);
+        return true;
+    }
+};
+
+bool hasControlMessage(msghdr& mh, int level, int type)
+{
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&mh); cmsg; cmsg = CMSG_NXTHDR(&mh, cmsg))
+    {
+        if (cmsg->cmsg_level == level && cmsg->cmsg_type == type)
+            return true;
+    }
+    return false;
+}
+
+// Remove the ancillary data of the given level and type from the message,
+// moving the data that follow it in the buffer, if any.
+void removeControlMessage(msghdr& mh, int level, int type)
+{
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&mh); cmsg; cmsg = CMSG_NXTHDR(&mh, cmsg))
+    {
+        if (cmsg->cmsg_level != level || cmsg->cmsg_type != type)
+            continue;
+
+        char* const  begin = (char*)cmsg;
+        char* const  end   = (char*)mh.msg_control + mh.msg_controllen;
+        const size_t space = CMSG_SPACE(cmsg->cmsg_len - CMSG_LEN(0));
+        memmove(begin, begin + space, end - (begin + space));
+        mh.msg_controllen -= space;
+        if (mh.msg_controllen == 0)
+            mh.msg_control = NULL;
+        return;
+    }
+}
+} // namespace
+#endif
+
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+namespace
+{
+// Receive timestamps older than this are regarded as broken by
+// a change of the system clock, which they are taken from.
+const int64_t RCVTIMESTAMP_MAX_AGE_US = 1000000;
+
+// The system receive timestamps are converted into the steady clock
+// domain by their age at the moment when the packets are read.
+struct ArrivalClock
+{
+    timespec                            sys;
+    srt::sync::steady_clock::time_point steady;
+
+    ArrivalClock()
+        : steady(srt::sync::steady_clock::now())
+    {
+        ::clock_gettime(CLOCK_REALTIME, &sys);
+    }
+
+    // Get the receive time of a packet from SCM_TIMESTAMPNS, or zero if not found.
+    srt::sync::steady_clock::time_point arrivalTime(const msghdr& mh) const
+    {
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&mh); cmsg != NULL; cmsg = CMSG_NXTHDR((msghdr*)&mh, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPNS)
+                continue;
+
+            timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof ts);
+            const int64_t age_us = int64_t(sys.tv_sec - ts.tv_sec) * 1000000 + (sys.tv_nsec - ts.tv_nsec) / 1000;
+            if (age_us < 0 || age_us > RCVTIMESTAMP_MAX_AGE_US)
+                break;
+            return steady - srt::sync::microseconds_from(age_us);
+        }
+        return srt::sync::steady_clock::time_point();
+    }
+};
+} // namespace
+#endif
+
 #ifdef _WIN32
 typedef int socklen_t;
 #endif
@@ -138,18 +286,30 @@ static int set_cloexec(int fd, int set)
 
 srt::CChannel::CChannel()
     : m_iSocket(INVALID_SOCKET)
+#ifdef SRT_ENABLE_RECVMMSG
+    , m_bUseGRO(false)
+#endif
+    , m_bUseRcvTimestamp(false)
+    , m_iRcvWaitUs(10000)
+    , m_bUseTxTime(false)
+#ifdef SRT_ENABLE_IOURING
+    , m_pRcvUring(NULL)
+    , m_pSndUring(NULL)
+    , m_bUringRcvArmed(false)
+#endif
+#ifdef SRT_ENABLE_SENDMMSG
+    , m_bUseGSO(false)
+#endif
 #ifdef SRT_ENABLE_PKTINFO
     , m_bBindMasked(true)
 #endif
 {
 #ifdef SRT_ENABLE_PKTINFO
    // Do the check for ancillary data buffer size, kinda assertion
-   static const size_t CMSG_MAX_SPACE = sizeof (CMSGNodeIPv4) + sizeof (CMSGNodeIPv6);
-
    if (CMSG_MAX_SPACE < CMSG_SPACE(sizeof(in_pktinfo)) + CMSG_SPACE(sizeof(in6_pktinfo)))
    {
        LOGC(kmlog.Fatal, log << "Size of CMSG_MAX_SPACE="
-               << CMSG_MAX_SPACE << " too short for cmsg "
+               << size_t(CMSG_MAX_SPACE) << " too short for cmsg "
                << CMSG_SPACE(sizeof(in_pktinfo)) << ", "
                << CMSG_SPACE(sizeof(in6_pktinfo)) << " - PLEASE FIX");
        throw CUDTException(MJ_SETUP, MN_NONE, 0);
@@ -157,7 +317,12 @@ srt::CChannel::CChannel()
 #endif
 }
 
-srt::CChannel::~CChannel() {}
+srt::CChannel::~CChannel()
+{
+#ifdef SRT_ENABLE_IOURING
+    closeUring();
+#endif
+}
 
 void srt::CChannel::createSocket(int family)
 {
@@ -213,6 +378,18 @@ void srt::CChannel::createSocket(int family)
         }
 #endif // ENABLE_LOGGING
     }
+
+    if (m_mcfg.iUDPShards > 1)
+    {
+#ifdef SRT_ENABLE_UDP_SHARDS
+        // Required also for the first socket bound to the port.
+        const int on = 1;
+        if (::setsockopt(m_iSocket, SOL_SOCKET, SO_REUSEPORT, (const char*)&on, sizeof on) == -1)
+#endif
+        {
+            LOGC(kmlog.Warn, log << "SO_REUSEPORT is not supported on this system, SRTO_UDP_SHARDS ignored");
+        }
+    }
 }
 
 void srt::CChannel::open(const sockaddr_any& addr)
@@ -519,10 +696,179 @@ void srt::CChannel::setUDPSockOpt()
         //::setsockopt(m_iSocket, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
     }
 #endif
+
+    if (m_mcfg.bUDPGso)
+    {
+#ifdef SRT_ENABLE_GSO
+        // The segment size is passed with every message, this only
+        // checks if the system supports it at all.
+        int       gso_size = 0;
+        socklen_t optlen   = sizeof gso_size;
+        m_bUseGSO          = ::getsockopt(m_iSocket, SOL_UDP, UDP_SEGMENT, (char*)&gso_size, &optlen) == 0;
+        if (!m_bUseGSO)
+#endif
+        {
+            LOGC(kmlog.Warn, log << "UDP GSO is not supported on this system, SRTO_UDP_GSO ignored");
+        }
+    }
+
+    if (m_mcfg.bUDPGro)
+    {
+#ifdef SRT_ENABLE_GRO
+        const int on = 1;
+        m_bUseGRO    = ::setsockopt(m_iSocket, SOL_UDP, UDP_GRO, (const char*)&on, sizeof on) == 0;
+        if (!m_bUseGRO)
+#endif
+        {
+            LOGC(kmlog.Warn, log << "UDP GRO is not supported on this system, SRTO_UDP_GRO ignored");
+        }
+    }
+
+    if (m_mcfg.bUDPRcvTimestamp)
+    {
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+        const int on       = 1;
+        m_bUseRcvTimestamp = ::setsockopt(m_iSocket, SOL_SOCKET, SO_TIMESTAMPNS, (const char*)&on, sizeof on) == 0;
+        if (!m_bUseRcvTimestamp)
+#endif
+        {
+            LOGC(kmlog.Warn,
+                 log << "UDP receive timestamps are not supported on this system, SRTO_UDP_RCVTIMESTAMP ignored");
+        }
+    }
+
+    if (m_mcfg.bUDPTxTime)
+    {
+#ifdef SRT_ENABLE_TXTIME
+        sock_txtime txtime_cfg;
+        txtime_cfg.clockid = CLOCK_MONOTONIC;
+        txtime_cfg.flags   = 0;
+        m_bUseTxTime = ::setsockopt(m_iSocket, SOL_SOCKET, SO_TXTIME, (const char*)&txtime_cfg, sizeof txtime_cfg) == 0;
+        if (!m_bUseTxTime)
+#endif
+        {
+            LOGC(kmlog.Warn, log << "UDP send time is not supported on this system, SRTO_UDP_TXTIME ignored");
+        }
+    }
+
+    if (m_mcfg.bUDPIoUring)
+    {
+#ifdef SRT_ENABLE_IOURING
+        setupUring();
+        if (!m_pRcvUring)
+#endif
+        {
+            LOGC(kmlog.Warn, log << "io_uring is not supported on this system, SRTO_UDP_IOURING ignored");
+        }
+    }
+}
+
+#ifdef SRT_ENABLE_IOURING
+void srt::CChannel::setupUring()
+{
+    // Every provided buffer receives the io_uring_recvmsg_out header, followed by
+    // the source address and ancillary data of the size set in m_UringRcvMsg, and
+    // then the packet. SRTO_MSS above the Ethernet MTU isn't supported this way.
+    memset(&m_UringRcvMsg, 0, sizeof m_UringRcvMsg);
+    m_UringRcvMsg.msg_namelen = m_BindAddr.size();
+#ifdef SRT_ENABLE_PKTINFO
+    if (m_bBindMasked)
+        m_UringRcvMsg.msg_controllen = RCV_CMSG_SPACE;
+#endif
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+    if (m_bUseRcvTimestamp)
+        m_UringRcvMsg.msg_controllen = RCV_CMSG_SPACE;
+#endif
+
+    static const unsigned RCV_URING_BUFFERS = 512;
+    size_t bufsize = sizeof(io_uring_recvmsg_out) + m_UringRcvMsg.msg_namelen + m_UringRcvMsg.msg_controllen
+                   + CPacket::ETH_MAX_MTU_SIZE;
+    bufsize = (bufsize + 63) & ~size_t(63);
+
+    m_pRcvUring = new CUring;
+    if (!m_pRcvUring->open(4, 2 * RCV_URING_BUFFERS)
+        || !m_pRcvUring->setupBufferRing(URING_RCV_BGID, RCV_URING_BUFFERS, bufsize))
+    {
+        closeUring();
+        return;
+    }
+
+    if (m_mcfg.iUDPSndBatch > 1)
+    {
+        // Only the batches are sent through the ring, see sendtoBatch().
+        m_pSndUring = new CUring;
+        if (!m_pSndUring->open(CSrtMuxerConfig::MAX_UDP_BATCH_SIZE, 0))
+        {
+            delete m_pSndUring;
+            m_pSndUring = NULL;
+        }
+    }
+
+#ifdef SRT_ENABLE_GRO
+    if (m_bUseGRO)
+    {
+        // Coalesced packets wouldn't fit in the provided buffers.
+        const int off = 0;
+        ::setsockopt(m_iSocket, SOL_UDP, UDP_GRO, (const char*)&off, sizeof off);
+        m_bUseGRO = false;
+        LOGC(kmlog.Warn, log << "SRTO_UDP_GRO is not used together with SRTO_UDP_IOURING");
+    }
+#endif
+}
+
+void srt::CChannel::closeUring() const
+{
+    delete m_pRcvUring;
+    m_pRcvUring      = NULL;
+    m_bUringRcvArmed = false;
+    delete m_pSndUring;
+    m_pSndUring = NULL;
+}
+#endif
+
+int srt::CChannel::pollDescriptor() const
+{
+#ifdef SRT_ENABLE_IOURING
+    if (m_pRcvUring)
+        return m_pRcvUring->fd();
+#endif
+    return (int)m_iSocket;
+}
+
+bool srt::CChannel::setShardSteering(int nshards SRT_ATR_UNUSED) const
+{
+#ifdef SRT_ENABLE_UDP_SHARDS
+    // The program is run with the UDP payload, that is, the SRT header, and
+    // returns the index of the socket. An index out of range (for ID 0)
+    // makes the system select the socket by the hash of the addresses.
+    sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, SRT_PH_ID * sizeof(uint32_t)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 2, 0),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, (uint32_t)nshards),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+        BPF_STMT(BPF_RET | BPF_K, (uint32_t)-1),
+    };
+
+    sock_fprog prog;
+    prog.len    = (unsigned short)Size(code);
+    prog.filter = code;
+    if (::setsockopt(m_iSocket, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof prog) == 0)
+        return true;
+
+    LOGC(kmlog.Warn, log << "CChannel: can't attach the steering program: " << SysStrError(NET_ERROR));
+#endif
+    return false;
 }
 
 void srt::CChannel::close() const
 {
+#ifdef SRT_ENABLE_IOURING
+    // Pending requests are canceled when the ring is closed, but the system
+    // does it asynchronously, and until then the socket stays bound. So the
+    // receive request is canceled first, for the port to be free on return.
+    cancelUringRcv();
+    closeUring();
+#endif
 #ifndef _WIN32
     ::close(m_iSocket);
 #else
@@ -736,6 +1082,7 @@ int srt::CChannel::sendto(const sockaddr_any& addr, CPacket& packet, const socka
 
     // convert control information into network order
     packet.toNetworkByteOrder();
+    bool with_txtime = false;
 
 #ifndef _WIN32
     msghdr mh;
@@ -745,11 +1092,14 @@ int srt::CChannel::sendto(const sockaddr_any& addr, CPacket& packet, const socka
     mh.msg_iovlen     = 2;
     bool have_set_src = false;
 
+#if defined(SRT_ENABLE_PKTINFO) || defined(SRT_ENABLE_TXTIME)
+    char mh_crtl_buf[SND_CMSG_SPACE];
+#endif
+
 #ifdef SRT_ENABLE_PKTINFO
 
     // Note that even if PKTINFO is desired, the first caller's packet will be sent
     // without ancillary info anyway because there's no "peer" yet to know where to send it.
-    char mh_crtl_buf[sizeof(CMSGNodeIPv4) + sizeof(CMSGNodeIPv6)];
     if (m_bBindMasked && source_addr.family() != AF_UNSPEC && !source_addr.isany())
     {
         if (!setSourceAddress(mh, mh_crtl_buf, source_addr))
@@ -772,7 +1122,26 @@ int srt::CChannel::sendto(const sockaddr_any& addr, CPacket& packet, const socka
     }
     mh.msg_flags      = 0;
 
-    const int res = (int)::sendmsg(m_iSocket, &mh, 0);
+#ifdef SRT_ENABLE_TXTIME
+    const size_t pktinfo_len = mh.msg_controllen;
+    with_txtime              = m_bUseTxTime && TxTimeClock().setSendTime((mh), mh_crtl_buf, packet.m_tsSendTime);
+#endif
+
+    int res = (int)::sendmsg(m_iSocket, &mh, 0);
+
+#ifdef SRT_ENABLE_TXTIME
+    if (res == -1 && with_txtime && NET_ERROR == EINVAL)
+    {
+        // The system refuses the send time. Turn it off and send the packet now.
+        LOGC(kslog.Warn, log << "CChannel::sendto: UDP send time rejected - turning SRTO_UDP_TXTIME off");
+        m_bUseTxTime      = false;
+        with_txtime       = false;
+        mh.msg_controllen = pktinfo_len;
+        if (mh.msg_controllen == 0)
+            mh.msg_control = NULL;
+        res = (int)::sendmsg(m_iSocket, &mh, 0);
+    }
+#endif
 #else
     class WSAEventRef
     {
@@ -833,23 +1202,260 @@ int srt::CChannel::sendto(const sockaddr_any& addr, CPacket& packet, const socka
 #endif
 
     packet.toHostByteOrder();
+    if (!with_txtime)
+        packet.m_tsSendTime = sync::steady_clock::time_point();
 
     return res;
 }
 
+int srt::CChannel::sendtoBatch(const sockaddr_any* addrs,
+                               CPacket* const*     packets,
+                               const sockaddr_any* srcs,
+                               int                 count,
+                               int&                w_gso_pkts) const
+{
+    w_gso_pkts = 0;
+
+    // Fake loss is implemented in sendto() only.
+#if defined(SRT_ENABLE_SENDMMSG) && !defined(SRT_TEST_FAKE_LOSS)
+    if (count > 1)
+    {
+        // The buffers below are shared by all sender workers (SRTO_SNDWORKERS).
+        sync::ScopedLock lk(m_SndBatchLock);
+
+        // Ancillary data space for one message: source address, send time and GSO segment size.
+        size_t cmsg_space = 0;
+#ifdef SRT_ENABLE_PKTINFO
+        if (m_bBindMasked)
+            cmsg_space += CMSG_MAX_SPACE;
+#endif
+#ifdef SRT_ENABLE_TXTIME
+        // Another sender thread may turn it off in the meantime (see sendto()).
+        const TxTimeClock txtime_clock;
+        const bool        use_txtime = m_bUseTxTime;
+        if (use_txtime)
+            cmsg_space += CMSG_SPACE(sizeof(uint64_t));
+#endif
+#ifdef SRT_ENABLE_GSO
+        if (m_bUseGSO)
+            cmsg_space += CMSG_SPACE(sizeof(uint16_t));
+#endif
+
+        if (m_SndBatchHeaders.size() < size_t(count))
+        {
+            m_SndBatchHeaders.resize(count);
+            m_SndBatchSegments.resize(count);
+            m_SndBatchIov.resize(count * CPacket::PV_SIZE);
+        }
+        if (m_SndBatchCmsgBuffer.size() < count * cmsg_space)
+            m_SndBatchCmsgBuffer.resize(count * cmsg_space);
+
+        // Prepare one message per packet, or, with GSO, one message per run
+        // of packets of the same size (except possibly the last one, which may
+        // be shorter) to the same destination from the same source.
+        int    nmsgs    = 0;
+        size_t iov_used = 0;
+        for (int i = 0; i < count;)
+        {
+            const size_t seglen = CPacket::HDR_SIZE + packets[i]->getLength();
+            int          nsegs  = 1;
+#ifdef SRT_ENABLE_GSO
+            if (m_bUseGSO)
+            {
+                size_t total = seglen;
+                while (i + nsegs < count && nsegs < GSO_MAX_SEGMENTS)
+                {
+                    const int    n   = i + nsegs;
+                    const size_t len = CPacket::HDR_SIZE + packets[n]->getLength();
+                    if (len > seglen || total + len > GSO_MAX_SIZE || addrs[n] != addrs[i] || !sameSourceAddress(srcs[n], srcs[i]))
+                        break;
+#ifdef SRT_ENABLE_TXTIME
+                    // All segments are sent at once, so only packets due at the same time.
+                    if (use_txtime && packets[n]->m_tsSendTime != packets[i]->m_tsSendTime)
+                        break;
+#endif
+                    total += len;
+                    ++nsegs;
+                    if (len < seglen)
+                        break;
+                }
+            }
+#endif
+
+            msghdr& mh     = m_SndBatchHeaders[nmsgs].msg_hdr;
+            mh.msg_name    = (sockaddr*)addrs[i].get();
+            mh.msg_namelen = addrs[i].size();
+            mh.msg_iov     = &m_SndBatchIov[iov_used];
+            mh.msg_iovlen  = nsegs * CPacket::PV_SIZE;
+
+            for (int n = i; n < i + nsegs; ++n)
+            {
+                CPacket& packet = *packets[n];
+                HLOGC(kslog.Debug,
+                      log << "CChannel::sendtoBatch: [" << n << "] DST=" << addrs[n].str() << " target=@" << packet.id()
+                          << " size=" << packet.getLength() << " " << packet.Info());
+
+                packet.toNetworkByteOrder();
+                for (size_t v = 0; v < CPacket::PV_SIZE; ++v)
+                    m_SndBatchIov[iov_used++] = packet.m_PacketVector[v];
+            }
+
+            mh.msg_control    = NULL;
+            mh.msg_controllen = 0;
+            mh.msg_flags      = 0;
+            char* cmsg_buf SRT_ATR_UNUSED = cmsg_space ? &m_SndBatchCmsgBuffer[nmsgs * cmsg_space] : NULL;
+#ifdef SRT_ENABLE_PKTINFO
+            const sockaddr_any& source_addr = srcs[i];
+            if (m_bBindMasked && source_addr.family() != AF_UNSPEC && !source_addr.isany())
+            {
+                if (!setSourceAddress(mh, cmsg_buf, source_addr))
+                {
+                    LOGC(kslog.Error, log << "CChannel::setSourceAddress: source address invalid family #" << source_addr.family() << ", NOT setting.");
+                    mh.msg_control    = NULL;
+                    mh.msg_controllen = 0;
+                }
+            }
+#endif
+#ifdef SRT_ENABLE_TXTIME
+            if (use_txtime)
+                txtime_clock.setSendTime((mh), cmsg_buf, packets[i]->m_tsSendTime);
+#endif
+#ifdef SRT_ENABLE_GSO
+            if (nsegs > 1)
+            {
+                // Append the segment size after the source address and send time, if any.
+                const size_t   pktinfo_len = mh.msg_controllen;
+                const uint16_t gso_size    = (uint16_t)seglen;
+                cmsghdr*       cmsg        = (cmsghdr*)(cmsg_buf + pktinfo_len);
+                cmsg->cmsg_level           = SOL_UDP;
+                cmsg->cmsg_type            = UDP_SEGMENT;
+                cmsg->cmsg_len             = CMSG_LEN(sizeof(uint16_t));
+                memcpy(CMSG_DATA(cmsg), &gso_size, sizeof gso_size);
+                mh.msg_control    = cmsg_buf;
+                mh.msg_controllen = pktinfo_len + CMSG_SPACE(sizeof(uint16_t));
+            }
+#endif
+            m_SndBatchHeaders[nmsgs].msg_len = 0;
+            m_SndBatchSegments[nmsgs]        = nsegs;
+            ++nmsgs;
+            i += nsegs;
+        }
+
+        // sendmmsg() stops at the first message that failed to be sent. Such
+        // a message is dropped, just like when sendto() fails, and the rest
+        // is sent with the next call.
+        int ncalls = 0;
+        for (int sent = 0; sent < nmsgs;)
+        {
+#ifdef SRT_ENABLE_IOURING
+            const int res = m_pSndUring ? sendmmsgUring(&m_SndBatchHeaders[sent], nmsgs - sent)
+                                        : ::sendmmsg(m_iSocket, &m_SndBatchHeaders[sent], nmsgs - sent, 0);
+#else
+            const int res = ::sendmmsg(m_iSocket, &m_SndBatchHeaders[sent], nmsgs - sent, 0);
+#endif
+            ++ncalls;
+            if (res > 0)
+            {
+                for (int m = sent; m < sent + res; ++m)
+                {
+                    if (m_SndBatchSegments[m] > 1)
+                        w_gso_pkts += m_SndBatchSegments[m];
+                }
+                sent += res;
+                continue;
+            }
+
+            const int err SRT_ATR_UNUSED = NET_ERROR;
+#ifdef SRT_ENABLE_TXTIME
+            if (use_txtime && err == EINVAL && hasControlMessage(m_SndBatchHeaders[sent].msg_hdr, SOL_SOCKET, SCM_TXTIME))
+            {
+                // The system refuses the send time. Turn it off and send the
+                // rejected message and the rest of them again without it.
+                LOGC(kslog.Warn, log << "CChannel::sendtoBatch: UDP send time rejected - turning SRTO_UDP_TXTIME off");
+                m_bUseTxTime = false;
+                for (int m = sent; m < nmsgs; ++m)
+                    removeControlMessage(m_SndBatchHeaders[m].msg_hdr, SOL_SOCKET, SCM_TXTIME);
+                continue;
+            }
+#endif
+#ifdef SRT_ENABLE_GSO
+            if (m_SndBatchSegments[sent] > 1 && (err == EIO || err == EINVAL || err == EOPNOTSUPP || err == ENOPROTOOPT))
+            {
+                // The system or the network device refuses segmentation offload.
+                // Turn it off and send the packets of this message one by one.
+                LOGC(kslog.Warn, log << "CChannel::sendtoBatch: UDP GSO rejected: " << SysStrError(err)
+                        << " - turning SRTO_UDP_GSO off");
+                m_bUseGSO = false;
+
+                msghdr mh = m_SndBatchHeaders[sent].msg_hdr;
+                mh.msg_controllen -= CMSG_SPACE(sizeof(uint16_t));
+                if (mh.msg_controllen == 0)
+                    mh.msg_control = NULL;
+                const iovec* iov = mh.msg_iov;
+                for (int n = 0; n < m_SndBatchSegments[sent]; ++n)
+                {
+                    mh.msg_iov    = (iovec*)iov + n * CPacket::PV_SIZE;
+                    mh.msg_iovlen = CPacket::PV_SIZE;
+                    ::sendmsg(m_iSocket, &mh, 0);
+                    ++ncalls;
+                }
+                ++sent;
+                continue;
+            }
+#endif
+            HLOGC(kslog.Debug, log << "CChannel::sendtoBatch: sendmmsg failed: " << SysStrError(err));
+            ++sent;
+        }
+
+        // Leave the send time only on the packets it was passed with.
+        for (int m = 0, i = 0; m < nmsgs; ++m)
+        {
+            bool with_txtime = false;
+#ifdef SRT_ENABLE_TXTIME
+            with_txtime = use_txtime && hasControlMessage(m_SndBatchHeaders[m].msg_hdr, SOL_SOCKET, SCM_TXTIME);
+#endif
+            for (const int end = i + m_SndBatchSegments[m]; i < end; ++i)
+            {
+                packets[i]->toHostByteOrder();
+                if (!with_txtime)
+                    packets[i]->m_tsSendTime = sync::steady_clock::time_point();
+            }
+        }
+
+        return ncalls;
+    }
+#endif
+
+    for (int i = 0; i < count; ++i)
+        sendto(addrs[i], *packets[i], srcs[i]);
+    return count;
+}
+
 srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet) const
 {
     EReadStatus status    = RST_OK;
     int         msg_flags = 0;
     int         recv_size = -1;
 
+#ifdef SRT_ENABLE_IOURING
+    if (m_pRcvUring)
+    {
+        CPacket* packet = &w_packet;
+        int      nrecv  = 0;
+        status          = recvfromUring(&w_addr, &packet, 1, (nrecv));
+        if (status != RST_OK)
+            w_packet.setLength(-1);
+        return status;
+    }
+#endif
+
 #if defined(UNIX) || defined(_WIN32)
     fd_set  set;
     timeval tv;
     FD_ZERO(&set);
     FD_SET(m_iSocket, &set);
     tv.tv_sec            = 0;
-    tv.tv_usec           = 10000;
+    tv.tv_usec           = m_iRcvWaitUs;
     const int select_ret = ::select((int)m_iSocket + 1, &set, NULL, &set, &tv);
 #else
     const int select_ret = 1; // the socket is expected to be in the blocking mode itself
@@ -875,10 +1481,12 @@ srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet
         mh.msg_control    = NULL;
         mh.msg_controllen = 0;
 
+#if defined(SRT_ENABLE_PKTINFO) || defined(SRT_ENABLE_RCVTIMESTAMP)
+        char mh_crtl_buf[RCV_CMSG_SPACE];
+#endif
 #ifdef SRT_ENABLE_PKTINFO
         // Without m_bBindMasked, we don't need ancillary data - the source
         // address will always be the bound address.
-        char mh_crtl_buf[sizeof(CMSGNodeIPv4) + sizeof(CMSGNodeIPv6)];
         if (m_bBindMasked)
         {
             // Extract the destination IP address from the ancillary
@@ -889,6 +1497,13 @@ srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet
             mh.msg_controllen = sizeof mh_crtl_buf;
         }
 #endif
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+        if (m_bUseRcvTimestamp)
+        {
+            mh.msg_control    = (mh_crtl_buf);
+            mh.msg_controllen = sizeof mh_crtl_buf;
+        }
+#endif
 
         mh.msg_flags      = 0;
 
@@ -946,6 +1561,11 @@ srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet
     }
 #endif
 
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+    if (m_bUseRcvTimestamp)
+        w_packet.m_tsArrival = ArrivalClock().arrivalTime(mh);
+#endif
+
 #else
     // XXX REFACTORING NEEDED!
     // This procedure uses the WSARecvFrom function that just reads
@@ -1089,3 +1709,439 @@ Return_error:
     w_packet.setLength(-1);
     return status;
 }
+
+srt::EReadStatus srt::CChannel::recvfromBatch(sockaddr_any* w_addrs, CPacket* const* w_packets, int count, int& w_nrecv) const
+{
+    w_nrecv = 0;
+
+#ifdef SRT_ENABLE_IOURING
+    if (m_pRcvUring)
+        return recvfromUring(w_addrs, w_packets, count, (w_nrecv));
+#endif
+
+#ifdef SRT_ENABLE_RECVMMSG
+    if (count > 1)
+    {
+        fd_set  rset, eset;
+        timeval tv;
+        FD_ZERO(&rset);
+        FD_SET(m_iSocket, &rset);
+        eset                 = rset;
+        tv.tv_sec            = 0;
+        tv.tv_usec           = m_iRcvWaitUs;
+        const int select_ret = ::select((int)m_iSocket + 1, &rset, NULL, &eset, &tv);
+
+        if (select_ret == 0) // timeout
+            return RST_AGAIN;
+
+        int nmsgs = -1;
+        if (select_ret > 0)
+        {
+            if (m_RcvBatchHeaders.size() < size_t(count))
+                m_RcvBatchHeaders.resize(count);
+            bool with_cmsg = m_bUseRcvTimestamp;
+#ifdef SRT_ENABLE_PKTINFO
+            with_cmsg = with_cmsg || m_bBindMasked;
+#endif
+            if (with_cmsg && m_RcvBatchCmsgBuffer.size() < count * RCV_CMSG_SPACE)
+                m_RcvBatchCmsgBuffer.resize(count * RCV_CMSG_SPACE);
+
+            for (int i = 0; i < count; ++i)
+            {
+                msghdr& mh        = m_RcvBatchHeaders[i].msg_hdr;
+                mh.msg_name       = w_addrs[i].get();
+                mh.msg_namelen    = w_addrs[i].size();
+                mh.msg_iov        = w_packets[i]->m_PacketVector;
+                mh.msg_iovlen     = 2;
+                mh.msg_control    = NULL;
+                mh.msg_controllen = 0;
+                if (with_cmsg)
+                {
+                    mh.msg_control    = &m_RcvBatchCmsgBuffer[i * RCV_CMSG_SPACE];
+                    mh.msg_controllen = RCV_CMSG_SPACE;
+                }
+                mh.msg_flags               = 0;
+                m_RcvBatchHeaders[i].msg_len = 0;
+            }
+
+            // The socket is in blocking mode, so MSG_DONTWAIT is required here, otherwise
+            // the call would block until the whole batch is filled up. The select() call
+            // above already waited for the first packet.
+            nmsgs = ::recvmmsg(m_iSocket, &m_RcvBatchHeaders[0], count, MSG_DONTWAIT, NULL);
+        }
+
+        // Error handling is the same as for recvfrom().
+        if (select_ret == -1 || nmsgs == -1)
+        {
+            const int err = NET_ERROR;
+            if (err == EAGAIN || err == EINTR || err == ECONNREFUSED)
+                return RST_AGAIN;
+
+            HLOGC(krlog.Debug, log << CONID() << "(sys)recvmmsg: " << SysStrError(err) << " [" << err << "]");
+            return RST_ERROR;
+        }
+
+        if (nmsgs == 0)
+            return RST_AGAIN;
+
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+        const ArrivalClock arrival_clock;
+#endif
+        for (int i = 0; i < nmsgs; ++i)
+        {
+            CPacket&     packet    = *w_packets[i];
+            const msghdr& mh       = m_RcvBatchHeaders[i].msg_hdr;
+            const size_t recv_size = m_RcvBatchHeaders[i].msg_len;
+
+            // Drop the packets that would be rejected by recvfrom(), see there for details.
+            if (recv_size < CPacket::HDR_SIZE || mh.msg_flags != 0)
+            {
+                HLOGC(krlog.Debug,
+                      log << CONID() << "(sys)recvmmsg: dropping packet #" << i << " size=" << recv_size
+                          << " msg_flags=0x" << hex << mh.msg_flags << dec);
+                packet.setLength(-1);
+                continue;
+            }
+
+#ifdef SRT_ENABLE_PKTINFO
+            if (m_bBindMasked)
+                packet.m_DestAddr = getTargetAddress(mh);
+#endif
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+            if (m_bUseRcvTimestamp)
+                packet.m_tsArrival = arrival_clock.arrivalTime(mh);
+#endif
+            packet.setLength(recv_size - CPacket::HDR_SIZE);
+            packet.toHostByteOrder();
+        }
+
+        w_nrecv = nmsgs;
+        return RST_OK;
+    }
+#endif
+
+    const EReadStatus st = recvfrom((w_addrs[0]), (*w_packets[0]));
+    if (st == RST_OK)
+        w_nrecv = 1;
+    return st;
+}
+
+srt::EReadStatus srt::CChannel::recvfromGro(sockaddr_any&                   w_addr,
+                                            char*                           buf,
+                                            size_t                          size,
+                                            size_t&                         w_len,
+                                            size_t&                         w_segsize,
+                                            sockaddr_any&                   w_dest,
+                                            sync::steady_clock::time_point& w_arrival) const
+{
+    w_len     = 0;
+    w_segsize = 0;
+    w_dest    = sockaddr_any();
+    w_arrival = sync::steady_clock::time_point();
+
+#ifdef SRT_ENABLE_GRO
+    fd_set  rset, eset;
+    timeval tv;
+    FD_ZERO(&rset);
+    FD_SET(m_iSocket, &rset);
+    eset                 = rset;
+    tv.tv_sec            = 0;
+    tv.tv_usec           = m_iRcvWaitUs;
+    const int select_ret = ::select((int)m_iSocket + 1, &rset, NULL, &eset, &tv);
+
+    if (select_ret == 0) // timeout
+        return RST_AGAIN;
+
+    int    recv_size = -1;
+    msghdr mh;
+    // Space for IP_PKTINFO (see recvfrom()), the UDP_GRO segment size and the timestamp.
+    char   mh_crtl_buf[CMSG_SPACE(sizeof(in_pktinfo)) + CMSG_SPACE(sizeof(in6_pktinfo)) + CMSG_SPACE(sizeof(int))
+                     + CMSG_SPACE(sizeof(timespec))];
+    if (select_ret > 0)
+    {
+        iovec iov;
+        iov.iov_base      = buf;
+        iov.iov_len       = size;
+        mh.msg_name       = w_addr.get();
+        mh.msg_namelen    = w_addr.size();
+        mh.msg_iov        = &iov;
+        mh.msg_iovlen     = 1;
+        mh.msg_control    = mh_crtl_buf;
+        mh.msg_controllen = sizeof mh_crtl_buf;
+        mh.msg_flags      = 0;
+
+        recv_size = (int)::recvmsg(m_iSocket, (&mh), 0);
+    }
+
+    // Error handling is the same as for recvfrom().
+    if (select_ret == -1 || recv_size == -1)
+    {
+        const int err = NET_ERROR;
+        if (err == EAGAIN || err == EINTR || err == ECONNREFUSED)
+            return RST_AGAIN;
+
+        HLOGC(krlog.Debug, log << CONID() << "(sys)recvmsg: " << SysStrError(err) << " [" << err << "]");
+        return RST_ERROR;
+    }
+
+    if (size_t(recv_size) < CPacket::HDR_SIZE || (mh.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0)
+    {
+        HLOGC(krlog.Debug,
+              log << CONID() << "(sys)recvmsg: dropping buffer size=" << recv_size << " msg_flags=0x" << hex
+                  << mh.msg_flags << dec);
+        return RST_AGAIN;
+    }
+
+    w_len     = recv_size;
+    w_segsize = w_len; // a single packet, unless stated otherwise by UDP_GRO
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&mh); cmsg != NULL; cmsg = CMSG_NXTHDR(&mh, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+        {
+            int gso_size = 0;
+            memcpy(&gso_size, CMSG_DATA(cmsg), sizeof gso_size);
+            if (gso_size > 0)
+                w_segsize = gso_size;
+        }
+    }
+
+#ifdef SRT_ENABLE_PKTINFO
+    if (m_bBindMasked)
+        w_dest = getTargetAddress(mh);
+#endif
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+    if (m_bUseRcvTimestamp)
+        w_arrival = ArrivalClock().arrivalTime(mh);
+#endif
+
+    return RST_OK;
+#else
+    (void)w_addr;
+    (void)buf;
+    (void)size;
+    return RST_ERROR;
+#endif
+}
+
+#ifdef SRT_ENABLE_IOURING
+void srt::CChannel::cancelUringRcv() const
+{
+    if (!m_pRcvUring || !m_bUringRcvArmed)
+        return;
+
+    // The receive request has user_data 0.
+    CUring&       ring = *m_pRcvUring;
+    io_uring_sqe* sqe  = ring.getSqe();
+    if (!sqe)
+        return;
+    sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+    sqe->addr      = 0;
+    sqe->user_data = 1;
+
+    static const int CANCEL_TIMEOUT_US = 100000;
+    const sync::steady_clock::time_point deadline = sync::steady_clock::now() + sync::microseconds_from(CANCEL_TIMEOUT_US);
+    while (m_bUringRcvArmed && sync::steady_clock::now() < deadline)
+    {
+        const io_uring_cqe* cqe = ring.peekCqe();
+        if (!cqe)
+        {
+            if (ring.enter(1, CANCEL_TIMEOUT_US) == -1 && errno != EINTR && errno != ETIME)
+                break;
+            continue;
+        }
+
+        // Received packets are dropped, and so their buffers.
+        if (cqe->user_data == 0 && (cqe->flags & IORING_CQE_F_MORE) == 0)
+            m_bUringRcvArmed = false;
+        ring.seenCqe();
+    }
+}
+
+srt::EReadStatus srt::CChannel::recvfromUring(sockaddr_any* w_addrs, CPacket* const* w_packets, int count, int& w_nrecv) const
+{
+    w_nrecv      = 0;
+    CUring& ring = *m_pRcvUring;
+
+    if (!m_bUringRcvArmed)
+    {
+        // A single request receives the packets until it's terminated,
+        // which happens when the provided buffers are exhausted.
+        io_uring_sqe* sqe = ring.getSqe();
+        sqe->opcode       = IORING_OP_RECVMSG;
+        sqe->fd           = m_iSocket;
+        sqe->addr         = (__u64)(uintptr_t)&m_UringRcvMsg;
+        sqe->ioprio       = IORING_RECV_MULTISHOT;
+        sqe->flags        = IOSQE_BUFFER_SELECT;
+        sqe->buf_group    = URING_RCV_BGID;
+        m_bUringRcvArmed  = true;
+    }
+
+    if (!ring.peekCqe())
+    {
+        // Submit the request, if prepared, and wait as with select() in recvfrom().
+        if (ring.enter(1, m_iRcvWaitUs) == -1)
+        {
+            const int err = errno;
+            if (err == ETIME || err == EINTR || err == EAGAIN || err == EBUSY)
+                return RST_AGAIN;
+
+            HLOGC(krlog.Debug, log << CONID() << "(sys)io_uring_enter: " << SysStrError(err) << " [" << err << "]");
+            return RST_ERROR;
+        }
+    }
+
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+    const ArrivalClock arrival_clock;
+#endif
+
+    while (w_nrecv < count)
+    {
+        const io_uring_cqe* cqe = ring.peekCqe();
+        if (!cqe)
+            break;
+
+        const int      res   = cqe->res;
+        const unsigned flags = cqe->flags;
+        ring.seenCqe();
+
+        // Without this flag the request is terminated and is rearmed by the next call.
+        if ((flags & IORING_CQE_F_MORE) == 0)
+            m_bUringRcvArmed = false;
+
+        if (res < 0)
+        {
+            if (res == -EINVAL)
+            {
+                // Multishot receive isn't supported by the system (Linux < 6.0).
+                LOGC(krlog.Warn, log << CONID() << "io_uring multishot receive not supported - turning SRTO_UDP_IOURING off");
+                closeUring();
+                return RST_AGAIN;
+            }
+
+            HLOGC(krlog.Debug, log << CONID() << "(sys)io_uring recvmsg: " << SysStrError(-res) << " [" << -res << "]");
+            if (res == -EBADF)
+                return RST_ERROR;
+            continue;
+        }
+
+        if ((flags & IORING_CQE_F_BUFFER) == 0)
+            continue;
+
+        const unsigned short        bid = (unsigned short)(flags >> IORING_CQE_BUFFER_SHIFT);
+        char*                       buf = ring.buffer(bid);
+        const io_uring_recvmsg_out* out = (const io_uring_recvmsg_out*)buf;
+        char*                       name    = buf + sizeof(io_uring_recvmsg_out);
+        char*                       control = name + m_UringRcvMsg.msg_namelen;
+        const char*                 payload = control + m_UringRcvMsg.msg_controllen;
+        const size_t                size    = out->payloadlen;
+
+        CPacket& packet = *w_packets[w_nrecv];
+
+        // As in recvfrom(), a packet that was truncated or has any other flag set is
+        // dropped; also the packets not fitting in the unit (possible with jumbo frames).
+        if (out->flags != 0 || size < CPacket::HDR_SIZE || size - CPacket::HDR_SIZE > size_t(packet.getLength()))
+        {
+            HLOGC(krlog.Debug,
+                  log << CONID() << "(sys)io_uring recvmsg: dropping packet size=" << size << " flags=0x" << hex
+                      << out->flags << dec);
+            ring.recycleBuffer(bid);
+            continue;
+        }
+
+        memcpy(packet.m_PacketVector[CPacket::PV_HEADER].iov_base, payload, CPacket::HDR_SIZE);
+        memcpy(packet.m_PacketVector[CPacket::PV_DATA].iov_base, payload + CPacket::HDR_SIZE, size - CPacket::HDR_SIZE);
+        w_addrs[w_nrecv].set((const sockaddr*)name, out->namelen);
+
+        // Only the ancillary data are retrieved from this header.
+        msghdr mh;
+        memset(&mh, 0, sizeof mh);
+        mh.msg_control    = out->controllen ? control : NULL;
+        mh.msg_controllen = out->controllen;
+
+#ifdef SRT_ENABLE_PKTINFO
+        if (m_bBindMasked)
+            packet.m_DestAddr = getTargetAddress(mh);
+#endif
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+        if (m_bUseRcvTimestamp)
+            packet.m_tsArrival = arrival_clock.arrivalTime(mh);
+#endif
+        ring.recycleBuffer(bid);
+
+        packet.setLength(size - CPacket::HDR_SIZE);
+        packet.toHostByteOrder();
+        ++w_nrecv;
+    }
+
+    return w_nrecv > 0 ? RST_OK : RST_AGAIN;
+}
+
+int srt::CChannel::sendmmsgUring(mmsghdr* msgs, int count) const
+{
+    CUring& ring = *m_pSndUring;
+
+    // The ring is empty here, as all requests are completed before return.
+    count = std::min(count, int(CSrtMuxerConfig::MAX_UDP_BATCH_SIZE));
+
+    // The requests are linked so that, as with sendmmsg(), the messages
+    // following a failed one are not sent (their requests are canceled).
+    for (int i = 0; i < count; ++i)
+    {
+        io_uring_sqe* sqe = ring.getSqe();
+        sqe->opcode       = IORING_OP_SENDMSG;
+        sqe->fd           = m_iSocket;
+        sqe->addr         = (__u64)(uintptr_t)&msgs[i].msg_hdr;
+        sqe->user_data    = i;
+        if (i < count - 1)
+            sqe->flags = IOSQE_IO_LINK;
+    }
+
+    int ret;
+    do
+        ret = ring.enter(count, -1);
+    while (ret == -1 && errno == EINTR);
+
+    if (ret == -1)
+    {
+        // Nothing was submitted, continue without the ring.
+        const int err SRT_ATR_UNUSED = errno;
+        LOGC(kslog.Warn, log << "CChannel::sendtoBatch: io_uring submission failed: " << SysStrError(err)
+                << " - sending with sendmmsg");
+        delete m_pSndUring;
+        m_pSndUring = NULL;
+        return ::sendmmsg(m_iSocket, msgs, count, 0);
+    }
+
+    int nsent = count;
+    int err   = 0;
+    for (int done = 0; done < count;)
+    {
+        const io_uring_cqe* cqe = ring.peekCqe();
+        if (!cqe)
+        {
+            // Wait for the remaining completions.
+            ring.enter(count - done, -1);
+            continue;
+        }
+
+        const int i   = (int)cqe->user_data;
+        const int res = cqe->res;
+        ring.seenCqe();
+        ++done;
+
+        msgs[i].msg_len = res >= 0 ? res : 0;
+        if (res < 0 && i < nsent)
+        {
+            nsent = i;
+            err   = -res;
+        }
+    }
+
+    if (nsent == 0)
+    {
+        errno = err;
+        return -1;
+    }
+    return nsent;
+}
+#endif
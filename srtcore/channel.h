@@ -52,11 +52,28 @@ modified by
 #ifndef INC_SRT_CHANNEL_H
 #define INC_SRT_CHANNEL_H
 
+#include <vector>
 #include "platform_sys.h"
 #include "udt.h"
 #include "packet.h"
 #include "socketconfig.h"
 #include "netinet_any.h"
+#include "uring.h"
+
+#if defined(SRT_ENABLE_RECVMMSG) && defined(SO_TIMESTAMPNS)
+// System receive timestamps with nanosecond resolution are supported (Linux).
+#define SRT_ENABLE_RCVTIMESTAMP 1
+#endif
+
+#if defined(SRT_ENABLE_SENDMMSG) && defined(SO_TXTIME)
+// Passing the send time of packets to the system is supported (Linux).
+#define SRT_ENABLE_TXTIME 1
+#endif
+
+#if defined(SRT_ENABLE_RECVMMSG) && defined(SO_REUSEPORT) && defined(SO_ATTACH_REUSEPORT_CBPF)
+// Steering packets between the sockets bound to the same port is supported (Linux).
+#define SRT_ENABLE_UDP_SHARDS 1
+#endif
 
 namespace srt
 {
@@ -111,14 +128,28 @@ public:
 
     void getPeerAddr(sockaddr_any& addr) const;
 
-    /// Send a packet to the given address.
+    /// Send a packet to the given address. If SRTO_UDP_TXTIME is in effect and
+    /// the packet has a send time set, the system sends it at that time.
     /// @param [in] addr pointer to the destination address.
-    /// @param [in] packet reference to a CPacket entity.
+    /// @param [in,out] packet reference to a CPacket entity. Its send time is
+    ///                 reset to zero if it wasn't passed to the system.
     /// @param [in] src source address to sent on an outgoing packet (if not ANY)
     /// @return Actual size of data sent.
 
     int sendto(const sockaddr_any& addr, srt::CPacket& packet, const sockaddr_any& src) const;
 
+    /// Send multiple packets with a single system call, if supported by
+    /// the platform; otherwise the packets are sent one by one with sendto().
+    /// @param [in] addrs array of @a count destination addresses.
+    /// @param [in,ref] packets array of @a count packets to be sent out, with
+    ///                 the send time reset as in sendto().
+    /// @param [in] srcs array of @a count source addresses (see sendto()).
+    /// @param [in] count number of packets to send.
+    /// @param [out] gso_pkts number of packets sent coalesced with UDP GSO (SRTO_UDP_GSO).
+    /// @return Number of system calls used to send the packets.
+
+    int sendtoBatch(const sockaddr_any* addrs, srt::CPacket* const* packets, const sockaddr_any* srcs, int count, int& gso_pkts) const;
+
     /// Receive a packet from the channel and record the source address.
     /// @param [in] addr pointer to the source address.
     /// @param [in] packet reference to a CPacket entity.
@@ -126,6 +157,93 @@ public:
 
     EReadStatus recvfrom(sockaddr_any& addr, srt::CPacket& packet) const;
 
+    /// Receive up to @a count packets from the channel with a single system call,
+    /// if supported by the platform; otherwise this reads one packet with recvfrom().
+    /// @param [out] addrs array of (at least) @a count source addresses.
+    /// @param [in,out] packets array of @a count packets with buffers ready for reading.
+    /// @param [in] count maximum number of packets to read.
+    /// @param [out] nrecv number of leading entries in @a packets that were filled in.
+    ///              An entry that was rejected as invalid has its length set to -1.
+    /// @return RST_OK if @a nrecv > 0, otherwise the status as for recvfrom().
+
+    EReadStatus recvfromBatch(sockaddr_any* addrs, srt::CPacket* const* packets, int count, int& nrecv) const;
+
+    /// Receive a buffer that may contain multiple packets coalesced by the
+    /// system with UDP GRO (SRTO_UDP_GRO). All packets in such a buffer have
+    /// the same source and destination address and the same size, except
+    /// possibly the last one, which may be shorter.
+    /// @param [out] addr source address.
+    /// @param [out] buf buffer to receive the data.
+    /// @param [in] size size of the buffer.
+    /// @param [out] len size of the received data.
+    /// @param [out] segsize size of a single packet in the buffer.
+    /// @param [out] dest destination address, if retrieved from IP_PKTINFO, otherwise AF_UNSPEC.
+    /// @param [out] arrival system receive time of the buffer (see CPacket::arrivalTime()).
+    /// @return The status as for recvfrom().
+
+    EReadStatus recvfromGro(sockaddr_any&                   addr,
+                            char*                           buf,
+                            size_t                          size,
+                            size_t&                         len,
+                            size_t&                         segsize,
+                            sockaddr_any&                   dest,
+                            sync::steady_clock::time_point& arrival) const;
+
+    /// Check if UDP GRO is requested (SRTO_UDP_GRO) and supported by the system.
+    bool groEnabled() const
+    {
+#ifdef SRT_ENABLE_RECVMMSG
+        return m_bUseGRO;
+#else
+        return false;
+#endif
+    }
+
+    /// Check if SRTO_UDP_TXTIME is requested and supported by the system.
+    bool txtimeEnabled() const { return m_bUseTxTime; }
+
+    /// Check if io_uring is used for receiving (SRTO_UDP_IOURING).
+    bool iouringEnabled() const
+    {
+#ifdef SRT_ENABLE_IOURING
+        return m_pRcvUring != NULL;
+#else
+        return false;
+#endif
+    }
+
+    /// Make the system deliver the packets to the sockets bound to this port
+    /// (SRTO_UDP_SHARDS) by the SRT destination socket ID: the socket with
+    /// index ID % @a nshards in the order of binding receives it. The packets
+    /// with ID 0 (handshake requests) are delivered by the hash of the source
+    /// and destination address. To be called before the other sockets are bound.
+    /// @param [in] nshards number of sockets bound to the port
+    /// @return false if this isn't supported by the system.
+
+    bool setShardSteering(int nshards) const;
+
+    /// Get the maximum number of packets to read at once (SRTO_UDP_RCVBATCH).
+    int rcvBatchSize() const { return m_mcfg.iUDPRcvBatch; }
+
+    /// Set the maximum time to wait for a packet in the receiving functions.
+    /// With 0 they return RST_AGAIN immediately if there's no packet ready,
+    /// which is used when the readiness is checked by the caller (see CIoWorker).
+    /// @param [in] us time in microseconds, less than 1 second
+    void setRcvWait(int us) { m_iRcvWaitUs = us; }
+
+    /// Get the system descriptor that becomes readable when there are
+    /// packets to receive: the socket, or the io_uring if it's in use.
+    int pollDescriptor() const;
+
+    /// Get the maximum number of packets to send at once (SRTO_UDP_SNDBATCH).
+    int sndBatchSize() const { return m_mcfg.iUDPSndBatch; }
+
+    /// Get the number of threads sending the data packets (SRTO_SNDWORKERS).
+    int sndWorkers() const { return m_mcfg.iSndWorkers; }
+
+    /// Get the number of threads processing the received packets (SRTO_RCVWORKERS).
+    int rcvWorkers() const { return m_mcfg.iRcvWorkers; }
+
     void setConfig(const CSrtMuxerConfig& config);
 
     void getSocketOption(int level, int sockoptname, char* pw_dataptr, socklen_t& w_len, int& w_status);
@@ -167,6 +285,22 @@ public:
 private:
     void setUDPSockOpt();
 
+#ifdef SRT_ENABLE_IOURING
+    void setupUring();
+    void closeUring() const;
+
+    /// Cancel the multishot receive request and wait until it's terminated.
+    void cancelUringRcv() const;
+
+    /// Receive up to @a count packets that were read by the multishot
+    /// receive request of the io_uring (see recvfromBatch()).
+    EReadStatus recvfromUring(sockaddr_any* addrs, CPacket* const* packets, int count, int& nrecv) const;
+
+    /// Send the messages through the io_uring, with the same
+    /// semantics as sendmmsg() (see sendtoBatch()).
+    int sendmmsgUring(mmsghdr* msgs, int count) const;
+#endif
+
 private:
     UDPSOCKET m_iSocket; // socket descriptor
 
@@ -176,6 +310,58 @@ private:
     mutable CSrtMuxerConfig m_mcfg; // Note: ReuseAddr is unused and ineffective.
     sockaddr_any            m_BindAddr;
 
+#ifdef SRT_ENABLE_RECVMMSG
+    // Headers for the recvmmsg call, reused by recvfromBatch.
+    // This is used exclusively by the receiver worker thread.
+    mutable std::vector<mmsghdr> m_RcvBatchHeaders;
+
+    // Whether UDP GRO is requested (SRTO_UDP_GRO) and supported by the system.
+    bool m_bUseGRO;
+#endif
+
+    // Whether the system receive timestamps are requested (SRTO_UDP_RCVTIMESTAMP)
+    // and supported by the system.
+    bool m_bUseRcvTimestamp;
+
+    // Maximum time to wait for a packet when receiving (see setRcvWait()).
+    int m_iRcvWaitUs;
+
+    // Whether passing the send time is requested (SRTO_UDP_TXTIME) and supported
+    // by the system. Turned off by any sender thread if the system rejects it.
+    mutable sync::atomic<bool> m_bUseTxTime;
+
+#ifdef SRT_ENABLE_IOURING
+    // The rings used with SRTO_UDP_IOURING, NULL if not in use. Each one is
+    // used exclusively by the receiver and sender worker thread respectively.
+    mutable CUring* m_pRcvUring;
+    mutable CUring* m_pSndUring;
+
+    // The message header template for the multishot receive request. Only
+    // the lengths of the name and ancillary data are used by the system.
+    msghdr m_UringRcvMsg;
+
+    // Whether the multishot receive request is active.
+    mutable bool m_bUringRcvArmed;
+
+    // Provided buffer group ID of the receive buffers.
+    static const unsigned short URING_RCV_BGID = 0;
+#endif
+
+#ifdef SRT_ENABLE_SENDMMSG
+    // Headers for the sendmmsg call with their buffer vectors, ancillary
+    // data and the number of packets in each, reused by sendtoBatch.
+    // Used by the sender worker threads under m_SndBatchLock.
+    mutable sync::Mutex          m_SndBatchLock;
+    mutable std::vector<mmsghdr> m_SndBatchHeaders;
+    mutable std::vector<iovec>   m_SndBatchIov;
+    mutable std::vector<char>    m_SndBatchCmsgBuffer;
+    mutable std::vector<int>     m_SndBatchSegments;
+
+    // Whether UDP GSO is requested (SRTO_UDP_GSO) and supported by the system.
+    // Turned off by the sender thread if the system rejects it.
+    mutable bool                 m_bUseGSO;
+#endif
+
     // This feature is not enabled on Windows, for now.
     // This is also turned off in case of MinGW
 #ifdef SRT_ENABLE_PKTINFO
@@ -205,6 +391,8 @@ private:
         cmsghdr hdr;
     };
 
+    static const size_t CMSG_MAX_SPACE = sizeof(CMSGNodeIPv4) + sizeof(CMSGNodeIPv6);
+
     sockaddr_any getTargetAddress(const msghdr& msg) const
     {
         // Loop through IP header messages
@@ -285,6 +473,51 @@ private:
 
 #endif //SRT_ENABLE_PKTINFO
 
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+    // Used only to determine the space for SCM_TIMESTAMPNS, as CMSGNodeIPv4 above.
+    struct CMSGNodeTimestamp
+    {
+        timespec ts;
+        size_t extrafill;
+        cmsghdr hdr;
+    };
+#endif
+
+    // Space for the ancillary data of a single received packet.
+    static const size_t RCV_CMSG_SPACE = 0
+#ifdef SRT_ENABLE_PKTINFO
+        + CMSG_MAX_SPACE
+#endif
+#ifdef SRT_ENABLE_RCVTIMESTAMP
+        + sizeof(CMSGNodeTimestamp)
+#endif
+        ;
+
+#ifdef SRT_ENABLE_TXTIME
+    // Used only to determine the space for SCM_TXTIME, as CMSGNodeIPv4 above.
+    struct CMSGNodeTxTime
+    {
+        uint64_t txtime;
+        size_t extrafill;
+        cmsghdr hdr;
+    };
+#endif
+
+    // Space for the ancillary data of a single sent packet, except GSO.
+    static const size_t SND_CMSG_SPACE = 0
+#ifdef SRT_ENABLE_PKTINFO
+        + CMSG_MAX_SPACE
+#endif
+#ifdef SRT_ENABLE_TXTIME
+        + sizeof(CMSGNodeTxTime)
+#endif
+        ;
+
+#ifdef SRT_ENABLE_RECVMMSG
+    // Ancillary data buffers for recvfromBatch, RCV_CMSG_SPACE per packet.
+    mutable std::vector<char> m_RcvBatchCmsgBuffer;
+#endif
+
 };
 
 } // namespace srt
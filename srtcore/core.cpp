@@ -167,6 +167,16 @@ struct SrtOptionAction
         flags[SRTO_RCVBUF]             = SRTO_R_PREBIND;
         flags[SRTO_UDP_SNDBUF]         = SRTO_R_PREBIND;
         flags[SRTO_UDP_RCVBUF]         = SRTO_R_PREBIND;
+        flags[SRTO_UDP_RCVBATCH]       = SRTO_R_PREBIND;
+        flags[SRTO_UDP_SNDBATCH]       = SRTO_R_PREBIND;
+        flags[SRTO_UDP_GSO]            = SRTO_R_PREBIND;
+        flags[SRTO_UDP_GRO]            = SRTO_R_PREBIND;
+        flags[SRTO_UDP_RCVTIMESTAMP]   = SRTO_R_PREBIND;
+        flags[SRTO_UDP_TXTIME]         = SRTO_R_PREBIND;
+        flags[SRTO_UDP_IOURING]        = SRTO_R_PREBIND;
+        flags[SRTO_UDP_SHARDS]         = SRTO_R_PREBIND;
+        flags[SRTO_SNDWORKERS]         = SRTO_R_PREBIND;
+        flags[SRTO_RCVWORKERS]         = SRTO_R_PREBIND;
         flags[SRTO_RENDEZVOUS]         = SRTO_R_PRE;
         flags[SRTO_REUSEADDR]          = SRTO_R_PREBIND;
         flags[SRTO_MAXBW]              = SRTO_POST_SPEC;
@@ -208,6 +218,8 @@ struct SrtOptionAction
 #endif
         flags[SRTO_PACKETFILTER]       = SRTO_R_PRE;
         flags[SRTO_RETRANSMITALGO]     = SRTO_R_PRE;
+        flags[SRTO_SNDBURST]           = SRTO_R_PRE;
+        flags[SRTO_SNDBUFRECLAIM]      = SRTO_R_PRE;
 #ifdef ENABLE_AEAD_API_PREVIEW
         flags[SRTO_CRYPTOMODE]         = SRTO_R_PRE;
 #endif
@@ -299,6 +311,8 @@ void srt::CUDT::construct()
     m_bPeerTsbPd          = false;
     m_bTsbPd              = false;
     m_bTsbPdNeedsWakeup   = false;
+    m_pTsbPdWorker        = NULL;
+    m_pTsbPdNode          = NULL;
     m_bGroupTsbPd         = false;
     m_bPeerTLPktDrop      = false;
     m_bBufferWasFull      = false;
@@ -393,6 +407,7 @@ srt::CUDT::~CUDT()
     delete m_pRcvLossList;
     delete m_pSNode;
     delete m_pRNode;
+    delete m_pTsbPdNode;
 }
 
 void srt::CUDT::setOpt(SRT_SOCKOPT optName, const void* optval, int optlen)
@@ -517,6 +532,56 @@ void srt::CUDT::getOpt(SRT_SOCKOPT optName, void *optval, int &optlen)
         optlen         = sizeof(int);
         break;
 
+    case SRTO_UDP_RCVBATCH:
+        *(int *)optval = m_config.iUDPRcvBatch;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_UDP_SNDBATCH:
+        *(int *)optval = m_config.iUDPSndBatch;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_UDP_GSO:
+        *(bool *)optval = m_config.bUDPGso;
+        optlen          = sizeof(bool);
+        break;
+
+    case SRTO_UDP_GRO:
+        *(bool *)optval = m_config.bUDPGro;
+        optlen          = sizeof(bool);
+        break;
+
+    case SRTO_UDP_RCVTIMESTAMP:
+        *(bool *)optval = m_config.bUDPRcvTimestamp;
+        optlen          = sizeof(bool);
+        break;
+
+    case SRTO_UDP_TXTIME:
+        *(bool *)optval = m_config.bUDPTxTime;
+        optlen          = sizeof(bool);
+        break;
+
+    case SRTO_UDP_IOURING:
+        *(bool *)optval = m_config.bUDPIoUring;
+        optlen          = sizeof(bool);
+        break;
+
+    case SRTO_UDP_SHARDS:
+        *(int *)optval = m_config.iUDPShards;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_SNDWORKERS:
+        *(int *)optval = m_config.iSndWorkers;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_RCVWORKERS:
+        *(int *)optval = m_config.iRcvWorkers;
+        optlen         = sizeof(int);
+        break;
+
     case SRTO_RENDEZVOUS:
         *(bool *)optval = m_config.bRendezvous;
         optlen          = sizeof(bool);
@@ -843,6 +908,16 @@ void srt::CUDT::getOpt(SRT_SOCKOPT optName, void *optval, int &optlen)
         *(int32_t *)optval = m_config.iRetransmitAlgo;
         optlen         = sizeof(int32_t);
         break;
+
+    case SRTO_SNDBURST:
+        *(int32_t *)optval = m_config.iSndBurst;
+        optlen         = sizeof(int32_t);
+        break;
+
+    case SRTO_SNDBUFRECLAIM:
+        *(int32_t *)optval = m_config.iSndBufReclaim;
+        optlen         = sizeof(int32_t);
+        break;
 #ifdef ENABLE_AEAD_API_PREVIEW
     case SRTO_CRYPTOMODE:
         if (m_pCryptoControl)
@@ -964,14 +1039,18 @@ void srt::CUDT::open()
         m_pSNode = new CSNode;
     m_pSNode->m_pUDT      = this;
     m_pSNode->m_tsTimeStamp = steady_clock::now();
-    m_pSNode->m_iHeapLoc  = -1;
+    m_pSNode->m_pPrev = m_pSNode->m_pNext = NULL;
+    m_pSNode->m_iSlot                     = -1;
 
     if (m_pRNode == NULL)
         m_pRNode = new CRNode;
     m_pRNode->m_pUDT      = this;
     m_pRNode->m_tsTimeStamp = steady_clock::now();
     m_pRNode->m_pPrev = m_pRNode->m_pNext = NULL;
+    m_pRNode->m_iSlot                     = -1;
     m_pRNode->m_bOnList                   = false;
+    m_pRNode->m_bCheckRequested           = false;
+    m_pRNode->m_pNextRequested            = NULL;
 
     // Set initial values of smoothed RTT and RTT variance.
     m_iSRTT               = INITIAL_RTT;
@@ -5408,142 +5487,13 @@ void * srt::CUDT::tsbpd(void* param)
     self->m_bTsbPdNeedsWakeup = true;
     while (!self->m_bClosing)
     {
-        steady_clock::time_point tsNextDelivery; // Next packet delivery time
-        bool                     rxready = false;
-#if ENABLE_BONDING
-        bool shall_update_group = false;
-#endif
-
         INCREMENT_THREAD_ITERATIONS();
 
-        enterCS(self->m_RcvBufferLock);
-        const steady_clock::time_point tnow = steady_clock::now();
-
-        self->m_pRcvBuffer->updRcvAvgDataSize(tnow);
-        const srt::CRcvBuffer::PacketInfo info = self->m_pRcvBuffer->getFirstValidPacketInfo();
-
-        const bool is_time_to_deliver = !is_zero(info.tsbpd_time) && (tnow >= info.tsbpd_time);
-        tsNextDelivery = info.tsbpd_time;
-
-#if ENABLE_HEAVY_LOGGING
-        if (info.seqno == SRT_SEQNO_NONE)
-        {
-            HLOGC(tslog.Debug, log << self->CONID() << "sok/tsbpd: packet check: NO PACKETS");
-        }
-        else
-        {
-            HLOGC(tslog.Debug, log << self->CONID() << "sok/tsbpd: packet check: %"
-                << info.seqno << " T=" << FormatTime(tsNextDelivery)
-                << " diff-now-playtime=" << FormatDuration(tnow - tsNextDelivery)
-                << " ready=" << is_time_to_deliver
-                << " ondrop=" << info.seq_gap);
-        }
-#endif
-
-        if (!self->m_bTLPktDrop)
-        {
-            rxready = !info.seq_gap && is_time_to_deliver;
-        }
-        else if (is_time_to_deliver)
-        {
-            rxready = true;
-            if (info.seq_gap)
-            {
-                const int iDropCnt SRT_ATR_UNUSED = self->rcvDropTooLateUpTo(info.seqno);
-#if ENABLE_BONDING
-                shall_update_group = true;
-#endif
-
-#if ENABLE_LOGGING
-                const int64_t timediff_us = count_microseconds(tnow - info.tsbpd_time);
-#if ENABLE_HEAVY_LOGGING
-                HLOGC(tslog.Debug,
-                    log << self->CONID() << "tsbpd: DROPSEQ: up to seqno %" << CSeqNo::decseq(info.seqno) << " ("
-                    << iDropCnt << " packets) playable at " << FormatTime(info.tsbpd_time) << " delayed "
-                    << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0') << (timediff_us % 1000) << " ms");
-#endif
-                string why;
-                if (self->frequentLogAllowed(FREQLOGFA_RCV_DROPPED, tnow, (why)))
-                {
-                    LOGC(brlog.Warn, log << self->CONID() << "RCV-DROPPED " << iDropCnt << " packet(s). Packet seqno %" << info.seqno
-                            << " delayed for " << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0')
-                            << (timediff_us % 1000) << " ms " << why);
-                }
-#if SRT_ENABLE_FREQUENT_LOG_TRACE
-                else
-                {
-                    LOGC(brlog.Warn, log << "SUPPRESSED: RCV-DROPPED LOG: " << why);
-                }
-#endif
-#endif
-
-                tsNextDelivery = steady_clock::time_point(); // Ready to read, nothing to wait for.
-            }
-        }
-        leaveCS(self->m_RcvBufferLock);
-
-        if (rxready)
-        {
-            HLOGC(tslog.Debug,
-                  log << self->CONID() << "tsbpd: PLAYING PACKET seq=" << info.seqno << " (belated "
-                      << FormatDuration<DUNIT_MS>(steady_clock::now() - info.tsbpd_time) << ")");
-            /*
-             * There are packets ready to be delivered
-             * signal a waiting "recv" call if there is any data available
-             */
-            if (self->m_config.bSynRecving)
-            {
-                recvdata_lcc.notify_one();
-            }
-            /*
-             * Set EPOLL_IN to wakeup any thread waiting on epoll
-             */
-            self->uglobal().m_EPoll.update_events(self->m_SocketID, self->m_sPollID, SRT_EPOLL_IN, true);
 #if ENABLE_BONDING
-            // If this is NULL, it means:
-            // - the socket never was a group member
-            // - the socket was a group member, but:
-            //    - was just removed as a part of closure
-            //    - and will never be member of the group anymore
-
-            // If this is not NULL, it means:
-            // - This socket is currently member of the group
-            // - This socket WAS a member of the group, though possibly removed from it already, BUT:
-            //   - the group that this socket IS OR WAS member of is in the GroupKeeper
-            //   - the GroupKeeper prevents the group from being deleted
-            //   - it is then completely safe to access the group here,
-            //     EVEN IF THE SOCKET THAT WAS ITS MEMBER IS BEING DELETED.
-
-            // It is ensured that the group object exists here because GroupKeeper
-            // keeps it busy, even if you just closed the socket, remove it as a member
-            // or even the group is empty and was explicitly closed.
-            if (gkeeper.group)
-            {
-                // Functions called below will lock m_GroupLock, which in hierarchy
-                // lies after m_RecvLock. Must unlock m_RecvLock to be able to lock
-                // m_GroupLock inside the calls.
-                InvertedLock unrecv(self->m_RecvLock);
-                // The current "APP reader" needs to simply decide as to whether
-                // the next CUDTGroup::recv() call should return with no blocking or not.
-                // When the group is read-ready, it should update its pollers as it sees fit.
-
-                // NOTE: this call will set lock to m_IncludedGroup->m_GroupLock
-                HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: GROUP: checking if %" << info.seqno << " makes group readable");
-                gkeeper.group->updateReadState(self->m_SocketID, info.seqno);
-
-                if (shall_update_group)
-                {
-                    // A group may need to update the parallelly used idle links,
-                    // should it have any. Pass the current socket position in order
-                    // to skip it from the group loop.
-                    // NOTE: SELF LOCKING.
-                    gkeeper.group->updateLatestRcv(self->m_parent);
-                }
-            }
+        const steady_clock::time_point tsNextDelivery = self->tsbpdCheck(recvdata_lcc.locker(), gkeeper.group);
+#else
+        const steady_clock::time_point tsNextDelivery = self->tsbpdCheck(recvdata_lcc.locker());
 #endif
-            CGlobEvent::triggerEvent();
-            tsNextDelivery = steady_clock::time_point(); // Ready to read, nothing to wait for.
-        }
 
         // We may just briefly unlocked the m_RecvLock, so we need to check m_bClosing again to avoid deadlock.
         if (self->m_bClosing)
@@ -5553,15 +5503,10 @@ void * srt::CUDT::tsbpd(void* param)
 
         if (!is_zero(tsNextDelivery))
         {
-            IF_HEAVY_LOGGING(const steady_clock::duration timediff = tsNextDelivery - tnow);
             /*
              * Buffer at head of queue is not ready to play.
              * Schedule wakeup when it will be.
              */
-            self->m_bTsbPdNeedsWakeup = false;
-            HLOGC(tslog.Debug,
-                  log << self->CONID() << "tsbpd: FUTURE PACKET seq=" << info.seqno
-                      << " T=" << FormatTime(tsNextDelivery) << " - waiting " << FormatDuration<DUNIT_MS>(timediff));
             THREAD_PAUSED();
             bWokeUpOnSignal = tsbpd_cc.wait_until(tsNextDelivery);
             THREAD_RESUMED();
@@ -5579,8 +5524,6 @@ void * srt::CUDT::tsbpd(void* param)
              * - New buffers ACKed
              * - Closing the connection
              */
-            HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: no data, scheduling wakeup at ack");
-            self->m_bTsbPdNeedsWakeup = true;
             THREAD_PAUSED();
             tsbpd_cc.wait();
             THREAD_RESUMED();
@@ -5595,6 +5538,174 @@ void * srt::CUDT::tsbpd(void* param)
     return NULL;
 }
 
+#if ENABLE_BONDING
+srt::CUDT::time_point srt::CUDT::tsbpdCheck(UniqueLock& recvlock, CUDTGroup* group)
+#else
+srt::CUDT::time_point srt::CUDT::tsbpdCheck(UniqueLock& recvlock)
+#endif
+{
+    steady_clock::time_point tsNextDelivery; // Next packet delivery time
+    bool                     rxready = false;
+#if ENABLE_BONDING
+    bool shall_update_group = false;
+#endif
+
+    enterCS(m_RcvBufferLock);
+    const steady_clock::time_point tnow = steady_clock::now();
+
+    m_pRcvBuffer->updRcvAvgDataSize(tnow);
+    const srt::CRcvBuffer::PacketInfo info = m_pRcvBuffer->getFirstValidPacketInfo();
+
+    const bool is_time_to_deliver = !is_zero(info.tsbpd_time) && (tnow >= info.tsbpd_time);
+    tsNextDelivery = info.tsbpd_time;
+
+#if ENABLE_HEAVY_LOGGING
+    if (info.seqno == SRT_SEQNO_NONE)
+    {
+        HLOGC(tslog.Debug, log << CONID() << "sok/tsbpd: packet check: NO PACKETS");
+    }
+    else
+    {
+        HLOGC(tslog.Debug, log << CONID() << "sok/tsbpd: packet check: %"
+            << info.seqno << " T=" << FormatTime(tsNextDelivery)
+            << " diff-now-playtime=" << FormatDuration(tnow - tsNextDelivery)
+            << " ready=" << is_time_to_deliver
+            << " ondrop=" << info.seq_gap);
+    }
+#endif
+
+    if (!m_bTLPktDrop)
+    {
+        rxready = !info.seq_gap && is_time_to_deliver;
+    }
+    else if (is_time_to_deliver)
+    {
+        rxready = true;
+        if (info.seq_gap)
+        {
+            const int iDropCnt SRT_ATR_UNUSED = rcvDropTooLateUpTo(info.seqno);
+#if ENABLE_BONDING
+            shall_update_group = true;
+#endif
+
+#if ENABLE_LOGGING
+            const int64_t timediff_us = count_microseconds(tnow - info.tsbpd_time);
+#if ENABLE_HEAVY_LOGGING
+            HLOGC(tslog.Debug,
+                log << CONID() << "tsbpd: DROPSEQ: up to seqno %" << CSeqNo::decseq(info.seqno) << " ("
+                << iDropCnt << " packets) playable at " << FormatTime(info.tsbpd_time) << " delayed "
+                << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0') << (timediff_us % 1000) << " ms");
+#endif
+            string why;
+            if (frequentLogAllowed(FREQLOGFA_RCV_DROPPED, tnow, (why)))
+            {
+                LOGC(brlog.Warn, log << CONID() << "RCV-DROPPED " << iDropCnt << " packet(s). Packet seqno %" << info.seqno
+                        << " delayed for " << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0')
+                        << (timediff_us % 1000) << " ms " << why);
+            }
+#if SRT_ENABLE_FREQUENT_LOG_TRACE
+            else
+            {
+                LOGC(brlog.Warn, log << "SUPPRESSED: RCV-DROPPED LOG: " << why);
+            }
+#endif
+#endif
+
+            tsNextDelivery = steady_clock::time_point(); // Ready to read, nothing to wait for.
+        }
+    }
+    leaveCS(m_RcvBufferLock);
+
+    if (rxready)
+    {
+        HLOGC(tslog.Debug,
+              log << CONID() << "tsbpd: PLAYING PACKET seq=" << info.seqno << " (belated "
+                  << FormatDuration<DUNIT_MS>(steady_clock::now() - info.tsbpd_time) << ")");
+        /*
+         * There are packets ready to be delivered
+         * signal a waiting "recv" call if there is any data available
+         */
+        if (m_config.bSynRecving)
+        {
+            CSync recvdata_cc(m_RecvDataCond, recvlock);
+            recvdata_cc.notify_one_locked(recvlock);
+        }
+        /*
+         * Set EPOLL_IN to wakeup any thread waiting on epoll
+         */
+        uglobal().m_EPoll.update_events(m_SocketID, m_sPollID, SRT_EPOLL_IN, true);
+#if ENABLE_BONDING
+        // If this is NULL, it means:
+        // - the socket never was a group member
+        // - the socket was a group member, but:
+        //    - was just removed as a part of closure
+        //    - and will never be member of the group anymore
+
+        // If this is not NULL, it means:
+        // - This socket is currently member of the group
+        // - This socket WAS a member of the group, though possibly removed from it already, BUT:
+        //   - the group that this socket IS OR WAS member of is in the GroupKeeper
+        //   - the GroupKeeper prevents the group from being deleted
+        //   - it is then completely safe to access the group here,
+        //     EVEN IF THE SOCKET THAT WAS ITS MEMBER IS BEING DELETED.
+
+        // It is ensured that the group object exists here because GroupKeeper
+        // keeps it busy, even if you just closed the socket, remove it as a member
+        // or even the group is empty and was explicitly closed.
+        if (group)
+        {
+            // Functions called below will lock m_GroupLock, which in hierarchy
+            // lies after m_RecvLock. Must unlock m_RecvLock to be able to lock
+            // m_GroupLock inside the calls.
+            InvertedLock unrecv(m_RecvLock);
+            // The current "APP reader" needs to simply decide as to whether
+            // the next CUDTGroup::recv() call should return with no blocking or not.
+            // When the group is read-ready, it should update its pollers as it sees fit.
+
+            // NOTE: this call will set lock to m_IncludedGroup->m_GroupLock
+            HLOGC(tslog.Debug, log << CONID() << "tsbpd: GROUP: checking if %" << info.seqno << " makes group readable");
+            group->updateReadState(m_SocketID, info.seqno);
+
+            if (shall_update_group)
+            {
+                // A group may need to update the parallelly used idle links,
+                // should it have any. Pass the current socket position in order
+                // to skip it from the group loop.
+                // NOTE: SELF LOCKING.
+                group->updateLatestRcv(m_parent);
+            }
+        }
+#endif
+        CGlobEvent::triggerEvent();
+        tsNextDelivery = steady_clock::time_point(); // Ready to read, nothing to wait for.
+    }
+
+    if (!is_zero(tsNextDelivery))
+    {
+        HLOGC(tslog.Debug,
+              log << CONID() << "tsbpd: FUTURE PACKET seq=" << info.seqno
+                  << " T=" << FormatTime(tsNextDelivery) << " - waiting " << FormatDuration<DUNIT_MS>(tsNextDelivery - tnow));
+        m_bTsbPdNeedsWakeup = false;
+    }
+    else
+    {
+        HLOGC(tslog.Debug, log << CONID() << "tsbpd: no data, scheduling wakeup at ack");
+        m_bTsbPdNeedsWakeup = true;
+    }
+
+    return tsNextDelivery;
+}
+
+// [[using locked(m_RecvLock)]]
+void srt::CUDT::kickTsbPd()
+{
+    CTsbPdWorker* w = m_pTsbPdWorker;
+    if (w)
+        w->wakeup(this);
+    else
+        m_RcvTsbPdCond.notify_one();
+}
+
 int srt::CUDT::rcvDropTooLateUpTo(int seqno, DropReason reason)
 {
     // Make sure that it would not drop over m_iRcvCurrSeqNo, which may break senders.
@@ -5716,8 +5827,9 @@ bool srt::CUDT::prepareBuffers(CUDTException* eout)
                 << " authtag=" << authtag);
 
         m_pSndBuffer = new CSndBuffer(AF_INET, 32, m_iMaxSRTPayloadSize, authtag);
+        m_pSndBuffer->setReclaimMinSize(m_config.iSndBufReclaim);
         SRT_ASSERT(m_iPeerISN != -1);
-        m_pRcvBuffer = new srt::CRcvBuffer(m_iPeerISN, m_config.iRcvBufSize, m_pRcvQueue->m_pUnitQueue, m_config.bMessageAPI);
+        m_pRcvBuffer = new srt::CRcvBuffer(m_iPeerISN, m_config.iRcvBufSize, m_pRcvQueue->unitQueue(m_SocketID), m_config.bMessageAPI);
         // After introducing lite ACK, the sndlosslist may not be cleared in time, so it requires twice a space.
         m_pSndLossList = new CSndLossList(m_iFlowWindowSize * 2);
         m_pRcvLossList = new CRcvLossList(m_config.iFlightFlagSize);
@@ -6068,7 +6180,7 @@ SRT_REJECT_REASON srt::CUDT::setupCC()
         {
             // The filter configurer is build the way that allows to quit immediately
             // exit by exception, but the exception is meant for the filter only.
-            status = m_PacketFilter.configure(this, m_pRcvQueue->m_pUnitQueue, m_config.sPacketFilterConfig.str());
+            status = m_PacketFilter.configure(this, m_pRcvQueue->unitQueue(m_SocketID), m_config.sPacketFilterConfig.str());
         }
         catch (CUDTException& )
         {
@@ -6166,14 +6278,16 @@ void srt::CUDT::considerLegacySrtHandshake(const steady_clock::time_point &timeb
     sendSrtMsg(SRT_CMD_HSREQ);
 }
 
-void srt::CUDT::checkSndTimers()
+bool srt::CUDT::checkSndTimers()
 {
+    bool hs_pending = false;
     if (m_SrtHsSide == HSD_INITIATOR)
     {
         HLOGC(cnlog.Debug,
               log << CONID() << "checkSndTimers: HS SIDE: INITIATOR, considering legacy handshake with timebase");
         // Legacy method for HSREQ, only if initiator.
         considerLegacySrtHandshake(m_tsSndHsLastTime + microseconds_from(m_iSRTT * 3 / 2));
+        hs_pending = isOPT_TsbPd() && m_config.bDataSender && m_iSndHsRetryCnt > 0;
     }
     else
     {
@@ -6186,8 +6300,9 @@ void srt::CUDT::checkSndTimers()
     // Retransmit KM request after a timeout if there is no response (KM RSP).
     // Or send KM REQ in case of the HSv4.
     ScopedLock lck(m_ConnectionLock);
-    if (m_pCryptoControl)
-        m_pCryptoControl->sendKeysToPeer(this, SRTT());
+    if (m_pCryptoControl && m_pCryptoControl->sendKeysToPeer(this, SRTT()))
+        return true;
+    return hs_pending;
 }
 
 void srt::CUDT::checkSndKMRefresh()
@@ -6267,7 +6382,7 @@ bool srt::CUDT::closeInternal() ATR_NOEXCEPT
 
     // remove this socket from the snd queue
     if (m_bConnected)
-        m_pSndQueue->m_pSndUList->remove(this);
+        m_pSndQueue->sndUList(m_SocketID)->remove(this);
 
     /*
      * update_events below useless
@@ -6322,6 +6437,8 @@ bool srt::CUDT::closeInternal() ATR_NOEXCEPT
 
     // Inform the threads handler to stop.
     m_bClosing = true;
+    if (m_pRcvQueue)
+        m_pRcvQueue->requestTimersCheck(this);
 
     HLOGC(smlog.Debug, log << CONID() << "CLOSING STATE. Acquiring connection lock");
 
@@ -6433,7 +6550,6 @@ int srt::CUDT::receiveBuffer(char *data, int len)
     }
 
     CSync rcond  (m_RecvDataCond, recvguard);
-    CSync tscond (m_RcvTsbPdCond, recvguard);
     if (!isRcvBufferReady())
     {
         if (!m_config.bSynRecving)
@@ -6493,7 +6609,7 @@ int srt::CUDT::receiveBuffer(char *data, int len)
     if (m_bTsbPd)
     {
         HLOGP(tslog.Debug, "Ping TSBPD thread to schedule wakeup");
-        tscond.notify_one_locked(recvguard);
+        kickTsbPd();
     }
     else
     {
@@ -6614,7 +6730,8 @@ int srt::CUDT::sendmsg(const char *data, int len, int msttl, bool inorder, int64
 // [[using maybe_locked(CUDTGroup::m_GroupLock, m_parent->m_GroupOf != NULL)]]
 // GroupLock is applied when this function is called from inside CUDTGroup::send,
 // which is the only case when the m_parent->m_GroupOf is not NULL.
-int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
+int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl,
+                        srt_send_release_fn* release, void* opaque)
 {
     // throw an exception if not connected
     if (m_bBroken || m_bClosing)
@@ -6696,7 +6813,10 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
 
     UniqueLock sendguard(m_SendLock);
 
-    if (m_pSndBuffer->getCurrBufSize() == 0)
+    // The timers checked while the sender buffer was empty
+    // didn't take the retransmission of these data into account.
+    const bool was_empty = m_pSndBuffer->getCurrBufSize() == 0;
+    if (was_empty)
     {
         // delay the EXP timer to avoid mis-fired timeout
         ScopedLock ack_lock(m_RecvAckLock);
@@ -6814,6 +6934,7 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
         size = min(len, sndBuffersLeft() * m_iMaxSRTPayloadSize);
     }
 
+    bool zerocopy = release != NULL;
     {
         ScopedLock recvAckLock(m_RecvAckLock);
         // insert the user buffer into the sending list
@@ -6878,7 +6999,11 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
         // - OUTPUT: value of the sequence number to be put on the first packet at the next sendmsg2 call.
         // We need to supply to the output the value that was STAMPED ON THE PACKET,
         // which is seqno. In the output we'll get the next sequence number.
-        m_pSndBuffer->addBuffer(data, size, (w_mctrl));
+        // The encryption is done in place, so the data can't be referred to then.
+        if (release && m_pCryptoControl && m_pCryptoControl->getSndCryptoFlags() != EK_NOENC)
+            zerocopy = false;
+
+        m_pSndBuffer->addBuffer(data, size, (w_mctrl), zerocopy ? release : NULL, opaque);
         m_iSndNextSeqNo = w_mctrl.pktseq;
         w_mctrl.pktseq = seqno;
 
@@ -6893,9 +7018,15 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
         }
     }
 
+    // The data have been copied, so they aren't needed any more.
+    if (release && !zerocopy)
+        release(opaque, data, size);
+
     // Insert this socket to the snd list if it is not on the list already.
-    // m_pSndUList->pop may lock CSndUList::m_ListLock and then m_RecvAckLock
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+    // CSndUList::pop may lock CSndUList::m_ListLock and then m_RecvAckLock
+    m_pSndQueue->sndUList(m_SocketID)->update(this, CSndUList::DONT_RESCHEDULE);
+    if (was_empty)
+        m_pRcvQueue->requestTimersCheck(this);
 
 #ifdef SRT_ENABLE_ECN
     // IF there was a packet drop on the sender side, report congestion to the app.
@@ -6955,12 +7086,106 @@ int srt::CUDT::recvmsg2(char* data, int len, SRT_MSGCTRL& w_mctrl)
     return receiveBuffer(data, len);
 }
 
+int srt::CUDT::recvmsgViews(SRT_MSGVIEW* views, int nviews)
+{
+#if ENABLE_BONDING
+    if (m_parent->m_GroupOf && m_parent->m_GroupOf->isGroupReceiver())
+    {
+        LOGP(arlog.Error, "recvmsg_zc: This socket is a receiver group member, which can't lend packets.");
+        throw CUDTException(MJ_NOTSUP, MN_INVALMSGAPI, 0);
+    }
+#endif
+
+    if (!m_bConnected || !m_CongCtl.ready())
+        throw CUDTException(MJ_CONNECTION, MN_NOCONN, 0);
+
+    if (!views || nviews <= 0)
+    {
+        LOGC(arlog.Error, log << CONID() << "Number of views '" << nviews << "' supplied to srt_recvmsg_zc.");
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+    }
+
+    if (!m_config.bMessageAPI)
+        throw CUDTException(MJ_NOTSUP, MN_INVALBUFFERAPI, 0);
+
+    SRT_MSGCTRL mctrl = srt_msgctrl_default;
+    return receiveMessage(NULL, nviews, (mctrl), 1, views);
+}
+
+void srt::CUDT::releaseMsgViews(const SRT_MSGVIEW* views, int nviews)
+{
+    int invalid = 0;
+    {
+        ScopedLock lck(m_RcvBufferLock);
+        for (int i = 0; i < nviews; ++i)
+        {
+            if (!m_pRcvBuffer || !m_pRcvBuffer->releaseLent(static_cast<CUnit*>(views[i].unit)))
+                ++invalid;
+        }
+    }
+
+    if (invalid)
+    {
+        LOGC(arlog.Error, log << CONID() << "recvmsg_zc_release: " << invalid << "/" << nviews
+                              << " views do not refer to packets lent by this socket.");
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+    }
+}
+
 // [[using locked(m_RcvBufferLock)]]
 size_t srt::CUDT::getAvailRcvBufferSizeNoLock() const
 {
     return m_pRcvBuffer->getAvailSize(m_iRcvLastAck);
 }
 
+// [[using locked(m_RcvBufferLock)]]
+int srt::CUDT::readRcvMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, SRT_MSGVIEW* w_views)
+{
+    if (!w_views)
+        return m_pRcvBuffer->readMessage(data, len, &w_mctrl);
+
+    // Lend the ready messages as long as all their packets fit in the views.
+    std::vector<CUnit*> units;
+    int nviews = 0;
+    do
+    {
+        SRT_MSGCTRL mctrl = w_mctrl;
+        const int   res   = m_pRcvBuffer->lendMessage((units), size_t(len - nviews), &mctrl);
+        if (res == 0)
+            break;
+
+        if (res < 0)
+        {
+            if (nviews > 0)
+                break; // Left for the next call.
+
+            if (res == -2)
+            {
+                LOGC(arlog.Error, log << CONID() << "recvmsg_zc: " << m_pRcvBuffer->countLent()
+                                      << " packets lent and not released already fill the receiver buffer.");
+                throw CUDTException(MJ_SYSTEMRES, MN_MEMORY, 0);
+            }
+
+            LOGC(arlog.Error, log << CONID() << "recvmsg_zc: the message has more packets than " << len << " views.");
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+        }
+
+        for (size_t i = 0; i < units.size(); ++i)
+        {
+            const CPacket& packet = units[i]->m_Packet;
+            SRT_MSGVIEW&   view   = w_views[nviews++];
+            view.data   = packet.m_pcData;
+            view.len    = (int) packet.getLength();
+            view.msgend = (i + 1 == units.size());
+            view.mctrl  = mctrl;
+            view.unit   = units[i];
+        }
+        units.clear();
+    } while (nviews < len && m_pRcvBuffer->isRcvDataReady(steady_clock::now()));
+
+    return nviews;
+}
+
 bool srt::CUDT::isRcvBufferReady() const
 {
     ScopedLock lck(m_RcvBufferLock);
@@ -6982,7 +7207,7 @@ bool srt::CUDT::isRcvBufferFull() const
 // - 0 - by return value
 // - 1 - by exception
 // - 2 - by abort (unused)
-int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_exception)
+int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_exception, SRT_MSGVIEW* w_views)
 {
     // Recvmsg isn't restricted to the congctl type, it's the most
     // basic method of passing the data. You can retrieve data as
@@ -6995,11 +7220,12 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
     // is only used internally, we state that the problem that would be
     // handled by exception here should not happen, and in case if it does,
     // it's a bug to fix, so the exception is nothing wrong.
-    if (!m_CongCtl->checkTransArgs(SrtCongestion::STA_MESSAGE, SrtCongestion::STAD_RECV, data, len, SRT_MSGTTL_INF, false))
+    // The views refer to whole packets, so they can always keep a payload.
+    const size_t bufsize = w_views ? size_t(m_iMaxSRTPayloadSize) : size_t(len);
+    if (!m_CongCtl->checkTransArgs(SrtCongestion::STA_MESSAGE, SrtCongestion::STAD_RECV, data, bufsize, SRT_MSGTTL_INF, false))
         throw CUDTException(MJ_NOTSUP, MN_INVALMSGAPI, 0);
 
     UniqueLock recvguard (m_RecvLock);
-    CSync tscond     (m_RcvTsbPdCond,  recvguard);
 
     /* XXX DEBUG STUFF - enable when required
        char charbool[2] = {'0', '1'};
@@ -7017,17 +7243,18 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
     if (m_bBroken || m_bClosing)
     {
         HLOGC(arlog.Debug, log << CONID() << "receiveMessage: CONNECTION BROKEN - reading from recv buffer just for formality");
-        enterCS(m_RcvBufferLock);
-        const int res = (m_pRcvBuffer->isRcvDataReady(steady_clock::now()))
-            ? m_pRcvBuffer->readMessage(data, len, &w_mctrl)
-            : 0;
-        leaveCS(m_RcvBufferLock);
+        int res = 0;
+        {
+            ScopedLock lck(m_RcvBufferLock);
+            if (m_pRcvBuffer->isRcvDataReady(steady_clock::now()))
+                res = readRcvMessage(data, len, (w_mctrl), w_views);
+        }
 
         // Kick TsbPd thread to schedule next wakeup (if running)
         if (m_bTsbPd)
         {
             HLOGP(tslog.Debug, "Ping TSBPD thread to schedule wakeup");
-            tscond.notify_one_locked(recvguard);
+            kickTsbPd();
         }
         else
         {
@@ -7056,11 +7283,12 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
     if (!m_config.bSynRecving)
     {
         HLOGC(arlog.Debug, log << CONID() << "receiveMessage: BEGIN ASYNC MODE. Going to extract payload size=" << len);
-        enterCS(m_RcvBufferLock);
-        const int res = (m_pRcvBuffer->isRcvDataReady(steady_clock::now()))
-            ? m_pRcvBuffer->readMessage(data, len, &w_mctrl)
-            : 0;
-        leaveCS(m_RcvBufferLock);
+        int res = 0;
+        {
+            ScopedLock lck(m_RcvBufferLock);
+            if (m_pRcvBuffer->isRcvDataReady(steady_clock::now()))
+                res = readRcvMessage(data, len, (w_mctrl), w_views);
+        }
         HLOGC(arlog.Debug, log << CONID() << "AFTER readMsg: (NON-BLOCKING) result=" << res);
 
         if (res == 0)
@@ -7070,7 +7298,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
             if (m_bTsbPd)
             {
                 HLOGP(arlog.Debug, "receiveMessage: nothing to read, kicking TSBPD, return AGAIN");
-                tscond.notify_one_locked(recvguard);
+                kickTsbPd();
             }
             else
             {
@@ -7091,7 +7319,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
             if (m_bTsbPd)
             {
                 HLOGP(arlog.Debug, "receiveMessage: DATA READ, but nothing more - kicking TSBPD.");
-                tscond.notify_one_locked(recvguard);
+                kickTsbPd();
             }
             else
             {
@@ -7135,7 +7363,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
                 // bool spurious = (tstime != 0);
 
                 HLOGC(tslog.Debug, log << CONID() << "receiveMessage: KICK tsbpd");
-                tscond.notify_one_locked(recvguard);
+                kickTsbPd();
             }
 
             THREAD_PAUSED();
@@ -7176,9 +7404,10 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
                 << " NMSG " << m_pRcvBuffer->getRcvMsgNum());
                 */
 
-        enterCS(m_RcvBufferLock);
-        res = m_pRcvBuffer->readMessage((data), len, &w_mctrl);
-        leaveCS(m_RcvBufferLock);
+        {
+            ScopedLock lck(m_RcvBufferLock);
+            res = readRcvMessage(data, len, (w_mctrl), w_views);
+        }
         HLOGC(arlog.Debug, log << CONID() << "AFTER readMsg: (BLOCKING) result=" << res);
 
         if (m_bBroken || m_bClosing)
@@ -7212,7 +7441,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
         if (m_bTsbPd)
         {
             HLOGP(tslog.Debug, "recvmsg: KICK tsbpd() (buffer empty)");
-            tscond.notify_one_locked(recvguard);
+            kickTsbPd();
         }
 
         // Shut up EPoll if no more messages in non-blocking mode
@@ -7327,7 +7556,8 @@ int64_t srt::CUDT::sendfile(fstream &ifs, int64_t &offset, int64_t size, int blo
         }
 
         // record total time used for sending
-        if (m_pSndBuffer->getCurrBufSize() == 0)
+        const bool was_empty = m_pSndBuffer->getCurrBufSize() == 0;
+        if (was_empty)
         {
             ScopedLock lock(m_StatsLock);
             m_stats.sndDurationCounter = steady_clock::now();
@@ -7351,7 +7581,9 @@ int64_t srt::CUDT::sendfile(fstream &ifs, int64_t &offset, int64_t size, int blo
         }
 
         // insert this socket to snd list if it is not on the list yet
-        m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+        m_pSndQueue->sndUList(m_SocketID)->update(this, CSndUList::DONT_RESCHEDULE);
+        if (was_empty)
+            m_pRcvQueue->requestTimersCheck(this);
     }
 
     return size - tosend;
@@ -7597,6 +7829,22 @@ void srt::CUDT::bstats(CBytePerfMon *perf, bool clear, bool instantaneous)
 
     perf->mbpsBandwidth = Bps2Mbps(availbw * (m_iMaxSRTPayloadSize + pktHdrSize));
 
+    // Multiplexer statistics, cumulative since the multiplexer was created
+    // and shared by all sockets using it.
+    if (m_pRcvQueue)
+    {
+        m_pRcvQueue->getBatchStats((perf->muxRcvBatchCallsTotal), (perf->muxRcvBatchPktsTotal), (perf->muxRcvBatchFullTotal));
+        m_pRcvQueue->getGroStats((perf->muxRcvGroBufsTotal), (perf->muxRcvGroPktsTotal));
+        perf->muxRcvUringPktsTotal = m_pRcvQueue->uringPackets();
+        perf->muxRcvWorkersBusy    = m_pRcvQueue->busyWorkers();
+    }
+    if (m_pSndQueue)
+    {
+        m_pSndQueue->getBatchStats((perf->muxSndBatchCallsTotal), (perf->muxSndBatchPktsTotal), (perf->muxSndGsoPktsTotal));
+        perf->muxSndTxTimePktsTotal = m_pSndQueue->txtimePackets();
+        perf->muxSndWorkersBusy     = m_pSndQueue->busyWorkers();
+    }
+
     if (tryEnterCS(m_ConnectionLock))
     {
         if (m_pSndBuffer)
@@ -7613,10 +7861,13 @@ void srt::CUDT::bstats(CBytePerfMon *perf, bool clear, bool instantaneous)
             }
             perf->byteSndBuf += (perf->pktSndBuf * pktHdrSize);
             perf->byteAvailSndBuf = (m_config.iSndBufSize - perf->pktSndBuf) * m_config.iMSS;
+            perf->byteSndBufAlloc = m_pSndBuffer->getMemoryUse((perf->byteSndBufAllocPeak));
         }
         else
         {
             perf->byteAvailSndBuf = 0;
+            perf->byteSndBufAlloc = 0;
+            perf->byteSndBufAllocPeak = 0;
             perf->pktSndBuf  = 0;
             perf->byteSndBuf = 0;
             perf->msSndBuf   = 0;
@@ -7837,6 +8088,13 @@ void srt::CUDT::releaseSynch()
     {
         m_RcvTsbPdThread.join();
     }
+    CTsbPdWorker* const tsbpd_worker = m_pTsbPdWorker;
+    if (tsbpd_worker)
+    {
+        // Kicks from now on are ignored, and the worker is
+        // kept alive by CUDTUnited until it has no sockets.
+        tsbpd_worker->remove(this);
+    }
     leaveCS(m_RcvTsbPdStartupLock);
 
     // Acquiring the m_RecvLock it is assumed that both tsbpd()
@@ -8166,10 +8424,10 @@ int srt::CUDT::sendCtrlAck(CPacket& ctrlpkt, int size)
         if (m_bTsbPd)
         {
             /* Newly acknowledged data, signal TsbPD thread */
-            CUniqueSync tslcc (m_RecvLock, m_RcvTsbPdCond);
+            ScopedLock tslock (m_RecvLock);
             // m_bTsbPdAckWakeup is protected by m_RecvLock in the tsbpd() thread
             if (m_bTsbPdNeedsWakeup)
-                tslcc.notify_one();
+                kickTsbPd();
         }
         else
         {
@@ -8380,7 +8638,7 @@ void srt::CUDT::updateSndLossListOnACK(int32_t ackdata_seqno)
 
     // insert this socket to snd list if it is not on the list yet
     const steady_clock::time_point currtime = steady_clock::now();
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE, currtime);
+    m_pSndQueue->sndUList(m_SocketID)->update(this, CSndUList::DONT_RESCHEDULE, currtime);
 
     if (m_config.bSynSending)
     {
@@ -8484,7 +8742,7 @@ void srt::CUDT::processCtrlAck(const CPacket &ctrlpkt, const steady_clock::time_
         const int cwnd    = std::min<int>(m_iFlowWindowSize, m_iCongestionWindow);
         if (bWasStuck && cwnd > getFlightSpan())
         {
-            m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+            m_pSndQueue->sndUList(m_SocketID)->update(this, CSndUList::DONT_RESCHEDULE);
             HLOGC(gglog.Debug,
                     log << CONID() << "processCtrlAck: could reschedule SND. iFlowWindowSize " << m_iFlowWindowSize
                     << " SPAN " << getFlightSpan() << " ackdataseqno %" << ackdata_seqno);
@@ -8891,7 +9149,7 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
     }
 
     // the lost packet (retransmission) should be sent out immediately
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+    m_pSndQueue->sndUList(m_SocketID)->update(this, CSndUList::DONT_RESCHEDULE);
 
     enterCS(m_StatsLock);
     m_stats.sndr.recvdNak.count(1);
@@ -9016,7 +9274,7 @@ void srt::CUDT::processCtrlDropReq(const CPacket& ctrlpkt)
     const int32_t* dropdata = (const int32_t*) ctrlpkt.m_pcData;
 
     {
-        CUniqueSync rcvtscc (m_RecvLock, m_RcvTsbPdCond);
+        ScopedLock rcvlock (m_RecvLock);
         // With both TLPktDrop and TsbPd enabled, a message always consists only of one packet.
         // It will be dropped as too late anyway. Not dropping it from the receiver buffer
         // in advance reduces false drops if the packet somehow manages to arrive.
@@ -9056,7 +9314,7 @@ void srt::CUDT::processCtrlDropReq(const CPacket& ctrlpkt)
         if (m_bTsbPd)
         {
             HLOGP(inlog.Debug, "DROPREQ: signal TSBPD");
-            rcvtscc.notify_one();
+            kickTsbPd();
         }
     }
 
@@ -9128,6 +9386,10 @@ void srt::CUDT::processCtrl(const CPacket &ctrlpkt)
     const steady_clock::time_point currtime = steady_clock::now();
     m_tsLastRspTime = currtime;
 
+    // The time when the system received the packet, if available, is used
+    // for the measurements (RTT and drift), see SRTO_UDP_RCVTIMESTAMP.
+    const steady_clock::time_point tsArrival = is_zero(ctrlpkt.arrivalTime()) ? currtime : ctrlpkt.arrivalTime();
+
     HLOGC(inlog.Debug,
           log << CONID() << "incoming UMSG:" << ctrlpkt.getType() << " ("
               << MessageTypeStr(ctrlpkt.getType(), ctrlpkt.getExtendedType()) << ") socket=%" << ctrlpkt.id());
@@ -9139,7 +9401,7 @@ void srt::CUDT::processCtrl(const CPacket &ctrlpkt)
         break;
 
     case UMSG_ACKACK: // 110 - Acknowledgement of Acknowledgement
-        processCtrlAckAck(ctrlpkt, currtime);
+        processCtrlAckAck(ctrlpkt, tsArrival);
         break;
 
     case UMSG_LOSSREPORT: // 011 - Loss Report
@@ -9157,7 +9419,7 @@ void srt::CUDT::processCtrl(const CPacket &ctrlpkt)
         break;
 
     case UMSG_KEEPALIVE: // 001 - Keep-alive
-        processKeepalive(ctrlpkt, currtime);
+        processKeepalive(ctrlpkt, tsArrival);
         break;
 
     case UMSG_HANDSHAKE: // 000 - Handshake
@@ -9591,7 +9853,11 @@ bool srt::CUDT::isRetransmissionAllowed(const time_point& tnow SRT_ATR_UNUSED)
     return true;
 }
 
-bool srt::CUDT::packData(CPacket& w_packet, steady_clock::time_point& w_nexttime, sockaddr_any& w_src_addr)
+bool srt::CUDT::packData(CPacket&                  w_packet,
+                         steady_clock::time_point& w_nexttime,
+                         sockaddr_any&             w_src_addr,
+                         steady_clock::time_point& w_sendtime,
+                         bool                      burst)
 {
     int payload = 0;
     bool probe = false;
@@ -9601,6 +9867,14 @@ bool srt::CUDT::packData(CPacket& w_packet, steady_clock::time_point& w_nexttime
 
     w_nexttime = enter_time;
 
+    // With SRTO_UDP_TXTIME the socket is picked up ahead of its scheduled time
+    // and the system sends the packet at that time. The pacing then continues
+    // from the scheduled time rather than from the current time. The same applies
+    // to the packets that follow in a burst, so the long-term rate is kept.
+    const steady_clock::time_point send_time =
+        ((burst || m_pSndQueue->txtimeEnabled()) && enter_time < m_tsNextSendTime) ? m_tsNextSendTime : enter_time;
+    w_sendtime = send_time;
+
     if (!is_zero(m_tsNextSendTime) && enter_time > m_tsNextSendTime)
     {
         m_tdSendTimeDiff = m_tdSendTimeDiff.load() + (enter_time - m_tsNextSendTime);
@@ -9696,7 +9970,7 @@ bool srt::CUDT::packData(CPacket& w_packet, steady_clock::time_point& w_nexttime
     if (probe)
     {
         // sends out probing packet pair
-        m_tsNextSendTime = enter_time;
+        m_tsNextSendTime = send_time;
         // Sending earlier, need to adjust the pace later on.
         m_tdSendTimeDiff = m_tdSendTimeDiff.load() - sendint;
         probe          = false;
@@ -9704,14 +9978,14 @@ bool srt::CUDT::packData(CPacket& w_packet, steady_clock::time_point& w_nexttime
     else
     {
 #if USE_BUSY_WAITING
-        m_tsNextSendTime = enter_time + m_tdSendInterval.load();
+        m_tsNextSendTime = send_time + m_tdSendInterval.load();
 #else
         const duration sendbrw = m_tdSendTimeDiff;
 
         if (sendbrw >= sendint)
         {
             // Send immediately
-            m_tsNextSendTime = enter_time;
+            m_tsNextSendTime = send_time;
 
             // ATOMIC NOTE: this is the only thread that
             // modifies this field
@@ -9719,7 +9993,7 @@ bool srt::CUDT::packData(CPacket& w_packet, steady_clock::time_point& w_nexttime
         }
         else
         {
-            m_tsNextSendTime = enter_time + (sendint - sendbrw);
+            m_tsNextSendTime = send_time + (sendint - sendbrw);
             m_tdSendTimeDiff = duration();
         }
 #endif
@@ -9899,7 +10173,8 @@ void srt::CUDT::processClose()
     if (m_bTsbPd)
     {
         HLOGP(smlog.Debug, "processClose: lock-and-signal TSBPD");
-        CSync::lock_notify_one(m_RcvTsbPdCond, m_RecvLock);
+        ScopedLock rcvlock (m_RecvLock);
+        kickTsbPd();
     }
 
     // Signal the sender and recver if they are waiting for data.
@@ -9993,13 +10268,33 @@ int srt::CUDT::checkLazySpawnTsbPdThread()
 {
     const bool need_tsbpd = m_bTsbPd || m_bGroupTsbPd;
 
-    if (need_tsbpd && !m_RcvTsbPdThread.joinable())
+    if (need_tsbpd && !m_RcvTsbPdThread.joinable() && !m_pTsbPdWorker)
     {
+        // The group members keep their own thread, which holds the group
+        // for its lifetime (see CUDT::tsbpd).
+#if ENABLE_BONDING
+        const bool shared = !m_parent->m_GroupOf;
+#else
+        const bool shared = true;
+#endif
+        // Locks m_GlobControlLock, so it must be done before locking m_RcvTsbPdStartupLock.
+        CTsbPdWorker* w = shared ? uglobal().selectTsbPdWorker() : NULL;
+
         ScopedLock lock(m_RcvTsbPdStartupLock);
 
         if (m_bClosing) // Check again to protect join() in CUDT::releaseSync()
             return -1;
 
+        if (w)
+        {
+            HLOGC(qrlog.Debug, log << CONID() << "Using the shared TSBPD thread");
+            if (!m_pTsbPdNode)
+                m_pTsbPdNode = new CSNode;
+            m_pTsbPdWorker = w;
+            w->add(this);
+            return 0;
+        }
+
         HLOGP(qrlog.Debug, "Spawning Socket TSBPD thread");
 #if ENABLE_HEAVY_LOGGING
         std::ostringstream tns1, tns2;
@@ -10350,18 +10645,32 @@ int srt::CUDT::processData(CUnit* in_unit)
     // make sure that this packet isn't going to be
     // effectively discarded, as repeated retransmission,
     // for example, burdens the link, but doesn't better the speed.
-    m_RcvTimeWindow.onPktArrival(pktsz);
+    //
+    // The time when the system received the packet, if available, is more accurate
+    // than the current time, which includes the delay of dispatching the packet.
+    const steady_clock::time_point tsArrival = is_zero(packet.arrivalTime()) ? steady_clock::now() : packet.arrivalTime();
+
+    // The packets received coalesced (UDP GRO) all have the time of the whole
+    // buffer, so they are left out of the interval and probe measurements.
+    if (packet.coalesced())
+    {
+        m_RcvTimeWindow.onCoalescedPktArrival(tsArrival);
+    }
+    else
+    {
+        m_RcvTimeWindow.onPktArrival(pktsz, tsArrival);
 
-    // Probe the packet pair if needed.
-    // Conditions and any extra data required for the packet
-    // this function will extract and test as needed.
+        // Probe the packet pair if needed.
+        // Conditions and any extra data required for the packet
+        // this function will extract and test as needed.
 
-    const bool unordered = CSeqNo::seqcmp(packet.seqno(), m_iRcvCurrSeqNo) <= 0;
+        const bool unordered = CSeqNo::seqcmp(packet.seqno(), m_iRcvCurrSeqNo) <= 0;
 
-    // Retransmitted and unordered packets do not provide expected measurement.
-    // We expect the 16th and 17th packet to be sent regularly,
-    // otherwise measurement must be rejected.
-    m_RcvTimeWindow.probeArrival(packet, unordered || retransmitted);
+        // Retransmitted and unordered packets do not provide expected measurement.
+        // We expect the 16th and 17th packet to be sent regularly,
+        // otherwise measurement must be rejected.
+        m_RcvTimeWindow.probeArrival(packet, unordered || retransmitted, tsArrival);
+    }
 
     enterCS(m_StatsLock);
     m_stats.rcvr.recvd.count(pktsz);
@@ -10508,7 +10817,7 @@ int srt::CUDT::processData(CUnit* in_unit)
                 if (initial_loss_ttl)
                 {
                     // The LOSSREPORT will be sent after initial_loss_ttl.
-                    m_FreshLoss.push_back(CRcvFreshLoss(i->first, i->second, initial_loss_ttl));
+                    m_FreshLoss.insert(i->first, i->second, initial_loss_ttl);
                 }
             }
         }
@@ -10562,12 +10871,19 @@ int srt::CUDT::processData(CUnit* in_unit)
         {
             HLOGC(qrlog.Debug, log << CONID() << "WILL REPORT LOSSES (SRT): " << Printable(srt_loss_seqs));
             sendLossReport(srt_loss_seqs);
+
+            // The periodic report is due an interval after this one also
+            // when the timers haven't been checked for a while.
+            const steady_clock::time_point now = steady_clock::now();
+            if (m_tsNextNAKTime.load() < now)
+                m_tsNextNAKTime.store(now + m_tdNAKInterval);
         }
 
         if (m_bTsbPd)
         {
             HLOGC(qrlog.Debug, log << CONID() << "loss: signaling TSBPD cond");
-            CSync::lock_notify_one(m_RcvTsbPdCond, m_RecvLock);
+            ScopedLock rcvlock (m_RecvLock);
+            kickTsbPd();
         }
         else
         {
@@ -10588,27 +10904,14 @@ int srt::CUDT::processData(CUnit* in_unit)
         if (m_bTsbPd)
         {
             HLOGC(qrlog.Debug, log << CONID() << "loss: signaling TSBPD cond");
-            CSync::lock_notify_one(m_RcvTsbPdCond, m_RecvLock);
+            ScopedLock rcvlock (m_RecvLock);
+            kickTsbPd();
         }
     }
 
     // Now review the list of FreshLoss to see if there's any "old enough" to send UMSG_LOSSREPORT to it.
-
-    // PERFORMANCE CONSIDERATIONS:
-    // This list is quite inefficient as a data type and finding the candidate to send UMSG_LOSSREPORT
-    // is linear time. On the other hand, there are some special cases that are important for performance:
-    // - only the first (plus some following) could have had TTL drown to 0
-    // - the only (little likely) possibility that the next-to-first record has TTL=0 is when there was
-    //   a loss range split (due to dropFromLossLists() of one sequence)
-    // - first found record with TTL>0 means end of "ready to LOSSREPORT" records
-    // So:
-    // All you have to do is:
-    //  - start with first element and continue with next elements, as long as they have TTL=0
-    //    If so, send the loss report and remove this element.
-    //  - Since the first element that has TTL>0, iterate until the end of container and decrease TTL.
-    //
-    // This will be efficient becase the loop to increment one field (without any condition check)
-    // can be quite well optimized.
+    // Only the records at the front can have their TTL expired, the TTL of the rest is decreased
+    // all at once.
 
     vector<int32_t> lossdata;
     {
@@ -10618,40 +10921,10 @@ int srt::CUDT::processData(CUnit* in_unit)
         // (that is, "belated loss report" feature is off), don't even touch m_FreshLoss.
         if (initial_loss_ttl && !m_FreshLoss.empty())
         {
-            deque<CRcvFreshLoss>::iterator i = m_FreshLoss.begin();
-
-            // Phase 1: take while TTL <= 0.
-            // There can be more than one record with the same TTL, if it has happened before
-            // that there was an 'unlost' (@c dropFromLossLists) sequence that has split one detected loss
-            // into two records.
-            for (; i != m_FreshLoss.end() && i->ttl <= 0; ++i)
-            {
-                HLOGC(qrlog.Debug, log << "Packet seq " << i->seq[0] << "-" << i->seq[1]
-                        << " (" << (CSeqNo::seqoff(i->seq[0], i->seq[1]) + 1) << " packets) considered lost - sending LOSSREPORT");
-                addLossRecord(lossdata, i->seq[0], i->seq[1]);
-            }
-
-            // Remove elements that have been processed and prepared for lossreport.
-            if (i != m_FreshLoss.begin())
-            {
-                m_FreshLoss.erase(m_FreshLoss.begin(), i);
-                i = m_FreshLoss.begin();
-            }
-
-            if (m_FreshLoss.empty())
-            {
-                HLOGP(qrlog.Debug, "NO MORE FRESH LOSS RECORDS.");
-            }
-            else
-            {
-                HLOGC(qrlog.Debug, log << "STILL " << m_FreshLoss.size() << " FRESH LOSS RECORDS, FIRST: "
-                        << i->seq[0] << "-" << i->seq[1]
-                        << " (" << (1 + CSeqNo::seqoff(i->seq[0], i->seq[1])) << ") TTL: " << i->ttl);
-            }
-
-            // Phase 2: rest of the records should have TTL decreased.
-            for (; i != m_FreshLoss.end(); ++i)
-                --i->ttl;
+            loss_seqs_t expired;
+            m_FreshLoss.expire((expired));
+            for (loss_seqs_t::iterator i = expired.begin(); i != expired.end(); ++i)
+                addLossRecord(lossdata, i->first, i->second);
         }
     }
     if (!lossdata.empty())
@@ -10811,7 +11084,7 @@ void srt::CUDT::unlose(const CPacket &packet)
         return;
 
     int had_ttl = 0;
-    if (CRcvFreshLoss::removeOne((m_FreshLoss), sequence, (&had_ttl)))
+    if (m_FreshLoss.removeOne(sequence, (&had_ttl)))
     {
         HLOGC(qrlog.Debug, log << "sequence " << sequence << " removed from belated lossreport record");
     }
@@ -10899,32 +11172,7 @@ void srt::CUDT::dropFromLossLists(int32_t from, int32_t to)
 
     // It's highly unlikely that this is waiting to send a belated UMSG_LOSSREPORT,
     // so treat it rather as a sanity check.
-
-    // It's enough to check if the first element of the list starts with a sequence older than 'to'.
-    // If not, just do nothing.
-
-    size_t delete_index = 0;
-    for (size_t i = 0; i < m_FreshLoss.size(); ++i)
-    {
-        CRcvFreshLoss::Emod result = m_FreshLoss[i].revoke(from, to);
-        switch (result)
-        {
-        case CRcvFreshLoss::DELETE:
-            delete_index = i + 1; // PAST THE END
-            continue;             // There may be further ranges that are included in this one, so check on.
-
-        case CRcvFreshLoss::NONE:
-        case CRcvFreshLoss::STRIPPED:
-            break; // THIS BREAKS ONLY 'switch', not 'for'!
-
-        case CRcvFreshLoss::SPLIT:; // This function never returns it. It's only a compiler shut-up.
-        }
-
-        break; // Now this breaks also FOR.
-    }
-
-    m_FreshLoss.erase(m_FreshLoss.begin(),
-                      m_FreshLoss.begin() + delete_index); // with delete_index == 0 will do nothing
+    m_FreshLoss.revoke(from, to);
 }
 
 // This function, as the name states, should bake a new cookie.
@@ -11340,7 +11588,14 @@ void srt::CUDT::addLossRecord(std::vector<int32_t> &lr, int32_t lo, int32_t hi)
     }
 }
 
-int srt::CUDT::checkACKTimer(const steady_clock::time_point &currtime)
+// Lower the time of the next check of the timers to @a ts, if earlier.
+static inline void setNextCheck(steady_clock::time_point& w_next_check, const steady_clock::time_point& ts)
+{
+    if (ts < w_next_check)
+        w_next_check = ts;
+}
+
+int srt::CUDT::checkACKTimer(const steady_clock::time_point &currtime, steady_clock::time_point& w_next_check)
 {
     int because_decision = BECAUSE_NO_REASON;
     if (currtime > m_tsNextACKTime.load()  // ACK time has come
@@ -11376,10 +11631,16 @@ int srt::CUDT::checkACKTimer(const steady_clock::time_point &currtime)
         because_decision = BECAUSE_LITEACK;
     }
 
+    // The periodic ACK is due only while there is something received
+    // that the peer hasn't confirmed with ACKACK yet, or when it should
+    // learn that there is space in the receiver buffer again.
+    if (m_iRcvLastAckAck != CSeqNo::incseq(m_iRcvCurrSeqNo) || m_bBufferWasFull)
+        setNextCheck((w_next_check), m_tsNextACKTime.load());
+
     return because_decision;
 }
 
-int srt::CUDT::checkNAKTimer(const steady_clock::time_point& currtime)
+int srt::CUDT::checkNAKTimer(const steady_clock::time_point& currtime, steady_clock::time_point& w_next_check)
 {
     // XXX The problem with working NAKREPORT with SRT_ARQ_ONREQ
     // is not that it would be inappropriate, but because it's not
@@ -11411,17 +11672,26 @@ int srt::CUDT::checkNAKTimer(const steady_clock::time_point& currtime)
     if (loss_len > 0)
     {
         if (currtime <= m_tsNextNAKTime.load())
+        {
+            setNextCheck((w_next_check), m_tsNextNAKTime.load());
             return BECAUSE_NO_REASON; // wait for next NAK time
+        }
 
         sendCtrl(UMSG_LOSSREPORT);
         debug_decision = BECAUSE_NAKREPORT;
     }
 
     m_tsNextNAKTime.store(currtime + m_tdNAKInterval);
+
+    // Repeat the report for the losses not yet recovered.
+    if (loss_len > 0)
+        setNextCheck((w_next_check), m_tsNextNAKTime.load());
     return debug_decision;
 }
 
-bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime, int check_reason SRT_ATR_UNUSED)
+bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime,
+                              int check_reason SRT_ATR_UNUSED,
+                              steady_clock::time_point& w_next_check)
 {
     // VERY HEAVY LOGGING
 #if ENABLE_HEAVY_LOGGING & 1
@@ -11447,25 +11717,12 @@ bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime, int chec
     HLOGC(xtlog.Debug, log << CONID() << "checkTimer: ACTIVITIES PERFORMED: " << decision);
 #endif
 
-    // In UDT the m_bUserDefinedRTO and m_iRTO were in CCC class.
-    // There's nothing in the original code that alters these values.
-
-    steady_clock::time_point next_exp_time;
-    if (m_CongCtl->RTO())
-    {
-        next_exp_time = m_tsLastRspTime.load() + microseconds_from(m_CongCtl->RTO());
-    }
-    else
-    {
-        steady_clock::duration exp_timeout =
-            microseconds_from(m_iEXPCount * (m_iSRTT + 4 * m_iRTTVar) + COMM_SYN_INTERVAL_US);
-        if (exp_timeout < (m_iEXPCount * m_tdMinExpInterval))
-            exp_timeout = m_iEXPCount * m_tdMinExpInterval;
-        next_exp_time = m_tsLastRspTime.load() + exp_timeout;
-    }
-
+    const steady_clock::time_point next_exp_time = getNextExpTime();
     if (currtime <= next_exp_time && !m_bBreakAsUnstable)
+    {
+        setNextCheck((w_next_check), next_exp_time);
         return false;
+    }
 
     // ms -> us
     const int PEER_IDLE_TMO_US = m_config.iPeerIdleTimeout_ms * 1000;
@@ -11487,11 +11744,13 @@ bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime, int chec
         m_iBrokenCounter = 30;
 
         // update snd U list to remove this socket
-        m_pSndQueue->m_pSndUList->update(this, CSndUList::DO_RESCHEDULE);
+        m_pSndQueue->sndUList(m_SocketID)->update(this, CSndUList::DO_RESCHEDULE);
 
         updateBrokenConnection();
         completeBrokenConnectionDependencies(SRT_ECONNLOST); // LOCKS!
 
+        // Let the socket be taken off the receiver's list without delay.
+        setNextCheck((w_next_check), currtime);
         return true;
     }
 
@@ -11514,13 +11773,30 @@ bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime, int chec
     // Reset last response time since we've just sent a heart-beat.
     // (fixed) m_tsLastRspTime = currtime_tk;
 
+    setNextCheck((w_next_check), getNextExpTime());
     return false;
 }
 
-void srt::CUDT::checkRexmitTimer(const steady_clock::time_point& currtime)
+srt::sync::steady_clock::time_point srt::CUDT::getNextExpTime()
+{
+    // In UDT the m_bUserDefinedRTO and m_iRTO were in CCC class.
+    // There's nothing in the original code that alters these values.
+    if (m_CongCtl->RTO())
+        return m_tsLastRspTime.load() + microseconds_from(m_CongCtl->RTO());
+
+    steady_clock::duration exp_timeout =
+        microseconds_from(m_iEXPCount * (m_iSRTT + 4 * m_iRTTVar) + COMM_SYN_INTERVAL_US);
+    if (exp_timeout < (m_iEXPCount * m_tdMinExpInterval))
+        exp_timeout = m_iEXPCount * m_tdMinExpInterval;
+    return m_tsLastRspTime.load() + exp_timeout;
+}
+
+void srt::CUDT::checkRexmitTimer(const steady_clock::time_point& currtime, steady_clock::time_point& w_next_check)
 {
     // Check if HSv4 should be retransmitted, and if KM_REQ should be resent if the side is INITIATOR.
-    checkSndTimers();
+    // Until the response comes, check again with every SYN interval.
+    if (checkSndTimers())
+        setNextCheck((w_next_check), currtime + microseconds_from(COMM_SYN_INTERVAL_US));
 
     // There are two algorithms of blind packet retransmission: LATEREXMIT and FASTREXMIT.
     //
@@ -11538,27 +11814,36 @@ void srt::CUDT::checkRexmitTimer(const steady_clock::time_point& currtime)
     // in the sender's buffer will be added to the SND loss list and retransmitted.
     //
 
-    {
-        ScopedLock ack_lock(m_RecvAckLock);
-        const uint64_t rtt_syn = (m_iSRTT + 4 * m_iRTTVar + 2 * COMM_SYN_INTERVAL_US);
-        const uint64_t exp_int_us = (m_iReXmitCount * rtt_syn + COMM_SYN_INTERVAL_US);
+    const bool is_laterexmit = m_CongCtl->rexmitMethod() == SrtCongestion::SRM_LATEREXMIT; // FileCC
+    const bool is_fastrexmit = m_CongCtl->rexmitMethod() == SrtCongestion::SRM_FASTREXMIT; // LiveCC
 
-        if (currtime <= (m_tsLastRspAckTime + microseconds_from(exp_int_us)))
-            return;
-    }
+    // If the receiver will send periodic NAK reports, then FASTREXMIT (live) is inactive.
+    // TODO: Probably some method of "blind rexmit" MUST BE DONE, when TLPKTDROP is off.
+    if (is_fastrexmit && m_bPeerNakReport)
+        return;
 
     // If there is no unacknowledged data in the sending buffer,
     // then there is nothing to retransmit.
     if (m_pSndBuffer->getCurrBufSize() <= 0)
         return;
 
-    const bool is_laterexmit = m_CongCtl->rexmitMethod() == SrtCongestion::SRM_LATEREXMIT; // FileCC
-    const bool is_fastrexmit = m_CongCtl->rexmitMethod() == SrtCongestion::SRM_FASTREXMIT; // LiveCC
+    {
+        ScopedLock ack_lock(m_RecvAckLock);
+        const uint64_t rtt_syn = (m_iSRTT + 4 * m_iRTTVar + 2 * COMM_SYN_INTERVAL_US);
+        const uint64_t exp_int_us = (m_iReXmitCount * rtt_syn + COMM_SYN_INTERVAL_US);
+        const steady_clock::time_point rexmit_time = m_tsLastRspAckTime + microseconds_from(exp_int_us);
 
-    // If the receiver will send periodic NAK reports, then FASTREXMIT (live) is inactive.
-    // TODO: Probably some method of "blind rexmit" MUST BE DONE, when TLPKTDROP is off.
-    if (is_fastrexmit && m_bPeerNakReport)
-        return;
+        if (currtime <= rexmit_time)
+        {
+            setNextCheck((w_next_check), rexmit_time);
+            return;
+        }
+
+        // When this is repeated since the last ACK, the next time may be
+        // already in the past, so the SYN interval is kept between them.
+        setNextCheck((w_next_check),
+                     std::max(rexmit_time + microseconds_from(rtt_syn), currtime + microseconds_from(COMM_SYN_INTERVAL_US)));
+    }
 
     // Schedule a retransmission IF:
     // - there are packets in flight (getFlightSpan() > 0);
@@ -11592,16 +11877,21 @@ void srt::CUDT::checkRexmitTimer(const steady_clock::time_point& currtime)
     updateCC(TEV_CHECKTIMER, EventVariant(stage));
 
     // schedule sending if not scheduled already
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+    m_pSndQueue->sndUList(m_SocketID)->update(this, CSndUList::DONT_RESCHEDULE);
 }
 
-void srt::CUDT::checkTimers()
+srt::sync::steady_clock::time_point srt::CUDT::checkTimers()
 {
     // update CC parameters
     updateCC(TEV_CHECKTIMER, EventVariant(TEV_CHT_INIT));
 
     const steady_clock::time_point currtime = steady_clock::now();
 
+    // Check again not later than with the keepalive period. This is also
+    // enough for releasing the sender buffer memory, and for taking up
+    // the changes made by other threads that aren't scheduled here.
+    steady_clock::time_point next_check = currtime + microseconds_from(COMM_KEEPALIVE_PERIOD_US);
+
     // This is a very heavy log, unblock only for temporary debugging!
 #if 0
     HLOGC(xtlog.Debug, log << CONID() << "checkTimers: nextacktime=" << FormatTime(m_tsNextACKTime)
@@ -11610,17 +11900,25 @@ void srt::CUDT::checkTimers()
 #endif
 
     // Check if it is time to send ACK
-    int debug_decision = checkACKTimer(currtime);
+    int debug_decision = checkACKTimer(currtime, (next_check));
 
     // Check if it is time to send a loss report
-    debug_decision |= checkNAKTimer(currtime);
+    debug_decision |= checkNAKTimer(currtime, (next_check));
 
     // Check if the connection is expired
-    if (checkExpTimer(currtime, debug_decision))
-        return;
+    if (checkExpTimer(currtime, debug_decision, (next_check)))
+        return next_check;
 
     // Check if FAST or LATE packet retransmission is required
-    checkRexmitTimer(currtime);
+    checkRexmitTimer(currtime, (next_check));
+
+    // Release the sender buffer memory not used for a while,
+    // and the user data blocks no longer sent from.
+    m_pSndBuffer->reclaim(currtime);
+    m_pSndBuffer->releaseDeferred(currtime);
+    const steady_clock::time_point next_release = m_pSndBuffer->nextDeferredRelease();
+    if (!is_zero(next_release))
+        setNextCheck((next_check), next_release);
 
     if (currtime > m_tsLastSndTime.load() + microseconds_from(COMM_KEEPALIVE_PERIOD_US))
     {
@@ -11641,6 +11939,17 @@ void srt::CUDT::checkTimers()
 #endif
         HLOGP(xtlog.Debug, "KEEPALIVE");
     }
+
+    setNextCheck((next_check), m_tsLastSndTime.load() + microseconds_from(COMM_KEEPALIVE_PERIOD_US));
+    return next_check;
+}
+
+void srt::CUDT::breakAsUnstable()
+{
+    m_bBreakAsUnstable = true;
+    // Broken in checkTimers(), at once rather than at the next deadline.
+    if (m_pRcvQueue)
+        m_pRcvQueue->requestTimersCheck(this);
 }
 
 void srt::CUDT::updateBrokenConnection()
@@ -177,6 +177,7 @@ class CUDT
     friend class CRcvQueue;
     friend class CSndUList;
     friend class CRcvUList;
+    friend class CTsbPdWorker;
     friend class PacketFilter;
     friend class CUDTGroup;
     friend class TestMockCUDT; // unit tests
@@ -197,6 +198,9 @@ private: // constructor and desctructor
 public: //API
     static int startup();
     static int cleanup();
+    static int setIoThreads(int nthreads);
+    static int setTsbPdThreads(int nthreads);
+    static int setCryptoThreads(int nthreads);
     static SRTSOCKET socket();
 #if ENABLE_BONDING
     static SRTSOCKET createGroup(SRT_GROUP_TYPE);
@@ -223,8 +227,11 @@ public: //API
     static int recv(SRTSOCKET u, char* buf, int len, int flags);
     static int sendmsg(SRTSOCKET u, const char* buf, int len, int ttl = SRT_MSGTTL_INF, bool inorder = false, int64_t srctime = 0);
     static int recvmsg(SRTSOCKET u, char* buf, int len, int64_t& srctime);
-    static int sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& mctrl);
+    static int sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& mctrl,
+                        srt_send_release_fn* release = NULL, void* opaque = NULL);
     static int recvmsg2(SRTSOCKET u, char* buf, int len, SRT_MSGCTRL& w_mctrl);
+    static int recvmsgViews(SRTSOCKET u, SRT_MSGVIEW* views, int nviews);
+    static int releaseMsgViews(SRTSOCKET u, const SRT_MSGVIEW* views, int nviews);
     static int64_t sendfile(SRTSOCKET u, std::fstream& ifs, int64_t& offset, int64_t size, int block = SRT_DEFAULT_SENDFILE_BLOCK);
     static int64_t recvfile(SRTSOCKET u, std::fstream& ofs, int64_t& offset, int64_t size, int block = SRT_DEFAULT_RECVFILE_BLOCK);
     static int select(int nfds, UDT::UDSET* readfds, UDT::UDSET* writefds, UDT::UDSET* exceptfds, const timeval* timeout);
@@ -333,6 +340,7 @@ public: // internal API
     int         bandwidth()         const { return m_iBandwidth; }
     int64_t     maxBandwidth()      const { return m_config.llMaxBW; }
     int         MSS()               const { return m_config.iMSS; }
+    int         sndBurst()          const { return m_config.iSndBurst; }
 
     uint32_t        peerLatency_us()        const { return m_iPeerTsbPdDelay_ms * 1000; }
     int             peerIdleTimeout_ms()    const { return m_config.iPeerIdleTimeout_ms; }
@@ -462,7 +470,7 @@ public: // internal API
     SRTU_PROPERTY_RR(sync::Condition*, recvTsbPdCond, &m_RcvTsbPdCond);
 
     /// @brief  Request a socket to be broken due to too long instability (normally by a group).
-    void breakAsUnstable() { m_bBreakAsUnstable = true; }
+    void breakAsUnstable();
 
     void ConnectSignal(ETransmissionEvent tev, EventSlot sl);
     void DisconnectSignal(ETransmissionEvent tev);
@@ -639,11 +647,33 @@ private:
     /// @param len [in] size of the buffer.
     /// @return Actual size of data received.
 
-    SRT_ATR_NODISCARD int sendmsg2(const char* data, int len, SRT_MSGCTRL& w_m);
+    /// Send a message with extra control data.
+    /// @param data [in] data to send.
+    /// @param len [in] size of the data.
+    /// @param w_m [inout] message control data.
+    /// @param release [in] if not NULL, the data are referred to instead of copying,
+    ///        and this is called when they are no longer used (see srt_sendmsg_zc).
+    /// @param opaque [in] first argument for @a release.
+    /// @return Actual size of data sent.
+    SRT_ATR_NODISCARD int sendmsg2(const char* data, int len, SRT_MSGCTRL& w_m,
+                                   srt_send_release_fn* release = NULL, void* opaque = NULL);
 
     SRT_ATR_NODISCARD int recvmsg(char* data, int len, int64_t& srctime);
     SRT_ATR_NODISCARD int recvmsg2(char* data, int len, SRT_MSGCTRL& w_m);
-    SRT_ATR_NODISCARD int receiveMessage(char* data, int len, SRT_MSGCTRL& w_m, int erh = 1 /*throw exception*/);
+
+    /// Receive one or more whole messages by lending their packets (see srt_recvmsg_zc).
+    /// @param views [out] the views to fill, one per packet.
+    /// @param nviews [in] the number of views.
+    /// @return The number of views filled.
+    SRT_ATR_NODISCARD int recvmsgViews(SRT_MSGVIEW* views, int nviews);
+
+    /// Return the packets lent by recvmsgViews().
+    void releaseMsgViews(const SRT_MSGVIEW* views, int nviews);
+
+    /// @param w_views [out] if not NULL, the messages are lent into these views
+    ///        (@a len is then their number) instead of being copied into @a data.
+    SRT_ATR_NODISCARD int receiveMessage(char* data, int len, SRT_MSGCTRL& w_m, int erh = 1 /*throw exception*/,
+                                         SRT_MSGVIEW* w_views = NULL);
     SRT_ATR_NODISCARD int receiveBuffer(char* data, int len);
 
     size_t dropMessage(int32_t seqtoskip);
@@ -703,8 +733,9 @@ private:
     SRT_ATTR_REQUIRES(m_RecvAckLock)
     bool getFirstNoncontSequence(int32_t& w_seq, std::string& w_log_reason);
 
+    /// @return true if the legacy handshake or the KM request may still have to be resent.
     SRT_ATTR_EXCLUDES(m_ConnectionLock)
-    void checkSndTimers();
+    bool checkSndTimers();
     
     /// @brief Check and perform KM refresh if needed.
     void checkSndKMRefresh();
@@ -762,6 +793,21 @@ private:
     // TSBPD thread main function.
     static void* tsbpd(void* param);
 
+    /// Signal the readiness of the packets that are due to play, and drop the
+    /// too late ones preceding them. This is one round of the TSBPD thread.
+    /// @return the time to check again, or zero to wait until kickTsbPd() is called
+#if ENABLE_BONDING
+    SRT_ATTR_REQUIRES(m_RecvLock)
+    time_point tsbpdCheck(sync::UniqueLock& recvlock, CUDTGroup* group);
+#else
+    SRT_ATTR_REQUIRES(m_RecvLock)
+    time_point tsbpdCheck(sync::UniqueLock& recvlock);
+#endif
+
+    /// Make the TSBPD thread check the receiver buffer again.
+    SRT_ATTR_REQUIRES(m_RecvLock)
+    void kickTsbPd();
+
     enum DropReason
     {
         DROP_TOO_LATE, //< Drop to keep up to the live pace (TLPKTDROP).
@@ -966,7 +1012,7 @@ private: // Receiving related data
     SRT_ATTR_GUARDED_BY(m_RcvLossLock)
     CRcvLossList* m_pRcvLossList;                //< Receiver loss list
     SRT_ATTR_GUARDED_BY(m_RcvLossLock)
-    std::deque<CRcvFreshLoss> m_FreshLoss;       //< Lost sequence already added to m_pRcvLossList, but not yet sent UMSG_LOSSREPORT for.
+    CRcvFreshLossList m_FreshLoss;               //< Lost sequence already added to m_pRcvLossList, but not yet sent UMSG_LOSSREPORT for.
 
     int m_iReorderTolerance;                     //< Current value of dynamic reorder tolerance
     int m_iConsecEarlyDelivery;                  //< Increases with every OOO packet that came <TTL-2 time, resets with every increased reorder tolerance
@@ -996,6 +1042,8 @@ private: // Receiving related data
     sync::Condition m_RcvTsbPdCond;              // TSBPD signals if reading is ready. Use together with m_RecvLock
     bool m_bTsbPdNeedsWakeup;                    // Signal TsbPd thread to wake up on RCV buffer state change.
     sync::Mutex m_RcvTsbPdStartupLock;           // Protects TSBPD thread creating and joining
+    sync::atomic<CTsbPdWorker*> m_pTsbPdWorker;  // The shared TSBPD thread, if used instead of m_RcvTsbPdThread
+    CSNode* m_pTsbPdNode;                        // Node on the timing wheel of m_pTsbPdWorker
 
     CallbackHolder<srt_listen_callback_fn> m_cbAcceptHook;
     CallbackHolder<srt_connect_callback_fn> m_cbConnectHook;
@@ -1121,10 +1169,15 @@ private: // Generation and processing of packets
     /// @param packet [out] a CPacket structure to fill
     /// @param nexttime [out] Time when this socket should be next time picked up for processing.
     /// @param src_addr [out] Source address to pass to channel's sendto
+    /// @param sendtime [out] Time when the packet is due to be sent. This is later than now
+    ///                 only if the packet is passed to the system ahead of time (SRTO_UDP_TXTIME)
+    ///                 or packed in a burst.
+    /// @param burst [in] The packet follows the previous one in a burst (SRTO_SNDBURST), that is,
+    ///              it's packed ahead of its time and the pacing continues from its scheduled time.
     ///
     /// @retval true A packet was extracted for sending, the socket should be rechecked at @a nexttime
     /// @retval false Nothing was extracted for sending, @a nexttime should be ignored
-    bool packData(CPacket& packet, time_point& nexttime, sockaddr_any& src_addr);
+    bool packData(CPacket& packet, time_point& nexttime, sockaddr_any& src_addr, time_point& sendtime, bool burst = false);
 
     int processData(CUnit* unit);
 
@@ -1172,6 +1225,12 @@ private: // Generation and processing of packets
     SRT_ATTR_REQUIRES(m_RcvBufferLock)
     size_t getAvailRcvBufferSizeNoLock() const;
 
+    /// Read the next message from the receiver buffer for receiveMessage().
+    /// Expects that m_RcvBufferLock is locked.
+    /// @return The size of the message, or the number of views filled if @a w_views is not NULL.
+    SRT_ATTR_REQUIRES(m_RcvBufferLock)
+    int readRcvMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, SRT_MSGVIEW* w_views);
+
 private: // Trace
     struct CoreStats
     {
@@ -1208,12 +1267,17 @@ private: // Timers functions
                      BECAUSE_NAKREPORT = 1 << 2,
                      LAST_BECAUSE_BIT  =      3;
 
-    void checkTimers();
+    /// Check the timers and perform their actions when due.
+    /// @return the time when the timers should be checked next.
+    time_point checkTimers();
     void considerLegacySrtHandshake(const time_point &timebase);
-    int checkACKTimer (const time_point& currtime);
-    int checkNAKTimer(const time_point& currtime);
-    bool checkExpTimer (const time_point& currtime, int check_reason);  // returns true if the connection is expired
-    void checkRexmitTimer(const time_point& currtime);
+
+    // Each of these lowers w_next_check to the time when it is due next, if earlier.
+    int checkACKTimer (const time_point& currtime, time_point& w_next_check);
+    int checkNAKTimer(const time_point& currtime, time_point& w_next_check);
+    bool checkExpTimer (const time_point& currtime, int check_reason, time_point& w_next_check);  // returns true if the connection is expired
+    void checkRexmitTimer(const time_point& currtime, time_point& w_next_check);
+    time_point getNextExpTime();
 
 
 private: // for UDP multiplexer
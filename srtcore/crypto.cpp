@@ -15,6 +15,7 @@ written by
 
 #include "platform_sys.h"
 
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <sstream>
@@ -466,14 +467,14 @@ int srt::CCryptoControl::processSrtMsg_KMRSP(const uint32_t* srtdata, size_t len
     return retstatus;
 }
 
-void srt::CCryptoControl::sendKeysToPeer(CUDT* sock SRT_ATR_UNUSED, int iSRTT SRT_ATR_UNUSED)
+bool srt::CCryptoControl::sendKeysToPeer(CUDT* sock SRT_ATR_UNUSED, int iSRTT SRT_ATR_UNUSED)
 {
     sync::ScopedLock lck(m_mtxLock);
     if (!m_hSndCrypto || m_SndKmState == SRT_KM_S_UNSECURED)
     {
         HLOGC(cnlog.Debug, log << "sendKeysToPeer: NOT sending/regenerating keys: "
                 << (m_hSndCrypto ? "CONNECTION UNSECURED" : "NO TX CRYPTO CTX created"));
-        return;
+        return false;
     }
 #ifdef SRT_ENABLE_ENCRYPTION
     srt::sync::steady_clock::time_point now = srt::sync::steady_clock::now();
@@ -501,6 +502,10 @@ void srt::CCryptoControl::sendKeysToPeer(CUDT* sock SRT_ATR_UNUSED, int iSRTT SR
             }
         }
     }
+
+    return getKmMsg_needSend(0, true) || getKmMsg_needSend(1, true);
+#else
+    return false;
 #endif
 }
 
@@ -594,6 +599,16 @@ srt::CCryptoControl::CCryptoControl(SRTSOCKET id)
     , m_KmPreAnnouncePkt(0)
     , m_iCryptoMode(CSrtConfig::CIPHER_MODE_AUTO)
     , m_bErrorReported(false)
+    , m_bKsChecked(false)
+    , m_pKsWorker(NULL)
+    , m_hKsGen(NULL)
+    , m_zKsStride(0)
+    , m_iKsLastSeq(SRT_SEQNO_NONE)
+    , m_iKsNextSeq(SRT_SEQNO_NONE)
+    , m_uKsEpoch(0)
+    , m_bKsQueued(false)
+    , m_bKsAttached(false)
+    , m_llKsPackets(0)
 {
     m_KmSecret.len = 0;
     //send
@@ -700,6 +715,9 @@ bool srt::CCryptoControl::init(HandshakeSide side, const CSrtConfig& cfg, bool b
 
 void srt::CCryptoControl::close() 
 {
+    // The worker locks m_mtxLock while filling the ring.
+    stopKeystream();
+
     /* Wipeout secrets */
     sync::ScopedLock lck(m_mtxLock);
     memset(&m_KmSecret, 0, sizeof(m_KmSecret));
@@ -800,9 +818,26 @@ srt::EncryptionStatus srt::CCryptoControl::encrypt(CPacket& w_packet SRT_ATR_UNU
     if ( getSndCryptoFlags() == EK_NOENC )
         return ENCS_CLEAR;
 
+    if (!m_bKsChecked)
+        startKeystream(w_packet.seqno());
+
+    // The keystream may be of a key that is no longer used, then
+    // the packet is encrypted the usual way.
+    int rc = -1;
+    int key_id = 0;
+    const unsigned char* ks = m_pKsWorker ? takeKeystream(w_packet.seqno(), (key_id)) : NULL;
+    if (ks && w_packet.getLength() <= m_zKsStride)
+    {
+        rc = HaiCrypt_Tx_DataKs(m_hSndCrypto, ((uint8_t*)w_packet.getHeader()), ((uint8_t*)w_packet.m_pcData), w_packet.getLength(),
+                ks, key_id);
+        if (rc >= 0)
+            ++m_llKsPackets;
+    }
+
     // Note that in case of GCM the header has to zero Retransmitted Packet Flag (R).
     // If TSBPD is disabled, timestamp also has to be zeroed.
-    int rc = HaiCrypt_Tx_Data(m_hSndCrypto, ((uint8_t*)w_packet.getHeader()), ((uint8_t*)w_packet.m_pcData), w_packet.getLength());
+    if (rc < 0)
+        rc = HaiCrypt_Tx_Data(m_hSndCrypto, ((uint8_t*)w_packet.getHeader()), ((uint8_t*)w_packet.m_pcData), w_packet.getLength());
     if (rc < 0)
     {
         return ENCS_FAILED;
@@ -900,6 +935,11 @@ srt::CCryptoControl::~CCryptoControl()
 {
 #ifdef SRT_ENABLE_ENCRYPTION
     close();
+    if (m_hKsGen)
+    {
+        HaiCrypt_KsGen_Close(m_hKsGen);
+    }
+
     if (m_hSndCrypto)
     {
         HaiCrypt_Close(m_hSndCrypto);
@@ -911,3 +951,250 @@ srt::CCryptoControl::~CCryptoControl()
     }
 #endif
 }
+
+void srt::CCryptoControl::startKeystream(int32_t seqno SRT_ATR_UNUSED)
+{
+    m_bKsChecked = true;
+#ifdef SRT_ENABLE_ENCRYPTION
+    // Only the AES-CTR keystream is known before the payload is.
+    if (m_iCryptoMode == CSrtConfig::CIPHER_MODE_AES_GCM)
+        return;
+
+    CKeystreamWorker* w = CUDT::uglobal().selectKeystreamWorker();
+    if (!w)
+        return;
+
+    {
+        sync::ScopedLock lck(m_mtxLock);
+        if (!m_hSndCrypto || HaiCrypt_KsGen_Create(m_hSndCrypto, (&m_hKsGen)) != HAICRYPT_OK)
+            return;
+    }
+
+    HLOGC(cnlog.Debug, log << CONID() << "encrypt: using the shared keystream thread from %" << seqno);
+
+    // The same limit as HaiCrypt has for the payload, rounded up to the cipher block.
+    m_zKsStride = ((HAICRYPT_DEF_DATA_MAX_LENGTH + HAICRYPT_CIPHER_BLK_SZ - 1) / HAICRYPT_CIPHER_BLK_SZ) * HAICRYPT_CIPHER_BLK_SZ;
+    m_KsBuffer.resize(KEYSTREAM_RING * m_zKsStride);
+    for (int i = 0; i < KEYSTREAM_RING; ++i)
+    {
+        m_aKsSlots[i].iSeqNo = SRT_SEQNO_NONE;
+        m_aKsSlots[i].iKeyId = 0;
+    }
+
+    {
+        sync::ScopedLock lk(m_KsLock);
+        m_iKsLastSeq = seqno;
+        m_iKsNextSeq = CSeqNo::incseq(seqno);
+        m_bKsQueued  = true;
+    }
+
+    w->add(this);
+    m_pKsWorker = w;
+    w->wakeup(this);
+#endif
+}
+
+void srt::CCryptoControl::stopKeystream()
+{
+    CKeystreamWorker* w = m_pKsWorker.exchange(NULL);
+    if (w)
+        w->remove(this);
+}
+
+const unsigned char* srt::CCryptoControl::takeKeystream(int32_t seqno, int& w_key_id)
+{
+    const unsigned char* ks   = NULL;
+    bool                 wake = false;
+    {
+        sync::ScopedLock lk(m_KsLock);
+        const int offset = CSeqNo::seqoff(m_iKsLastSeq, seqno);
+        const int ready  = CSeqNo::seqoff(m_iKsLastSeq, m_iKsNextSeq) - 1;
+        const int slot   = seqno % KEYSTREAM_RING;
+        if (offset > 0 && offset <= ready && m_aKsSlots[slot].iSeqNo == seqno)
+        {
+            ks       = &m_KsBuffer[slot * m_zKsStride];
+            w_key_id = m_aKsSlots[slot].iKeyId;
+            // The slots skipped over, if any, are free now.
+            m_iKsLastSeq = seqno;
+        }
+        else
+        {
+            // Not prepared yet or out of order, so start over from the next one.
+            HLOGC(cnlog.Debug, log << CONID() << "encrypt: no keystream for %" << seqno << ", restarting");
+            m_iKsLastSeq = seqno;
+            m_iKsNextSeq = CSeqNo::incseq(seqno);
+            ++m_uKsEpoch;
+        }
+
+        if (!m_bKsQueued && CSeqNo::seqoff(m_iKsLastSeq, m_iKsNextSeq) <= KEYSTREAM_RING / 2)
+        {
+            m_bKsQueued = true;
+            wake        = true;
+        }
+    }
+
+    if (wake)
+    {
+        CKeystreamWorker* w = m_pKsWorker;
+        if (w)
+            w->wakeup(this);
+    }
+    return ks;
+}
+
+void srt::CCryptoControl::fillKeystream()
+{
+#ifdef SRT_ENABLE_ENCRYPTION
+    {
+        sync::ScopedLock lk(m_KsLock);
+        m_bKsQueued = false;
+    }
+
+    for (;;)
+    {
+        int key_id;
+        {
+            sync::ScopedLock lck(m_mtxLock);
+            if (!m_hSndCrypto)
+                return;
+            key_id = HaiCrypt_KsGen_SetKey(m_hKsGen, m_hSndCrypto);
+        }
+        if (key_id <= 0)
+            return;
+
+        int32_t  seqno;
+        unsigned epoch;
+        int      count;
+        {
+            sync::ScopedLock lk(m_KsLock);
+            // The slot of m_iKsLastSeq is still in use.
+            const int nfree = KEYSTREAM_RING - CSeqNo::seqoff(m_iKsLastSeq, m_iKsNextSeq);
+            if (nfree <= 0)
+                return;
+            count = std::min(nfree, int(KEYSTREAM_BATCH));
+            seqno = m_iKsNextSeq;
+            epoch = m_uKsEpoch;
+        }
+
+        // takeKeystream() doesn't read the slots from m_iKsNextSeq on,
+        // so they are written without the lock.
+        int32_t s = seqno;
+        for (int i = 0; i < count; ++i, s = CSeqNo::incseq(s))
+        {
+            unsigned char* out = &m_KsBuffer[(s % KEYSTREAM_RING) * m_zKsStride];
+            if (HaiCrypt_KsGen_Generate(m_hKsGen, uint32_t(s), out, m_zKsStride) < 0)
+            {
+                LOGC(cnlog.Error, log << CONID() << "fillKeystream: generating keystream failed");
+                return;
+            }
+        }
+
+        sync::ScopedLock lk(m_KsLock);
+        if (epoch != m_uKsEpoch)
+            continue; // restarted by takeKeystream() in the meantime
+
+        s = seqno;
+        for (int i = 0; i < count; ++i, s = CSeqNo::incseq(s))
+        {
+            KeystreamSlot& slot = m_aKsSlots[s % KEYSTREAM_RING];
+            slot.iSeqNo = s;
+            slot.iKeyId = key_id;
+        }
+        m_iKsNextSeq = s;
+    }
+#endif
+}
+
+srt::CKeystreamWorker::CKeystreamWorker()
+    : m_bClosing(false)
+    , m_iLoad(0)
+    , m_pCurrent(NULL)
+{
+    sync::setupMutex(m_Lock, "KeystreamWorker");
+    sync::setupCond(m_Cond, "KeystreamWorker");
+    sync::setupCond(m_DoneCond, "KeystreamWorkerDone");
+}
+
+srt::CKeystreamWorker::~CKeystreamWorker()
+{
+    m_bClosing = true;
+    if (m_Thread.joinable())
+    {
+        sync::CSync::lock_notify_one(m_Cond, m_Lock);
+        m_Thread.join();
+    }
+
+    sync::releaseCond(m_DoneCond);
+    sync::releaseCond(m_Cond);
+    sync::releaseMutex(m_Lock);
+}
+
+void srt::CKeystreamWorker::start(int index)
+{
+    const std::string thrname = "SRT:KsGenW" + Sprint(index);
+    if (!sync::StartThread(m_Thread, CKeystreamWorker::worker, this, thrname.c_str()))
+        throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+}
+
+void srt::CKeystreamWorker::add(CCryptoControl* c)
+{
+    ++m_iLoad;
+    sync::ScopedLock lk(m_Lock);
+    c->m_bKsAttached = true;
+}
+
+void srt::CKeystreamWorker::remove(CCryptoControl* c)
+{
+    sync::UniqueLock lk(m_Lock);
+    while (m_pCurrent == c)
+        m_DoneCond.wait(lk);
+
+    m_Queue.erase(std::remove(m_Queue.begin(), m_Queue.end(), c), m_Queue.end());
+    // Ignore the wakeups from now on.
+    c->m_bKsAttached = false;
+    --m_iLoad;
+}
+
+void srt::CKeystreamWorker::wakeup(CCryptoControl* c)
+{
+    sync::ScopedLock lk(m_Lock);
+    if (!c->m_bKsAttached)
+        return;
+    m_Queue.push_back(c);
+    m_Cond.notify_one();
+}
+
+void* srt::CKeystreamWorker::worker(void* param)
+{
+    CKeystreamWorker* self = (CKeystreamWorker*)param;
+
+    THREAD_STATE_INIT("SRT:KsGenWorker");
+
+    sync::UniqueLock lk(self->m_Lock);
+    while (!self->m_bClosing)
+    {
+        INCREMENT_THREAD_ITERATIONS();
+
+        if (self->m_Queue.empty())
+        {
+            THREAD_PAUSED();
+            self->m_Cond.wait(lk);
+            THREAD_RESUMED();
+            continue;
+        }
+
+        // The crypto control can't be removed while it's being filled.
+        CCryptoControl* c = self->m_Queue.front();
+        self->m_Queue.pop_front();
+        self->m_pCurrent = c;
+        {
+            sync::InvertedLock unlocked(self->m_Lock);
+            c->fillKeystream();
+        }
+        self->m_pCurrent = NULL;
+        self->m_DoneCond.notify_all();
+    }
+
+    THREAD_EXIT();
+    return NULL;
+}
@@ -18,12 +18,15 @@ written by
 
 #include <cstring>
 #include <string>
+#include <deque>
+#include <vector>
 
 // UDT
 #include "udt.h"
 #include "packet.h"
 #include "utilities.h"
 #include "logging.h"
+#include "sync.h"
 
 #include <haicrypt.h>
 #include <hcrypt_msg.h>
@@ -42,6 +45,50 @@ namespace srt
 {
 class CUDT;
 struct CSrtConfig;
+class CCryptoControl;
+
+/// A thread that prepares the AES-CTR keystream of the next packets of many
+/// sending sockets (see srt_setcryptothreads()), so that encrypting a packet
+/// on the sending thread is only a XOR with the prepared keystream.
+class CKeystreamWorker
+{
+public:
+    CKeystreamWorker();
+    ~CKeystreamWorker();
+
+    /// Start the thread.
+    /// @param [in] index number of the thread, used for its name
+    void start(int index);
+
+    /// Start preparing the keystream of the crypto control on request.
+    void add(CCryptoControl* c);
+
+    /// Stop preparing the keystream. When this returns, the thread no longer uses it.
+    void remove(CCryptoControl* c);
+
+    /// Fill the keystream ring of the crypto control as soon as possible.
+    void wakeup(CCryptoControl* c);
+
+    /// Get the number of crypto controls handled by this thread.
+    int load() const { return m_iLoad; }
+
+private:
+    static void* worker(void* param);
+
+    sync::CThread      m_Thread;
+    sync::atomic<bool> m_bClosing;
+    sync::atomic<int>  m_iLoad;
+
+    sync::Mutex                 m_Lock;
+    sync::Condition             m_Cond;     // signaled when a crypto control is queued
+    sync::Condition             m_DoneCond; // signaled when the thread has finished filling m_pCurrent
+    std::deque<CCryptoControl*> m_Queue;    // protected by m_Lock
+    CCryptoControl*             m_pCurrent; // the one being filled, protected by m_Lock
+
+private:
+    CKeystreamWorker(const CKeystreamWorker&);
+    CKeystreamWorker& operator=(const CKeystreamWorker&);
+};
 
 
 // For KMREQ/KMRSP. Only one field is used.
@@ -84,6 +131,45 @@ private:
 
     bool m_bErrorReported;
 
+    // The AES-CTR keystream of the packets following the last encrypted one,
+    // prepared by a CKeystreamWorker. The slot of a sequence number is at
+    // (seqno % KEYSTREAM_RING), and the slots from m_iKsLastSeq (exclusive)
+    // to m_iKsNextSeq (exclusive) are ready. The slot of m_iKsLastSeq is
+    // still being used by encrypt().
+    static const int KEYSTREAM_RING  = 128; // must divide the sequence number range
+    static const int KEYSTREAM_BATCH = 16;  // slots prepared at once by the worker
+    struct KeystreamSlot
+    {
+        int32_t iSeqNo;
+        int     iKeyId; // HaiCrypt_KsGen_SetKey() result
+    };
+
+    bool                           m_bKsChecked;  // whether encrypt() has checked for a worker
+    sync::atomic<CKeystreamWorker*> m_pKsWorker;
+    HaiCrypt_KsGen                 m_hKsGen;      // used only by m_pKsWorker
+    size_t                         m_zKsStride;   // length of the keystream in a slot
+    std::vector<unsigned char>     m_KsBuffer;    // KEYSTREAM_RING * m_zKsStride
+    sync::Mutex                    m_KsLock;      // protects the fields below
+    KeystreamSlot                  m_aKsSlots[KEYSTREAM_RING];
+    int32_t                        m_iKsLastSeq;
+    int32_t                        m_iKsNextSeq;
+    unsigned                       m_uKsEpoch;    // changed when the ring is restarted
+    bool                           m_bKsQueued;   // whether it's in the queue of m_pKsWorker
+    bool                           m_bKsAttached; // whether m_pKsWorker accepts wakeups, protected by its m_Lock
+    sync::atomic<int64_t>          m_llKsPackets; // number of packets encrypted with a prepared keystream
+
+    friend class CKeystreamWorker;
+
+    // Start using a keystream worker, if any is configured and the encryption is AES-CTR.
+    void startKeystream(int32_t seqno);
+    void stopKeystream();
+
+    // Get the prepared keystream for the packet and release the previous one.
+    const unsigned char* takeKeystream(int32_t seqno, int& w_key_id);
+
+    // Prepare the free slots of the ring. Called by m_pKsWorker.
+    void fillKeystream();
+
 public:
     static void globalInit();
 
@@ -116,6 +202,13 @@ public:
         return m_iCryptoMode;
     }
 
+    /// Get the number of packets encrypted with the keystream prepared
+    /// by the shared keystream thread (srt_setcryptothreads).
+    int64_t keystreamPackets() const
+    {
+        return m_llKsPackets;
+    }
+
     /// Regenerate cryptographic key material if needed.
     /// @param[in] sock If not null, the socket will be used to send the KM message to the peer (e.g. KM refresh).
     /// @param[in] bidirectional If true, the key material will be regenerated for both directions (receiver and sender).
@@ -217,8 +310,9 @@ public:
     /// - The case of key regeneration (KM refresh), when a new key has to be sent again.
     ///   In this case the first sending happens in regenCryptoKm(..). This function
     ///   retransmits the KM request by timeout if not KM response has been received.
+    /// @return true if the KM request may still have to be retransmitted.
     SRT_ATTR_EXCLUDES(m_mtxLock)
-    void sendKeysToPeer(CUDT* sock, int iSRTT);
+    bool sendKeysToPeer(CUDT* sock, int iSRTT);
 
     void setCryptoSecret(const HaiCrypt_Secret& secret)
     {
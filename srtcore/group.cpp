@@ -513,12 +513,24 @@ void CUDTGroup::deriveSettings(CUDT* u)
     IM(SRTO_LINGER, Linger);
     IM(SRTO_UDP_SNDBUF, iUDPSndBufSize);
     IM(SRTO_UDP_RCVBUF, iUDPRcvBufSize);
+    IM(SRTO_UDP_RCVBATCH, iUDPRcvBatch);
+    IM(SRTO_UDP_SNDBATCH, iUDPSndBatch);
+    IM(SRTO_UDP_GSO, bUDPGso);
+    IM(SRTO_UDP_GRO, bUDPGro);
+    IM(SRTO_UDP_RCVTIMESTAMP, bUDPRcvTimestamp);
+    IM(SRTO_UDP_TXTIME, bUDPTxTime);
+    IM(SRTO_UDP_IOURING, bUDPIoUring);
+    IM(SRTO_UDP_SHARDS, iUDPShards);
+    IM(SRTO_SNDWORKERS, iSndWorkers);
+    IM(SRTO_RCVWORKERS, iRcvWorkers);
     // SRTO_RENDEZVOUS: impossible to have it set on a listener socket.
     // SRTO_SNDTIMEO/RCVTIMEO: groupwise setting
     IM(SRTO_CONNTIMEO, tdConnTimeOut);
     IM(SRTO_DRIFTTRACER, bDriftTracer);
     // Reuseaddr: true by default and should only be true.
     IM(SRTO_MAXBW, llMaxBW);
+    IM(SRTO_SNDBURST, iSndBurst);
+    IM(SRTO_SNDBUFRECLAIM, iSndBufReclaim);
     IM(SRTO_INPUTBW, llInputBW);
     IM(SRTO_MININPUTBW, llMinInputBW);
     IM(SRTO_OHEADBW, iOverheadBW);
@@ -648,6 +660,19 @@ static bool getOptDefault(SRT_SOCKOPT optname, void* pw_optval, int& w_optlen)
     case SRTO_UDP_SNDBUF:
     case SRTO_UDP_RCVBUF:
         RD(CSrtConfig::DEF_UDP_BUFFER_SIZE);
+    case SRTO_UDP_RCVBATCH:
+    case SRTO_UDP_SNDBATCH:
+    case SRTO_UDP_SHARDS:
+    case SRTO_SNDWORKERS:
+    case SRTO_RCVWORKERS:
+    case SRTO_SNDBURST:
+        RD(1);
+    case SRTO_UDP_GSO:
+    case SRTO_UDP_GRO:
+    case SRTO_UDP_RCVTIMESTAMP:
+    case SRTO_UDP_TXTIME:
+    case SRTO_UDP_IOURING:
+        RD(false);
     case SRTO_RENDEZVOUS:
         RD(false);
     case SRTO_SNDTIMEO:
@@ -670,6 +695,8 @@ static bool getOptDefault(SRT_SOCKOPT optname, void* pw_optval, int& w_optlen)
         RD(0);
     case SRTO_RCVDATA:
         RD(0);
+    case SRTO_SNDBUFRECLAIM:
+        RD(0);
 
     case SRTO_IPTTL:
         RD(0);
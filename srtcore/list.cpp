@@ -52,6 +52,8 @@ modified by
 
 #include "platform_sys.h"
 
+#include <cstring>
+
 #include "list.h"
 #include "packet.h"
 #include "logging.h"
@@ -70,432 +72,433 @@ using srt_logging::tslog;
 
 using namespace srt::sync;
 
-srt::CSndLossList::CSndLossList(int size)
-    : m_caSeq()
-    , m_iHead(-1)
-    , m_iLength(0)
-    , m_iSize(size)
-    , m_iLastInsertPos(-1)
-    , m_ListLock()
+static inline int highestBit(uint64_t x)
 {
-    m_caSeq = new Seq[size];
-
-    // -1 means there is no data in the node
-    for (int i = 0; i < size; ++i)
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(x);
+#else
+    int i = 63;
+    while ((x >> 63) == 0)
     {
-        m_caSeq[i].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[i].seqend   = SRT_SEQNO_NONE;
+        x <<= 1;
+        --i;
     }
-
-    // sender list needs mutex protection
-    setupMutex(m_ListLock, "LossList");
+    return i;
+#endif
 }
 
-srt::CSndLossList::~CSndLossList()
+static inline int bitCount(uint64_t x)
 {
-    delete[] m_caSeq;
-    releaseMutex(m_ListLock);
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return int((x * 0x0101010101010101ULL) >> 56);
+#endif
 }
 
-void srt::CSndLossList::traceState() const
+// Mask of the bits [bit1, bit2] of a word.
+static inline uint64_t wordMask(int bit1, int bit2)
 {
-    traceState(std::cout) << "\n";
+    return (~uint64_t(0) << bit1) & (~uint64_t(0) >> (63 - bit2));
 }
 
-int srt::CSndLossList::insert(int32_t seqno1, int32_t seqno2)
+srt::CLossBitmap::CLossBitmap(int size)
+    : m_aBits()
+    , m_aSummary()
+    , m_iCapacity(64)
+    , m_iWords()
+    , m_iFirstSeq(SRT_SEQNO_NONE)
+    , m_iLastSeq(SRT_SEQNO_NONE)
+    , m_iCount(0)
 {
-    if (seqno1 < 0 || seqno2 < 0 ) {
-        LOGC(qslog.Error, log << "IPE: Tried to insert negative seqno " << seqno1 << ":" << seqno2
-            << " into sender's loss list. Ignoring.");
-        return 0;
-    }
-
-    const int inserted_range = CSeqNo::seqlen(seqno1, seqno2);
-    if (inserted_range <= 0 || inserted_range >= m_iSize) {
-        LOGC(qslog.Error, log << "IPE: Tried to insert too big range of seqno: " << inserted_range <<  ". Ignoring. "
-                << "seqno " << seqno1 << ":" << seqno2);
-        return 0;
-    }
+    // The capacity must divide the sequence number space,
+    // so that the ring follows the sequence number overflow.
+    while (m_iCapacity < size)
+        m_iCapacity *= 2;
+
+    m_iWords   = m_iCapacity / 64;
+    m_aBits    = new uint64_t[m_iWords];
+    m_aSummary = new uint64_t[(m_iWords + 63) / 64];
+    memset(m_aBits, 0, m_iWords * sizeof(uint64_t));
+    memset(m_aSummary, 0, ((m_iWords + 63) / 64) * sizeof(uint64_t));
+}
 
-    ScopedLock listguard(m_ListLock);
+srt::CLossBitmap::~CLossBitmap()
+{
+    delete[] m_aBits;
+    delete[] m_aSummary;
+}
 
-    if (m_iLength == 0)
-    {
-        insertHead(0, seqno1, seqno2);
-        return m_iLength;
+int srt::CLossBitmap::setBits(int pos1, int pos2)
+{
+    const int w1 = pos1 / 64, w2 = pos2 / 64;
+    int       n  = 0;
+    for (int w = w1; w <= w2; ++w)
+    {
+        const int      bit1 = w == w1 ? pos1 % 64 : 0, bit2 = w == w2 ? pos2 % 64 : 63;
+        const uint64_t mask = wordMask(bit1, bit2);
+        const uint64_t old  = m_aBits[w];
+        // Count the bits only if some were already set.
+        n += (old & mask) ? bitCount(mask & ~old) : bit2 - bit1 + 1;
+        m_aBits[w] = old | mask;
+        if (!old)
+            m_aSummary[w / 64] |= uint64_t(1) << (w % 64);
     }
+    return n;
+}
 
-    // Find the insert position in the non-empty list
-    const int origlen = m_iLength;
-    const int offset  = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno1);
-
-    if (offset >= m_iSize)
-    {
-        LOGC(qslog.Error, log << "IPE: New loss record is too far from the first record. Ignoring. "
-                << "First loss seqno " << m_caSeq[m_iHead].seqstart
-                << ", insert seqno " << seqno1 << ":" << seqno2);
-        return 0;
+int srt::CLossBitmap::clearBits(int pos1, int pos2)
+{
+    const int w1 = pos1 / 64, w2 = pos2 / 64;
+    int       n  = 0;
+    for (int w = w1; w <= w2; ++w)
+    {
+        const uint64_t old = m_aBits[w];
+        if (!old)
+            continue;
+        const int      bit1 = w == w1 ? pos1 % 64 : 0, bit2 = w == w2 ? pos2 % 64 : 63;
+        const uint64_t mask = wordMask(bit1, bit2);
+        // Count the bits only if some were not set.
+        n += (~old & mask) ? bitCount(mask & old) : bit2 - bit1 + 1;
+        m_aBits[w] = old & ~mask;
+        if (!m_aBits[w])
+            m_aSummary[w / 64] &= ~(uint64_t(1) << (w % 64));
     }
+    return n;
+}
 
-    int loc = (m_iHead + offset + m_iSize) % m_iSize;
-
-    if (loc < 0)
+int srt::CLossBitmap::findSet(int pos1, int pos2) const
+{
+    const int w1 = pos1 / 64, w2 = pos2 / 64;
+    int       w  = w1;
+    while (w <= w2)
     {
-        const int offset_seqno2 = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno2);
-        const int loc_seqno2    = (m_iHead + offset_seqno2 + m_iSize) % m_iSize;
+        const uint64_t bits = m_aBits[w] & wordMask(w == w1 ? pos1 % 64 : 0, w == w2 ? pos2 % 64 : 63);
+        if (bits)
+            return w * 64 + lowestBit(bits);
 
-        if (loc_seqno2 < 0)
+        // Skip the empty words using the summary.
+        ++w;
+        while (w <= w2)
         {
-            // The size of the CSndLossList should be at least the size of the flow window.
-            // It means that all the packets sender has sent should fit within m_iSize.
-            // If the new loss does not fit, there is some error.
-            LOGC(qslog.Error, log << "IPE: New loss record is too old. Ignoring. "
-                << "First loss seqno " << m_caSeq[m_iHead].seqstart
-                << ", insert seqno " << seqno1 << ":" << seqno2);
-            return 0;
+            const uint64_t sum = m_aSummary[w / 64] & (~uint64_t(0) << (w % 64));
+            if (sum)
+            {
+                w = (w / 64) * 64 + lowestBit(sum);
+                break;
+            }
+            w = (w / 64 + 1) * 64;
         }
-
-        loc = loc_seqno2;
     }
+    return -1;
+}
 
-    if (offset < 0)
-    {
-        insertHead(loc, seqno1, seqno2);
-    }
-    else if (offset > 0)
+int srt::CLossBitmap::findLastSet(int pos1, int pos2) const
+{
+    const int w1 = pos1 / 64, w2 = pos2 / 64;
+    int       w  = w2;
+    while (w >= w1)
     {
-        if (seqno1 == m_caSeq[loc].seqstart)
-        {
-            const bool updated = updateElement(loc, seqno1, seqno2);
-            if (!updated)
-                return 0;
-        }
-        else
-        {
-            // Find the prior node.
-            // It should be the highest sequence number less than seqno1.
-            // 1. Start the search either from m_iHead, or from m_iLastInsertPos
-            int i = m_iHead;
-            if ((m_iLastInsertPos != -1) && (CSeqNo::seqcmp(m_caSeq[m_iLastInsertPos].seqstart, seqno1) < 0))
-                i = m_iLastInsertPos;
-
-            // 2. Find the highest sequence number less than seqno1.
-            while (m_caSeq[i].inext != -1 && CSeqNo::seqcmp(m_caSeq[m_caSeq[i].inext].seqstart, seqno1) < 0)
-                i = m_caSeq[i].inext;
+        const uint64_t bits = m_aBits[w] & wordMask(w == w1 ? pos1 % 64 : 0, w == w2 ? pos2 % 64 : 63);
+        if (bits)
+            return w * 64 + highestBit(bits);
 
-            // 3. Check if seqno1 overlaps with (seqbegin, seqend)
-            const int seqend = m_caSeq[i].seqend == SRT_SEQNO_NONE ? m_caSeq[i].seqstart : m_caSeq[i].seqend;
-
-            if (CSeqNo::seqcmp(seqend, seqno1) < 0 && CSeqNo::incseq(seqend) != seqno1)
+        --w;
+        while (w >= w1)
+        {
+            const uint64_t sum = m_aSummary[w / 64] & (~uint64_t(0) >> (63 - w % 64));
+            if (sum)
             {
-                // No overlap
-                // TODO: Here we should actually insert right after i, not at loc.
-                insertAfter(loc, i, seqno1, seqno2);
+                w = (w / 64) * 64 + highestBit(sum);
+                break;
             }
-            else
-            {
-                // TODO: Replace with updateElement(i, seqno1, seqno2).
-                // Some changes to updateElement(..) are required.
-                m_iLastInsertPos = i;
-                if (CSeqNo::seqcmp(seqend, seqno2) >= 0)
-                    return 0;
+            w = (w / 64) * 64 - 1;
+        }
+    }
+    return -1;
+}
 
-                // overlap, coalesce with prior node, insert(3, 7) to [2, 5], ... becomes [2, 7]
-                m_iLength += CSeqNo::seqlen(seqend, seqno2) - 1;
-                m_caSeq[i].seqend = seqno2;
+// The following functions search the range of sequence numbers
+// [seqno1, seqno2], which may wrap around the end of the ring.
 
-                loc = i;
-            }
-        }
+int32_t srt::CLossBitmap::findSetSeq(int32_t seqno1, int32_t seqno2) const
+{
+    const int pos1 = pos(seqno1), pos2 = pos(seqno2);
+    int       found = -1;
+    if (pos1 <= pos2)
+    {
+        found = findSet(pos1, pos2);
     }
-    else // offset == 0, loc == m_iHead
+    else
     {
-        const bool updated = updateElement(m_iHead, seqno1, seqno2);
-        if (!updated)
-            return 0;
+        found = findSet(pos1, m_iCapacity - 1);
+        if (found == -1)
+            found = findSet(0, pos2);
     }
-
-    coalesce(loc);
-    return m_iLength - origlen;
+    if (found == -1)
+        return SRT_SEQNO_NONE;
+    return CSeqNo::incseq(seqno1, (found - pos1) & (m_iCapacity - 1));
 }
 
-void srt::CSndLossList::removeUpTo(int32_t seqno)
+int32_t srt::CLossBitmap::findLastSetSeq(int32_t seqno1, int32_t seqno2) const
 {
-    ScopedLock listguard(m_ListLock);
-
-    if (0 == m_iLength)
-        return;
-
-    // Remove all from the head pointer to a node with a larger seq. no. or the list is empty
-    int offset = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno);
-    int loc    = (m_iHead + offset + m_iSize) % m_iSize;
-
-    if (0 == offset)
+    const int pos1 = pos(seqno1), pos2 = pos(seqno2);
+    int       found = -1;
+    if (pos1 <= pos2)
     {
-        // It is the head. Remove the head and point to the next node
-        loc = (loc + 1) % m_iSize;
-
-        if (SRT_SEQNO_NONE == m_caSeq[m_iHead].seqend)
-            loc = m_caSeq[m_iHead].inext;
-        else
-        {
-            m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-            if (CSeqNo::seqcmp(m_caSeq[m_iHead].seqend, CSeqNo::incseq(seqno)) > 0)
-                m_caSeq[loc].seqend = m_caSeq[m_iHead].seqend;
-
-            m_caSeq[m_iHead].seqend = SRT_SEQNO_NONE;
-
-            m_caSeq[loc].inext = m_caSeq[m_iHead].inext;
-        }
-
-        m_caSeq[m_iHead].seqstart = SRT_SEQNO_NONE;
-
-        if (m_iLastInsertPos == m_iHead)
-            m_iLastInsertPos = -1;
-
-        m_iHead = loc;
-
-        m_iLength--;
+        found = findLastSet(pos1, pos2);
     }
-    else if (offset > 0)
+    else
     {
-        int h = m_iHead;
-
-        if (seqno == m_caSeq[loc].seqstart)
-        {
-            // target node is not empty, remove part/all of the seqno in the node.
-            int temp = loc;
-            loc      = (loc + 1) % m_iSize;
-
-            if (SRT_SEQNO_NONE == m_caSeq[temp].seqend)
-                m_iHead = m_caSeq[temp].inext;
-            else
-            {
-                // remove part, e.g., [3, 7] becomes [], [4, 7] after remove(3)
-                m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-                if (CSeqNo::seqcmp(m_caSeq[temp].seqend, m_caSeq[loc].seqstart) > 0)
-                    m_caSeq[loc].seqend = m_caSeq[temp].seqend;
-                m_iHead              = loc;
-                m_caSeq[loc].inext   = m_caSeq[temp].inext;
-                m_caSeq[temp].inext  = loc;
-                m_caSeq[temp].seqend = SRT_SEQNO_NONE;
-            }
-        }
-        else
-        {
-            // target node is empty, check prior node
-            int i = m_iHead;
-            while ((-1 != m_caSeq[i].inext) && (CSeqNo::seqcmp(m_caSeq[m_caSeq[i].inext].seqstart, seqno) < 0))
-                i = m_caSeq[i].inext;
+        found = findLastSet(0, pos2);
+        if (found == -1)
+            found = findLastSet(pos1, m_iCapacity - 1);
+    }
+    if (found == -1)
+        return SRT_SEQNO_NONE;
+    return CSeqNo::incseq(seqno1, (found - pos1) & (m_iCapacity - 1));
+}
 
-            loc = (loc + 1) % m_iSize;
+int srt::CLossBitmap::set(int32_t seqno1, int32_t seqno2)
+{
+    int32_t first = seqno1, last = seqno2;
+    if (m_iCount > 0)
+    {
+        if (CSeqNo::seqcmp(m_iFirstSeq, first) < 0)
+            first = m_iFirstSeq;
+        if (CSeqNo::seqcmp(m_iLastSeq, last) > 0)
+            last = m_iLastSeq;
+    }
 
-            if (SRT_SEQNO_NONE == m_caSeq[i].seqend)
-                m_iHead = m_caSeq[i].inext;
-            else if (CSeqNo::seqcmp(m_caSeq[i].seqend, seqno) > 0)
-            {
-                // remove part/all seqno in the prior node
-                m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-                if (CSeqNo::seqcmp(m_caSeq[i].seqend, m_caSeq[loc].seqstart) > 0)
-                    m_caSeq[loc].seqend = m_caSeq[i].seqend;
+    if (CSeqNo::seqlen(first, last) > m_iCapacity)
+        return -1;
 
-                m_caSeq[i].seqend = seqno;
+    const int pos1 = pos(seqno1), pos2 = pos(seqno2);
+    int       n    = 0;
+    if (pos1 <= pos2)
+    {
+        n = setBits(pos1, pos2);
+    }
+    else
+    {
+        n = setBits(pos1, m_iCapacity - 1);
+        n += setBits(0, pos2);
+    }
 
-                m_caSeq[loc].inext = m_caSeq[i].inext;
-                m_caSeq[i].inext   = loc;
+    m_iFirstSeq = first;
+    m_iLastSeq  = last;
+    m_iCount += n;
+    return n;
+}
 
-                m_iHead = loc;
-            }
-            else
-                m_iHead = m_caSeq[i].inext;
-        }
+int srt::CLossBitmap::clear(int32_t seqno1, int32_t seqno2)
+{
+    if (m_iCount == 0)
+        return 0;
 
-        // Remove all nodes prior to the new head
-        while (h != m_iHead)
-        {
-            if (m_caSeq[h].seqend != SRT_SEQNO_NONE)
-            {
-                m_iLength -= CSeqNo::seqlen(m_caSeq[h].seqstart, m_caSeq[h].seqend);
-                m_caSeq[h].seqend = SRT_SEQNO_NONE;
-            }
-            else
-                m_iLength--;
+    // Only the range [m_iFirstSeq, m_iLastSeq] has any bits set.
+    if (CSeqNo::seqcmp(seqno1, m_iFirstSeq) < 0)
+        seqno1 = m_iFirstSeq;
+    if (CSeqNo::seqcmp(seqno2, m_iLastSeq) > 0)
+        seqno2 = m_iLastSeq;
+    if (CSeqNo::seqcmp(seqno1, seqno2) > 0)
+        return 0;
 
-            m_caSeq[h].seqstart = SRT_SEQNO_NONE;
+    if (seqno1 == seqno2)
+        return clearOne(seqno1);
 
-            if (m_iLastInsertPos == h)
-                m_iLastInsertPos = -1;
+    const int pos1 = pos(seqno1), pos2 = pos(seqno2);
+    int       n    = 0;
+    if (pos1 <= pos2)
+    {
+        n = clearBits(pos1, pos2);
+    }
+    else
+    {
+        n = clearBits(pos1, m_iCapacity - 1);
+        n += clearBits(0, pos2);
+    }
 
-            h = m_caSeq[h].inext;
-        }
+    m_iCount -= n;
+    if (m_iCount == 0)
+    {
+        m_iFirstSeq = SRT_SEQNO_NONE;
+        m_iLastSeq  = SRT_SEQNO_NONE;
+    }
+    else if (n > 0)
+    {
+        // Something is left on either side, or both,
+        // of the cleared range.
+        if (seqno1 == m_iFirstSeq)
+            m_iFirstSeq = findSetSeq(CSeqNo::incseq(seqno2), m_iLastSeq);
+        if (seqno2 == m_iLastSeq)
+            m_iLastSeq = findLastSetSeq(m_iFirstSeq, CSeqNo::decseq(seqno1));
     }
+    return n;
 }
 
-int srt::CSndLossList::getLossLength() const
+int srt::CLossBitmap::clearOne(int32_t seqno)
 {
-    ScopedLock listguard(m_ListLock);
+    // The most frequent case: a single packet recovered, or popped from
+    // the front of the list. The next set bit is usually in the same word.
+    const int      p    = pos(seqno);
+    uint64_t&      word = m_aBits[p / 64];
+    const uint64_t bit  = uint64_t(1) << (p % 64);
+    if (!(word & bit))
+        return 0;
 
-    return m_iLength;
-}
+    word &= ~bit;
+    if (!word)
+        m_aSummary[p / 64 / 64] &= ~(uint64_t(1) << (p / 64 % 64));
 
-int32_t srt::CSndLossList::popLostSeq()
-{
-    ScopedLock listguard(m_ListLock);
-
-    if (0 == m_iLength)
+    if (--m_iCount == 0)
     {
-        SRT_ASSERT(m_iHead == -1);
-        return SRT_SEQNO_NONE;
+        m_iFirstSeq = SRT_SEQNO_NONE;
+        m_iLastSeq  = SRT_SEQNO_NONE;
     }
-
-    if (m_iLastInsertPos == m_iHead)
-        m_iLastInsertPos = -1;
-
-    // return the first loss seq. no.
-    const int32_t seqno = m_caSeq[m_iHead].seqstart;
-
-    // head moves to the next node
-    if (SRT_SEQNO_NONE == m_caSeq[m_iHead].seqend)
+    else if (seqno == m_iFirstSeq)
     {
-        //[3, SRT_SEQNO_NONE] becomes [], and head moves to next node in the list
-        m_caSeq[m_iHead].seqstart = SRT_SEQNO_NONE;
-        m_iHead                   = m_caSeq[m_iHead].inext;
+        const uint64_t above = word & (~uint64_t(0) << (p % 64));
+        m_iFirstSeq = above ? CSeqNo::incseq(seqno, lowestBit(above) - p % 64)
+                            : findSetSeq(CSeqNo::incseq(seqno), m_iLastSeq);
     }
-    else
+    else if (seqno == m_iLastSeq)
     {
-        // shift to next node, e.g., [3, 7] becomes [], [4, 7]
-        int loc = (m_iHead + 1) % m_iSize;
+        m_iLastSeq = findLastSetSeq(m_iFirstSeq, CSeqNo::decseq(seqno));
+    }
+    return 1;
+}
 
-        m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-        if (CSeqNo::seqcmp(m_caSeq[m_iHead].seqend, m_caSeq[loc].seqstart) > 0)
-            m_caSeq[loc].seqend = m_caSeq[m_iHead].seqend;
+bool srt::CLossBitmap::any(int32_t seqno1, int32_t seqno2) const
+{
+    if (m_iCount == 0)
+        return false;
 
-        m_caSeq[m_iHead].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[m_iHead].seqend   = SRT_SEQNO_NONE;
+    if (CSeqNo::seqcmp(seqno1, m_iFirstSeq) < 0)
+        seqno1 = m_iFirstSeq;
+    if (CSeqNo::seqcmp(seqno2, m_iLastSeq) > 0)
+        seqno2 = m_iLastSeq;
+    if (CSeqNo::seqcmp(seqno1, seqno2) > 0)
+        return false;
 
-        m_caSeq[loc].inext = m_caSeq[m_iHead].inext;
-        m_iHead            = loc;
-    }
+    return findSetSeq(seqno1, seqno2) != SRT_SEQNO_NONE;
+}
 
-    m_iLength--;
+////////////////////////////////////////////////////////////////////////////////
 
-    return seqno;
+srt::CSndLossList::CSndLossList(int size)
+    : m_Bitmap(size * 2) // records may precede the first loss by up to size
+    , m_iSize(size)
+    , m_ListLock()
+{
+    // sender list needs mutex protection
+    setupMutex(m_ListLock, "LossList");
 }
 
-void srt::CSndLossList::insertHead(int pos, int32_t seqno1, int32_t seqno2)
+srt::CSndLossList::~CSndLossList()
 {
-    SRT_ASSERT(pos >= 0);
-    m_caSeq[pos].seqstart = seqno1;
-    SRT_ASSERT(m_caSeq[pos].seqend == SRT_SEQNO_NONE);
-    if (seqno2 != seqno1)
-        m_caSeq[pos].seqend = seqno2;
-
-    // new node becomes head
-    m_caSeq[pos].inext = m_iHead;
-    m_iHead            = pos;
-    m_iLastInsertPos   = pos;
+    releaseMutex(m_ListLock);
+}
 
-    m_iLength += CSeqNo::seqlen(seqno1, seqno2);
+void srt::CSndLossList::traceState() const
+{
+    traceState(std::cout) << "\n";
 }
 
-void srt::CSndLossList::insertAfter(int pos, int pos_after, int32_t seqno1, int32_t seqno2)
+int srt::CSndLossList::insert(int32_t seqno1, int32_t seqno2)
 {
-    m_caSeq[pos].seqstart = seqno1;
-    SRT_ASSERT(m_caSeq[pos].seqend == SRT_SEQNO_NONE);
-    if (seqno2 != seqno1)
-        m_caSeq[pos].seqend = seqno2;
+    if (seqno1 < 0 || seqno2 < 0 ) {
+        LOGC(qslog.Error, log << "IPE: Tried to insert negative seqno " << seqno1 << ":" << seqno2
+            << " into sender's loss list. Ignoring.");
+        return 0;
+    }
 
-    m_caSeq[pos].inext       = m_caSeq[pos_after].inext;
-    m_caSeq[pos_after].inext = pos;
-    m_iLastInsertPos         = pos;
+    const int inserted_range = CSeqNo::seqlen(seqno1, seqno2);
+    if (inserted_range <= 0 || inserted_range >= m_iSize) {
+        LOGC(qslog.Error, log << "IPE: Tried to insert too big range of seqno: " << inserted_range <<  ". Ignoring. "
+                << "seqno " << seqno1 << ":" << seqno2);
+        return 0;
+    }
 
-    m_iLength += CSeqNo::seqlen(seqno1, seqno2);
-}
+    ScopedLock listguard(m_ListLock);
 
-void srt::CSndLossList::coalesce(int loc)
-{
-    // coalesce with next node. E.g., [3, 7], ..., [6, 9] becomes [3, 9]
-    while ((m_caSeq[loc].inext != -1) && (m_caSeq[loc].seqend != SRT_SEQNO_NONE))
+    if (m_Bitmap.count() > 0)
     {
-        const int i = m_caSeq[loc].inext;
-        if (CSeqNo::seqcmp(m_caSeq[i].seqstart, CSeqNo::incseq(m_caSeq[loc].seqend)) > 0)
-            break;
+        const int32_t first  = m_Bitmap.first();
+        const int     offset = CSeqNo::seqoff(first, seqno1);
 
-        // coalesce if there is overlap
-        if (m_caSeq[i].seqend != SRT_SEQNO_NONE)
+        if (offset >= m_iSize)
         {
-            if (CSeqNo::seqcmp(m_caSeq[i].seqend, m_caSeq[loc].seqend) > 0)
-            {
-                if (CSeqNo::seqcmp(m_caSeq[loc].seqend, m_caSeq[i].seqstart) >= 0)
-                    m_iLength -= CSeqNo::seqlen(m_caSeq[i].seqstart, m_caSeq[loc].seqend);
-
-                m_caSeq[loc].seqend = m_caSeq[i].seqend;
-            }
-            else
-                m_iLength -= CSeqNo::seqlen(m_caSeq[i].seqstart, m_caSeq[i].seqend);
+            LOGC(qslog.Error, log << "IPE: New loss record is too far from the first record. Ignoring. "
+                    << "First loss seqno " << first
+                    << ", insert seqno " << seqno1 << ":" << seqno2);
+            return 0;
         }
-        else
+
+        // The size of the CSndLossList should be at least the size of the flow window.
+        // It means that all the packets sender has sent should fit within m_iSize.
+        // If the new loss does not fit, there is some error.
+        if (offset < 0 && CSeqNo::seqoff(first, seqno2) < -m_iSize)
         {
-            if (m_caSeq[i].seqstart == CSeqNo::incseq(m_caSeq[loc].seqend))
-                m_caSeq[loc].seqend = m_caSeq[i].seqstart;
-            else
-                m_iLength--;
+            LOGC(qslog.Error, log << "IPE: New loss record is too old. Ignoring. "
+                << "First loss seqno " << first
+                << ", insert seqno " << seqno1 << ":" << seqno2);
+            return 0;
         }
+    }
 
-        m_caSeq[i].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[i].seqend   = SRT_SEQNO_NONE;
-        m_caSeq[loc].inext  = m_caSeq[i].inext;
+    const int n = m_Bitmap.set(seqno1, seqno2);
+    if (n < 0)
+    {
+        LOGC(qslog.Error, log << "IPE: New loss record exceeds the span of the list. Ignoring. "
+            << "First loss seqno " << m_Bitmap.first() << ", last " << m_Bitmap.last()
+            << ", insert seqno " << seqno1 << ":" << seqno2);
+        return 0;
     }
+
+    return n;
 }
 
-bool srt::CSndLossList::updateElement(int pos, int32_t seqno1, int32_t seqno2)
+void srt::CSndLossList::removeUpTo(int32_t seqno)
 {
-    m_iLastInsertPos = pos;
+    ScopedLock listguard(m_ListLock);
 
-    if (seqno2 == SRT_SEQNO_NONE || seqno2 == seqno1)
-        return false;
+    if (m_Bitmap.count() == 0 || CSeqNo::seqcmp(seqno, m_Bitmap.first()) < 0)
+        return;
 
-    if (m_caSeq[pos].seqend == SRT_SEQNO_NONE)
-    {
-        m_iLength += CSeqNo::seqlen(seqno1, seqno2) - 1;
-        m_caSeq[pos].seqend = seqno2;
-        return true;
-    }
+    m_Bitmap.clear(m_Bitmap.first(), seqno);
+}
 
-    // seqno2 <= m_caSeq[pos].seqend
-    if (CSeqNo::seqcmp(seqno2, m_caSeq[pos].seqend) <= 0)
-        return false;
+int srt::CSndLossList::getLossLength() const
+{
+    ScopedLock listguard(m_ListLock);
 
-    // seqno2 > m_caSeq[pos].seqend
-    m_iLength += CSeqNo::seqlen(m_caSeq[pos].seqend, seqno2) - 1;
-    m_caSeq[pos].seqend = seqno2;
-    return true;
+    return m_Bitmap.count();
+}
+
+int32_t srt::CSndLossList::popLostSeq()
+{
+    ScopedLock listguard(m_ListLock);
+
+    const int32_t seqno = m_Bitmap.first();
+    if (seqno != SRT_SEQNO_NONE)
+        m_Bitmap.clear(seqno, seqno);
+
+    return seqno;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 srt::CRcvLossList::CRcvLossList(int size)
-    : m_caSeq()
-    , m_iHead(-1)
-    , m_iTail(-1)
-    , m_iLength(0)
-    , m_iSize(size)
+    : m_Bitmap(size)
     , m_iLargestSeq(SRT_SEQNO_NONE)
 {
-    m_caSeq = new Seq[m_iSize];
-
-    // -1 means there is no data in the node
-    for (int i = 0; i < size; ++i)
-    {
-        m_caSeq[i].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[i].seqend   = SRT_SEQNO_NONE;
-    }
 }
 
-srt::CRcvLossList::~CRcvLossList()
-{
-    delete[] m_caSeq;
-}
+srt::CRcvLossList::~CRcvLossList() {}
 
 int srt::CRcvLossList::insert(int32_t seqno1, int32_t seqno2)
 {
@@ -517,63 +520,31 @@ int srt::CRcvLossList::insert(int32_t seqno1, int32_t seqno2)
         {
             LOGC(qrlog.Warn,
                  log << "RCV-LOSS/insert: (" << seqno1 << "," << seqno2
-                     << ") to be inserted is too small: m_iLargestSeq=" << m_iLargestSeq << ", m_iLength=" << m_iLength
-                     << ", m_iHead=" << m_iHead << ", m_iTail=" << m_iTail << " -- REJECTING");
+                     << ") to be inserted is too small: m_iLargestSeq=" << m_iLargestSeq
+                     << ", length=" << m_Bitmap.count() << ", first=" << m_Bitmap.first()
+                     << ", last=" << m_Bitmap.last() << " -- REJECTING");
             return 0;
         }
     }
     m_iLargestSeq = seqno2;
 
-    if (0 == m_iLength)
-    {
-        // insert data into an empty list
-        m_iHead                   = 0;
-        m_iTail                   = 0;
-        m_caSeq[m_iHead].seqstart = seqno1;
-        if (seqno2 != seqno1)
-            m_caSeq[m_iHead].seqend = seqno2;
-
-        m_caSeq[m_iHead].inext  = -1;
-        m_caSeq[m_iHead].iprior = -1;
-        const int n = CSeqNo::seqlen(seqno1, seqno2);
-        m_iLength += n;
-        return n;
-    }
-
-    // otherwise searching for the position where the node should be
-    const int offset = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno1);
-    if (offset < 0)
+    if (m_Bitmap.count() > 0 && CSeqNo::seqcmp(seqno1, m_Bitmap.first()) < 0)
     {
         LOGC(qrlog.Error,
              log << "RCV-LOSS/insert: IPE: new LOSS %(" << seqno1 << "-" << seqno2 << ") PREDATES HEAD %"
-                 << m_caSeq[m_iHead].seqstart << " -- REJECTING");
+                 << m_Bitmap.first() << " -- REJECTING");
         return -1;
     }
 
-    int loc = (m_iHead + offset) % m_iSize;
-
-    if ((SRT_SEQNO_NONE != m_caSeq[m_iTail].seqend) && (CSeqNo::incseq(m_caSeq[m_iTail].seqend) == seqno1))
-    {
-        // coalesce with prior node, e.g., [2, 5], [6, 7] becomes [2, 7]
-        loc                 = m_iTail;
-        m_caSeq[loc].seqend = seqno2;
-    }
-    else
+    const int n = m_Bitmap.set(seqno1, seqno2);
+    if (n < 0)
     {
-        // create new node
-        m_caSeq[loc].seqstart = seqno1;
-
-        if (seqno2 != seqno1)
-            m_caSeq[loc].seqend = seqno2;
-
-        m_caSeq[m_iTail].inext = loc;
-        m_caSeq[loc].iprior    = m_iTail;
-        m_caSeq[loc].inext     = -1;
-        m_iTail                = loc;
+        LOGC(qrlog.Error,
+             log << "RCV-LOSS/insert: IPE: new LOSS %(" << seqno1 << "-" << seqno2 << ") too far from HEAD %"
+                 << m_Bitmap.first() << " -- REJECTING");
+        return -1;
     }
 
-    const int n = CSeqNo::seqlen(seqno1, seqno2);
-    m_iLength += n;
     return n;
 }
 
@@ -582,135 +553,10 @@ bool srt::CRcvLossList::remove(int32_t seqno)
     if (m_iLargestSeq == SRT_SEQNO_NONE || CSeqNo::seqcmp(seqno, m_iLargestSeq) > 0)
         m_iLargestSeq = seqno;
 
-    if (0 == m_iLength)
-        return false;
-
-    // locate the position of "seqno" in the list
-    int offset = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno);
-    if (offset < 0)
-        return false;
-
-    int loc = (m_iHead + offset) % m_iSize;
-
-    if (seqno == m_caSeq[loc].seqstart)
-    {
-        // This is a seq. no. that starts the loss sequence
-
-        if (SRT_SEQNO_NONE == m_caSeq[loc].seqend)
-        {
-            // there is only 1 loss in the sequence, delete it from the node
-            if (m_iHead == loc)
-            {
-                m_iHead = m_caSeq[m_iHead].inext;
-                if (-1 != m_iHead)
-                    m_caSeq[m_iHead].iprior = -1;
-                else
-                    m_iTail = -1;
-            }
-            else
-            {
-                m_caSeq[m_caSeq[loc].iprior].inext = m_caSeq[loc].inext;
-                if (-1 != m_caSeq[loc].inext)
-                    m_caSeq[m_caSeq[loc].inext].iprior = m_caSeq[loc].iprior;
-                else
-                    m_iTail = m_caSeq[loc].iprior;
-            }
-
-            m_caSeq[loc].seqstart = SRT_SEQNO_NONE;
-        }
-        else
-        {
-            // there are more than 1 loss in the sequence
-            // move the node to the next and update the starter as the next loss inSeqNo(seqno)
-
-            // find next node
-            int i = (loc + 1) % m_iSize;
-
-            // remove the "seqno" and change the starter as next seq. no.
-            m_caSeq[i].seqstart = CSeqNo::incseq(m_caSeq[loc].seqstart);
-
-            // process the sequence end
-            if (CSeqNo::seqcmp(m_caSeq[loc].seqend, CSeqNo::incseq(m_caSeq[loc].seqstart)) > 0)
-                m_caSeq[i].seqend = m_caSeq[loc].seqend;
-
-            // remove the current node
-            m_caSeq[loc].seqstart = SRT_SEQNO_NONE;
-            m_caSeq[loc].seqend   = SRT_SEQNO_NONE;
-
-            // update list pointer
-            m_caSeq[i].inext  = m_caSeq[loc].inext;
-            m_caSeq[i].iprior = m_caSeq[loc].iprior;
-
-            if (m_iHead == loc)
-                m_iHead = i;
-            else
-                m_caSeq[m_caSeq[i].iprior].inext = i;
-
-            if (m_iTail == loc)
-                m_iTail = i;
-            else
-                m_caSeq[m_caSeq[i].inext].iprior = i;
-        }
-
-        m_iLength--;
-        if (m_iLength == 0)
-            m_iLargestSeq = SRT_SEQNO_NONE;
-
-        return true;
-    }
-
-    // There is no loss sequence in the current position
-    // the "seqno" may be contained in a previous node
-
-    // searching previous node
-    int i = (loc - 1 + m_iSize) % m_iSize;
-    while (SRT_SEQNO_NONE == m_caSeq[i].seqstart)
-        i = (i - 1 + m_iSize) % m_iSize;
-
-    // not contained in this node, return
-    if ((SRT_SEQNO_NONE == m_caSeq[i].seqend) || (CSeqNo::seqcmp(seqno, m_caSeq[i].seqend) > 0))
+    if (m_Bitmap.clear(seqno, seqno) == 0)
         return false;
 
-    if (seqno == m_caSeq[i].seqend)
-    {
-        // it is the sequence end
-
-        if (seqno == CSeqNo::incseq(m_caSeq[i].seqstart))
-            m_caSeq[i].seqend = SRT_SEQNO_NONE;
-        else
-            m_caSeq[i].seqend = CSeqNo::decseq(seqno);
-    }
-    else
-    {
-        // split the sequence
-
-        // construct the second sequence from CSeqNo::incseq(seqno) to the original sequence end
-        // located at "loc + 1"
-        loc = (loc + 1) % m_iSize;
-
-        m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-        if (CSeqNo::seqcmp(m_caSeq[i].seqend, m_caSeq[loc].seqstart) > 0)
-            m_caSeq[loc].seqend = m_caSeq[i].seqend;
-
-        // the first (original) sequence is between the original sequence start to CSeqNo::decseq(seqno)
-        if (seqno == CSeqNo::incseq(m_caSeq[i].seqstart))
-            m_caSeq[i].seqend = SRT_SEQNO_NONE;
-        else
-            m_caSeq[i].seqend = CSeqNo::decseq(seqno);
-
-        // update the list pointer
-        m_caSeq[loc].inext  = m_caSeq[i].inext;
-        m_caSeq[i].inext    = loc;
-        m_caSeq[loc].iprior = i;
-
-        if (m_iTail == i)
-            m_iTail = loc;
-        else
-            m_caSeq[m_caSeq[loc].inext].iprior = loc;
-    }
-
-    m_iLength--;
-    if (m_iLength == 0)
+    if (m_Bitmap.count() == 0)
         m_iLargestSeq = SRT_SEQNO_NONE;
 
     return true;
@@ -722,9 +568,18 @@ bool srt::CRcvLossList::remove(int32_t seqno1, int32_t seqno2)
     {
         return false;
     }
-    for (int32_t i = seqno1; CSeqNo::seqcmp(i, seqno2) <= 0; i = CSeqNo::incseq(i))
+
+    // This has the same effect as removing the sequences one by one:
+    // the largest sequence is forgotten when the list gets emptied, and
+    // any sequence removed afterwards becomes the largest one.
+    const int32_t last = m_Bitmap.last();
+    if (m_Bitmap.clear(seqno1, seqno2) > 0 && m_Bitmap.count() == 0)
+    {
+        m_iLargestSeq = (last == seqno2) ? SRT_SEQNO_NONE : seqno2;
+    }
+    else if (m_iLargestSeq == SRT_SEQNO_NONE || CSeqNo::seqcmp(seqno2, m_iLargestSeq) > 0)
     {
-        remove(i);
+        m_iLargestSeq = seqno2;
     }
     return true;
 }
@@ -748,201 +603,182 @@ int32_t srt::CRcvLossList::removeUpTo(int32_t seqno_last)
 
     // NOTE: seqno_last is past-the-end here. Removed are only seqs
     // that are earlier than this.
-    for (int32_t i = first; CSeqNo::seqcmp(i, seqno_last) <= 0; i = CSeqNo::incseq(i))
-    {
-        //HLOGC(tslog.Debug, log << "... removing %" << i);
-        remove(i);
-    }
+    remove(first, seqno_last);
 
     return first;
 }
 
 bool srt::CRcvLossList::find(int32_t seqno1, int32_t seqno2) const
 {
-    if (0 == m_iLength)
-        return false;
-
-    int p = m_iHead;
-
-    while (-1 != p)
-    {
-        if ((CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno1) == 0) ||
-            ((CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno1) > 0) && (CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno2) <= 0)) ||
-            ((CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno1) < 0) && (m_caSeq[p].seqend != SRT_SEQNO_NONE) &&
-             CSeqNo::seqcmp(m_caSeq[p].seqend, seqno1) >= 0))
-            return true;
-
-        p = m_caSeq[p].inext;
-    }
-
-    return false;
+    return m_Bitmap.any(seqno1, seqno2);
 }
 
 int srt::CRcvLossList::getLossLength() const
 {
-    return m_iLength;
+    return m_Bitmap.count();
 }
 
 int32_t srt::CRcvLossList::getFirstLostSeq() const
 {
-    if (0 == m_iLength)
-        return SRT_SEQNO_NONE;
-
-    return m_caSeq[m_iHead].seqstart;
+    return m_Bitmap.first();
 }
 
-void srt::CRcvLossList::getLossArray(int32_t* array, int& len, int limit)
+namespace srt {
+// Encodes the loss ranges for the NAK report.
+struct CLossArrayWriter
 {
-    len = 0;
+    int32_t* array;
+    int&     len;
+    int      limit;
 
-    int i = m_iHead;
+    CLossArrayWriter(int32_t* a, int& l, int lim) : array(a), len(l), limit(lim) {}
 
-    while ((len < limit - 1) && (-1 != i))
+    bool operator()(int32_t seqlo, int32_t seqhi)
     {
-        array[len] = m_caSeq[i].seqstart;
-        if (SRT_SEQNO_NONE != m_caSeq[i].seqend)
+        array[len] = seqlo;
+        if (seqhi != seqlo)
         {
             // there are more than 1 loss in the sequence
             array[len] |= LOSSDATA_SEQNO_RANGE_FIRST;
             ++len;
-            array[len] = m_caSeq[i].seqend;
+            array[len] = seqhi;
         }
 
         ++len;
-
-        i = m_caSeq[i].inext;
+        return len < limit - 1;
     }
+};
+}
+
+void srt::CRcvLossList::getLossArray(int32_t* array, int& len, int limit)
+{
+    len = 0;
+    if (limit < 2)
+        return;
+
+    CLossArrayWriter writer(array, len, limit);
+    m_Bitmap.forEachRange(writer);
 }
 
-srt::CRcvFreshLoss::CRcvFreshLoss(int32_t seqlo, int32_t seqhi, int initial_age)
-    : ttl(initial_age)
-    , timestamp(steady_clock::now())
+srt::CRcvFreshLossList::CRcvFreshLossList()
+    : m_uAge(0)
 {
-    seq[0] = seqlo;
-    seq[1] = seqhi;
 }
 
-srt::CRcvFreshLoss::Emod srt::CRcvFreshLoss::revoke(int32_t sequence)
+void srt::CRcvFreshLossList::insert(int32_t seqlo, int32_t seqhi, int ttl)
 {
-    int32_t diffbegin = CSeqNo::seqcmp(sequence, seq[0]);
-    int32_t diffend   = CSeqNo::seqcmp(sequence, seq[1]);
+    Range r;
+    r.seqlo    = seqlo;
+    r.deadline = m_uAge + uint32_t(ttl);
+    // Newer than all others, so it goes at the end.
+    m_Ranges.insert(m_Ranges.end(), std::make_pair(seqhi, r));
+}
 
-    if (diffbegin < 0 || diffend > 0)
+bool srt::CRcvFreshLossList::removeOne(int32_t sequence, int* pw_had_ttl)
+{
+    // The first range that ends not earlier than the sequence.
+    ranges_t::iterator i = m_Ranges.lower_bound(sequence);
+    if (i == m_Ranges.end() || CSeqNo::seqcmp(sequence, i->second.seqlo) < 0)
     {
-        return NONE; // not within the range at all.
+        if (pw_had_ttl)
+            *pw_had_ttl = 0;
+        return false;
     }
 
-    if (diffbegin == 0)
+    if (pw_had_ttl)
+        *pw_had_ttl = ttl(i->second);
+
+    const int32_t seqlo = i->second.seqlo;
+    const int32_t seqhi = i->first;
+
+    if (sequence != seqhi)
     {
-        if (diffend == 0) // exactly at begin and end
+        //  ... xooo ... => ... ooo ...
+        // ... ooxooo ... => ... oo ... ooo ...
+        // The part above the sequence keeps the key.
+        i->second.seqlo = CSeqNo::incseq(sequence);
+        if (sequence != seqlo)
         {
-            return DELETE;
+            Range lower = i->second;
+            lower.seqlo = seqlo;
+            m_Ranges.insert(i, std::make_pair(CSeqNo::decseq(sequence), lower));
         }
-
-        // only exactly at begin. Shrink the range
-        seq[0] = CSeqNo::incseq(seq[0]);
-        return STRIPPED;
+        return true;
     }
 
-    if (diffend == 0) // exactly at end
+    // ... ooox ... => ... ooo ...
+    // ... oo ... x ... o ... => ... oo ... o ...
+    // The range ends at the sequence, so it gets a new key, if anything remains.
+    if (sequence != seqlo)
     {
-        seq[1] = CSeqNo::decseq(seq[1]);
-        return STRIPPED;
+        Range lower = i->second;
+        m_Ranges.insert(i, std::make_pair(CSeqNo::decseq(sequence), lower));
     }
-
-    return SPLIT;
+    m_Ranges.erase(i);
+    return true;
 }
 
-srt::CRcvFreshLoss::Emod srt::CRcvFreshLoss::revoke(int32_t lo, int32_t hi)
+void srt::CRcvFreshLossList::revoke(int32_t lo, int32_t hi)
 {
-    // This should only if the range lo-hi is anyhow covered by seq[0]-seq[1].
+    // Records older than the dropped range are dropped as well, so only
+    // the front of the list needs to be checked.
+    while (!m_Ranges.empty())
+    {
+        ranges_t::iterator i = m_Ranges.begin();
 
-    // Note: if the checked item contains sequences that are OLDER
-    // than the oldest sequence in this range, they should be deleted,
-    // even though this wasn't explicitly requested.
+        // LOHI:               <lo, hi>
+        // ITEM:  <lo, hi>                      <--- delete
+        if (lo != SRT_SEQNO_NONE && CSeqNo::seqcmp(lo, i->first) > 0)
+        {
+            m_Ranges.erase(i);
+            continue;
+        }
 
-    // LOHI:               <lo, hi>
-    // ITEM:  <lo, hi>                      <--- delete
-    // If the sequence range is older than the range to be revoked,
-    // delete it anyway.
-    if (lo != SRT_SEQNO_NONE && CSeqNo::seqcmp(lo, seq[1]) > 0)
-        return DELETE;
-    // IF <lo> is NONE, then rely simply on that item.hi <% arg.hi,
-    // which is a condition at the end.
+        // LOHI:  <lo, hi>
+        // ITEM:             <lo, hi>  <-- not found, newer
+        if (CSeqNo::seqcmp(hi, i->second.seqlo) < 0)
+            break;
 
-    // LOHI:  <lo, hi>
-    // ITEM:             <lo, hi>  <-- NOTFOUND
-    // This element is newer than the given sequence, so match failed.
-    if (CSeqNo::seqcmp(hi, seq[0]) < 0)
-        return NONE;
+        // LOHI:     <lo,     hi>
+        // ITEM:       <lo,    !     hi>
+        // RESULT:            <lo,   hi>
+        if (CSeqNo::seqcmp(hi, i->first) < 0)
+        {
+            i->second.seqlo = CSeqNo::incseq(hi);
+            break;
+        }
 
-    // LOHI:     <lo,     hi>
-    // ITEM:       <lo,    !     hi>
-    // RESULT:            <lo,   hi>
-    // 2. If the 'hi' is in the middle (less than seq[1]), delete partially.
-    // That is, take care of this range for itself and return STRIPPED.
-    if (CSeqNo::seqcmp(hi, seq[1]) < 0)
-    {
-        seq[0] = CSeqNo::incseq(hi);
-        return STRIPPED;
+        // LOHI:            <lo,         hi>
+        // ITEM:       <lo,    !     hi>
+        // RESULT: DELETE, even if this was covering only part of this range.
+        m_Ranges.erase(i);
     }
-
-    // LOHI:            <lo,         hi>
-    // ITEM:       <lo,    !     hi>
-    // RESULT: DELETE.
-    // 3. Otherwise delete the record, even if this was covering only part of this range.
-    // This is not possible that the sequences OLDER THAN THIS are not required to be
-    // revoken together with this one.
-
-    return DELETE;
 }
 
-bool srt::CRcvFreshLoss::removeOne(std::deque<CRcvFreshLoss>& w_container, int32_t sequence, int* pw_had_ttl)
+void srt::CRcvFreshLossList::expire(std::vector< std::pair<int32_t, int32_t> >& w_expired)
 {
-    for (size_t i = 0; i < w_container.size(); ++i)
+    // Take while TTL <= 0. There can be more than one record with the same
+    // TTL, if a sequence that arrived has split one detected loss into two.
+    ranges_t::iterator i = m_Ranges.begin();
+    for (; i != m_Ranges.end() && ttl(i->second) <= 0; ++i)
     {
-        const int had_ttl = w_container[i].ttl;
-        Emod wh = w_container[i].revoke(sequence);
-
-        if (wh == NONE)
-            continue;  // Not found. Search again.
-
-        if (wh == DELETE)   //  ... oo ... x ... o ... => ... oo ... o ...
-        {
-            // Removed the only element in the record - remove the record.
-            w_container.erase(w_container.begin() + i);
-        }
-        else if (wh == SPLIT) // ... ooxooo ... => ... oo ... ooo ...
-        {
-            // Create a new element that will hold the upper part of the range,
-            // and the found one modify to be the lower part of the range.
-
-            // Keep the current end-of-sequence value for the second element
-            int32_t next_end = w_container[i].seq[1];
-
-            // seq-1 set to the end of this element
-            w_container[i].seq[1] = CSeqNo::decseq(sequence);
-            // seq+1 set to the begin of the next element
-            int32_t next_begin = CSeqNo::incseq(sequence);
-
-            // Use position of the NEXT element because insertion happens BEFORE pointed element.
-            // Use the same TTL (will stay the same in the other one).
-            w_container.insert(w_container.begin() + i + 1,
-                    CRcvFreshLoss(next_begin, next_end, w_container[i].ttl));
-        }
-        // For STRIPPED:  ... xooo ... => ... ooo ...
-        // i.e. there's nothing to do.
-
-        // Every loss is unique. We're done here.
-        if (pw_had_ttl)
-            *pw_had_ttl = had_ttl;
+        HLOGC(qrlog.Debug, log << "Packet seq " << i->second.seqlo << "-" << i->first
+                << " (" << CSeqNo::seqlen(i->second.seqlo, i->first) << " packets) considered lost - sending LOSSREPORT");
+        w_expired.push_back(std::make_pair(i->second.seqlo, i->first));
+    }
+    m_Ranges.erase(m_Ranges.begin(), i);
 
-        return true;
+    if (m_Ranges.empty())
+    {
+        HLOGP(qrlog.Debug, "NO MORE FRESH LOSS RECORDS.");
+        return;
     }
 
-    if (pw_had_ttl)
-        *pw_had_ttl = 0;
-    return false;
+    HLOGC(qrlog.Debug, log << "STILL " << m_Ranges.size() << " FRESH LOSS RECORDS, FIRST: "
+            << m_Ranges.begin()->second.seqlo << "-" << m_Ranges.begin()->first
+            << " (" << CSeqNo::seqlen(m_Ranges.begin()->second.seqlo, m_Ranges.begin()->first)
+            << ") TTL: " << ttl(m_Ranges.begin()->second));
 
+    // Decrease the TTL of all the remaining records.
+    ++m_uAge;
 }
-
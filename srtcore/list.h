@@ -53,13 +53,153 @@ modified by
 #ifndef INC_SRT_LIST_H
 #define INC_SRT_LIST_H
 
-#include <deque>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #include "udt.h"
 #include "common.h"
 
 namespace srt {
 
+/// A set of sequence numbers kept as a bitmap, one bit per sequence number.
+/// The bit of a sequence number is found directly from its value, so that
+/// the bitmap works as a ring that follows the sequence numbers as they
+/// advance. All operations work on whole 64-bit words, and an additional
+/// summary word per 64 words of the bitmap marks the words that have any
+/// bit set, so that the gaps between lost packets are skipped 4096
+/// sequence numbers at a time. The span from the first to the last set
+/// sequence number is limited by the capacity, which is the given size
+/// rounded up to a power of two. No locking.
+class CLossBitmap
+{
+public:
+    CLossBitmap(int size);
+    ~CLossBitmap();
+
+    /// Set all sequence numbers in the range.
+    /// @param [in] seqno1 first sequence number in range.
+    /// @param [in] seqno2 last sequence number in range.
+    /// @return number of sequence numbers that were not set before,
+    ///         -1 if the resulting span would exceed the capacity.
+    int set(int32_t seqno1, int32_t seqno2);
+
+    /// Clear all sequence numbers in the range.
+    /// @return number of sequence numbers that were cleared.
+    int clear(int32_t seqno1, int32_t seqno2);
+
+    /// Check if any sequence number in the range is set.
+    bool any(int32_t seqno1, int32_t seqno2) const;
+
+    /// Call the callback for every range of consecutive set sequence
+    /// numbers, in order, as cb(seqlo, seqhi), until it returns false.
+    template <class Callback>
+    void forEachRange(Callback& cb) const;
+
+    int32_t first() const { return m_iFirstSeq; }
+    int32_t last() const { return m_iLastSeq; }
+    int     count() const { return m_iCount; }
+    int     capacity() const { return m_iCapacity; }
+
+private:
+    // Operations on the ring positions [pos1, pos2], where pos1 <= pos2.
+    int setBits(int pos1, int pos2);
+    int clearBits(int pos1, int pos2);
+    int findSet(int pos1, int pos2) const;
+    int findLastSet(int pos1, int pos2) const;
+
+    int     pos(int32_t seqno) const { return seqno & (m_iCapacity - 1); }
+
+    static int lowestBit(uint64_t x)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(x);
+#else
+        int i = 0;
+        while ((x & 1) == 0)
+        {
+            x >>= 1;
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    int32_t findSetSeq(int32_t seqno1, int32_t seqno2) const;
+    int32_t findLastSetSeq(int32_t seqno1, int32_t seqno2) const;
+    int     clearOne(int32_t seqno);
+
+    uint64_t* m_aBits;     // one bit per sequence number
+    uint64_t* m_aSummary;  // one bit per non-zero word of m_aBits
+    int       m_iCapacity; // number of bits, a power of two
+    int       m_iWords;    // number of words in m_aBits
+    int32_t   m_iFirstSeq; // first set sequence number
+    int32_t   m_iLastSeq;  // last set sequence number
+    int       m_iCount;    // number of set sequence numbers
+
+private:
+    CLossBitmap(const CLossBitmap&);
+    CLossBitmap& operator=(const CLossBitmap&);
+};
+
+template <class Callback>
+void CLossBitmap::forEachRange(Callback& cb) const
+{
+    if (m_iCount == 0)
+        return;
+
+    // Scan the words from the first to the last set sequence number,
+    // cutting the runs of ones out of each word. The offsets are counted
+    // from the first sequence number, so the ring wrap is transparent.
+    const int span  = CSeqNo::seqlen(m_iFirstSeq, m_iLastSeq);
+    const int pos0  = pos(m_iFirstSeq);
+    bool      inrun = false;
+    int       runstart = 0;
+
+    for (int off = 0; off < span; off += 64 - (pos0 + off) % 64)
+    {
+        const int p     = (pos0 + off) & (m_iCapacity - 1);
+        const int avail = std::min(64 - p % 64, span - off);
+        uint64_t  bits  = m_aBits[p / 64] >> (p % 64);
+        if (avail < 64)
+            bits &= (uint64_t(1) << avail) - 1;
+
+        if (inrun)
+        {
+            // Find the end of the run continued from the previous word.
+            const uint64_t zeros = ~bits & (avail < 64 ? (uint64_t(1) << avail) - 1 : ~uint64_t(0));
+            if (!zeros)
+                continue;
+            const int end = lowestBit(zeros);
+            inrun = false;
+            if (!cb(CSeqNo::incseq(m_iFirstSeq, runstart), CSeqNo::incseq(m_iFirstSeq, off + end - 1)))
+                return;
+            bits &= ~uint64_t(0) << end;
+        }
+
+        while (bits)
+        {
+            // Adding the lowest bit of a run carries over the whole run
+            // and sets the first bit above it.
+            const int      start = lowestBit(bits);
+            const uint64_t carry = bits + (uint64_t(1) << start);
+            const int      end   = carry ? lowestBit(carry) : 64;
+            if (end >= avail)
+            {
+                inrun    = true;
+                runstart = off + start;
+                break;
+            }
+            if (!cb(CSeqNo::incseq(m_iFirstSeq, off + start), CSeqNo::incseq(m_iFirstSeq, off + end - 1)))
+                return;
+            bits &= carry;
+        }
+    }
+
+    if (inrun)
+        cb(CSeqNo::incseq(m_iFirstSeq, runstart), m_iLastSeq);
+}
+
 class CSndLossList
 {
 public:
@@ -76,7 +216,7 @@ public:
     /// @param [in] seqno sequence number.
     void removeUpTo(int32_t seqno);
 
-    /// Read the loss length.∏
+    /// Read the loss length.
     /// @return The length of the list.
     int getLossLength() const;
 
@@ -87,66 +227,34 @@ public:
     template <class Stream>
     Stream& traceState(Stream& sout) const
     {
-        int pos = m_iHead;
-        while (pos != SRT_SEQNO_NONE)
-        {
-            sout << "[" << pos << "]:" << m_caSeq[pos].seqstart;
-            if (m_caSeq[pos].seqend != SRT_SEQNO_NONE)
-                sout << ":" << m_caSeq[pos].seqend;
-            if (m_caSeq[pos].inext == -1)
-                sout << "=|";
-            else
-                sout << "->[" << m_caSeq[pos].inext << "]";
-            sout << ", ";
-            pos = m_caSeq[pos].inext;
-        }
-        sout << " {len:" << m_iLength << " head:" << m_iHead << " last:" << m_iLastInsertPos << "}";
+        TraceRange<Stream> trace(sout);
+        m_Bitmap.forEachRange(trace);
+        sout << " {len:" << m_Bitmap.count() << " first:" << m_Bitmap.first() << " last:" << m_Bitmap.last() << "}";
         return sout;
     }
     void traceState() const;
 
-    // Debug/unittest support.
-
-    int head() const { return m_iHead; }
-    int next(int loc) const { return m_caSeq[loc].inext; }
-    int last() const { return m_iLastInsertPos; }
-
 private:
-    struct Seq
+    template <class Stream>
+    struct TraceRange
     {
-        int32_t seqstart; // sequence number starts
-        int32_t seqend;   // sequence number ends
-        int     inext;    // index of the next node in the list
-    } * m_caSeq;
+        Stream& sout;
+        TraceRange(Stream& s) : sout(s) {}
+        bool operator()(int32_t seqlo, int32_t seqhi)
+        {
+            sout << seqlo;
+            if (seqhi != seqlo)
+                sout << ":" << seqhi;
+            sout << ", ";
+            return true;
+        }
+    };
 
-    int       m_iHead;          // first node
-    int       m_iLength;        // loss length
-    const int m_iSize;          // size of the static array
-    int       m_iLastInsertPos; // position of last insert node
+    CLossBitmap m_Bitmap;
+    const int   m_iSize; // maximum distance from the first loss
 
     mutable srt::sync::Mutex m_ListLock; // used to synchronize list operation
 
-private:
-    /// Inserts an element to the beginning and updates head pointer.
-    /// No lock.
-    void insertHead(int pos, int32_t seqno1, int32_t seqno2);
-
-    /// Inserts an element after previous element.
-    /// No lock.
-    void insertAfter(int pos, int pos_after, int32_t seqno1, int32_t seqno2);
-
-    /// Check if it is possible to coalesce element at loc with further elements.
-    /// @param loc - last changed location
-    void coalesce(int loc);
-
-    /// Update existing element with the new range (increase only)
-    /// @param pos     position of the element being updated
-    /// @param seqno1  first sequence number in range
-    /// @param seqno2  last sequence number in range (SRT_SEQNO_NONE if no range)
-    bool updateElement(int pos, int32_t seqno1, int32_t seqno2);
-
-    static const int LOC_NONE = -1;
-
 private:
     CSndLossList(const CSndLossList&);
     CSndLossList& operator=(const CSndLossList&);
@@ -210,97 +318,71 @@ public:
     void getLossArray(int32_t* array, int& len, int limit);
 
 private:
-    struct Seq
-    {
-        int32_t seqstart; // sequence number starts
-        int32_t seqend;   // sequence number ends
-        int     inext;    // index of the next node in the list
-        int     iprior;   // index of the previous node in the list
-    } * m_caSeq;
-
-    int m_iHead;   // first node in the list
-    int m_iTail;   // last node in the list;
-    int m_iLength; // loss length
-    int m_iSize;   // size of the static array
-    int m_iLargestSeq; // largest seq ever seen
+    CLossBitmap m_Bitmap;
+    int         m_iLargestSeq; // largest seq ever seen
 
 private:
     CRcvLossList(const CRcvLossList&);
     CRcvLossList& operator=(const CRcvLossList&);
-
-public:
-    struct iterator
-    {
-        int32_t head;
-        Seq*    seq;
-
-        iterator(Seq* str, int32_t v)
-            : head(v)
-            , seq(str)
-        {
-        }
-
-        iterator next() const
-        {
-            if (head == -1)
-                return *this; // should report error, but we can only throw exception, so simply ignore it.
-
-            return iterator(seq, seq[head].inext);
-        }
-
-        iterator& operator++()
-        {
-            *this = next();
-            return *this;
-        }
-
-        iterator operator++(int)
-        {
-            iterator old(seq, head);
-            *this = next();
-            return old;
-        }
-
-        bool operator==(const iterator& second) const
-        {
-            // Ignore seq - should be the same and this is only a sanity check.
-            return head == second.head;
-        }
-
-        bool operator!=(const iterator& second) const { return !(*this == second); }
-
-        std::pair<int32_t, int32_t> operator*() { return std::make_pair(seq[head].seqstart, seq[head].seqend); }
-    };
-
-    iterator begin() { return iterator(m_caSeq, m_iHead); }
-    iterator end() { return iterator(m_caSeq, -1); }
 };
 
-struct CRcvFreshLoss
+/// Lost sequences already added to the receiver's loss list, for which
+/// UMSG_LOSSREPORT is held back until the reorder tolerance (TTL, counted
+/// in received packets) expires. The records are disjoint ranges kept in a
+/// map keyed by the last sequence of the range, so that finding, stripping
+/// and splitting a range for a belated packet takes O(log n). TTLs are aged
+/// all at once by advancing a common counter that the records' deadlines
+/// are compared against.
+class CRcvFreshLossList
 {
-    int32_t                             seq[2];
-    int                                 ttl;
-    srt::sync::steady_clock::time_point timestamp;
+public:
+    CRcvFreshLossList();
+
+    /// Add a loss range newer than all the ranges in the list.
+    /// @param [in] seqlo first lost sequence number.
+    /// @param [in] seqhi last lost sequence number.
+    /// @param [in] ttl number of packets to wait before reporting the loss.
+    void insert(int32_t seqlo, int32_t seqhi, int ttl);
+
+    /// Remove a sequence number that has arrived, splitting its range if needed.
+    /// @param [in] sequence the sequence number.
+    /// @param [out] pw_had_ttl the TTL of the range the sequence was in, 0 if not found.
+    /// @return true if the sequence was found.
+    bool removeOne(int32_t sequence, int* pw_had_ttl = NULL);
+
+    /// Remove the ranges dropped from the receiver's loss list. The ranges
+    /// older than @a lo are removed too.
+    /// @param [in] lo first dropped sequence number, or SRT_SEQNO_NONE.
+    /// @param [in] hi last dropped sequence number.
+    void revoke(int32_t lo, int32_t hi);
+
+    /// Take the ranges at the front of the list whose TTL has expired,
+    /// then decrease the TTL of the remaining ones.
+    /// @param [out] w_expired the expired ranges, appended.
+    void expire(std::vector< std::pair<int32_t, int32_t> >& w_expired);
+
+    size_t size() const { return m_Ranges.size(); }
+    bool   empty() const { return m_Ranges.empty(); }
 
-    CRcvFreshLoss(int32_t seqlo, int32_t seqhi, int initial_ttl);
+private:
+    struct SeqLess
+    {
+        bool operator()(int32_t a, int32_t b) const { return CSeqNo::seqcmp(a, b) < 0; }
+    };
 
-// Don't WTF when looking at this. The Windows system headers define
-// a publicly visible preprocessor macro with that name. REALLY!
-#ifdef DELETE
-#undef DELETE
-#endif
-    enum Emod
+    struct Range
     {
-        NONE,     //< the given sequence was not found in this range
-        STRIPPED, //< it was equal to first or last, already taken care of
-        SPLIT,    //< found in the middle, you have to split this range into two
-        DELETE    //< This was a range of one element exactly equal to sequence. Simply delete it.
+        int32_t  seqlo;    // first sequence number; the last one is the key
+        uint32_t deadline; // value of m_uAge at which the TTL expires
     };
 
-    Emod revoke(int32_t sequence);
-    Emod revoke(int32_t lo, int32_t hi);
+    typedef std::map<int32_t, Range, SeqLess> ranges_t;
+
+    // Counted in unsigned arithmetic, so that overflows are harmless.
+    int ttl(const Range& r) const { return int(int32_t(r.deadline - m_uAge)); }
 
-    static bool removeOne(std::deque<CRcvFreshLoss>& w_container, int32_t sequence, int* had_ttl = NULL);
+    ranges_t m_Ranges;
+    uint32_t m_uAge; // number of times the TTLs were decreased
 };
 
 } // namespace srt
@@ -179,6 +179,7 @@ CPacket::CPacket()
     : m_nHeader() // Silences GCC 12 warning "used uninitialized".
     , m_extra_pad()
     , m_data_owned(false)
+    , m_bCoalesced(false)
     , m_pcData((char*&)(m_PacketVector[PV_DATA].dataRef()))
 {
     m_nHeader.clear();
@@ -552,10 +553,22 @@ CPacket* CPacket::clone() const
     SRT_ASSERT(this->getLength() == pkt->getLength());
     memcpy((pkt->m_pcData), m_pcData, this->getLength());
     pkt->m_DestAddr = m_DestAddr;
+    pkt->m_tsArrival = m_tsArrival;
+    pkt->m_bCoalesced = m_bCoalesced;
 
     return pkt;
 }
 
+void CPacket::copyFrom(const CPacket& src)
+{
+    memcpy((m_nHeader), src.m_nHeader, HDR_SIZE);
+    setLength(src.getLength());
+    memcpy((m_pcData), src.m_pcData, src.getLength());
+    m_DestAddr  = src.m_DestAddr;
+    m_tsArrival = src.m_tsArrival;
+    m_bCoalesced = src.m_bCoalesced;
+}
+
 // Useful for debugging
 std::string PacketMessageFlagStr(uint32_t msgno_field)
 {
@@ -309,6 +309,14 @@ public:
 
     sockaddr_any udpDestAddr() const { return m_DestAddr; }
 
+    /// Read the time when the packet was received by the system.
+    /// @return the receive time, if provided by the channel (SRTO_UDP_RCVTIMESTAMP), otherwise zero.
+    sync::steady_clock::time_point arrivalTime() const { return m_tsArrival; }
+
+    /// Check if the packet was received in a buffer of multiple coalesced
+    /// packets (SRTO_UDP_GRO), all of which have the arrival time of the buffer.
+    bool coalesced() const { return m_bCoalesced; }
+
 #ifdef SRT_DEBUG_TSBPD_WRAP                           // Receiver
     static const uint32_t MAX_TIMESTAMP = 0x07FFFFFF; // 27 bit fast wraparound for tests (~2m15s)
 #else
@@ -322,6 +330,10 @@ public:
     /// @return Pointer to the new packet.
     CPacket* clone() const;
 
+    /// Copy a received packet into the buffer of this one, which must be
+    /// big enough: the header, the payload and the receiving details.
+    void copyFrom(const CPacket& src);
+
     enum PacketVectorFields
     {
         PV_HEADER = 0,
@@ -347,6 +359,9 @@ protected:
     int32_t m_extra_pad;
     bool    m_data_owned;
     sockaddr_any m_DestAddr;
+    sync::steady_clock::time_point m_tsArrival;
+    bool    m_bCoalesced;
+    sync::steady_clock::time_point m_tsSendTime; // passed to the system with SRTO_UDP_TXTIME, if not zero
     size_t  m_zCapacity;
 
 protected:
@@ -130,7 +130,7 @@ void srt::PacketFilter::receive(CUnit* unit, std::vector<CUnit*>& w_incoming, lo
     {
         // For the sake of rebuilding MARK THIS UNIT GOOD, otherwise the
         // unit factory will supply it from getNextAvailUnit() as if it were not in use.
-        unit->m_bTaken = true;
+        m_unitq->makeUnitTaken(unit);
         HLOGC(pflog.Debug, log << "FILTER: PASSTHRU current packet %" << unit->m_Packet.getSeqNo());
         w_incoming.push_back(unit);
     }
@@ -172,23 +172,22 @@ void srt::PacketFilter::receive(CUnit* unit, std::vector<CUnit*>& w_incoming, lo
         m_parent->m_stats.rcvr.suppliedByFilter.count((uint32_t)nsupply);
     }
 
+    // Packets must be sorted by sequence number, ascending, in order
+    // not to challenge the SRT's contiguity checker.
+    sort(w_incoming.begin(), w_incoming.end(), SortBySequence());
+
     // Now that all units have been filled as they should be,
     // SET THEM ALL FREE. This is because now it's up to the 
     // buffer to decide as to whether it wants them or not.
     // Wanted units will be set GOOD flag, unwanted will remain
     // with FREE and therefore will be returned at the next
-    // call to getNextAvailUnit().
-    unit->m_bTaken = false;
-    for (vector<CUnit*>::iterator i = w_incoming.begin(); i != w_incoming.end(); ++i)
+    // call to getNextAvailUnit(). In reverse, so that they are
+    // taken from the beginning of the list of free units.
+    for (vector<CUnit*>::reverse_iterator i = w_incoming.rbegin(); i != w_incoming.rend(); ++i)
     {
-        CUnit* u = *i;
-        u->m_bTaken = false;
+        m_unitq->makeUnitAvail(*i);
     }
 
-    // Packets must be sorted by sequence number, ascending, in order
-    // not to challenge the SRT's contiguity checker.
-    sort(w_incoming.begin(), w_incoming.end(), SortBySequence());
-
     // For now, report immediately the irrecoverable packets
     // from the row.
 
@@ -253,7 +252,7 @@ void srt::PacketFilter::InsertRebuilt(vector<CUnit*>& incoming, CUnitQueue* uq)
 
         // LOCK the unit as taken because otherwise the next
         // call to getNextAvailUnit will return THE SAME UNIT.
-        u->m_bTaken = true;
+        uq->makeUnitTaken(u);
         // After returning from this function, all units will be
         // set back to FREE so that the buffer can decide whether
         // it wants them or not.
@@ -52,6 +52,7 @@ modified by
 
 #include "platform_sys.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "common.h"
@@ -61,24 +62,36 @@ modified by
 #include "logging.h"
 #include "queue.h"
 
+#ifdef SRT_ENABLE_IOPOOL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
 using namespace std;
 using namespace srt::sync;
 using namespace srt_logging;
 
 srt::CUnitQueue::CUnitQueue(int initNumUnits, int mss)
-    : m_iNumTaken(0)
+    : m_pFreeUnits(NULL)
+    , m_iShrinkCheck(SHRINK_CHECK_PERIOD)
+    , m_iShrinkPeriod(SHRINK_CHECK_PERIOD)
     , m_iMSS(mss)
     , m_iBlockSize(initNumUnits)
+    , m_pReturned(NULL)
+    , m_iNumTaken(0)
 {
     CQEntry* tempq = allocateEntry(m_iBlockSize, m_iMSS);
 
     if (tempq == NULL)
         throw CUDTException(MJ_SYSTEMRES, MN_MEMORY);
 
-    m_pQEntry = m_pCurrQueue = m_pLastQueue = tempq;
+    m_pQEntry = m_pLastQueue = tempq;
     m_pQEntry->m_pNext = m_pQEntry;
 
-    m_pAvailUnit = m_pCurrQueue->m_pUnit;
+    // Push them in reverse, so that the units are first taken in order.
+    for (int i = m_iBlockSize - 1; i >= 0; --i)
+        pushFree_(&tempq->m_pUnit[i]);
 
     m_iSize = m_iBlockSize;
 }
@@ -127,6 +140,8 @@ srt::CUnitQueue::CQEntry* srt::CUnitQueue::allocateEntry(const int iNumUnits, co
     {
         tempu[i].m_bTaken = false;
         tempu[i].m_Packet.m_pcData = tempb + i * mss;
+        tempu[i].m_pNextFree = NULL;
+        tempu[i].m_pPrevFree = NULL;
     }
 
     tempq->m_pUnit   = tempu;
@@ -149,49 +164,197 @@ int srt::CUnitQueue::increase_()
     m_pLastQueue          = tempq;
     m_pLastQueue->m_pNext = m_pQEntry;
 
+    for (int i = numUnits - 1; i >= 0; --i)
+        pushFree_(&tempq->m_pUnit[i]);
+
     m_iSize += numUnits;
 
     return 0;
 }
 
-srt::CUnit* srt::CUnitQueue::getNextAvailUnit()
+bool srt::CUnitQueue::shrink_()
+{
+    // All free units must be on the free list to tell which blocks are unused.
+    // The units being freed are on neither list, so their blocks are kept.
+    collectReturned_();
+    for (CUnit* u = m_pFreeUnits; u && u->m_pNextFree; u = u->m_pNextFree)
+        u->m_pNextFree->m_pPrevFree = u;
+
+    CQEntry* prev = m_pQEntry;
+    for (CQEntry* q = m_pQEntry->m_pNext; q != m_pQEntry; prev = q, q = q->m_pNext)
+    {
+        CUnit* const begin = q->m_pUnit;
+        CUnit* const end   = q->m_pUnit + q->m_iSize;
+
+        // The next available unit may still be used by the caller of getNextAvailUnit().
+        if (m_pFreeUnits >= begin && m_pFreeUnits < end)
+            continue;
+
+        if (countFree_(q) != q->m_iSize)
+            continue;
+
+        for (CUnit* u = begin; u != end; ++u)
+            unlinkFree_(u);
+
+        prev->m_pNext = q->m_pNext;
+        if (q == m_pLastQueue)
+            m_pLastQueue = prev;
+        m_iSize -= q->m_iSize;
+
+        HLOGC(qrlog.Debug, log << "CUnitQueue::shrink: Capacity " << capacity() << " after releasing " << q->m_iSize << " units, " << m_iNumTaken << " in use.");
+
+        delete[] q->m_pUnit;
+        delete[] q->m_pBuffer;
+        delete q;
+        return true;
+    }
+
+    return false;
+}
+
+void srt::CUnitQueue::prepareTake_(int count)
 {
+    m_iShrinkCheck -= count;
+    if (m_iShrinkCheck <= 0)
+    {
+        if (m_pQEntry == m_pLastQueue || m_iNumTaken * 4 >= m_iSize)
+            m_iShrinkPeriod = SHRINK_CHECK_PERIOD;
+        else if (shrink_())
+            m_iShrinkPeriod = SHRINK_CHECK_PERIOD;
+        else if (m_iShrinkPeriod < 64 * SHRINK_CHECK_PERIOD)
+            m_iShrinkPeriod *= 2; // Checking walks the free list, so it is done less often while it fails.
+        m_iShrinkCheck = m_iShrinkPeriod;
+    }
+
     const int iNumUnitsTotal = capacity();
-    if (m_iNumTaken * 10 > iNumUnitsTotal * 9) // 90% or more are in use.
+    if ((m_iNumTaken + count - 1) * 10 > iNumUnitsTotal * 9) // 90% or more would be in use.
         increase_();
 
-    if (m_iNumTaken >= capacity())
+    if (!m_pFreeUnits)
+        collectReturned_();
+}
+
+void srt::CUnitQueue::collectReturned_()
+{
+    CUnit* const returned = m_pReturned.exchange(NULL);
+    if (!returned)
+        return;
+
+    // The returned units are linked the same way, so the list is taken over
+    // as a whole, the most recently freed units first. Their backward links
+    // are not set (see m_pPrevFree), so it's done when the free list is empty,
+    // except in shrink_(), which sets all the links anew.
+    if (m_pFreeUnits)
+    {
+        CUnit* last = returned;
+        while (last->m_pNextFree)
+            last = last->m_pNextFree;
+        last->m_pNextFree = m_pFreeUnits;
+    }
+    m_pFreeUnits = returned;
+}
+
+void srt::CUnitQueue::pushFree_(CUnit* unit)
+{
+    unit->m_pNextFree = m_pFreeUnits;
+    if (m_pFreeUnits)
+        m_pFreeUnits->m_pPrevFree = unit;
+    m_pFreeUnits = unit;
+}
+
+void srt::CUnitQueue::popFree_()
+{
+    m_pFreeUnits = m_pFreeUnits->m_pNextFree;
+}
+
+void srt::CUnitQueue::unlinkFree_(CUnit* unit)
+{
+    if (unit == m_pFreeUnits)
+    {
+        popFree_();
+        return;
+    }
+
+    unit->m_pPrevFree->m_pNextFree = unit->m_pNextFree;
+    if (unit->m_pNextFree)
+        unit->m_pNextFree->m_pPrevFree = unit->m_pPrevFree;
+}
+
+int srt::CUnitQueue::countFree_(const CQEntry* q) const
+{
+    const CUnit* const begin = q->m_pUnit;
+    const CUnit* const end   = q->m_pUnit + q->m_iSize;
+
+    int count = 0;
+    for (const CUnit* u = m_pFreeUnits; u; u = u->m_pNextFree)
+    {
+        if (u >= begin && u < end)
+            ++count;
+    }
+    return count;
+}
+
+srt::CUnit* srt::CUnitQueue::getNextAvailUnit()
+{
+    prepareTake_(1);
+
+    if (!m_pFreeUnits)
     {
         LOGC(qrlog.Error, log << "CUnitQueue: No free units to take. Capacity" << capacity() << ".");
         return NULL;
     }
 
-    int units_checked = 0;
-    do
-    {
-        const CUnit* end = m_pCurrQueue->m_pUnit + m_pCurrQueue->m_iSize;
-        for (; m_pAvailUnit != end; ++m_pAvailUnit, ++units_checked)
-        {
-            if (!m_pAvailUnit->m_bTaken)
-            {
-                return m_pAvailUnit;
-            }
-        }
+    return m_pFreeUnits;
+}
 
-        m_pCurrQueue = m_pCurrQueue->m_pNext;
-        m_pAvailUnit = m_pCurrQueue->m_pUnit;
-    } while (units_checked < m_iSize);
+int srt::CUnitQueue::takeUnits(CUnit** w_units, int count)
+{
+    prepareTake_(count);
 
-    return NULL;
+    int n = 0;
+    for (; n < count && m_pFreeUnits; ++n)
+    {
+        CUnit* u = m_pFreeUnits;
+        popFree_();
+        u->m_bTaken.store(true);
+        ++m_iNumTaken;
+        w_units[n] = u;
+
+        if (!m_pFreeUnits)
+            collectReturned_();
+    }
+
+    if (n == 0)
+    {
+        LOGC(qrlog.Error, log << "CUnitQueue: No free units to take. Capacity" << capacity() << ".");
+    }
+    return n;
 }
 
 void srt::CUnitQueue::makeUnitFree(CUnit* unit)
 {
     SRT_ASSERT(unit != NULL);
     SRT_ASSERT(unit->m_bTaken);
+
     unit->m_bTaken.store(false);
+    --m_iNumTaken;
+
+    CUnit* head;
+    do
+    {
+        head              = m_pReturned;
+        unit->m_pNextFree = head;
+    } while (!m_pReturned.compare_exchange(head, unit));
+}
+
+void srt::CUnitQueue::makeUnitAvail(CUnit* unit)
+{
+    SRT_ASSERT(unit != NULL);
+    SRT_ASSERT(unit->m_bTaken);
 
+    unit->m_bTaken.store(false);
     --m_iNumTaken;
+    pushFree_(unit);
 }
 
 void srt::CUnitQueue::makeUnitTaken(CUnit* unit)
@@ -200,24 +363,288 @@ void srt::CUnitQueue::makeUnitTaken(CUnit* unit)
 
     SRT_ASSERT(unit != NULL);
     SRT_ASSERT(!unit->m_bTaken);
+    // Also the units returned by makeUnitAvail() and not taken in order.
+    unlinkFree_(unit);
     unit->m_bTaken.store(true);
 }
 
+// Index of the lowest set bit of a non-zero value.
+static inline int lowestBit(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int i = 0;
+    while ((x & 1) == 0)
+    {
+        x >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+srt::CSndTimingWheel::CSndTimingWheel()
+    : m_uCurrTick(0)
+    , m_iCount(0)
+{
+    memset(m_Slots, 0, sizeof m_Slots);
+    memset(m_Used, 0, sizeof m_Used);
+}
+
+uint64_t srt::CSndTimingWheel::tickOf(const steady_clock::time_point& ts)
+{
+    return uint64_t(count_microseconds(ts.time_since_epoch())) >> TICK_SHIFT;
+}
+
+void srt::CSndTimingWheel::insert(CSNode* n)
+{
+    uint64_t tick = tickOf(n->m_tsTimeStamp);
+
+    // With nothing scheduled the window may start anywhere not later than
+    // now, otherwise the times already passed go to the current tick.
+    if (m_iCount == 0)
+        m_uCurrTick = std::min(tick, tickOf(steady_clock::now()));
+    else if (tick < m_uCurrTick)
+        tick = m_uCurrTick;
+
+    link_(n, tick);
+    ++m_iCount;
+}
+
+void srt::CSndTimingWheel::remove(CSNode* n)
+{
+    unlink_(n);
+    --m_iCount;
+}
+
+srt::CSNode* srt::CSndTimingWheel::pop(const steady_clock::time_point& ts_due)
+{
+    if (m_iCount == 0)
+        return NULL;
+
+    const uint64_t due = tickOf(ts_due);
+    advance_(due);
+
+    const int slot = findSlot_(0);
+    if (slot == -1 || slotStart_(0, slot) > due)
+        return NULL;
+
+    // All nodes in a slot before the due tick are due,
+    // in the due tick only some of them may be.
+    CSNode* n = m_Slots[0][slot].head;
+    if (slotStart_(0, slot) == due)
+    {
+        while (n && n->m_tsTimeStamp > ts_due)
+            n = n->m_pNext;
+        if (!n)
+            return NULL;
+    }
+
+    remove(n);
+    return n;
+}
+
+steady_clock::time_point srt::CSndTimingWheel::nextTime(const steady_clock::time_point& now)
+{
+    if (m_iCount == 0)
+        return steady_clock::time_point();
+
+    const uint64_t now_tick = tickOf(now);
+    advance_(now_tick);
+
+    int level = 0, slot = 0;
+    earliestSlot_((level), (slot));
+    const CSNode* n = m_Slots[level][slot].head;
+    if (level == 0 && slotStart_(0, slot) < now_tick)
+        return n->m_tsTimeStamp;
+
+    steady_clock::time_point earliest = n->m_tsTimeStamp;
+    for (n = n->m_pNext; n && earliest > now; n = n->m_pNext)
+    {
+        if (n->m_tsTimeStamp < earliest)
+            earliest = n->m_tsTimeStamp;
+    }
+    return earliest;
+}
+
+bool srt::CSndTimingWheel::isEarliest(const steady_clock::time_point& ts) const
+{
+    int level = 0, slot = 0;
+    if (!earliestSlot_((level), (slot)))
+        return true;
+
+    const uint64_t tick = tickOf(ts);
+    if (level == 0 || tick <= slotStart_(level, slot))
+        return tick <= slotStart_(level, slot);
+
+    // A slot of a higher level covers many ticks, and the earliest node
+    // is one of those in it.
+    for (const CSNode* n = m_Slots[level][slot].head; n; n = n->m_pNext)
+    {
+        if (tickOf(n->m_tsTimeStamp) < tick)
+            return false;
+    }
+    return true;
+}
+
+void srt::CSndTimingWheel::link_(CSNode* n, uint64_t tick)
+{
+    // Take the lowest level where the tick is in the current window
+    // of the slots. The top level wraps around instead, and the times
+    // too far for it are kept in its last slot.
+    int level = 0;
+    while (level < LEVELS - 1 && (tick >> (SLOT_BITS * (level + 1))) != (m_uCurrTick >> (SLOT_BITS * (level + 1))))
+        ++level;
+
+    const int shift = SLOT_BITS * level;
+    if (level == LEVELS - 1)
+    {
+        const uint64_t curr = m_uCurrTick >> shift;
+        if ((tick >> shift) - curr > uint64_t(SLOTS - 1))
+            tick = (curr + SLOTS - 1) << shift;
+    }
+    const int slot = int((tick >> shift) & (SLOTS - 1));
+
+    Slot& s    = m_Slots[level][slot];
+    n->m_pPrev = s.tail;
+    n->m_pNext = NULL;
+    if (s.tail)
+    {
+        s.tail->m_pNext = n;
+    }
+    else
+    {
+        s.head = n;
+        m_Used[level][slot / 64] |= uint64_t(1) << (slot % 64);
+    }
+    s.tail     = n;
+    n->m_iSlot = level * SLOTS + slot;
+}
+
+void srt::CSndTimingWheel::unlink_(CSNode* n)
+{
+    const int level = n->m_iSlot / SLOTS;
+    const int slot  = n->m_iSlot % SLOTS;
+    Slot&     s     = m_Slots[level][slot];
+
+    if (n->m_pPrev)
+        n->m_pPrev->m_pNext = n->m_pNext;
+    else
+        s.head = n->m_pNext;
+
+    if (n->m_pNext)
+        n->m_pNext->m_pPrev = n->m_pPrev;
+    else
+        s.tail = n->m_pPrev;
+
+    if (!s.head)
+        m_Used[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+
+    n->m_pPrev = n->m_pNext = NULL;
+    n->m_iSlot = -1;
+}
+
+int srt::CSndTimingWheel::findSlot_(int level) const
+{
+    // The lower levels have no slots behind the current tick in the window,
+    // the top level is searched circularly from the slot after the current tick.
+    const int from = level == LEVELS - 1 ? int(((m_uCurrTick >> (SLOT_BITS * level)) + 1) & (SLOTS - 1)) : 0;
+    const int words = SLOTS / 64;
+    for (int i = 0; i <= words; ++i)
+    {
+        const int w    = (from / 64 + i) % words;
+        uint64_t  bits = m_Used[level][w];
+        if (i == 0)
+            bits &= ~uint64_t(0) << (from % 64);
+        else if (i == words)
+            bits &= ~(~uint64_t(0) << (from % 64));
+
+        if (bits)
+            return w * 64 + lowestBit(bits);
+    }
+    return -1;
+}
+
+uint64_t srt::CSndTimingWheel::slotStart_(int level, int slot) const
+{
+    const int shift = SLOT_BITS * level;
+    if (level < LEVELS - 1)
+    {
+        const int up = shift + SLOT_BITS;
+        return ((m_uCurrTick >> up) << up) | (uint64_t(slot) << shift);
+    }
+
+    const uint64_t curr = m_uCurrTick >> shift;
+    return (curr + ((uint64_t(slot) - curr) & (SLOTS - 1))) << shift;
+}
+
+bool srt::CSndTimingWheel::earliestSlot_(int& w_level, int& w_slot) const
+{
+    // Every slot of a level is later than all slots of the levels below.
+    for (int level = 0; level < LEVELS; ++level)
+    {
+        const int slot = findSlot_(level);
+        if (slot != -1)
+        {
+            w_level = level;
+            w_slot  = slot;
+            return true;
+        }
+    }
+    return false;
+}
+
+void srt::CSndTimingWheel::advance_(uint64_t tick)
+{
+    // The current tick doesn't pass the earliest slot, so that
+    // no node is ever behind it.
+    while (tick > m_uCurrTick)
+    {
+        int level = 0, slot = 0;
+        if (!earliestSlot_((level), (slot)))
+        {
+            m_uCurrTick = tick;
+            return;
+        }
+
+        const uint64_t start = slotStart_(level, slot);
+        if (start > tick)
+        {
+            m_uCurrTick = tick;
+            return;
+        }
+
+        m_uCurrTick = start;
+        if (level == 0)
+            return;
+
+        // The time has reached the slot, so its nodes go down the levels.
+        Slot&   s = m_Slots[level][slot];
+        CSNode* n = s.head;
+        s.head = s.tail = NULL;
+        m_Used[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+        while (n)
+        {
+            CSNode* next = n->m_pNext;
+            uint64_t t   = tickOf(n->m_tsTimeStamp);
+            link_(n, t < m_uCurrTick ? m_uCurrTick : t);
+            n = next;
+        }
+    }
+}
+
 srt::CSndUList::CSndUList(sync::CTimer* pTimer)
-    : m_pHeap(NULL)
-    , m_iArrayLength(512)
-    , m_iLastEntry(-1)
-    , m_ListLock()
+    : m_ListLock()
     , m_pTimer(pTimer)
+    , m_pIoWorker(NULL)
 {
     setupCond(m_ListCond, "CSndUListCond");
-    m_pHeap = new CSNode*[m_iArrayLength];
 }
 
 srt::CSndUList::~CSndUList()
 {
     releaseCond(m_ListCond);
-    delete[] m_pHeap;
 }
 
 void srt::CSndUList::update(const CUDT* u, EReschedule reschedule, sync::steady_clock::time_point ts)
@@ -226,7 +653,7 @@ void srt::CSndUList::update(const CUDT* u, EReschedule reschedule, sync::steady_
 
     CSNode* n = u->m_pSNode;
 
-    if (n->m_iHeapLoc >= 0)
+    if (n->m_iSlot >= 0)
     {
         if (reschedule == DONT_RESCHEDULE)
             return;
@@ -234,57 +661,46 @@ void srt::CSndUList::update(const CUDT* u, EReschedule reschedule, sync::steady_
         if (n->m_tsTimeStamp <= ts)
             return;
 
-        if (n->m_iHeapLoc == 0)
-        {
-            n->m_tsTimeStamp = ts;
-            m_pTimer->interrupt();
-            return;
-        }
-
-        remove_(u);
-        insert_norealloc_(ts, u);
-        return;
+        m_Wheel.remove(n);
     }
 
     insert_(ts, u);
 }
 
-srt::CUDT* srt::CSndUList::pop()
+srt::CUDT* srt::CSndUList::pop(steady_clock::time_point ts_due)
 {
     ScopedLock listguard(m_ListLock);
 
-    if (-1 == m_iLastEntry)
-        return NULL;
-
     // no pop until the next scheduled time
-    if (m_pHeap[0]->m_tsTimeStamp > steady_clock::now())
-        return NULL;
-
-    CUDT* u = m_pHeap[0]->m_pUDT;
-    remove_(u);
-    return u;
+    CSNode* n = m_Wheel.pop(ts_due);
+    return n ? n->m_pUDT : NULL;
 }
 
 void srt::CSndUList::remove(const CUDT* u)
 {
     ScopedLock listguard(m_ListLock);
-    remove_(u);
+
+    CSNode* n = u->m_pSNode;
+    if (n->m_iSlot < 0)
+        return;
+
+    m_Wheel.remove(n);
+
+    // the only event has been deleted, wake up immediately
+    if (m_Wheel.empty())
+        interrupt_();
 }
 
 steady_clock::time_point srt::CSndUList::getNextProcTime()
 {
     ScopedLock listguard(m_ListLock);
-
-    if (-1 == m_iLastEntry)
-        return steady_clock::time_point();
-
-    return m_pHeap[0]->m_tsTimeStamp;
+    return m_Wheel.nextTime(steady_clock::now());
 }
 
 void srt::CSndUList::waitNonEmpty() const
 {
     UniqueLock listguard(m_ListLock);
-    if (m_iLastEntry >= 0)
+    if (!m_Wheel.empty())
         return;
 
     m_ListCond.wait(listguard);
@@ -296,120 +712,43 @@ void srt::CSndUList::signalInterrupt() const
     m_ListCond.notify_one();
 }
 
-void srt::CSndUList::realloc_()
-{
-    CSNode** temp = NULL;
-
-    try
-    {
-        temp = new CSNode*[2 * m_iArrayLength];
-    }
-    catch (...)
-    {
-        throw CUDTException(MJ_SYSTEMRES, MN_MEMORY, 0);
-    }
-
-    memcpy((temp), m_pHeap, sizeof(CSNode*) * m_iArrayLength);
-    m_iArrayLength *= 2;
-    delete[] m_pHeap;
-    m_pHeap = temp;
-}
-
 void srt::CSndUList::insert_(const steady_clock::time_point& ts, const CUDT* u)
-{
-    // increase the heap array size if necessary
-    if (m_iLastEntry == m_iArrayLength - 1)
-        realloc_();
-
-    insert_norealloc_(ts, u);
-}
-
-void srt::CSndUList::insert_norealloc_(const steady_clock::time_point& ts, const CUDT* u)
 {
     CSNode* n = u->m_pSNode;
 
-    // do not insert repeated node
-    if (n->m_iHeapLoc >= 0)
-        return;
-
-    SRT_ASSERT(m_iLastEntry < m_iArrayLength);
-
-    m_iLastEntry++;
-    m_pHeap[m_iLastEntry] = n;
-    n->m_tsTimeStamp      = ts;
-
-    int q = m_iLastEntry;
-    int p = q;
-    while (p != 0)
-    {
-        p = (q - 1) >> 1;
-        if (m_pHeap[p]->m_tsTimeStamp <= m_pHeap[q]->m_tsTimeStamp)
-            break;
-
-        swap(m_pHeap[p], m_pHeap[q]);
-        m_pHeap[q]->m_iHeapLoc = q;
-        q                      = p;
-    }
+    // an earlier event is being inserted, wake up sending worker
+    const bool earliest = m_Wheel.isEarliest(ts);
 
-    n->m_iHeapLoc = q;
+    n->m_tsTimeStamp = ts;
+    m_Wheel.insert(n);
 
-    // an earlier event has been inserted, wake up sending worker
-    if (n->m_iHeapLoc == 0)
-        m_pTimer->interrupt();
+    if (earliest)
+        interrupt_();
 
     // first entry, activate the sending queue
-    if (0 == m_iLastEntry)
+    if (m_Wheel.size() == 1)
     {
         // m_ListLock is assumed to be locked.
         m_ListCond.notify_one();
     }
 }
 
-void srt::CSndUList::remove_(const CUDT* u)
+void srt::CSndUList::interrupt_() const
 {
-    CSNode* n = u->m_pSNode;
-
-    if (n->m_iHeapLoc >= 0)
-    {
-        // remove the node from heap
-        m_pHeap[n->m_iHeapLoc] = m_pHeap[m_iLastEntry];
-        m_iLastEntry--;
-        m_pHeap[n->m_iHeapLoc]->m_iHeapLoc = n->m_iHeapLoc.load();
-
-        int q = n->m_iHeapLoc;
-        int p = q * 2 + 1;
-        while (p <= m_iLastEntry)
-        {
-            if ((p + 1 <= m_iLastEntry) && (m_pHeap[p]->m_tsTimeStamp > m_pHeap[p + 1]->m_tsTimeStamp))
-                p++;
-
-            if (m_pHeap[q]->m_tsTimeStamp > m_pHeap[p]->m_tsTimeStamp)
-            {
-                swap(m_pHeap[p], m_pHeap[q]);
-                m_pHeap[p]->m_iHeapLoc = p;
-                m_pHeap[q]->m_iHeapLoc = q;
-
-                q = p;
-                p = q * 2 + 1;
-            }
-            else
-                break;
-        }
-
-        n->m_iHeapLoc = -1;
-    }
-
-    // the only event has been deleted, wake up immediately
-    if (0 == m_iLastEntry)
-        m_pTimer->interrupt();
+    m_pTimer->interrupt();
+#ifdef SRT_ENABLE_IOPOOL
+    if (m_pIoWorker)
+        m_pIoWorker->wakeup();
+#endif
 }
 
 //
 srt::CSndQueue::CSndQueue()
-    : m_pSndUList(NULL)
-    , m_pChannel(NULL)
+    : m_pChannel(NULL)
     , m_pTimer(NULL)
+    , m_pIoWorker(NULL)
     , m_bClosing(false)
+    , m_iSndBatchSize(1)
 {
 }
 
@@ -422,16 +761,33 @@ srt::CSndQueue::~CSndQueue()
         m_pTimer->interrupt();
     }
 
-    // Unblock CSndQueue worker thread if it is waiting.
-    m_pSndUList->signalInterrupt();
+#ifdef SRT_ENABLE_IOPOOL
+    if (m_pIoWorker)
+        m_pIoWorker->remove(this);
+#endif
 
-    if (m_WorkerThread.joinable())
+    // Unblock CSndQueue worker threads if they are waiting.
+    for (size_t i = 0; i < m_vWorkers.size(); ++i)
     {
-        HLOGC(rslog.Debug, log << "SndQueue: EXIT");
-        m_WorkerThread.join();
+        m_vWorkers[i]->timer->interrupt();
+        m_vWorkers[i]->list->signalInterrupt();
     }
 
-    delete m_pSndUList;
+    for (size_t i = 0; i < m_vWorkers.size(); ++i)
+    {
+        Worker* w = m_vWorkers[i];
+        if (w->thread.joinable())
+        {
+            HLOGC(rslog.Debug, log << "SndQueue: EXIT worker " << i);
+            w->thread.join();
+        }
+
+        delete w->list;
+        if (w->timer != m_pTimer)
+            delete w->timer;
+        delete[] w->batch_packets;
+        delete w;
+    }
 }
 
 int srt::CSndQueue::ioctlQuery(int type) const
@@ -447,21 +803,73 @@ int srt::CSndQueue::sockoptQuery(int level, int type) const
 int srt::CSndQueue::m_counter = 0;
 #endif
 
-void srt::CSndQueue::init(CChannel* c, CTimer* t)
+void srt::CSndQueue::init(CChannel* c, CTimer* t, CIoWorker* w)
 {
-    m_pChannel  = c;
-    m_pTimer    = t;
-    m_pSndUList = new CSndUList(t);
+    m_pChannel = c;
+    m_pTimer   = t;
+
+    m_iSndBatchSize = m_pChannel->sndBatchSize();
+
+    // The shared I/O thread serves a single list of the multiplexer.
+    int nworkers = m_pChannel->sndWorkers();
+#ifdef SRT_ENABLE_IOPOOL
+    if (w)
+        nworkers = 1;
+#endif
+
+    for (int i = 0; i < nworkers; ++i)
+    {
+        Worker* wk        = new Worker;
+        wk->queue         = this;
+        wk->timer         = i == 0 ? t : new CTimer;
+        wk->list          = new CSndUList(wk->timer);
+        wk->batch_packets = NULL;
+        wk->batch_calls   = 0;
+        wk->batch_pkts    = 0;
+        wk->batch_gsopkts = 0;
+        wk->txtime_pkts   = 0;
+        wk->sent_pkts     = 0;
+        m_vWorkers.push_back(wk);
+
+        if (m_iSndBatchSize > 1)
+        {
+            wk->batch_packets = new CPacket[m_iSndBatchSize];
+            wk->batch_ppackets.resize(m_iSndBatchSize, NULL);
+            wk->batch_addrs.resize(m_iSndBatchSize);
+            wk->batch_srcaddrs.resize(m_iSndBatchSize);
+            for (int j = 0; j < m_iSndBatchSize; ++j)
+                wk->batch_ppackets[j] = &wk->batch_packets[j];
+        }
+    }
+
+#ifdef SRT_ENABLE_IOPOOL
+    if (w)
+    {
+        m_pIoWorker = w;
+        m_vWorkers[0]->list->setIoWorker(w);
+        w->add(this);
+        return;
+    }
+#else
+    (void)w;
+#endif
 
 #if ENABLE_LOGGING
     ++m_counter;
-    const std::string thrname = "SRT:SndQ:w" + Sprint(m_counter);
-    const char*       thname  = thrname.c_str();
+#endif
+    for (int i = 0; i < nworkers; ++i)
+    {
+#if ENABLE_LOGGING
+        std::string thrname = "SRT:SndQ:w" + Sprint(m_counter);
+        if (nworkers > 1)
+            thrname += "." + Sprint(i);
+        const char* thname = thrname.c_str();
 #else
-    const char* thname = "SRT:SndQ";
+        const char* thname = "SRT:SndQ";
 #endif
-    if (!StartThread(m_WorkerThread, CSndQueue::worker, this, thname))
-        throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+        if (!StartThread(m_vWorkers[i]->thread, CSndQueue::worker, m_vWorkers[i], thname))
+            throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+    }
 }
 
 int srt::CSndQueue::getIpTTL() const
@@ -502,7 +910,8 @@ static void CSndQueueDebugHighratePrint(const srt::CSndQueue* self, const steady
 
 void* srt::CSndQueue::worker(void* param)
 {
-    CSndQueue* self = (CSndQueue*)param;
+    Worker&    w    = *(Worker*)param;
+    CSndQueue* self = w.queue;
 
 #if ENABLE_LOGGING
     THREAD_STATE_INIT(("SRT:SndQ:w" + Sprint(m_counter)).c_str());
@@ -521,7 +930,7 @@ void* srt::CSndQueue::worker(void* param)
 
     while (!self->m_bClosing)
     {
-        const steady_clock::time_point next_time = self->m_pSndUList->getNextProcTime();
+        const steady_clock::time_point next_time = w.list->getNextProcTime();
 
         INCREMENT_THREAD_ITERATIONS();
 
@@ -535,7 +944,7 @@ void* srt::CSndQueue::worker(void* param)
             THREAD_PAUSED();
             if (!self->m_bClosing)
             {
-                self->m_pSndUList->waitNonEmpty();
+                w.list->waitNonEmpty();
                 IF_DEBUG_HIGHRATE(self->m_WorkerStats.lCondWait++);
             }
             THREAD_RESUMED();
@@ -543,64 +952,222 @@ void* srt::CSndQueue::worker(void* param)
             continue;
         }
 
-        // wait until next processing time of the first socket on the list
+        // wait until next processing time of the first socket on the list,
+        // or less, if the packets can be passed to the system ahead of time
         const steady_clock::time_point currtime = steady_clock::now();
+        const steady_clock::duration   ahead    = self->sendAheadTime();
 
         IF_DEBUG_HIGHRATE(CSndQueueDebugHighratePrint(self, currtime));
-        if (currtime < next_time)
+        if (currtime < next_time - ahead)
         {
             THREAD_PAUSED();
-            self->m_pTimer->sleep_until(next_time);
+            w.timer->sleep_until(next_time - ahead);
             THREAD_RESUMED();
             IF_DEBUG_HIGHRATE(self->m_WorkerStats.lSleepTo++);
         }
 
-        // Get a socket with a send request if any.
-        CUDT* u = self->m_pSndUList->pop();
-        if (u == NULL)
-        {
-            IF_DEBUG_HIGHRATE(self->m_WorkerStats.lNotReadyPop++);
-            continue;
-        }
+        self->worker_SendNext(w);
+    }
+
+    THREAD_EXIT();
+    return NULL;
+}
+
+void srt::CSndQueue::worker_SendNext(Worker& w)
+{
+    // Get a socket with a send request if any.
+    CUDT* u = w.list->pop(steady_clock::now() + sendAheadTime());
+    if (u == NULL)
+    {
+        IF_DEBUG_HIGHRATE(m_WorkerStats.lNotReadyPop++);
+        return;
+    }
 
 #define UST(field) ((u->m_b##field) ? "+" : "-") << #field << " "
-        HLOGC(qslog.Debug,
-            log << "CSndQueue: requesting packet from @" << u->socketID() << " STATUS: " << UST(Listening)
-                << UST(Connecting) << UST(Connected) << UST(Closing) << UST(Shutdown) << UST(Broken) << UST(PeerHealth)
-                << UST(Opened));
+    HLOGC(qslog.Debug,
+        log << "CSndQueue: requesting packet from @" << u->socketID() << " STATUS: " << UST(Listening)
+            << UST(Connecting) << UST(Connected) << UST(Closing) << UST(Shutdown) << UST(Broken) << UST(PeerHealth)
+            << UST(Opened));
 #undef UST
 
-        if (!u->m_bConnected || u->m_bBroken)
-        {
-            IF_DEBUG_HIGHRATE(self->m_WorkerStats.lNotReadyPop++);
-            continue;
-        }
+    if (!u->m_bConnected || u->m_bBroken)
+    {
+        IF_DEBUG_HIGHRATE(m_WorkerStats.lNotReadyPop++);
+        return;
+    }
 
-        // pack a packet from the socket
+    if (m_iSndBatchSize > 1)
+    {
+        worker_SendBatch(w, u);
+        return;
+    }
+
+    // Pack and send packets from the socket as long as they are due within
+    // the burst quantum; only then the socket is put back on the list.
+    for (int n = 0;; ++n)
+    {
         CPacket pkt;
         steady_clock::time_point next_send_time;
         sockaddr_any source_addr;
-        const bool res = u->packData((pkt), (next_send_time), (source_addr));
+        const bool res = u->packData((pkt), (next_send_time), (source_addr), (pkt.m_tsSendTime), n > 0);
 
         // Check if extracted anything to send
         if (res == false)
         {
-            IF_DEBUG_HIGHRATE(self->m_WorkerStats.lNotReadyPop++);
-            continue;
+            IF_DEBUG_HIGHRATE(m_WorkerStats.lNotReadyPop++);
+            return;
         }
 
         const sockaddr_any addr = u->m_PeerAddr;
-        if (!is_zero(next_send_time))
-            self->m_pSndUList->update(u, CSndUList::DO_RESCHEDULE, next_send_time);
+        const bool burst = !is_zero(next_send_time) && continueBurst(u, n + 1, next_send_time);
+        if (!burst && !is_zero(next_send_time))
+            w.list->update(u, CSndUList::DO_RESCHEDULE, next_send_time);
+
+        HLOGC(qslog.Debug, log << CONID() << "chn:SENDING: " << pkt.Info());
+        m_pChannel->sendto(addr, pkt, source_addr);
 
-        HLOGC(qslog.Debug, log << self->CONID() << "chn:SENDING: " << pkt.Info());
-        self->m_pChannel->sendto(addr, pkt, source_addr);
+        // Written only by this worker thread, read by the statistics.
+        ++w.sent_pkts;
+        if (!is_zero(pkt.m_tsSendTime))
+            ++w.txtime_pkts;
 
-        IF_DEBUG_HIGHRATE(self->m_WorkerStats.lSendTo++);
+        IF_DEBUG_HIGHRATE(m_WorkerStats.lSendTo++);
+        if (!burst)
+            return;
     }
+}
 
-    THREAD_EXIT();
-    return NULL;
+bool srt::CSndQueue::continueBurst(const CUDT* u, int n, const steady_clock::time_point& next_time) const
+{
+    if (n >= u->sndBurst() || !u->m_bConnected || u->m_bBroken)
+        return false;
+    return next_time <= steady_clock::now() + sendAheadTime() + microseconds_from(SND_BURST_QUANTUM_US);
+}
+
+steady_clock::time_point srt::CSndQueue::worker_SendDue(int maxsend)
+{
+    // With the shared I/O thread there's only one worker.
+    Worker&                      w     = *m_vWorkers[0];
+    const steady_clock::duration ahead = sendAheadTime();
+    for (int i = 0; i < maxsend; ++i)
+    {
+        const steady_clock::time_point next_time = w.list->getNextProcTime();
+        if (is_zero(next_time) || steady_clock::now() < next_time - ahead)
+            return is_zero(next_time) ? next_time : next_time - ahead;
+
+        worker_SendNext(w);
+    }
+    return steady_clock::now();
+}
+
+void srt::CSndQueue::worker_SendBatch(Worker& w, CUDT* u)
+{
+    int npkts = 0;
+    int burst = 0; // packets packed from u in a row
+    for (;;)
+    {
+        if (u->m_bConnected && !u->m_bBroken)
+        {
+            // Reset the packet as it was freshly constructed; packData expects that.
+            CPacket& pkt = w.batch_packets[npkts];
+            pkt.m_nHeader.clear();
+            pkt.m_PacketVector[CPacket::PV_DATA].set(NULL, 0);
+
+            steady_clock::time_point next_send_time;
+            sockaddr_any&            source_addr = w.batch_srcaddrs[npkts];
+            source_addr                          = sockaddr_any();
+            if (u->packData((pkt), (next_send_time), (source_addr), (pkt.m_tsSendTime), burst > 0))
+            {
+                w.batch_addrs[npkts] = u->m_PeerAddr;
+                ++npkts;
+                ++burst;
+
+                // Take the next packet of this socket right away if it's due within the burst.
+                if (!is_zero(next_send_time))
+                {
+                    if (npkts < m_iSndBatchSize && continueBurst(u, burst, next_send_time))
+                        continue;
+                    w.list->update(u, CSndUList::DO_RESCHEDULE, next_send_time);
+                }
+            }
+        }
+
+        if (npkts == m_iSndBatchSize)
+            break;
+
+        // Take more packets only if they are already due to be sent (or can
+        // be passed to the system ahead), so that the pacing of every socket
+        // is preserved.
+        const steady_clock::time_point ts_due    = steady_clock::now() + sendAheadTime();
+        const steady_clock::time_point next_time = w.list->getNextProcTime();
+        if (is_zero(next_time) || next_time > ts_due)
+            break;
+
+        u = w.list->pop(ts_due);
+        if (!u)
+            break;
+        burst = 0;
+    }
+
+    if (npkts == 0)
+        return;
+
+    HLOGC(qslog.Debug, log << CONID() << "chn:SENDING batch of " << npkts << " packets");
+    int       gso_pkts = 0;
+    const int ncalls   = m_pChannel->sendtoBatch(&w.batch_addrs[0], &w.batch_ppackets[0], &w.batch_srcaddrs[0], npkts, (gso_pkts));
+
+    int txtime_pkts = 0;
+    for (int i = 0; i < npkts; ++i)
+    {
+        if (!is_zero(w.batch_packets[i].m_tsSendTime))
+            ++txtime_pkts;
+    }
+
+    // Written only by this worker thread, read by the statistics.
+    w.sent_pkts = w.sent_pkts + npkts;
+    if (npkts > 1)
+    {
+        w.batch_calls   = w.batch_calls + ncalls;
+        w.batch_pkts    = w.batch_pkts + npkts;
+        w.batch_gsopkts = w.batch_gsopkts + gso_pkts;
+    }
+    if (txtime_pkts > 0)
+        w.txtime_pkts = w.txtime_pkts + txtime_pkts;
+}
+
+bool srt::CSndQueue::txtimeEnabled() const
+{
+    return m_pChannel->txtimeEnabled();
+}
+
+void srt::CSndQueue::getBatchStats(int64_t& w_calls, int64_t& w_pkts, int64_t& w_gso_pkts) const
+{
+    w_calls = w_pkts = w_gso_pkts = 0;
+    for (size_t i = 0; i < m_vWorkers.size(); ++i)
+    {
+        w_calls += m_vWorkers[i]->batch_calls;
+        w_pkts += m_vWorkers[i]->batch_pkts;
+        w_gso_pkts += m_vWorkers[i]->batch_gsopkts;
+    }
+}
+
+int64_t srt::CSndQueue::txtimePackets() const
+{
+    int64_t pkts = 0;
+    for (size_t i = 0; i < m_vWorkers.size(); ++i)
+        pkts += m_vWorkers[i]->txtime_pkts;
+    return pkts;
+}
+
+int srt::CSndQueue::busyWorkers() const
+{
+    int busy = 0;
+    for (size_t i = 0; i < m_vWorkers.size(); ++i)
+    {
+        if (m_vWorkers[i]->sent_pkts > 0)
+            ++busy;
+    }
+    return busy;
 }
 
 int srt::CSndQueue::sendto(const sockaddr_any& addr, CPacket& w_packet, const sockaddr_any& src)
@@ -615,8 +1182,7 @@ int srt::CSndQueue::sendto(const sockaddr_any& addr, CPacket& w_packet, const so
 
 //
 srt::CRcvUList::CRcvUList()
-    : m_pUList(NULL)
-    , m_pLast(NULL)
+    : m_pRequested(NULL)
 {
 }
 
@@ -625,166 +1191,238 @@ srt::CRcvUList::~CRcvUList() {}
 void srt::CRcvUList::insert(const CUDT* u)
 {
     CRNode* n        = u->m_pRNode;
-    n->m_tsTimeStamp = steady_clock::now();
-
-    if (NULL == m_pUList)
-    {
-        // empty list, insert as the single node
-        n->m_pPrev = n->m_pNext = NULL;
-        m_pLast = m_pUList = n;
-
-        return;
-    }
-
-    // always insert at the end for RcvUList
-    n->m_pPrev       = m_pLast;
-    n->m_pNext       = NULL;
-    m_pLast->m_pNext = n;
-    m_pLast          = n;
+    n->m_tsTimeStamp = steady_clock::now() + microseconds_from(CUDT::COMM_SYN_INTERVAL_US);
+    m_Wheel.insert(n);
 }
 
 void srt::CRcvUList::remove(const CUDT* u)
 {
     CRNode* n = u->m_pRNode;
-
-    if (!n->m_bOnList)
-        return;
-
-    if (NULL == n->m_pPrev)
-    {
-        // n is the first node
-        m_pUList = n->m_pNext;
-        if (NULL == m_pUList)
-            m_pLast = NULL;
-        else
-            m_pUList->m_pPrev = NULL;
-    }
-    else
-    {
-        n->m_pPrev->m_pNext = n->m_pNext;
-        if (NULL == n->m_pNext)
-        {
-            // n is the last node
-            m_pLast = n->m_pPrev;
-        }
-        else
-            n->m_pNext->m_pPrev = n->m_pPrev;
-    }
-
-    n->m_pNext = n->m_pPrev = NULL;
+    if (n->m_iSlot != -1)
+        m_Wheel.remove(n);
 }
 
-void srt::CRcvUList::update(const CUDT* u)
+void srt::CRcvUList::update(const CUDT* u, const steady_clock::time_point& ts)
 {
     CRNode* n = u->m_pRNode;
 
     if (!n->m_bOnList)
         return;
 
-    n->m_tsTimeStamp = steady_clock::now();
+    if (n->m_iSlot != -1)
+        m_Wheel.remove(n);
 
-    // if n is the last node, do not need to change
-    if (NULL == n->m_pNext)
-        return;
+    n->m_tsTimeStamp = ts;
+    m_Wheel.insert(n);
+}
+
+srt::CUDT* srt::CRcvUList::pop(const steady_clock::time_point& ts_due)
+{
+    CSNode* n = m_Wheel.pop(ts_due);
+    return n ? n->m_pUDT : NULL;
+}
 
-    if (NULL == n->m_pPrev)
+bool srt::CRcvUList::requestCheck(const CUDT* u)
+{
+    CRNode* n = u->m_pRNode;
+    if (!n->m_bOnList || n->m_bCheckRequested.exchange(true))
+        return false;
+
+    // The socket isn't deleted while the flag is set (see CUDTUnited::removeSocket).
+    CRNode* head;
+    do
     {
-        m_pUList          = n->m_pNext;
-        m_pUList->m_pPrev = NULL;
-    }
-    else
+        head                = m_pRequested;
+        n->m_pNextRequested = head;
+    } while (!m_pRequested.compare_exchange(head, n));
+    return true;
+}
+
+void srt::CRcvUList::takeRequests(const steady_clock::time_point& now)
+{
+    CRNode* n = m_pRequested.exchange(NULL);
+    while (n)
     {
-        n->m_pPrev->m_pNext = n->m_pNext;
-        n->m_pNext->m_pPrev = n->m_pPrev;
+        CRNode* const next = n->m_pNextRequested;
+        // Not on the wheel yet, if not inserted since connected.
+        if (n->m_iSlot != -1)
+            update(n->m_pUDT, now);
+        n->m_bCheckRequested = false;
+        n = next;
     }
-
-    n->m_pPrev       = m_pLast;
-    n->m_pNext       = NULL;
-    m_pLast->m_pNext = n;
-    m_pLast          = n;
 }
 
 //
 srt::CHash::CHash()
-    : m_pBucket(NULL)
+    : m_iMigrated(0)
     , m_iHashSize(0)
+    , m_iCount(0)
 {
+    m_Table.m_pEntry    = NULL;
+    m_Table.m_iShift    = 32;
+    m_OldTable.m_pEntry = NULL;
+    m_OldTable.m_iShift = 32;
 }
 
 srt::CHash::~CHash()
 {
+    delete[] m_Table.m_pEntry;
+    delete[] m_OldTable.m_pEntry;
+}
+
+void srt::CHash::init(int size)
+{
+    // Keep the table at most 3/4 full, so that the probes stay short.
+    int bits = 4;
+    while ((1 << bits) * 3 / 4 < size)
+        ++bits;
+
+    m_iHashSize      = 1 << bits;
+    m_Table.m_iShift = 32 - bits;
+    m_Table.m_pEntry = new CEntry[m_iHashSize];
     for (int i = 0; i < m_iHashSize; ++i)
+        m_Table.m_pEntry[i].m_iDist = 0;
+}
+
+srt::CHash::CEntry* srt::CHash::find_(const CTable& t, int32_t id)
+{
+    const size_t mask = t.size() - 1;
+    size_t       i    = t.slot(id);
+    for (int32_t dist = 1;; ++dist, i = (i + 1) & mask)
     {
-        CBucket* b = m_pBucket[i];
-        while (NULL != b)
+        CEntry& e = t.m_pEntry[i];
+        // An entry farther from home would have taken this slot.
+        if (e.m_iDist < dist)
+            return NULL;
+        if (e.m_iID == id)
+            return &e;
+    }
+}
+
+void srt::CHash::insert_(CTable& t, int32_t id, CUDT* u)
+{
+    CEntry ins;
+    ins.m_iID   = id;
+    ins.m_iDist = 1;
+    ins.m_pUDT  = u;
+
+    const size_t mask = t.size() - 1;
+    for (size_t i = t.slot(id);; i = (i + 1) & mask)
+    {
+        CEntry& e = t.m_pEntry[i];
+        if (e.m_iDist == 0)
         {
-            CBucket* n = b->m_pNext;
-            delete b;
-            b = n;
+            e = ins;
+            return;
         }
+
+        // Robin Hood: the entry closer to its home slot gives way.
+        if (e.m_iDist < ins.m_iDist)
+            std::swap(e, ins);
+        ++ins.m_iDist;
     }
+}
 
-    delete[] m_pBucket;
+void srt::CHash::remove_(CTable& t, CEntry* e)
+{
+    // Shift the following entries back, as long as they are not in their home slot.
+    const size_t mask = t.size() - 1;
+    size_t       i    = e - t.m_pEntry;
+    for (;;)
+    {
+        const size_t next = (i + 1) & mask;
+        if (t.m_pEntry[next].m_iDist <= 1)
+        {
+            t.m_pEntry[i].m_iDist = 0;
+            return;
+        }
+        t.m_pEntry[i] = t.m_pEntry[next];
+        --t.m_pEntry[i].m_iDist;
+        i = next;
+    }
 }
 
-void srt::CHash::init(int size)
+void srt::CHash::migrate_()
 {
-    m_pBucket = new CBucket*[size];
+    if (!m_OldTable.m_pEntry)
+        return;
 
-    for (int i = 0; i < size; ++i)
-        m_pBucket[i] = NULL;
+    // Every call moves at least as many slots as needed to empty the old table
+    // before the new one, twice as big, fills up.
+    const int oldsize = m_OldTable.size();
+    for (int step = 0; step < 4 && m_iMigrated < oldsize; ++step)
+    {
+        CEntry* e = &m_OldTable.m_pEntry[m_iMigrated];
+        if (e->m_iDist == 0)
+        {
+            ++m_iMigrated;
+            continue;
+        }
 
-    m_iHashSize = size;
+        // Removed the regular way, so that the rest of the old table can
+        // still be searched. The next entry may be shifted into this slot.
+        insert_(m_Table, e->m_iID, e->m_pUDT);
+        remove_(m_OldTable, e);
+    }
+
+    if (m_iMigrated == oldsize)
+    {
+        delete[] m_OldTable.m_pEntry;
+        m_OldTable.m_pEntry = NULL;
+    }
 }
 
 srt::CUDT* srt::CHash::lookup(int32_t id)
 {
-    // simple hash function (% hash table size); suitable for socket descriptors
-    CBucket* b = m_pBucket[id % m_iHashSize];
+    migrate_();
 
-    while (NULL != b)
-    {
-        if (id == b->m_iID)
-            return b->m_pUDT;
-        b = b->m_pNext;
-    }
+    CEntry* e = find_(m_Table, id);
+    if (!e && m_OldTable.m_pEntry)
+        e = find_(m_OldTable, id);
 
-    return NULL;
+    return e ? e->m_pUDT : NULL;
 }
 
 void srt::CHash::insert(int32_t id, CUDT* u)
 {
-    CBucket* b = m_pBucket[id % m_iHashSize];
+    remove(id);
 
-    CBucket* n = new CBucket;
-    n->m_iID   = id;
-    n->m_pUDT  = u;
-    n->m_pNext = b;
+    if (m_iCount + 1 > capacity())
+    {
+        // The previous growth must be complete. It normally is by now.
+        while (m_OldTable.m_pEntry)
+            migrate_();
+
+        m_OldTable = m_Table;
+        m_iMigrated = 0;
+
+        m_iHashSize *= 2;
+        m_Table.m_iShift -= 1;
+        m_Table.m_pEntry = new CEntry[m_iHashSize];
+        for (int i = 0; i < m_iHashSize; ++i)
+            m_Table.m_pEntry[i].m_iDist = 0;
+    }
 
-    m_pBucket[id % m_iHashSize] = n;
+    insert_(m_Table, id, u);
+    ++m_iCount;
 }
 
 void srt::CHash::remove(int32_t id)
 {
-    CBucket* b = m_pBucket[id % m_iHashSize];
-    CBucket* p = NULL;
+    migrate_();
 
-    while (NULL != b)
+    CTable* t = &m_Table;
+    CEntry* e = find_(m_Table, id);
+    if (!e && m_OldTable.m_pEntry)
     {
-        if (id == b->m_iID)
-        {
-            if (NULL == p)
-                m_pBucket[id % m_iHashSize] = b->m_pNext;
-            else
-                p->m_pNext = b->m_pNext;
-
-            delete b;
-
-            return;
-        }
+        t = &m_OldTable;
+        e = find_(m_OldTable, id);
+    }
 
-        p = b;
-        b = b->m_pNext;
+    if (e)
+    {
+        remove_(*t, e);
+        --m_iCount;
     }
 }
 
@@ -892,6 +1530,12 @@ srt::CUDT* srt::CRendezvousQueue::retrieve(const sockaddr_any& addr, SRTSOCKET&
     return NULL;
 }
 
+bool srt::CRendezvousQueue::empty() const
+{
+    ScopedLock vg(m_RIDListLock);
+    return m_lRendezvousID.empty();
+}
+
 void srt::CRendezvousQueue::updateConnStatus(EReadStatus rst, EConnectStatus cst, CUnit* unit)
 {
     vector<LinkStatusInfo> toRemove, toProcess;
@@ -1126,9 +1770,22 @@ srt::CRcvQueue::CRcvQueue()
     , m_pHash(NULL)
     , m_pChannel(NULL)
     , m_pTimer(NULL)
+    , m_pIoWorker(NULL)
     , m_iIPversion()
     , m_szPayloadSize()
     , m_bClosing(false)
+    , m_iRcvBatchSize(1)
+    , m_iBatchNext(0)
+    , m_iBatchCount(0)
+    , m_llBatchCalls(0)
+    , m_llBatchPackets(0)
+    , m_llBatchFull(0)
+    , m_zGroLength(0)
+    , m_zGroOffset(0)
+    , m_zGroSegSize(0)
+    , m_llGroBuffers(0)
+    , m_llGroPackets(0)
+    , m_llUringPackets(0)
     , m_LSLock()
     , m_pListener(NULL)
     , m_pRendezvousQueue(NULL)
@@ -1144,11 +1801,37 @@ srt::CRcvQueue::~CRcvQueue()
 {
     m_bClosing = true;
 
+#ifdef SRT_ENABLE_IOPOOL
+    if (m_pIoWorker)
+        m_pIoWorker->remove(this);
+#endif
+
     if (m_WorkerThread.joinable())
     {
         HLOGC(rslog.Debug, log << "RcvQueue: EXIT");
         m_WorkerThread.join();
     }
+
+    for (size_t i = 0; i < m_vWorkers.size(); ++i)
+    {
+        Worker* w = m_vWorkers[i];
+        {
+            ScopedLock lk(w->lock);
+            w->cond.notify_one();
+        }
+        if (w->thread.joinable())
+        {
+            HLOGC(rslog.Debug, log << "RcvQueue: EXIT processing worker " << i);
+            w->thread.join();
+        }
+
+        // The units of the packets still waiting in the tasks
+        // are those of m_pUnitQueue, deleted below.
+        delete w->units;
+        delete w->ulist;
+        releaseCond(w->cond);
+        delete w;
+    }
     releaseCond(m_BufferCond);
 
     delete m_pUnitQueue;
@@ -1172,7 +1855,7 @@ srt::CRcvQueue::~CRcvQueue()
 srt::sync::atomic<int> srt::CRcvQueue::m_counter(0);
 #endif
 
-void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CChannel* cc, CTimer* t)
+void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CChannel* cc, CTimer* t, CIoWorker* w)
 {
     m_iIPversion    = version;
     m_szPayloadSize = payload;
@@ -1186,9 +1869,37 @@ void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CCh
     m_pChannel = cc;
     m_pTimer   = t;
 
+    m_iRcvBatchSize = m_pChannel->rcvBatchSize();
+    if (m_iRcvBatchSize > 1)
+    {
+        m_vBatchUnits.resize(m_iRcvBatchSize, NULL);
+        m_vBatchPackets.resize(m_iRcvBatchSize, NULL);
+        m_vBatchAddrs.resize(m_iRcvBatchSize, sockaddr_any(version));
+    }
+
+    if (m_pChannel->groEnabled())
+    {
+        // Maximum size of a UDP datagram
+        m_vGroBuffer.resize(65535);
+        m_GroSrcAddr = sockaddr_any(version);
+    }
+
     m_pRcvUList        = new CRcvUList;
     m_pRendezvousQueue = new CRendezvousQueue;
 
+#ifdef SRT_ENABLE_IOPOOL
+    if (w)
+    {
+        // The shared thread waits for the packets itself.
+        m_pIoWorker = w;
+        m_pChannel->setRcvWait(0);
+        w->add(this);
+        return;
+    }
+#else
+    (void)w;
+#endif
+
 #if ENABLE_LOGGING
     const int cnt = ++m_counter;
     const std::string thrname = "SRT:RcvQ:w" + Sprint(cnt);
@@ -1196,12 +1907,188 @@ void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CCh
     const std::string thrname = "SRT:RcvQ:w";
 #endif
 
+    // The processing threads, if any, are started before the packets come.
+    const int nworkers = m_pChannel->rcvWorkers();
+    for (int i = 0; nworkers > 1 && i < nworkers; ++i)
+    {
+        Worker* wk = new Worker;
+        wk->queue  = this;
+        wk->units  = new CUnitQueue(qsize, (int)payload);
+        wk->ulist  = new CRcvUList;
+        setupCond(wk->cond, "RcvWorker");
+        m_vWorkers.push_back(wk);
+
+        const std::string wname = thrname + "." + Sprint(i);
+        if (!StartThread(wk->thread, CRcvQueue::processing_worker, wk, wname.c_str()))
+            throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+    }
+
     if (!StartThread(m_WorkerThread, CRcvQueue::worker, this, thrname.c_str()))
     {
         throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
     }
 }
 
+void* srt::CRcvQueue::processing_worker(void* param)
+{
+    Worker&    w    = *(Worker*)param;
+    CRcvQueue* self = w.queue;
+
+    THREAD_STATE_INIT("SRT:RcvQ:proc");
+
+    // Check the timers at least after this many packets.
+    const int MAX_TASKS_AT_ONCE = 64;
+
+    while (!self->m_bClosing)
+    {
+        Worker::Task task;
+        int          ntasks = 0;
+        for (; ntasks < MAX_TASKS_AT_ONCE && w.tasks.pop((task)); ++ntasks)
+            self->processing_Task(w, task);
+
+        INCREMENT_THREAD_ITERATIONS();
+        const steady_clock::time_point next_timers = self->processing_CheckTimers(w);
+
+        if (ntasks == 0)
+        {
+            // Sleep until a task is passed (see pushTask), but not longer
+            // than until the timers are due.
+            UniqueLock lk(w.lock);
+            w.sleeping = true;
+            if (w.tasks.empty() && !w.ulist->hasRequests() && !self->m_bClosing)
+            {
+                THREAD_PAUSED();
+                w.cond.wait_until(lk, next_timers);
+                THREAD_RESUMED();
+            }
+            w.sleeping = false;
+        }
+    }
+
+    THREAD_EXIT();
+    return NULL;
+}
+
+void srt::CRcvQueue::processing_Task(Worker& w, const Worker::Task& task)
+{
+    CUDT* const u = task.u;
+    if (task.type == Worker::TASK_ADD)
+    {
+        w.ulist->insert(u);
+        return;
+    }
+
+    if (task.type == Worker::TASK_RELEASE)
+    {
+        // No more packets will be passed for the socket, so it can be deleted.
+        u->m_pRNode->m_bOnList = false;
+        return;
+    }
+
+    CUnit* const unit = task.unit;
+    if (!u->m_bConnected || u->m_bBroken || u->m_bClosing)
+    {
+        m_pUnitQueue->makeUnitFree(unit);
+        return;
+    }
+
+    if (unit->m_Packet.isControl())
+    {
+        u->processCtrl(unit->m_Packet);
+        m_pUnitQueue->makeUnitFree(unit);
+    }
+    else
+    {
+        // The receiver buffer and the packet filter of the socket use the
+        // units of this thread, so that it's the only one that takes them.
+        CUnit* const own = w.units->getNextAvailUnit();
+        if (own)
+            own->m_Packet.copyFrom(unit->m_Packet);
+        m_pUnitQueue->makeUnitFree(unit);
+
+        if (!own)
+        {
+            LOGC(qrlog.Error, log << CUDTUnited::CONID(u->m_SocketID) << "LOCAL STORAGE DEPLETED. Dropping 1 packet.");
+            return;
+        }
+        ++w.data_pkts;
+        u->processData(own);
+    }
+
+    w.ulist->update(u, u->checkTimers());
+}
+
+steady_clock::time_point srt::CRcvQueue::processing_CheckTimers(Worker& w)
+{
+    const steady_clock::time_point now = steady_clock::now();
+    w.ulist->takeRequests(now);
+
+    CUDT* u;
+    while ((u = w.ulist->pop(now)) != NULL)
+    {
+        if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
+        {
+            w.ulist->update(u, u->checkTimers());
+        }
+        else
+        {
+            HLOGC(qrlog.Debug,
+                  log << CUDTUnited::CONID(u->m_SocketID) << " SOCKET broken, REMOVING FROM PROCESSING WORKER.");
+            // The receiving thread removes it from the hash table, and
+            // then passes it back to be released (see worker_ReleaseSockets).
+            ScopedLock lk(m_ReleasedLock);
+            m_vReleased.push_back(u);
+        }
+    }
+
+    const steady_clock::time_point next_timers = w.ulist->nextTime(now);
+    const steady_clock::time_point latest      = now + microseconds_from(MAX_TIMERS_WAIT_US);
+    return (is_zero(next_timers) || next_timers > latest) ? latest : next_timers;
+}
+
+void srt::CRcvQueue::requestTimersCheck(CUDT* u)
+{
+    if (m_vWorkers.empty())
+    {
+        // The receiving thread takes it up when it stops waiting for packets,
+        // the shared I/O thread at once.
+        const bool requested = m_pRcvUList->requestCheck(u);
+#ifdef SRT_ENABLE_IOPOOL
+        if (requested && m_pIoWorker)
+            m_pIoWorker->wakeup();
+#else
+        (void)requested;
+#endif
+        return;
+    }
+
+    Worker& w = *m_vWorkers[size_t(u->m_SocketID) % m_vWorkers.size()];
+    // The worker sets the flag before checking for the requests.
+    if (w.ulist->requestCheck(u) && w.sleeping)
+    {
+        ScopedLock lk(w.lock);
+        w.cond.notify_one();
+    }
+}
+
+bool srt::CRcvQueue::pushTask(Worker& w, const Worker::Task& task, bool wait)
+{
+    while (!w.tasks.push(task))
+    {
+        if (!wait || m_bClosing)
+            return false;
+        sync::this_thread::sleep_for(milliseconds_from(1));
+    }
+
+    // The worker sets the flag before checking for the tasks.
+    if (w.sleeping)
+    {
+        ScopedLock lk(w.lock);
+        w.cond.notify_one();
+    }
+    return true;
+}
+
 void* srt::CRcvQueue::worker(void* param)
 {
     CRcvQueue*   self = (CRcvQueue*)param;
@@ -1224,42 +2111,8 @@ void* srt::CRcvQueue::worker(void* param)
         INCREMENT_THREAD_ITERATIONS();
         if (rst == RST_OK)
         {
-            if (id < 0)
-            {
-                // User error on peer. May log something, but generally can only ignore it.
-                // XXX Think maybe about sending some "connection rejection response".
-                HLOGC(qrlog.Debug,
-                      log << self->CONID() << "RECEIVED negative socket id '" << id
-                          << "', rejecting (POSSIBLE ATTACK)");
-                continue;
-            }
-
-            // NOTE: cst state is being changed here.
-            // This state should be maintained through any next failed calls to worker_RetrieveUnit.
-            // Any error switches this to rejection, just for a case.
-
-            // Note to rendezvous connection. This can accept:
-            // - ID == 0 - take the first waiting rendezvous socket
-            // - ID > 0  - find the rendezvous socket that has this ID.
-            if (id == 0)
-            {
-                // ID 0 is for connection request, which should be passed to the listening socket or rendezvous sockets
-                cst = self->worker_ProcessConnectionRequest(unit, sa);
-            }
-            else
-            {
-                // Otherwise ID is expected to be associated with:
-                // - an enqueued rendezvous socket
-                // - a socket connected to a peer
-                cst = self->worker_ProcessAddressedPacket(id, unit, sa);
-                // CAN RETURN CONN_REJECT, but m_RejectReason is already set
-            }
-            HLOGC(qrlog.Debug, log << self->CONID() << "worker: result for the unit: " << ConnectStatusStr(cst));
-            if (cst == CONN_AGAIN)
-            {
-                HLOGC(qrlog.Debug, log << self->CONID() << "worker: packet not dispatched, continuing reading.");
+            if (!self->worker_DispatchUnit(id, unit, sa, (cst)))
                 continue;
-            }
             have_received = true;
         }
         else if (rst == RST_ERROR)
@@ -1285,112 +2138,402 @@ void* srt::CRcvQueue::worker(void* param)
         }
         // OTHERWISE: this is an "AGAIN" situation. No data was read, but the process should continue.
 
-        // take care of the timing event for all UDT sockets
-        const steady_clock::time_point curtime_minus_syn =
-            steady_clock::now() - microseconds_from(CUDT::COMM_SYN_INTERVAL_US);
-
-        CRNode* ul = self->m_pRcvUList->m_pUList;
-        while ((NULL != ul) && (ul->m_tsTimeStamp < curtime_minus_syn))
+        if (have_received)
         {
-            CUDT* u = ul->m_pUDT;
+            HLOGC(qrlog.Debug,
+                  log << "worker: RECEIVED PACKET --> updateConnStatus. cst=" << ConnectStatusStr(cst) << " id=" << id
+                      << " pkt-payload-size=" << unit->m_Packet.getLength());
+        }
 
-            if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
-            {
-                u->checkTimers();
-                self->m_pRcvUList->update(u);
-            }
-            else
-            {
-                HLOGC(qrlog.Debug,
-                      log << CUDTUnited::CONID(u->m_SocketID) << " SOCKET broken, REMOVING FROM RCV QUEUE/MAP.");
-                // the socket must be removed from Hash table first, then RcvUList
-                self->m_pHash->remove(u->m_SocketID);
-                self->m_pRcvUList->remove(u);
-                u->m_pRNode->m_bOnList = false;
-            }
+        // Wait for the next packet not longer than until the timers are due.
+        const steady_clock::duration wait = self->worker_CheckTimers(rst, cst, unit) - steady_clock::now();
+        self->m_pChannel->setRcvWait(wait > steady_clock::duration::zero() ? (int)count_microseconds(wait) : 0);
+    }
 
-            ul = self->m_pRcvUList->m_pUList;
-        }
+    HLOGC(qrlog.Debug, log << "worker: EXIT");
 
-        if (have_received)
+    THREAD_EXIT();
+    return NULL;
+}
+
+// Pass the packet to the socket that it's addressed to. Returns
+// false if it was ignored, otherwise the connection status is in @a w_cst.
+bool srt::CRcvQueue::worker_DispatchUnit(int32_t id, CUnit* unit, const sockaddr_any& sa, EConnectStatus& w_cst)
+{
+    if (id < 0)
+    {
+        // User error on peer. May log something, but generally can only ignore it.
+        // XXX Think maybe about sending some "connection rejection response".
+        HLOGC(qrlog.Debug,
+              log << CONID() << "RECEIVED negative socket id '" << id << "', rejecting (POSSIBLE ATTACK)");
+        return false;
+    }
+
+    // NOTE: cst state is being changed here.
+    // This state should be maintained through any next failed calls to worker_RetrieveUnit.
+    // Any error switches this to rejection, just for a case.
+
+    // Note to rendezvous connection. This can accept:
+    // - ID == 0 - take the first waiting rendezvous socket
+    // - ID > 0  - find the rendezvous socket that has this ID.
+    if (id == 0)
+    {
+        // ID 0 is for connection request, which should be passed to the listening socket or rendezvous sockets
+        w_cst = worker_ProcessConnectionRequest(unit, sa);
+    }
+    else
+    {
+        // Otherwise ID is expected to be associated with:
+        // - an enqueued rendezvous socket
+        // - a socket connected to a peer
+        w_cst = worker_ProcessAddressedPacket(id, unit, sa);
+        // CAN RETURN CONN_REJECT, but m_RejectReason is already set
+    }
+    HLOGC(qrlog.Debug, log << CONID() << "worker: result for the unit: " << ConnectStatusStr(w_cst));
+    if (w_cst == CONN_AGAIN)
+    {
+        HLOGC(qrlog.Debug, log << CONID() << "worker: packet not dispatched, continuing reading.");
+        return false;
+    }
+    return true;
+}
+
+steady_clock::time_point srt::CRcvQueue::worker_CheckTimers(EReadStatus rst, EConnectStatus cst, CUnit* unit)
+{
+    // take care of the timing events of the UDT sockets that are due
+    const steady_clock::time_point now = steady_clock::now();
+    m_pRcvUList->takeRequests(now);
+
+    CUDT* u;
+    while ((u = m_pRcvUList->pop(now)) != NULL)
+    {
+        if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
+        {
+            m_pRcvUList->update(u, u->checkTimers());
+        }
+        else
         {
             HLOGC(qrlog.Debug,
-                  log << "worker: RECEIVED PACKET --> updateConnStatus. cst=" << ConnectStatusStr(cst) << " id=" << id
-                      << " pkt-payload-size=" << unit->m_Packet.getLength());
+                  log << CUDTUnited::CONID(u->m_SocketID) << " SOCKET broken, REMOVING FROM RCV QUEUE/MAP.");
+            // the socket must be removed from Hash table first, then RcvUList
+            m_pHash->remove(u->m_SocketID);
+            u->m_pRNode->m_bOnList = false;
+        }
+    }
+
+    // Check connection requests status for all sockets in the RendezvousQueue.
+    // Pass the connection status from the last call of:
+    // worker_ProcessAddressedPacket --->
+    // worker_TryAsyncRend_OrStore --->
+    // CUDT::processAsyncConnectResponse --->
+    // CUDT::processConnectResponse
+    m_pRendezvousQueue->updateConnStatus(rst, cst, unit);
+
+    // XXX updateConnStatus may have removed the connector from the list,
+    // however there's still m_mBuffer in CRcvQueue for that socket to care about.
+
+    // The pending connections are updated with every SYN interval.
+    if (!m_pRendezvousQueue->empty())
+        return now + microseconds_from(CUDT::COMM_SYN_INTERVAL_US);
+
+    const steady_clock::time_point next_timers = m_pRcvUList->nextTime(now);
+    const steady_clock::time_point latest      = now + microseconds_from(MAX_TIMERS_WAIT_US);
+    return (is_zero(next_timers) || next_timers > latest) ? latest : next_timers;
+}
+
+void srt::CRcvQueue::worker_InsertNewEntries()
+{
+    // check waiting list, if new socket, insert it to the list
+    while (ifNewEntry())
+    {
+        CUDT* ne = getNewEntry();
+        if (ne)
+            worker_AddSocket(ne);
+    }
+}
+
+void srt::CRcvQueue::worker_AddSocket(CUDT* u)
+{
+    HLOGC(qrlog.Debug,
+          log << CUDTUnited::CONID(u->m_SocketID) << " SOCKET pending for connection - ADDING TO RCV QUEUE/MAP");
+
+    m_pHash->insert(u->m_SocketID, u);
+    if (m_vWorkers.empty())
+    {
+        m_pRcvUList->insert(u);
+        return;
+    }
+
+    const Worker::Task task = {Worker::TASK_ADD, u, NULL};
+    pushTask(*m_vWorkers[size_t(u->m_SocketID) % m_vWorkers.size()], task, true);
+}
+
+void srt::CRcvQueue::worker_HandOver(CUDT* u, CUnit* unit)
+{
+    // The unit stays taken until the processing thread has copied the packet.
+    m_pUnitQueue->makeUnitTaken(unit);
+
+    const Worker::Task task = {Worker::TASK_PACKET, u, unit};
+    if (!pushTask(*m_vWorkers[size_t(u->m_SocketID) % m_vWorkers.size()], task, false))
+    {
+        // It will be recovered as a lost one.
+        LOGC(qrlog.Warn,
+             log << CUDTUnited::CONID(u->m_SocketID) << "processing worker overloaded. Dropping 1 packet.");
+        m_pUnitQueue->makeUnitAvail(unit);
+    }
+}
+
+void srt::CRcvQueue::worker_ReleaseSockets()
+{
+    if (m_vWorkers.empty())
+        return;
+
+    std::vector<CUDT*> released;
+    {
+        ScopedLock lk(m_ReleasedLock);
+        if (m_vReleased.empty())
+            return;
+        released.swap(m_vReleased);
+    }
+
+    for (size_t i = 0; i < released.size(); ++i)
+    {
+        CUDT* u = released[i];
+        m_pHash->remove(u->m_SocketID);
+
+        // After the packets already passed to it.
+        const Worker::Task task = {Worker::TASK_RELEASE, u, NULL};
+        pushTask(*m_vWorkers[size_t(u->m_SocketID) % m_vWorkers.size()], task, true);
+    }
+}
+
+srt::EReadStatus srt::CRcvQueue::worker_RetrieveUnit(int32_t& w_id, CUnit*& w_unit, sockaddr_any& w_addr)
+{
+#if !USE_BUSY_WAITING
+    // This might be not really necessary, and probably
+    // not good for extensive bidirectional communication.
+    m_pTimer->tick();
+#endif
+
+    worker_InsertNewEntries();
+    worker_ReleaseSockets();
+
+    if (m_pChannel->groEnabled())
+        return worker_RetrieveGroUnit((w_id), (w_unit), (w_addr));
+
+    if (m_iRcvBatchSize > 1)
+    {
+        // Dispatch the packets remaining from the last batch before reading again.
+        if (m_iBatchNext == m_iBatchCount)
+        {
+            const EReadStatus rst = worker_RetrieveBatch();
+            if (rst != RST_OK)
+                return rst;
         }
+        return worker_NextBatchUnit((w_id), (w_unit), (w_addr));
+    }
+
+    // find next available slot for incoming packet
+    w_unit = m_pUnitQueue->getNextAvailUnit();
+    if (!w_unit)
+    {
+        // no space, skip this packet
+        CPacket temp;
+        temp.allocate(m_szPayloadSize);
+        THREAD_PAUSED();
+        EReadStatus rst = m_pChannel->recvfrom((w_addr), (temp));
+        THREAD_RESUMED();
+        // Note: this will print nothing about the packet details unless heavy logging is on.
+        LOGC(qrlog.Error, log << CONID() << "LOCAL STORAGE DEPLETED. Dropping 1 packet: " << temp.Info());
+
+        // Be transparent for RST_ERROR, but ignore the correct
+        // data read and fake that the packet was dropped.
+        return rst == RST_ERROR ? RST_ERROR : RST_AGAIN;
+    }
+
+    w_unit->m_Packet.setLength(m_szPayloadSize);
+
+    // reading next incoming packet, recvfrom returns -1 is nothing has been received
+    THREAD_PAUSED();
+    EReadStatus rst = m_pChannel->recvfrom((w_addr), (w_unit->m_Packet));
+    THREAD_RESUMED();
 
-        // Check connection requests status for all sockets in the RendezvousQueue.
-        // Pass the connection status from the last call of:
-        // worker_ProcessAddressedPacket --->
-        // worker_TryAsyncRend_OrStore --->
-        // CUDT::processAsyncConnectResponse --->
-        // CUDT::processConnectResponse
-        self->m_pRendezvousQueue->updateConnStatus(rst, cst, unit);
+    if (rst == RST_OK)
+    {
+        // Written only by the worker thread, read by the statistics.
+        if (m_pChannel->iouringEnabled())
+            ++m_llUringPackets;
+        w_id = w_unit->m_Packet.id();
+        HLOGC(qrlog.Debug,
+              log << "INCOMING PACKET: FROM=" << w_addr.str() << " BOUND=" << m_pChannel->bindAddressAny().str() << " "
+                  << w_unit->m_Packet.Info());
+    }
+    return rst;
+}
 
-        // XXX updateConnStatus may have removed the connector from the list,
-        // however there's still m_mBuffer in CRcvQueue for that socket to care about.
+srt::EReadStatus srt::CRcvQueue::worker_RetrieveBatch()
+{
+    // Reserve units for the whole batch. They must be marked as taken
+    // for getNextAvailUnit() not to return the same unit again.
+    const int nunits = m_pUnitQueue->takeUnits(&m_vBatchUnits[0], m_iRcvBatchSize);
+    for (int i = 0; i < nunits; ++i)
+    {
+        CUnit* u = m_vBatchUnits[i];
+        u->m_Packet.setLength(m_szPayloadSize);
+        m_vBatchPackets[i] = &u->m_Packet;
+    }
+
+    if (nunits == 0)
+    {
+        // no space, skip this packet
+        CPacket temp;
+        temp.allocate(m_szPayloadSize);
+        sockaddr_any addr(m_iIPversion);
+        THREAD_PAUSED();
+        EReadStatus rst = m_pChannel->recvfrom((addr), (temp));
+        THREAD_RESUMED();
+        LOGC(qrlog.Error, log << CONID() << "LOCAL STORAGE DEPLETED. Dropping 1 packet: " << temp.Info());
+        return rst == RST_ERROR ? RST_ERROR : RST_AGAIN;
+    }
+
+    int nrecv = 0;
+    THREAD_PAUSED();
+    const EReadStatus rst = m_pChannel->recvfromBatch(&m_vBatchAddrs[0], &m_vBatchPackets[0], nunits, (nrecv));
+    THREAD_RESUMED();
+
+    // Return the units that were not filled in.
+    for (int i = nrecv; i < nunits; ++i)
+        m_pUnitQueue->makeUnitAvail(m_vBatchUnits[i]);
+
+    m_iBatchNext  = 0;
+    m_iBatchCount = nrecv;
+
+    if (rst == RST_OK)
+    {
+        // Written only by the worker thread, read by the statistics.
+        ++m_llBatchCalls;
+        m_llBatchPackets = m_llBatchPackets + nrecv;
+        if (nrecv == m_iRcvBatchSize)
+            ++m_llBatchFull;
+        if (m_pChannel->iouringEnabled())
+            m_llUringPackets = m_llUringPackets + nrecv;
+        HLOGC(qrlog.Debug, log << CONID() << "worker: read batch of " << nrecv << "/" << nunits << " packets");
+    }
+    return rst;
+}
+
+srt::EReadStatus srt::CRcvQueue::worker_NextBatchUnit(int32_t& w_id, CUnit*& w_unit, sockaddr_any& w_addr)
+{
+    while (m_iBatchNext < m_iBatchCount)
+    {
+        CUnit* u = m_vBatchUnits[m_iBatchNext];
+        const sockaddr_any& addr = m_vBatchAddrs[m_iBatchNext];
+        ++m_iBatchNext;
+
+        // The unit is now handed over to the worker the same way as in case of
+        // non-batched reading: available, until the receiver buffer takes it.
+        m_pUnitQueue->makeUnitAvail(u);
+
+        // Packets rejected by the channel have the length set to -1.
+        if (u->m_Packet.getLength() == size_t(-1))
+            continue;
+
+        w_unit = u;
+        w_addr = addr;
+        w_id   = u->m_Packet.id();
+        HLOGC(qrlog.Debug,
+              log << "INCOMING PACKET: FROM=" << w_addr.str() << " BOUND=" << m_pChannel->bindAddressAny().str() << " "
+                  << w_unit->m_Packet.Info());
+        return RST_OK;
     }
 
-    HLOGC(qrlog.Debug, log << "worker: EXIT");
-
-    THREAD_EXIT();
-    return NULL;
+    return RST_AGAIN;
 }
 
-srt::EReadStatus srt::CRcvQueue::worker_RetrieveUnit(int32_t& w_id, CUnit*& w_unit, sockaddr_any& w_addr)
+void srt::CRcvQueue::getBatchStats(int64_t& w_calls, int64_t& w_pkts, int64_t& w_full) const
 {
-#if !USE_BUSY_WAITING
-    // This might be not really necessary, and probably
-    // not good for extensive bidirectional communication.
-    m_pTimer->tick();
-#endif
+    w_calls = m_llBatchCalls;
+    w_pkts  = m_llBatchPackets;
+    w_full  = m_llBatchFull;
+}
 
-    // check waiting list, if new socket, insert it to the list
-    while (ifNewEntry())
+srt::EReadStatus srt::CRcvQueue::worker_RetrieveGroUnit(int32_t& w_id, CUnit*& w_unit, sockaddr_any& w_addr)
+{
+    // Read the next buffer when all packets from the last one are dispatched.
+    if (m_zGroOffset >= m_zGroLength)
     {
-        CUDT* ne = getNewEntry();
-        if (ne)
+        m_zGroOffset = m_zGroLength = 0;
+
+        size_t len = 0, segsize = 0;
+        THREAD_PAUSED();
+        const EReadStatus rst = m_pChannel->recvfromGro((m_GroSrcAddr), &m_vGroBuffer[0], m_vGroBuffer.size(),
+                                                        (len), (segsize), (m_GroDestAddr), (m_tsGroArrival));
+        THREAD_RESUMED();
+        if (rst != RST_OK)
+            return rst;
+
+        m_zGroLength  = len;
+        m_zGroSegSize = segsize;
+        if (len > segsize)
         {
-            HLOGC(qrlog.Debug,
-                  log << CUDTUnited::CONID(ne->m_SocketID)
-                      << " SOCKET pending for connection - ADDING TO RCV QUEUE/MAP");
-            m_pRcvUList->insert(ne);
-            m_pHash->insert(ne->m_SocketID, ne);
+            // Written only by the worker thread, read by the statistics.
+            ++m_llGroBuffers;
+            m_llGroPackets = m_llGroPackets + int64_t((len + segsize - 1) / segsize);
+            HLOGC(qrlog.Debug, log << CONID() << "worker: GRO buffer of " << len << " bytes, segment " << segsize);
         }
     }
-    // find next available slot for incoming packet
+
+    // Split out the next packet. Only the last one may be shorter.
+    const char*  seg    = &m_vGroBuffer[m_zGroOffset];
+    const size_t seglen = std::min(m_zGroSegSize, m_zGroLength - m_zGroOffset);
+    m_zGroOffset += seglen;
+
+    if (seglen < CPacket::HDR_SIZE || seglen - CPacket::HDR_SIZE > m_szPayloadSize)
+    {
+        HLOGC(qrlog.Debug, log << CONID() << "worker: GRO segment of invalid size " << seglen << " - dropping");
+        return RST_AGAIN;
+    }
+
     w_unit = m_pUnitQueue->getNextAvailUnit();
     if (!w_unit)
     {
-        // no space, skip this packet
-        CPacket temp;
-        temp.allocate(m_szPayloadSize);
-        THREAD_PAUSED();
-        EReadStatus rst = m_pChannel->recvfrom((w_addr), (temp));
-        THREAD_RESUMED();
-        // Note: this will print nothing about the packet details unless heavy logging is on.
-        LOGC(qrlog.Error, log << CONID() << "LOCAL STORAGE DEPLETED. Dropping 1 packet: " << temp.Info());
-
-        // Be transparent for RST_ERROR, but ignore the correct
-        // data read and fake that the packet was dropped.
-        return rst == RST_ERROR ? RST_ERROR : RST_AGAIN;
+        LOGC(qrlog.Error, log << CONID() << "LOCAL STORAGE DEPLETED. Dropping 1 packet.");
+        return RST_AGAIN;
     }
 
-    w_unit->m_Packet.setLength(m_szPayloadSize);
+    CPacket& pkt = w_unit->m_Packet;
+    memcpy(pkt.m_nHeader.raw(), seg, CPacket::HDR_SIZE);
+    memcpy(pkt.m_pcData, seg + CPacket::HDR_SIZE, seglen - CPacket::HDR_SIZE);
+    pkt.setLength(seglen - CPacket::HDR_SIZE);
+    pkt.toHostByteOrder();
+    if (m_GroDestAddr.family() != AF_UNSPEC)
+        pkt.m_DestAddr = m_GroDestAddr;
+    pkt.m_tsArrival  = m_tsGroArrival;
+    pkt.m_bCoalesced = m_zGroLength > m_zGroSegSize;
 
-    // reading next incoming packet, recvfrom returns -1 is nothing has been received
-    THREAD_PAUSED();
-    EReadStatus rst = m_pChannel->recvfrom((w_addr), (w_unit->m_Packet));
-    THREAD_RESUMED();
+    w_addr = m_GroSrcAddr;
+    w_id   = pkt.id();
+    HLOGC(qrlog.Debug,
+          log << "INCOMING PACKET: FROM=" << w_addr.str() << " BOUND=" << m_pChannel->bindAddressAny().str() << " "
+              << pkt.Info());
+    return RST_OK;
+}
 
-    if (rst == RST_OK)
+void srt::CRcvQueue::getGroStats(int64_t& w_bufs, int64_t& w_pkts) const
+{
+    w_bufs = m_llGroBuffers;
+    w_pkts = m_llGroPackets;
+}
+
+int srt::CRcvQueue::busyWorkers() const
+{
+    int busy = 0;
+    for (size_t i = 0; i < m_vWorkers.size(); ++i)
     {
-        w_id = w_unit->m_Packet.id();
-        HLOGC(qrlog.Debug,
-              log << "INCOMING PACKET: FROM=" << w_addr.str() << " BOUND=" << m_pChannel->bindAddressAny().str() << " "
-                  << w_unit->m_Packet.Info());
+        if (m_vWorkers[i]->data_pkts > 0)
+            ++busy;
     }
-    return rst;
+    return busy;
 }
 
 srt::EConnectStatus srt::CRcvQueue::worker_ProcessConnectionRequest(CUnit* unit, const sockaddr_any& addr)
@@ -1439,6 +2582,14 @@ srt::EConnectStatus srt::CRcvQueue::worker_ProcessConnectionRequest(CUnit* unit,
 srt::EConnectStatus srt::CRcvQueue::worker_ProcessAddressedPacket(int32_t id, CUnit* unit, const sockaddr_any& addr)
 {
     CUDT* u = m_pHash->lookup(id);
+    if (!u && ifNewEntry())
+    {
+        // The socket might have been connected while this thread was waiting
+        // for this packet, which happens when the peer sends data immediately.
+        worker_InsertNewEntries();
+        u = m_pHash->lookup(id);
+    }
+
     if (!u)
     {
         // Pass this to either async rendezvous connection,
@@ -1469,13 +2620,18 @@ srt::EConnectStatus srt::CRcvQueue::worker_ProcessAddressedPacket(int32_t id, CU
         return CONN_REJECT;
     }
 
+    if (!m_vWorkers.empty())
+    {
+        worker_HandOver(u, unit);
+        return CONN_RUNNING;
+    }
+
     if (unit->m_Packet.isControl())
         u->processCtrl(unit->m_Packet);
     else
         u->processData(unit);
 
-    u->checkTimers();
-    m_pRcvUList->update(u);
+    m_pRcvUList->update(u, u->checkTimers());
 
     return CONN_RUNNING;
 }
@@ -1575,11 +2731,7 @@ srt::EConnectStatus srt::CRcvQueue::worker_TryAsyncRend_OrStore(int32_t id, CUni
             // differently throughout the functions).
             if (ne)
             {
-                HLOGC(cnlog.Debug,
-                      log << CUDTUnited::CONID(ne->m_SocketID)
-                          << " SOCKET pending for connection - ADDING TO RCV QUEUE/MAP");
-                m_pRcvUList->insert(ne);
-                m_pHash->insert(ne->m_SocketID, ne);
+                worker_AddSocket(ne);
 
                 // The current situation is that this has passed processAsyncConnectResponse, but actually
                 // this packet *SHOULD HAVE BEEN* handled by worker_ProcessAddressedPacket, however the
@@ -1676,6 +2828,8 @@ int srt::CRcvQueue::recvfrom(int32_t id, CPacket& w_packet)
     memcpy((w_packet.m_pcData), newpkt->m_pcData, newpkt->getLength());
     w_packet.setLength(newpkt->getLength());
     w_packet.m_DestAddr = newpkt->m_DestAddr;
+    w_packet.m_tsArrival = newpkt->m_tsArrival;
+    w_packet.m_bCoalesced = newpkt->m_bCoalesced;
 
     delete newpkt;
 
@@ -1785,6 +2939,459 @@ void srt::CRcvQueue::storePktClone(int32_t id, const CPacket& pkt)
     }
 }
 
+#ifdef SRT_ENABLE_IOPOOL
+srt::CIoWorker::CIoWorker()
+    : m_bClosing(false)
+    , m_bWaiting(false)
+    , m_iLoad(0)
+    , m_iEpoll(-1)
+    , m_iEventFd(-1)
+    , m_iTimerFd(-1)
+{
+}
+
+srt::CIoWorker::~CIoWorker()
+{
+    m_bClosing = true;
+    if (m_Thread.joinable())
+    {
+        const uint64_t one = 1;
+        if (::write(m_iEventFd, &one, sizeof one) == -1)
+        {
+            // Can fail only if the counter is already set.
+        }
+        m_Thread.join();
+    }
+
+    for (size_t i = 0; i < m_vEntries.size(); ++i)
+        delete m_vEntries[i];
+
+    if (m_iTimerFd != -1)
+        ::close(m_iTimerFd);
+    if (m_iEventFd != -1)
+        ::close(m_iEventFd);
+    if (m_iEpoll != -1)
+        ::close(m_iEpoll);
+}
+
+void srt::CIoWorker::start(int index)
+{
+    m_iEpoll   = ::epoll_create1(EPOLL_CLOEXEC);
+    m_iEventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_iTimerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_iEpoll == -1 || m_iEventFd == -1 || m_iTimerFd == -1)
+        throw CUDTException(MJ_SETUP, MN_NONE, errno);
+
+    // These are recognized by the address of the member holding them.
+    epoll_event ev;
+    ev.events   = EPOLLIN;
+    ev.data.ptr = &m_iEventFd;
+    if (::epoll_ctl(m_iEpoll, EPOLL_CTL_ADD, m_iEventFd, &ev) == -1)
+        throw CUDTException(MJ_SETUP, MN_NONE, errno);
+    ev.data.ptr = &m_iTimerFd;
+    if (::epoll_ctl(m_iEpoll, EPOLL_CTL_ADD, m_iTimerFd, &ev) == -1)
+        throw CUDTException(MJ_SETUP, MN_NONE, errno);
+
+    const std::string thrname = "SRT:IoW" + Sprint(index);
+    if (!StartThread(m_Thread, CIoWorker::worker, this, thrname.c_str()))
+        throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+}
+
+void srt::CIoWorker::add(CSndQueue* q)
+{
+    Entry* e = new Entry;
+    e->sndq  = q;
+    addEntry(e, -1);
+}
+
+void srt::CIoWorker::add(CRcvQueue* q)
+{
+    Entry* e = new Entry;
+    e->rcvq  = q;
+    e->addr  = sockaddr_any(q->getIPversion());
+    addEntry(e, q->m_pChannel->pollDescriptor());
+}
+
+void srt::CIoWorker::addEntry(Entry* e, int fd)
+{
+    e->fd = fd;
+    if (fd != -1)
+    {
+        epoll_event ev;
+        ev.events   = EPOLLIN;
+        ev.data.ptr = e;
+        if (::epoll_ctl(m_iEpoll, EPOLL_CTL_ADD, fd, &ev) == -1)
+        {
+            const int err = errno;
+            delete e;
+            throw CUDTException(MJ_SETUP, MN_NONE, err);
+        }
+    }
+
+    {
+        ScopedLock lg(m_ListLock);
+        m_vEntries.push_back(e);
+    }
+    ++m_iLoad;
+
+    // Let the thread pick up the new entry.
+    const uint64_t one = 1;
+    if (::write(m_iEventFd, &one, sizeof one) == -1)
+    {
+        // Can fail only if the counter is already set.
+    }
+}
+
+void srt::CIoWorker::remove(const CSndQueue* q)
+{
+    removeEntry(q);
+}
+
+void srt::CIoWorker::remove(const CRcvQueue* q)
+{
+    removeEntry(q);
+}
+
+void srt::CIoWorker::removeEntry(const void* q)
+{
+    Entry* e = NULL;
+    {
+        ScopedLock lg(m_ListLock);
+        for (size_t i = 0; i < m_vEntries.size(); ++i)
+        {
+            Entry* x = m_vEntries[i];
+            if ((x->sndq == q || x->rcvq == q) && !x->removed)
+            {
+                e = x;
+                break;
+            }
+        }
+    }
+
+    if (!e)
+        return;
+
+    // Wait until the thread is done with this queue. The entry
+    // is then deleted by the thread, after this lock is released.
+    ScopedLock eg(e->lock);
+    if (e->fd != -1)
+        ::epoll_ctl(m_iEpoll, EPOLL_CTL_DEL, e->fd, NULL);
+    --m_iLoad;
+    e->removed = true;
+}
+
+void srt::CIoWorker::wakeup()
+{
+    if (!m_bWaiting)
+        return;
+
+    const uint64_t one = 1;
+    if (::write(m_iEventFd, &one, sizeof one) == -1)
+    {
+        // Can fail only if the counter is already set.
+    }
+}
+
+// Receive and dispatch the packets as in CRcvQueue::worker.
+// Returns true if there may be more packets to receive.
+bool srt::CIoWorker::receive(Entry& e)
+{
+    CRcvQueue& q = *e.rcvq;
+    for (int i = 0; i < MAX_PACKETS_AT_ONCE; ++i)
+    {
+        e.rst = q.worker_RetrieveUnit((e.id), (e.unit), (e.addr));
+        if (e.rst == RST_AGAIN)
+            return false;
+
+        if (e.rst == RST_ERROR)
+        {
+            if (!q.m_bClosing)
+            {
+                LOGC(qrlog.Fatal,
+                     log << "CChannel reported ERROR DURING TRANSMISSION - IPE. STOPPING receiving anyway.");
+            }
+            e.cst = CONN_REJECT;
+            ::epoll_ctl(m_iEpoll, EPOLL_CTL_DEL, e.fd, NULL);
+            return false;
+        }
+
+        q.worker_DispatchUnit(e.id, e.unit, e.addr, (e.cst));
+    }
+    return true;
+}
+
+void srt::CIoWorker::wait(const steady_clock::time_point& next)
+{
+    int timeout_ms = -1;
+    if (!is_zero(next))
+    {
+        const steady_clock::duration timeout = next - steady_clock::now();
+        if (timeout <= steady_clock::duration::zero())
+        {
+            timeout_ms = 0;
+        }
+        else
+        {
+            // The timer is used because the epoll timeout is in milliseconds.
+            const int64_t   us = count_microseconds(timeout);
+            itimerspec      its;
+            memset(&its, 0, sizeof its);
+            its.it_value.tv_sec  = time_t(us / 1000000);
+            its.it_value.tv_nsec = long(us % 1000000) * 1000;
+            if (its.it_value.tv_nsec == 0 && its.it_value.tv_sec == 0)
+                its.it_value.tv_nsec = 1000;
+            ::timerfd_settime(m_iTimerFd, 0, &its, NULL);
+        }
+    }
+
+    epoll_event events[MAX_PACKETS_AT_ONCE];
+    const int   nev = ::epoll_wait(m_iEpoll, events, MAX_PACKETS_AT_ONCE, timeout_ms);
+    m_bWaiting      = false;
+
+    for (int i = 0; i < nev; ++i)
+    {
+        void* const ptr = events[i].data.ptr;
+        if (ptr == &m_iEventFd || ptr == &m_iTimerFd)
+        {
+            uint64_t count;
+            if (::read(*(int*)ptr, &count, sizeof count) == -1)
+            {
+                // Already read.
+            }
+            continue;
+        }
+
+        // The entry isn't deleted before the next round.
+        ((Entry*)ptr)->ready = true;
+    }
+}
+
+void* srt::CIoWorker::worker(void* param)
+{
+    CIoWorker* self = (CIoWorker*)param;
+
+    THREAD_STATE_INIT("SRT:IoWorker");
+
+    while (!self->m_bClosing)
+    {
+        INCREMENT_THREAD_ITERATIONS();
+
+        {
+            ScopedLock lg(self->m_ListLock);
+            vector<Entry*>::iterator last = self->m_vEntries.begin();
+            for (vector<Entry*>::iterator i = self->m_vEntries.begin(); i != self->m_vEntries.end(); ++i)
+            {
+                Entry* e = *i;
+                if (e->removed)
+                {
+                    // Synchronize with the end of removeEntry().
+                    enterCS(e->lock);
+                    leaveCS(e->lock);
+                    delete e;
+                    continue;
+                }
+                *last++ = e;
+            }
+            self->m_vEntries.erase(last, self->m_vEntries.end());
+            self->m_vActive = self->m_vEntries;
+        }
+
+        // Any new packet to send since now must wake up the thread.
+        self->m_bWaiting = true;
+
+        steady_clock::time_point next;
+        bool                     busy = false;
+        for (size_t i = 0; i < self->m_vActive.size(); ++i)
+        {
+            Entry&     e = *self->m_vActive[i];
+            ScopedLock eg(e.lock);
+            if (e.removed)
+                continue;
+
+            steady_clock::time_point due;
+            if (e.sndq)
+            {
+                if (e.sndq->m_bClosing)
+                    continue;
+
+                due = e.sndq->worker_SendDue(MAX_PACKETS_AT_ONCE);
+            }
+            else
+            {
+                if (e.rcvq->m_bClosing || e.rst == RST_ERROR)
+                    continue;
+
+                bool received = false;
+                if (e.ready)
+                {
+                    e.ready  = self->receive(e);
+                    received = true;
+                    busy     = busy || e.ready;
+                }
+
+                const steady_clock::time_point now = steady_clock::now();
+                if (received || now >= e.next_timers || e.rcvq->m_pRcvUList->hasRequests())
+                {
+                    // Sockets connected since the last packet
+                    // must get on the list without waiting for one.
+                    e.rcvq->worker_InsertNewEntries();
+                    e.next_timers = e.rcvq->worker_CheckTimers(e.rst, e.cst, e.unit);
+                }
+                due = e.next_timers;
+            }
+
+            if (!is_zero(due) && (is_zero(next) || due < next))
+                next = due;
+        }
+
+        if (busy)
+            next = steady_clock::now();
+
+        THREAD_PAUSED();
+        self->wait(next);
+        THREAD_RESUMED();
+    }
+
+    THREAD_EXIT();
+    return NULL;
+}
+#endif
+
+srt::CTsbPdWorker::CTsbPdWorker()
+    : m_bClosing(false)
+    , m_iLoad(0)
+    , m_pCurrent(NULL)
+{
+    setupMutex(m_Lock, "TsbPdWorker");
+    setupCond(m_Cond, "TsbPdWorker");
+    setupCond(m_DoneCond, "TsbPdWorkerDone");
+}
+
+srt::CTsbPdWorker::~CTsbPdWorker()
+{
+    m_bClosing = true;
+    if (m_Thread.joinable())
+    {
+        CSync::lock_notify_one(m_Cond, m_Lock);
+        m_Thread.join();
+    }
+
+    releaseCond(m_DoneCond);
+    releaseCond(m_Cond);
+    releaseMutex(m_Lock);
+}
+
+void srt::CTsbPdWorker::start(int index)
+{
+    const std::string thrname = "SRT:TsbPdW" + Sprint(index);
+    if (!StartThread(m_Thread, CTsbPdWorker::worker, this, thrname.c_str()))
+        throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+}
+
+void srt::CTsbPdWorker::add(CUDT* u)
+{
+    CSNode* n  = u->m_pTsbPdNode;
+    n->m_pUDT  = u;
+    n->m_pPrev = n->m_pNext = NULL;
+    n->m_iSlot = -1;
+
+    ++m_iLoad;
+    ScopedLock lk(m_Lock);
+    schedule(n, steady_clock::now());
+}
+
+void srt::CTsbPdWorker::remove(CUDT* u)
+{
+    UniqueLock lk(m_Lock);
+    while (m_pCurrent == u)
+        m_DoneCond.wait(lk);
+
+    CSNode* n = u->m_pTsbPdNode;
+    if (n->m_iSlot != -1)
+        m_Wheel.remove(n);
+    // Ignore the wakeups from now on.
+    n->m_pUDT = NULL;
+    --m_iLoad;
+}
+
+void srt::CTsbPdWorker::wakeup(CUDT* u)
+{
+    ScopedLock lk(m_Lock);
+    CSNode* n = u->m_pTsbPdNode;
+    if (n->m_pUDT)
+        schedule(n, steady_clock::now());
+}
+
+// [[using locked(m_Lock)]]
+void srt::CTsbPdWorker::schedule(CSNode* n, const steady_clock::time_point& ts)
+{
+    if (n->m_iSlot != -1)
+    {
+        if (n->m_tsTimeStamp <= ts)
+            return;
+        m_Wheel.remove(n);
+    }
+
+    const bool earliest = m_Wheel.isEarliest(ts);
+    n->m_tsTimeStamp    = ts;
+    m_Wheel.insert(n);
+    if (earliest)
+        m_Cond.notify_one();
+}
+
+void* srt::CTsbPdWorker::worker(void* param)
+{
+    CTsbPdWorker* self = (CTsbPdWorker*)param;
+
+    THREAD_STATE_INIT("SRT:TsbPdWorker");
+
+    UniqueLock lk(self->m_Lock);
+    while (!self->m_bClosing)
+    {
+        INCREMENT_THREAD_ITERATIONS();
+
+        const steady_clock::time_point now = steady_clock::now();
+        CSNode* n = self->m_Wheel.pop(now);
+        if (!n)
+        {
+            const steady_clock::time_point next = self->m_Wheel.nextTime(now);
+            THREAD_PAUSED();
+            if (is_zero(next))
+                self->m_Cond.wait(lk);
+            else
+                self->m_Cond.wait_until(lk, next);
+            THREAD_RESUMED();
+            continue;
+        }
+
+        // The socket can't be removed while it's being checked, and the
+        // wakeups coming in the meantime put it back on the wheel.
+        CUDT* u = n->m_pUDT;
+        self->m_pCurrent = u;
+        steady_clock::time_point next;
+        {
+            InvertedLock unlocked(self->m_Lock);
+            UniqueLock   recvlock(u->m_RecvLock);
+            if (!u->m_bClosing)
+            {
+#if ENABLE_BONDING
+                next = u->tsbpdCheck(recvlock, NULL);
+#else
+                next = u->tsbpdCheck(recvlock);
+#endif
+            }
+        }
+        self->m_pCurrent = NULL;
+
+        if (!is_zero(next))
+            self->schedule(n, next);
+        self->m_DoneCond.notify_all();
+    }
+
+    THREAD_EXIT();
+    return NULL;
+}
+
 void srt::CMultiplexer::destroy()
 {
     // Reverse order of the assigned.
@@ -63,17 +63,37 @@ modified by
 #include <queue>
 #include <vector>
 
+// The shared I/O threads (srt_setiothreads) wait for
+// the sockets and timers with the system epoll.
+#ifdef LINUX
+#define SRT_ENABLE_IOPOOL 1
+#endif
+
 namespace srt
 {
 class CChannel;
 class CUDT;
+class CIoWorker;
+class CTsbPdWorker;
 
 struct CUnit
 {
     CPacket m_Packet; // packet
     sync::atomic<bool> m_bTaken; // true if the unit is is use (can be stored in the RCV buffer).
+
+    CUnit* m_pNextFree; // next on the list of free or returned units of CUnitQueue
+    // Previous on the list of free units of CUnitQueue. Only valid from the second
+    // unit up to the last one put there by makeUnitAvail(), as only these are taken
+    // out of order, so that the returned units are taken over without walking them.
+    CUnit* m_pPrevFree;
 };
 
+/// The pool of units for the received packets, shared by the sockets of a
+/// multiplexer. The free units are kept on a doubly linked list, so they are
+/// taken, also out of order, and freed in O(1). Any thread can free a unit, and it goes onto a separate
+/// lock-free list of returned units, which the receiving thread moves onto
+/// its free list when that runs out. A block of units that is no longer
+/// used is released again when the use drops below 25%.
 class CUnitQueue
 {
 public:
@@ -90,15 +110,34 @@ public:
 
 public:
     /// @brief Find an available unit for incoming packet. Allocate new units if 90% or more are in use.
+    /// The same unit is returned again until it's made taken.
     /// @note This function is not thread-safe. Currently only CRcvQueue::worker thread calls it, thus
     /// it is not an issue. However, must be protected if used from several threads in the future.
     /// @return Pointer to the available unit, NULL if not found.
     CUnit* getNextAvailUnit();
 
+    /// @brief Take up to @a count available units at once, as getNextAvailUnit() and
+    /// makeUnitTaken() would do for each. The same thread restrictions apply.
+    /// @param w_units [out] the taken units.
+    /// @return the number of units taken.
+    int takeUnits(CUnit** w_units, int count);
+
+    /// Return a taken unit to the queue. Can be called from any thread.
     void makeUnitFree(CUnit* unit);
 
+    /// Return a taken unit as the next available one, to be taken again
+    /// by makeUnitTaken() or returned by getNextAvailUnit().
+    /// Only the thread calling getNextAvailUnit() may call it.
+    void makeUnitAvail(CUnit* unit);
+
+    /// Mark an available unit as taken. Only the thread calling getNextAvailUnit() may call it.
     void makeUnitTaken(CUnit* unit);
 
+    /// The number of calls of getNextAvailUnit() between the checks if a block
+    /// of units can be released, when less than 25% of the units are in use.
+    /// The period is doubled (up to 64 times) after each check that fails.
+    static const int SHRINK_CHECK_PERIOD = 4096;
+
 private:
     struct CQEntry
     {
@@ -110,10 +149,27 @@ private:
     };
 
     /// Increase the unit queue size (by @a m_iBlockSize units).
-    /// Uses m_mtx to protect access and changes of the queue state.
     /// @return 0: success, -1: failure.
     int increase_();
 
+    /// Release one block of units, other than the first one, if none of its units is in use.
+    /// Walks the free list, so it is called only when less than 25% of the units are in use.
+    /// @return true if a block was released.
+    bool shrink_();
+
+    /// Check the size of the queue and the free units before taking @a count units.
+    void prepareTake_(int count);
+
+    /// Move the units returned by makeUnitFree() to the free list.
+    void collectReturned_();
+
+    void pushFree_(CUnit* unit);
+    void popFree_();
+    void unlinkFree_(CUnit* unit);
+
+    /// The number of units of @a q on the free list.
+    int countFree_(const CQEntry* q) const;
+
     /// @brief Allocated a CQEntry of iNumUnits with each unit of mss bytes.
     /// @param iNumUnits a number of units to allocate
     /// @param mss the size of each unit in bytes.
@@ -122,14 +178,19 @@ private:
 
 private:
     CQEntry* m_pQEntry;    // pointer to the first unit queue
-    CQEntry* m_pCurrQueue; // pointer to the current available queue
     CQEntry* m_pLastQueue; // pointer to the last unit queue
-    CUnit* m_pAvailUnit; // recent available unit
+    CUnit* m_pFreeUnits; // the list of free units, the first one is the next available
     int m_iSize;  // total size of the unit queue, in number of packets
-    sync::atomic<int> m_iNumTaken; // total number of valid (occupied) packets in the queue
+    int m_iShrinkCheck; // the number of takes left to the next shrink check
+    int m_iShrinkPeriod; // the number of takes between the shrink checks
     const int m_iMSS; // unit buffer size
     const int m_iBlockSize; // Number of units in each CQEntry.
 
+    // The state shared with the threads freeing the units,
+    // in a cache line separate from the above.
+    SRT_ATR_ALIGNAS(64) sync::atomic<CUnit*> m_pReturned; // the units freed and not yet moved to m_pFreeUnits
+    sync::atomic<int> m_iNumTaken; // total number of valid (occupied) packets in the queue
+
 private:
     CUnitQueue(const CUnitQueue&);
     CUnitQueue& operator=(const CUnitQueue&);
@@ -140,7 +201,76 @@ struct CSNode
     CUDT*                          m_pUDT; // Pointer to the instance of CUDT socket
     sync::steady_clock::time_point m_tsTimeStamp;
 
-    sync::atomic<int> m_iHeapLoc; // location on the heap, -1 means not on the heap
+    CSNode* m_pPrev; // previous link in the slot
+    CSNode* m_pNext; // next link in the slot
+
+    sync::atomic<int> m_iSlot; // slot in the timing wheel, -1 means not on the list
+};
+
+/// A hierarchical timing wheel of CSNode, ordered by m_tsTimeStamp, for the
+/// sending schedule. The time is divided into ticks of 2^TICK_SHIFT us. The
+/// lowest level has a slot for every tick in the current window of SLOTS ticks,
+/// and a slot on every next level covers a whole window of the level below.
+/// A slot of a higher level is moved down when the time reaches it, so nodes
+/// are inserted and removed in O(1), and the ones due in the same tick are
+/// taken in the order of insertion. Times beyond the top level are kept in
+/// its last slot until they come close enough.
+class CSndTimingWheel
+{
+public:
+    CSndTimingWheel();
+
+    bool empty() const { return m_iCount == 0; }
+    int  size() const { return m_iCount; }
+
+    /// Insert the node at its m_tsTimeStamp.
+    /// @param [in] n node not yet on the wheel
+    void insert(CSNode* n);
+
+    /// Remove the node from the wheel.
+    /// @param [in] n node on the wheel
+    void remove(CSNode* n);
+
+    /// Retrieve the earliest node due not later than @a ts_due and remove it from the wheel.
+    /// @param [in] ts_due the latest scheduled time of a node to be retrieved
+    /// @return the node, or NULL if none is due.
+    CSNode* pop(const sync::steady_clock::time_point& ts_due);
+
+    /// Retrieve the earliest scheduled time. If any node is already due at
+    /// @a now, the time of a due node in the earliest tick is returned instead.
+    /// @param [in] now the current time
+    /// @return the time, or zero if the wheel is empty.
+    sync::steady_clock::time_point nextTime(const sync::steady_clock::time_point& now);
+
+    /// Check if the node would be the first to pop if inserted at the given time.
+    /// @param [in] ts the time to check
+    bool isEarliest(const sync::steady_clock::time_point& ts) const;
+
+    static const int TICK_SHIFT = 3; // 8us
+    static const int LEVELS     = 4;
+    static const int SLOT_BITS  = 8;
+    static const int SLOTS      = 1 << SLOT_BITS;
+
+private:
+    struct Slot
+    {
+        CSNode* head;
+        CSNode* tail;
+    };
+
+    static uint64_t tickOf(const sync::steady_clock::time_point& ts);
+
+    void     link_(CSNode* n, uint64_t tick);
+    void     unlink_(CSNode* n);
+    int      findSlot_(int level) const;
+    uint64_t slotStart_(int level, int slot) const;
+    bool     earliestSlot_(int& w_level, int& w_slot) const;
+    void     advance_(uint64_t tick);
+
+    Slot     m_Slots[LEVELS][SLOTS];
+    uint64_t m_Used[LEVELS][SLOTS / 64]; // bitmap of the non-empty slots
+    uint64_t m_uCurrTick;                // no node is scheduled before this tick
+    int      m_iCount;
 };
 
 class CSndUList
@@ -164,9 +294,10 @@ public:
     /// @param [in] ts the next time to trigger sending logic on the CUDT
     void update(const CUDT* u, EReschedule reschedule, sync::steady_clock::time_point ts = sync::steady_clock::now());
 
-    /// Retrieve the next (in time) socket from the heap to process its sending request.
+    /// Retrieve the next (in time) socket from the list to process its sending request.
+    /// @param [in] ts_due the latest scheduled time of a socket to be retrieved
     /// @return a pointer to CUDT instance to process next.
-    CUDT* pop();
+    CUDT* pop(sync::steady_clock::time_point ts_due = sync::steady_clock::now());
 
     /// Remove UDT instance from the list.
     /// @param [in] u pointer to the UDT instance
@@ -182,54 +313,44 @@ public:
     /// Signal to stop waiting in waitNonEmpty().
     void signalInterrupt() const;
 
-private:
-    /// Doubles the size of the list.
-    ///
-    void realloc_();// REQUIRES(m_ListLock);
-
-    /// Insert a new UDT instance into the list with realloc if required.
-    ///
-    /// @param [in] ts time stamp: next processing time
-    /// @param [in] u pointer to the UDT instance
-    void insert_(const sync::steady_clock::time_point& ts, const CUDT* u);
+    /// Set the shared I/O thread to be woken up when
+    /// an earlier processing time is scheduled.
+    void setIoWorker(CIoWorker* w) { m_pIoWorker = w; }
 
-    /// Insert a new UDT instance into the list without realloc.
-    /// Should be called if there is a guaranteed space for the element.
+private:
+    /// Insert a new UDT instance into the list.
     ///
     /// @param [in] ts time stamp: next processing time
     /// @param [in] u pointer to the UDT instance
-    void insert_norealloc_(const sync::steady_clock::time_point& ts, const CUDT* u);// REQUIRES(m_ListLock);
+    void insert_(const sync::steady_clock::time_point& ts, const CUDT* u);// REQUIRES(m_ListLock);
 
-    /// Removes CUDT entry from the list.
-    /// If the last entry is removed, calls sync::CTimer::interrupt().
-    void remove_(const CUDT* u);
+    /// Wake up the sending worker to check the next processing time.
+    void interrupt_() const;
 
 private:
-    CSNode** m_pHeap;        // The heap array
-    int      m_iArrayLength; // physical length of the array
-    int      m_iLastEntry;   // position of last entry on the heap array or -1 if empty.
+    CSndTimingWheel m_Wheel;
 
-    mutable sync::Mutex     m_ListLock; // Protects the list (m_pHeap, m_iArrayLength, m_iLastEntry).
+    mutable sync::Mutex     m_ListLock; // Protects the list (m_Wheel).
     mutable sync::Condition m_ListCond;
 
     sync::CTimer* const m_pTimer;
+    CIoWorker*          m_pIoWorker; // the shared I/O thread, if used instead of the worker
 
 private:
     CSndUList(const CSndUList&);
     CSndUList& operator=(const CSndUList&);
 };
 
-struct CRNode
+struct CRNode : CSNode
 {
-    CUDT*                          m_pUDT;        // Pointer to the instance of CUDT socket
-    sync::steady_clock::time_point m_tsTimeStamp; // Time Stamp
-
-    CRNode* m_pPrev; // previous link
-    CRNode* m_pNext; // next link
-
     sync::atomic<bool> m_bOnList; // if the node is already on the list
+
+    sync::atomic<bool> m_bCheckRequested; // if the node is on the requests of CRcvUList::requestCheck()
+    CRNode*            m_pNextRequested;  // next on these requests
 };
 
+/// The sockets of a receiving thread, each scheduled on a timing wheel at
+/// the next time when its timers should be checked (see CUDT::checkTimers).
 class CRcvUList
 {
 public:
@@ -237,7 +358,8 @@ public:
     ~CRcvUList();
 
 public:
-    /// Insert a new UDT instance to the list.
+    /// Insert a new UDT instance to the list, with the timers to be checked
+    /// after the SYN interval.
     /// @param [in] u pointer to the UDT instance
 
     void insert(const CUDT* u);
@@ -247,22 +369,60 @@ public:
 
     void remove(const CUDT* u);
 
-    /// Move the UDT instance to the end of the list, if it already exists; otherwise, do nothing.
+    /// Reschedule the UDT instance, if it is on the list; otherwise, do nothing.
     /// @param [in] u pointer to the UDT instance
+    /// @param [in] ts the next time to check its timers
 
-    void update(const CUDT* u);
+    void update(const CUDT* u, const sync::steady_clock::time_point& ts);
 
-public:
-    CRNode* m_pUList; // the head node
+    /// Retrieve an UDT instance with the timers due and take it off the
+    /// schedule. It stays on the list, so it should be rescheduled with update().
+    /// @param [in] ts_due the latest time of the timers to be retrieved
+    /// @return the instance, or NULL if none is due.
+
+    CUDT* pop(const sync::steady_clock::time_point& ts_due);
+
+    /// Request the timers of the UDT instance to be checked at once, as its
+    /// state has been changed by another thread. Can be called from any thread.
+    /// @param [in] u pointer to the UDT instance
+    /// @return true if requested, false if it's already requested.
+
+    bool requestCheck(const CUDT* u);
+
+    /// Whether there are requests from requestCheck() not taken up yet.
+
+    bool hasRequests() const { return m_pRequested.load() != NULL; }
+
+    /// Reschedule the UDT instances requested by requestCheck() to @a now,
+    /// if they are already scheduled. Only the thread using the list may call it.
+    /// @param [in] now the current time
+
+    void takeRequests(const sync::steady_clock::time_point& now);
+
+    /// Retrieve the earliest time to check the timers.
+    /// @param [in] now the current time
+    /// @return the time, or zero if the list is empty.
+
+    sync::steady_clock::time_point nextTime(const sync::steady_clock::time_point& now)
+    {
+        return m_Wheel.nextTime(now);
+    }
 
 private:
-    CRNode* m_pLast; // the last node
+    CSndTimingWheel m_Wheel;
+
+    sync::atomic<CRNode*> m_pRequested; // the nodes requested by requestCheck(), the latest first
 
 private:
     CRcvUList(const CRcvUList&);
     CRcvUList& operator=(const CRcvUList&);
 };
 
+/// The table of the sockets of a multiplexer, by socket ID.
+/// The entries are kept in the table itself (open addressing, Robin Hood
+/// probing), so that a lookup usually touches a single cache line. When it
+/// fills up, a table twice as big is made, and the entries are moved to it
+/// a few at a time with every following call, without a pause.
 class CHash
 {
 public:
@@ -271,7 +431,7 @@ public:
 
 public:
     /// Initialize the hash table.
-    /// @param [in] size hash table size
+    /// @param [in] size the initial number of sockets to hold
 
     void init(int size);
 
@@ -292,22 +452,105 @@ public:
 
     void remove(int32_t id);
 
+    /// The number of entries.
+    int size() const { return m_iCount; }
+
+    /// The number of entries the table can hold before it grows again.
+    int capacity() const { return m_iHashSize * 3 / 4; }
+
 private:
-    struct CBucket
+    struct CEntry
     {
-        int32_t m_iID;  // Socket ID
-        CUDT*   m_pUDT; // Socket instance
+        int32_t m_iID;   // Socket ID
+        int32_t m_iDist; // 1 + distance from the home slot, 0 if empty
+        CUDT*   m_pUDT;  // Socket instance
+    };
+
+    struct CTable
+    {
+        CEntry* m_pEntry;
+        int     m_iShift; // 32 - log2(size)
+
+        int    size() const { return 1 << (32 - m_iShift); }
+        size_t slot(int32_t id) const
+        {
+            // Fibonacci hashing; the IDs are given out in sequence.
+            return (uint32_t(id) * 2654435769u) >> m_iShift;
+        }
+    };
+
+    static CEntry* find_(const CTable& t, int32_t id);
+    static void    insert_(CTable& t, int32_t id, CUDT* u);
+    static void    remove_(CTable& t, CEntry* e);
 
-        CBucket* m_pNext; // next bucket
-    } * *m_pBucket;       // list of buckets (the hash table)
+    /// Move a few entries from the table being replaced.
+    void migrate_();
 
-    int m_iHashSize; // size of hash table
+    CTable m_Table;    // the table where the entries are added
+    CTable m_OldTable; // the table being replaced, its m_pEntry is NULL if none
+    int    m_iMigrated; // the slots of m_OldTable already moved
+    int    m_iHashSize; // size of m_Table
+    int    m_iCount;    // number of entries in both tables
 
 private:
     CHash(const CHash&);
     CHash& operator=(const CHash&);
 };
 
+/// A fixed-size queue passing items from one thread to another one,
+/// without locking. The size must be a power of two.
+template <class T>
+class CSPSCQueue
+{
+public:
+    explicit CSPSCQueue(size_t size)
+        : m_Items(size)
+        , m_zMask(size - 1)
+        , m_zHead(0)
+        , m_zTail(0)
+    {
+        SRT_ASSERT((size & m_zMask) == 0);
+    }
+
+    /// Add an item. Only one thread may call it.
+    /// @return false if the queue is full.
+    bool push(const T& item)
+    {
+        const size_t tail = m_zTail.load();
+        if (tail - m_zHead.load() > m_zMask)
+            return false;
+        m_Items[tail & m_zMask] = item;
+        m_zTail.store(tail + 1);
+        return true;
+    }
+
+    /// Take the oldest item. Only one thread may call it.
+    /// @return false if the queue is empty.
+    bool pop(T& w_item)
+    {
+        const size_t head = m_zHead.load();
+        if (head == m_zTail.load())
+            return false;
+        w_item = m_Items[head & m_zMask];
+        m_zHead.store(head + 1);
+        return true;
+    }
+
+    bool empty() const { return m_zHead.load() == m_zTail.load(); }
+
+private:
+    std::vector<T> m_Items;
+    const size_t   m_zMask;
+
+    // Each written by one of the threads only, in separate cache lines.
+    SRT_ATR_ALIGNAS(64) sync::atomic<size_t> m_zHead; // the next item to take
+    SRT_ATR_ALIGNAS(64) sync::atomic<size_t> m_zTail; // the next item to add
+
+private:
+    CSPSCQueue(const CSPSCQueue&);
+    CSPSCQueue& operator=(const CSPSCQueue&);
+};
+
 /// @brief A queue of sockets pending for connection.
 /// It can be either a caller socket in a non-blocking mode
 /// (the connection has to be handled in background),
@@ -336,6 +579,9 @@ public:
     /// @return a pointer to CUDT instance retrieved, or NULL if nothing was found.
     CUDT* retrieve(const sockaddr_any& addr, SRTSOCKET& id) const;
 
+    /// @brief Check if no socket is pending for connection.
+    bool empty() const;
+
     /// @brief Update status of connections in the pending queue.
     /// Stop connecting if TTL expires. Resend handshake request every 250 ms if no response from the peer.
     /// @param rst result of reading from a UDP socket: received packet / nothin read / read error.
@@ -395,6 +641,7 @@ class CSndQueue
 {
     friend class CUDT;
     friend class CUDTUnited;
+    friend class CIoWorker;
 
 public:
     CSndQueue();
@@ -410,7 +657,12 @@ public:
     /// Initialize the sending queue.
     /// @param [in] c UDP channel to be associated to the queue
     /// @param [in] t Timer
-    void init(CChannel* c, sync::CTimer* t);
+    /// @param [in] w shared I/O thread to send the packets, NULL to start own worker threads
+    void init(CChannel* c, sync::CTimer* t, CIoWorker* w = NULL);
+
+    /// Get the list for sending of the worker that the socket is pinned to (SRTO_SNDWORKERS).
+    /// @param [in] id the socket ID
+    CSndUList* sndUList(SRTSOCKET id) const { return m_vWorkers[size_t(id) % m_vWorkers.size()]->list; }
 
     /// Send out a packet to a given address. The @a src parameter is
     /// blindly passed by the caller down the call with intention to
@@ -440,17 +692,88 @@ public:
 
     void setClosing() { m_bClosing = true; }
 
+    /// Check if the packets are passed to the system ahead of their
+    /// send time, which then sends them on time (SRTO_UDP_TXTIME).
+    bool txtimeEnabled() const;
+
+    /// Get the statistics of batched sending (SRTO_UDP_SNDBATCH).
+    /// @param [out] w_calls number of system calls used for batched sending
+    /// @param [out] w_pkts number of packets sent in batches
+    /// @param [out] w_gso_pkts number of packets sent coalesced with UDP GSO (SRTO_UDP_GSO)
+    void getBatchStats(int64_t& w_calls, int64_t& w_pkts, int64_t& w_gso_pkts) const;
+
+    /// Get the number of packets passed to the system with their send time (SRTO_UDP_TXTIME).
+    int64_t txtimePackets() const;
+
+    /// Get the number of sender threads (SRTO_SNDWORKERS) that have sent any data packets.
+    int busyWorkers() const;
+
 private:
-    static void*  worker(void* param);
-    sync::CThread m_WorkerThread;
+    // A sender thread with the list of the sockets pinned to it.
+    struct Worker
+    {
+        CSndQueue*    queue;
+        CSndUList*    list;
+        sync::CTimer* timer; // the multiplexer's timer for the first worker, own for the others
+        sync::CThread thread;
+
+        // Batched sending, used if m_iSndBatchSize > 1.
+        CPacket*                  batch_packets;
+        std::vector<CPacket*>     batch_ppackets;
+        std::vector<sockaddr_any> batch_addrs;
+        std::vector<sockaddr_any> batch_srcaddrs;
+
+        sync::atomic<int64_t> batch_calls;   // number of system calls used for batched sending
+        sync::atomic<int64_t> batch_pkts;    // number of packets sent in batches
+        sync::atomic<int64_t> batch_gsopkts; // number of packets sent coalesced with UDP GSO
+        sync::atomic<int64_t> txtime_pkts;   // number of packets sent with their send time
+        sync::atomic<int64_t> sent_pkts;     // number of data packets sent by this worker
+    };
+
+    static void* worker(void* param);
+
+    // Maximum time ahead of the send time that a packet
+    // is passed to the system with SRTO_UDP_TXTIME.
+    static const int TXTIME_HORIZON_US = 1000;
+
+    // Maximum time ahead of the send time that the next packet
+    // of a socket is packed in a burst (SRTO_SNDBURST).
+    static const int SND_BURST_QUANTUM_US = 100;
+
+    // Whether the next packet of @a u, due at @a next_time, is packed in the
+    // current burst, in which @a n packets of this socket have been packed.
+    bool continueBurst(const CUDT* u, int n, const sync::steady_clock::time_point& next_time) const;
+
+    // The time ahead of the send time that packets are sent out.
+    sync::steady_clock::duration sendAheadTime() const
+    {
+        return txtimeEnabled() ? sync::microseconds_from(TXTIME_HORIZON_US) : sync::steady_clock::duration();
+    }
+
+    // Subroutine of worker: pack the packet from @a u and all other
+    // packets that are already due to be sent, and send them at once.
+    void worker_SendBatch(Worker& w, CUDT* u);
+
+    // Subroutine of worker: send the packet(s) of the first socket on
+    // the list, if it's due to be sent (or can be passed ahead to the system).
+    void worker_SendNext(Worker& w);
+
+    // Send the packets that are due to be sent, at most @a maxsend times,
+    // without waiting. Used by the shared I/O thread.
+    // @return the time when the next packet is due (zero if the list is
+    // empty), or the current time if there are still packets due.
+    sync::steady_clock::time_point worker_SendDue(int maxsend);
 
 private:
-    CSndUList*    m_pSndUList; // List of UDT instances for data sending
-    CChannel*     m_pChannel;  // The UDP channel for data sending
-    sync::CTimer* m_pTimer;    // Timing facility
+    std::vector<Worker*> m_vWorkers;  // The sender threads, each with its list of UDT instances for data sending
+    CChannel*            m_pChannel;  // The UDP channel for data sending
+    sync::CTimer*        m_pTimer;    // Timing facility
+    CIoWorker*           m_pIoWorker; // The shared I/O thread, if used instead of the workers
 
     sync::atomic<bool> m_bClosing;            // closing the worker
 
+    int m_iSndBatchSize; // max number of packets sent at once
+
 public:
 #if defined(SRT_DEBUG_SNDQ_HIGHRATE) //>>debug high freq worker
     sync::steady_clock::duration m_DbgPeriod;
@@ -480,6 +803,7 @@ class CRcvQueue
 {
     friend class CUDT;
     friend class CUDTUnited;
+    friend class CIoWorker;
 
 public:
     CRcvQueue();
@@ -499,7 +823,16 @@ public:
     /// @param [in] hsize hash table size
     /// @param [in] c UDP channel to be associated to the queue
     /// @param [in] t timer
-    void init(int size, size_t payload, int version, int hsize, CChannel* c, sync::CTimer* t);
+    /// @param [in] w shared I/O thread to receive the packets, NULL to start an own worker thread
+    void init(int size, size_t payload, int version, int hsize, CChannel* c, sync::CTimer* t, CIoWorker* w = NULL);
+
+    /// Get the units for the received packets of the socket, which are
+    /// those of the processing worker that it is pinned to (SRTO_RCVWORKERS).
+    /// @param [in] id the socket ID
+    CUnitQueue* unitQueue(SRTSOCKET id) const
+    {
+        return m_vWorkers.empty() ? m_pUnitQueue : m_vWorkers[size_t(id) % m_vWorkers.size()]->units;
+    }
 
     /// Read a packet for a specific UDT socket id.
     /// @param [in] id Socket ID
@@ -513,14 +846,102 @@ public:
 
     int getIPversion() { return m_iIPversion; }
 
+    /// Get the statistics of batched reading (SRTO_UDP_RCVBATCH).
+    /// @param [out] w_calls number of batched read calls
+    /// @param [out] w_pkts number of packets retrieved by batched read calls
+    /// @param [out] w_full number of batched read calls that filled up the whole batch
+    void getBatchStats(int64_t& w_calls, int64_t& w_pkts, int64_t& w_full) const;
+
+    /// Get the statistics of receiving with UDP GRO (SRTO_UDP_GRO).
+    /// @param [out] w_bufs number of received buffers with coalesced packets
+    /// @param [out] w_pkts number of packets split out of these buffers
+    void getGroStats(int64_t& w_bufs, int64_t& w_pkts) const;
+
+    /// Get the number of packets received through io_uring (SRTO_UDP_IOURING).
+    int64_t uringPackets() const { return m_llUringPackets; }
+
+    /// Have the timers of the socket checked at once by the thread that checks
+    /// them, as the socket's state has been changed by another thread.
+    /// Can be called from any thread.
+    void requestTimersCheck(CUDT* u);
+
+    /// Get the number of processing threads (SRTO_RCVWORKERS)
+    /// that have processed any data packet so far.
+    int busyWorkers() const;
+
 private:
     static void*  worker(void* param);
     sync::CThread m_WorkerThread;
     // Subroutines of worker
+    void           worker_InsertNewEntries();
     EReadStatus    worker_RetrieveUnit(int32_t& id, CUnit*& unit, sockaddr_any& sa);
+    EReadStatus    worker_RetrieveBatch();
+    EReadStatus    worker_NextBatchUnit(int32_t& id, CUnit*& unit, sockaddr_any& sa);
+    EReadStatus    worker_RetrieveGroUnit(int32_t& id, CUnit*& unit, sockaddr_any& sa);
     EConnectStatus worker_ProcessConnectionRequest(CUnit* unit, const sockaddr_any& sa);
     EConnectStatus worker_TryAsyncRend_OrStore(int32_t id, CUnit* unit, const sockaddr_any& sa);
     EConnectStatus worker_ProcessAddressedPacket(int32_t id, CUnit* unit, const sockaddr_any& sa);
+    bool           worker_DispatchUnit(int32_t id, CUnit* unit, const sockaddr_any& sa, EConnectStatus& w_cst);
+    sync::steady_clock::time_point worker_CheckTimers(EReadStatus rst, EConnectStatus cst, CUnit* unit);
+    void           worker_AddSocket(CUDT* u);
+    void           worker_HandOver(CUDT* u, CUnit* unit);
+    void           worker_ReleaseSockets();
+
+    // A thread processing the packets of the sockets pinned to it by their ID
+    // (SRTO_RCVWORKERS). The receiving thread passes it the packets, together
+    // with the changes of its sockets, in the order they happen.
+    struct Worker
+    {
+        enum TaskType
+        {
+            TASK_PACKET,  // process the packet in the unit
+            TASK_ADD,     // the socket is connected, add it to the list
+            TASK_RELEASE, // the socket is no longer dispatched to, and it can be deleted
+        };
+
+        struct Task
+        {
+            TaskType type;
+            CUDT*    u;
+            CUnit*   unit; // from CRcvQueue::m_pUnitQueue, to be freed after processing
+        };
+
+        static const size_t MAX_TASKS = 4096;
+
+        Worker()
+            : queue(NULL)
+            , units(NULL)
+            , ulist(NULL)
+            , tasks(MAX_TASKS)
+            , sleeping(false)
+            , data_pkts(0)
+        {
+        }
+
+        CRcvQueue*         queue;
+        sync::CThread      thread;
+        CUnitQueue*        units; // the units of the packets of its sockets
+        CRcvUList*         ulist; // its sockets, for checking the timers
+        CSPSCQueue<Task>   tasks;
+        sync::Mutex        lock;
+        sync::Condition    cond;
+        sync::atomic<bool> sleeping; // waiting on cond for the next task
+
+        sync::atomic<int64_t> data_pkts; // number of data packets processed by this worker
+    };
+
+    static void* processing_worker(void* param);
+    void         processing_Task(Worker& w, const Worker::Task& task);
+    sync::steady_clock::time_point processing_CheckTimers(Worker& w);
+
+    // The timers are checked again at the earliest time due on the list (see
+    // worker_CheckTimers and processing_CheckTimers), but not later than this,
+    // so that the changes made by other threads are taken up.
+    static const int MAX_TIMERS_WAIT_US = 100000;
+
+    // Pass the task to the worker. If the worker can't take it, the task is
+    // dropped, unless @a wait is set, in which case it waits for the worker.
+    bool pushTask(Worker& w, const Worker::Task& task, bool wait);
 
 private:
     CUnitQueue*   m_pUnitQueue; // The received packet queue
@@ -528,6 +949,11 @@ private:
     CHash*        m_pHash;      // Hash table for UDT socket looking up
     CChannel*     m_pChannel;   // UDP channel for receiving packets
     sync::CTimer* m_pTimer;     // shared timer with the snd queue
+    CIoWorker*    m_pIoWorker;  // the shared I/O thread, if used instead of the worker
+
+    std::vector<Worker*> m_vWorkers;     // The processing threads, if any (SRTO_RCVWORKERS)
+    std::vector<CUDT*>   m_vReleased;    // sockets removed from the processing threads, to be removed from m_pHash
+    sync::Mutex          m_ReleasedLock;
 
     int m_iIPversion;           // IP version
     size_t m_szPayloadSize;     // packet payload size
@@ -537,6 +963,35 @@ private:
     static srt::sync::atomic<int> m_counter; // A static counter to log RcvQueue worker thread number.
 #endif
 
+    // Batched reading. Units in m_vBatchUnits in the range [m_iBatchNext, m_iBatchCount)
+    // have been filled in by the last read and wait to be dispatched. They are kept marked
+    // as taken until then so that the unit queue doesn't give them out again.
+    int                       m_iRcvBatchSize; // max number of packets read at once
+    std::vector<CUnit*>       m_vBatchUnits;
+    std::vector<CPacket*>     m_vBatchPackets;
+    std::vector<sockaddr_any> m_vBatchAddrs;
+    int                       m_iBatchNext;
+    int                       m_iBatchCount;
+
+    sync::atomic<int64_t> m_llBatchCalls;    // number of batched read calls
+    sync::atomic<int64_t> m_llBatchPackets;  // number of packets retrieved by batched read calls
+    sync::atomic<int64_t> m_llBatchFull;     // number of batched read calls that filled up the batch
+
+    // Reading with UDP GRO. The buffer keeps the data of the last read, and the
+    // packets in the range [m_zGroOffset, m_zGroLength) wait to be dispatched.
+    std::vector<char> m_vGroBuffer;
+    size_t            m_zGroLength;
+    size_t            m_zGroOffset;
+    size_t            m_zGroSegSize;  // size of a single packet in the buffer
+    sockaddr_any      m_GroSrcAddr;
+    sockaddr_any      m_GroDestAddr;
+    sync::steady_clock::time_point m_tsGroArrival;
+
+    sync::atomic<int64_t> m_llGroBuffers;    // number of received buffers with coalesced packets
+    sync::atomic<int64_t> m_llGroPackets;    // number of packets split out of these buffers
+
+    sync::atomic<int64_t> m_llUringPackets;  // number of packets received through io_uring
+
 private:
     int  setListener(CUDT* u);
     void removeListener(const CUDT* u);
@@ -570,6 +1025,143 @@ private:
     CRcvQueue& operator=(const CRcvQueue&);
 };
 
+#ifdef SRT_ENABLE_IOPOOL
+/// A thread that does the work of the worker threads of the sending and
+/// receiving queues of many multiplexers (see srt_setiothreads()). It waits
+/// for the packets on all their UDP sockets with a single system epoll and
+/// for the earliest time when any of them has a packet to send.
+class CIoWorker
+{
+public:
+    CIoWorker();
+    ~CIoWorker();
+
+    /// Start the thread.
+    /// @param [in] index number of the thread, used for its name
+    void start(int index);
+
+    void add(CSndQueue* q);
+    void add(CRcvQueue* q);
+
+    /// Stop handling the queue. When this returns, the thread no longer uses it.
+    void remove(const CSndQueue* q);
+    void remove(const CRcvQueue* q);
+
+    /// Wake up the thread to check the sending lists again.
+    void wakeup();
+
+    /// Get the number of queues handled by this thread.
+    int load() const { return m_iLoad; }
+
+private:
+    struct Entry
+    {
+        CSndQueue*         sndq;
+        CRcvQueue*         rcvq;
+        int                fd;      // descriptor polled for the packets, -1 if none
+        sync::Mutex        lock;    // held while the thread is handling the queue
+        sync::atomic<bool> removed; // set by remove(), the entry is deleted by the thread
+        bool               ready;   // packets may be waiting to be received
+
+        // State of the receiving, kept between calls as in CRcvQueue::worker.
+        int32_t                        id;
+        CUnit*                         unit;
+        sockaddr_any                   addr;
+        EReadStatus                    rst;
+        EConnectStatus                 cst;
+        sync::steady_clock::time_point next_timers;
+
+        Entry()
+            : sndq(NULL)
+            , rcvq(NULL)
+            , fd(-1)
+            , removed(false)
+            , ready(true)
+            , id(0)
+            , unit(NULL)
+            , rst(RST_AGAIN)
+            , cst(CONN_AGAIN)
+        {
+        }
+    };
+
+    static void* worker(void* param);
+
+    void  addEntry(Entry* e, int fd);
+    void  removeEntry(const void* q);
+    bool  receive(Entry& e);
+    void  wait(const sync::steady_clock::time_point& next);
+
+    // Maximum number of packets received or sent for a queue at once,
+    // before the other queues are handled.
+    static const int MAX_PACKETS_AT_ONCE = 64;
+
+    sync::CThread      m_Thread;
+    sync::atomic<bool> m_bClosing;
+    sync::atomic<bool> m_bWaiting; // the thread may be waiting for the events
+    sync::atomic<int>  m_iLoad;
+
+    int m_iEpoll;   // epoll with the descriptors of all UDP sockets and the two below
+    int m_iEventFd; // written to wake up the thread
+    int m_iTimerFd; // the timer for the next packet to be sent
+
+    sync::Mutex         m_ListLock;
+    std::vector<Entry*> m_vEntries; // protected by m_ListLock
+    std::vector<Entry*> m_vActive;  // copy of m_vEntries used by the thread
+
+private:
+    CIoWorker(const CIoWorker&);
+    CIoWorker& operator=(const CIoWorker&);
+};
+#endif
+
+/// A thread that does the work of the TSBPD threads of many receiving sockets
+/// (see srt_settsbpdthreads()). The sockets are kept on a timing wheel by the
+/// time when the first packet in their receiver buffer is due to play, and the
+/// ones waiting for a new packet or ACK are off the wheel until kicked.
+class CTsbPdWorker
+{
+public:
+    CTsbPdWorker();
+    ~CTsbPdWorker();
+
+    /// Start the thread.
+    /// @param [in] index number of the thread, used for its name
+    void start(int index);
+
+    /// Start checking the socket, with its m_pTsbPdNode already set up.
+    void add(CUDT* u);
+
+    /// Stop checking the socket. When this returns, the thread no longer uses it.
+    /// Must not be called with the m_RecvLock of the socket locked.
+    void remove(CUDT* u);
+
+    /// Check the socket as soon as possible (see CUDT::kickTsbPd()).
+    void wakeup(CUDT* u);
+
+    /// Get the number of sockets handled by this thread.
+    int load() const { return m_iLoad; }
+
+private:
+    static void* worker(void* param);
+
+    void schedule(CSNode* n, const sync::steady_clock::time_point& ts);
+
+    sync::CThread      m_Thread;
+    sync::atomic<bool> m_bClosing;
+    sync::atomic<int>  m_iLoad;
+
+    sync::Mutex     m_Lock;
+    sync::Condition m_Cond;     // signaled when a socket is due earlier than the thread waits for
+    sync::Condition m_DoneCond; // signaled when the thread has finished checking m_pCurrent
+    CSndTimingWheel m_Wheel;    // protected by m_Lock
+    CUDT*           m_pCurrent; // the socket being checked, protected by m_Lock
+
+private:
+    CTsbPdWorker(const CTsbPdWorker&);
+    CTsbPdWorker& operator=(const CTsbPdWorker&);
+};
+
 struct CMultiplexer
 {
     CSndQueue*    m_pSndQueue; // The sending queue
@@ -585,6 +1177,10 @@ struct CMultiplexer
 
     int m_iID; // multiplexer ID
 
+    // IDs of all the multiplexers bound to the same port (SRTO_UDP_SHARDS),
+    // including this one, in the order of binding; empty if not sharded.
+    std::vector<int> m_vShards;
+
     // Constructor should reset all pointers to NULL
     // to prevent dangling pointer when checking for memory alloc fails
     CMultiplexer()
@@ -173,6 +173,117 @@ struct CSrtConfigSetter<SRTO_UDP_RCVBUF>
         co.iUDPRcvBufSize = std::max(co.iMSS, cast_optval<int>(optval, optlen));
     }
 };
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_RCVBATCH>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtConfig::MAX_UDP_BATCH_SIZE)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iUDPRcvBatch = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_SNDBATCH>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtConfig::MAX_UDP_BATCH_SIZE)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iUDPSndBatch = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_GSO>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bUDPGso = cast_optval<bool>(optval, optlen);
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_GRO>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bUDPGro = cast_optval<bool>(optval, optlen);
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_RCVTIMESTAMP>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bUDPRcvTimestamp = cast_optval<bool>(optval, optlen);
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_TXTIME>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bUDPTxTime = cast_optval<bool>(optval, optlen);
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_IOURING>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bUDPIoUring = cast_optval<bool>(optval, optlen);
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_SHARDS>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtConfig::MAX_UDP_SHARDS)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iUDPShards = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_SNDWORKERS>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtConfig::MAX_SND_WORKERS)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iSndWorkers = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_RCVWORKERS>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtConfig::MAX_RCV_WORKERS)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iRcvWorkers = val;
+    }
+};
+
 template<>
 struct CSrtConfigSetter<SRTO_RENDEZVOUS>
 {
@@ -898,6 +1009,32 @@ struct CSrtConfigSetter<SRTO_RETRANSMITALGO>
     }
 };
 
+template<>
+struct CSrtConfigSetter<SRTO_SNDBURST>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtConfig::MAX_SND_BURST)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iSndBurst = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_SNDBUFRECLAIM>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 0)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iSndBufReclaim = val;
+    }
+};
+
 #ifdef ENABLE_AEAD_API_PREVIEW
 template<>
 struct CSrtConfigSetter<SRTO_CRYPTOMODE>
@@ -945,6 +1082,16 @@ int dispatchSet(SRT_SOCKOPT optName, CSrtConfig& co, const void* optval, int opt
         DISPATCH(SRTO_LINGER);
         DISPATCH(SRTO_UDP_SNDBUF);
         DISPATCH(SRTO_UDP_RCVBUF);
+        DISPATCH(SRTO_UDP_RCVBATCH);
+        DISPATCH(SRTO_UDP_SNDBATCH);
+        DISPATCH(SRTO_UDP_GSO);
+        DISPATCH(SRTO_UDP_GRO);
+        DISPATCH(SRTO_UDP_RCVTIMESTAMP);
+        DISPATCH(SRTO_UDP_TXTIME);
+        DISPATCH(SRTO_UDP_IOURING);
+        DISPATCH(SRTO_UDP_SHARDS);
+        DISPATCH(SRTO_SNDWORKERS);
+        DISPATCH(SRTO_RCVWORKERS);
         DISPATCH(SRTO_RENDEZVOUS);
         DISPATCH(SRTO_SNDTIMEO);
         DISPATCH(SRTO_RCVTIMEO);
@@ -989,6 +1136,8 @@ int dispatchSet(SRT_SOCKOPT optName, CSrtConfig& co, const void* optval, int opt
         DISPATCH(SRTO_IPV6ONLY);
         DISPATCH(SRTO_PACKETFILTER);
         DISPATCH(SRTO_RETRANSMITALGO);
+        DISPATCH(SRTO_SNDBURST);
+        DISPATCH(SRTO_SNDBUFRECLAIM);
 #ifdef ENABLE_AEAD_API_PREVIEW
         DISPATCH(SRTO_CRYPTOMODE);
 #endif
@@ -1085,11 +1234,23 @@ bool SRT_SocketOptionObject::add(SRT_SOCKOPT optname, const void* optval, size_t
         //SRTO_RCVSYN - must be always false in groups
         //SRTO_RCVTIMEO - must be always -1 in groups
     case SRTO_SNDBUF:
+    case SRTO_SNDBURST:
+    case SRTO_SNDBUFRECLAIM:
     case SRTO_SNDDROPDELAY:
         //SRTO_TLPKTDROP - per transmission setting
         //SRTO_TSBPDMODE - per transmission setting
     case SRTO_UDP_RCVBUF:
     case SRTO_UDP_SNDBUF:
+    case SRTO_UDP_RCVBATCH:
+    case SRTO_UDP_SNDBATCH:
+    case SRTO_UDP_GSO:
+    case SRTO_UDP_GRO:
+    case SRTO_UDP_RCVTIMESTAMP:
+    case SRTO_UDP_TXTIME:
+    case SRTO_UDP_IOURING:
+    case SRTO_UDP_SHARDS:
+    case SRTO_SNDWORKERS:
+    case SRTO_RCVWORKERS:
         break;
 
     default:
@@ -79,6 +79,10 @@ namespace srt
 struct CSrtMuxerConfig
 {
     static const int DEF_UDP_BUFFER_SIZE = 65536;
+    static const int MAX_UDP_BATCH_SIZE = 256;
+    static const int MAX_UDP_SHARDS = 64;
+    static const int MAX_SND_WORKERS = 64;
+    static const int MAX_RCV_WORKERS = 64;
 
     int  iIpTTL;
     int  iIpToS;
@@ -90,6 +94,16 @@ struct CSrtMuxerConfig
 #endif
     int iUDPSndBufSize; // UDP sending buffer size
     int iUDPRcvBufSize; // UDP receiving buffer size
+    int iUDPRcvBatch;   // max number of UDP packets read in one system call
+    int iUDPSndBatch;   // max number of UDP packets sent in one system call
+    bool bUDPGso;       // use UDP generic segmentation offload for batched sending
+    bool bUDPGro;       // use UDP generic receive offload
+    bool bUDPRcvTimestamp; // use the system receive timestamps of UDP packets
+    bool bUDPTxTime;    // pass the sending time of UDP packets to the system
+    bool bUDPIoUring;   // use io_uring for the UDP socket I/O
+    int iUDPShards;     // number of UDP sockets sharing the port (SO_REUSEPORT)
+    int iSndWorkers;    // number of sender threads
+    int iRcvWorkers;    // number of threads processing the received packets, 1: the receiver thread only
 
     // NOTE: this operator is not reversable. The syntax must use:
     //  muxer_entry == socket_entry
@@ -104,6 +118,16 @@ struct CSrtMuxerConfig
 #endif
             && CEQUAL(iUDPSndBufSize)
             && CEQUAL(iUDPRcvBufSize)
+            && CEQUAL(iUDPRcvBatch)
+            && CEQUAL(iUDPSndBatch)
+            && CEQUAL(bUDPGso)
+            && CEQUAL(bUDPGro)
+            && CEQUAL(bUDPRcvTimestamp)
+            && CEQUAL(bUDPTxTime)
+            && CEQUAL(bUDPIoUring)
+            && CEQUAL(iUDPShards)
+            && CEQUAL(iSndWorkers)
+            && CEQUAL(iRcvWorkers)
             && (other.iIpV6Only == -1 || CEQUAL(iIpV6Only))
             // NOTE: iIpV6Only is not regarded because
             // this matches only in case of IPv6 with "any" address.
@@ -121,6 +145,16 @@ struct CSrtMuxerConfig
         , bReuseAddr(true) // This is default in SRT
         , iUDPSndBufSize(DEF_UDP_BUFFER_SIZE)
         , iUDPRcvBufSize(DEF_UDP_BUFFER_SIZE)
+        , iUDPRcvBatch(1)
+        , iUDPSndBatch(1)
+        , bUDPGso(false)
+        , bUDPGro(false)
+        , bUDPRcvTimestamp(false)
+        , bUDPTxTime(false)
+        , bUDPIoUring(false)
+        , iUDPShards(1)
+        , iSndWorkers(1)
+        , iRcvWorkers(1)
     {
     }
 };
@@ -209,6 +243,7 @@ struct CSrtConfig: CSrtMuxerConfig
     static const size_t MAX_SID_LENGTH     = 512;
     static const size_t MAX_PFILTER_LENGTH = 64;
     static const size_t MAX_CONG_LENGTH    = 16;
+    static const int    MAX_SND_BURST      = 256;
 
     int    iMSS;            // Maximum Segment Size, in bytes
     size_t zExpPayloadSize; // Expected average payload size (user option)
@@ -253,6 +288,8 @@ struct CSrtConfig: CSrtMuxerConfig
     uint32_t uMinStabilityTimeout_ms;
     int      iRetransmitAlgo;
     int      iCryptoMode; // SRTO_CRYPTOMODE
+    int      iSndBurst;   // max number of packets sent in a row (SRTO_SNDBURST)
+    int      iSndBufReclaim; // low watermark in bytes for shrinking the sender buffer, 0: never (SRTO_SNDBUFRECLAIM)
 
     int64_t llInputBW;         // Input stream rate (bytes/sec). 0: use internally estimated input bandwidth
     int64_t llMinInputBW;      // Minimum input stream rate estimate (bytes/sec)
@@ -308,6 +345,8 @@ struct CSrtConfig: CSrtMuxerConfig
         , uMinStabilityTimeout_ms(COMM_DEF_MIN_STABILITY_TIMEOUT_MS)
         , iRetransmitAlgo(1)
         , iCryptoMode(CIPHER_MODE_AUTO)
+        , iSndBurst(1)
+        , iSndBufReclaim(0)
         , llInputBW(0)
         , llMinInputBW(0)
         , iOverheadBW(25)
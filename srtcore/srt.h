@@ -233,6 +233,18 @@ typedef enum SRT_SOCKOPT {
 #ifdef ENABLE_MAXREXMITBW
    SRTO_MAXREXMITBW = 63,    // Maximum bandwidth limit for retransmision (Bytes/s)
 #endif
+   SRTO_UDP_RCVBATCH = 64,   // Maximum number of UDP packets read from the system in a single call
+   SRTO_UDP_SNDBATCH,        // Maximum number of UDP packets passed to the system in a single call
+   SRTO_UDP_GSO,             // Coalesce same-size packets to the same peer with UDP generic segmentation offload
+   SRTO_UDP_GRO,             // Receive packets coalesced by the system with UDP generic receive offload
+   SRTO_UDP_RCVTIMESTAMP,    // Use the system receive time of UDP packets for the time measurements
+   SRTO_UDP_TXTIME,          // Pass the scheduled sending time of UDP packets to the system (pacing)
+   SRTO_UDP_IOURING,         // Use io_uring for the UDP socket I/O
+   SRTO_UDP_SHARDS,          // Number of UDP sockets bound to the same port with SO_REUSEPORT, each with own worker threads
+   SRTO_SNDWORKERS,          // Number of threads sending the data packets of the multiplexer
+   SRTO_SNDBURST,            // Maximum number of packets sent in a row when their sending times are close
+   SRTO_SNDBUFRECLAIM,       // Shrink the sender buffer after a period of low use, down to this size in bytes (0: never)
+   SRTO_RCVWORKERS,          // Number of threads processing the received packets of the multiplexer
 
    SRTO_E_SIZE // Always last element, not a valid option.
 } SRT_SOCKOPT;
@@ -401,6 +413,24 @@ struct CBytePerfMon
    int64_t  pktRecvUnique;              // number of packets to be received by the application
    uint64_t byteSentUnique;             // number of data bytes, sent by the application
    uint64_t byteRecvUnique;             // number of data bytes to be received by the application
+
+   // Multiplexer measurements (shared by all sockets bound to the same UDP socket)
+   int64_t  muxRcvBatchCallsTotal;      // number of batched UDP read calls (SRTO_UDP_RCVBATCH > 1)
+   int64_t  muxRcvBatchPktsTotal;       // number of UDP packets retrieved by batched UDP read calls
+   int64_t  muxRcvBatchFullTotal;       // number of batched UDP read calls that filled up the whole batch
+   int64_t  muxSndBatchCallsTotal;      // number of batched UDP send calls (SRTO_UDP_SNDBATCH > 1)
+   int64_t  muxSndBatchPktsTotal;       // number of UDP packets sent by batched UDP send calls
+   int64_t  muxSndGsoPktsTotal;         // number of UDP packets sent coalesced with GSO (SRTO_UDP_GSO)
+   int64_t  muxRcvGroBufsTotal;         // number of coalesced buffers received with GRO (SRTO_UDP_GRO)
+   int64_t  muxRcvGroPktsTotal;         // number of UDP packets split out of coalesced buffers
+   int64_t  muxSndTxTimePktsTotal;      // number of UDP packets passed to the system with their send time (SRTO_UDP_TXTIME)
+   int64_t  muxRcvUringPktsTotal;       // number of UDP packets received through io_uring (SRTO_UDP_IOURING)
+   int      muxSndWorkersBusy;          // number of sender threads (SRTO_SNDWORKERS) that have sent any data packets
+   int      muxRcvWorkersBusy;          // number of processing threads (SRTO_RCVWORKERS) that have processed any data packets
+
+   // Memory measurements
+   int64_t  byteSndBufAlloc;            // memory currently allocated for the sender buffer
+   int64_t  byteSndBufAllocPeak;        // highest memory allocated for the sender buffer
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -744,6 +774,19 @@ static const int SRT_ERROR = -1;
 SRT_API       int srt_startup(void);
 SRT_API       int srt_cleanup(void);
 
+// Number of threads shared by all multiplexers created after this call,
+// instead of two own threads in each of them (0 by default).
+SRT_API       int srt_setiothreads(int nthreads);
+
+// Number of threads shared by the TSBPD of all sockets starting to receive
+// after this call, instead of an own thread in each of them (0 by default).
+SRT_API       int srt_settsbpdthreads(int nthreads);
+
+// Number of threads shared by all AES-CTR encrypting sockets starting to send
+// after this call, which prepare the keystream of their next packets so that
+// the sending thread only applies it (0 by default).
+SRT_API       int srt_setcryptothreads(int nthreads);
+
 //
 // Socket operations
 //
@@ -835,6 +878,13 @@ SRT_API int srt_send    (SRTSOCKET u, const char* buf, int len);
 SRT_API int srt_sendmsg (SRTSOCKET u, const char* buf, int len, int ttl/* = -1*/, int inorder/* = false*/);
 SRT_API int srt_sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL *mctrl);
 
+// Zero-copy sending: the payload is not copied, but referred to until it's
+// acknowledged or dropped, and shortly after that the release function is called
+// with the buffer and the size accepted for sending, in one of the SRT threads.
+typedef void srt_send_release_fn(void* opaque, const char* buf, int len);
+SRT_API int srt_sendmsg_zc(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL *mctrl,
+                           srt_send_release_fn* release, void* opaque);
+
 //
 // Receiving functions
 //
@@ -844,6 +894,24 @@ SRT_API int srt_recv    (SRTSOCKET u, char* buf, int len);
 SRT_API int srt_recvmsg (SRTSOCKET u, char* buf, int len);
 SRT_API int srt_recvmsg2(SRTSOCKET u, char *buf, int len, SRT_MSGCTRL *mctrl);
 
+// Zero-copy receiving: the payloads of the packets of one or more whole
+// messages are lent to the application in place, one view per packet, until
+// given back by srt_recvmsg_zc_release. Until then they occupy the space in
+// the receiver buffer, and no more than its size can be lent. The views become
+// invalid when the socket is closed: their packets are returned to the queue
+// shared by the sockets of the multiplexer and reused for other sockets.
+typedef struct SRT_MsgView
+{
+   const char* data;     // payload of the packet (read only)
+   int len;              // size of the payload
+   int msgend;           // 1 if this is the last packet of the message, otherwise 0
+   SRT_MSGCTRL mctrl;    // message control data of the message, as from srt_recvmsg2
+   void* unit;           // internal: the lent packet
+} SRT_MSGVIEW;
+
+SRT_API int srt_recvmsg_zc(SRTSOCKET u, SRT_MSGVIEW* views, int nviews);
+SRT_API int srt_recvmsg_zc_release(SRTSOCKET u, const SRT_MSGVIEW* views, int nviews);
+
 
 // Special send/receive functions for files only.
 #define SRT_DEFAULT_SENDFILE_BLOCK 364000
@@ -31,6 +31,9 @@ extern "C" {
 
 int srt_startup() { return CUDT::startup(); }
 int srt_cleanup() { return CUDT::cleanup(); }
+int srt_setiothreads(int nthreads) { return CUDT::setIoThreads(nthreads); }
+int srt_settsbpdthreads(int nthreads) { return CUDT::setTsbPdThreads(nthreads); }
+int srt_setcryptothreads(int nthreads) { return CUDT::setCryptoThreads(nthreads); }
 
 // Socket creation.
 SRTSOCKET srt_socket(int , int , int ) { return CUDT::socket(); }
@@ -231,6 +234,15 @@ int srt_sendmsg2(SRTSOCKET u, const char * buf, int len, SRT_MSGCTRL *mctrl)
     return CUDT::sendmsg2(u, buf, len, (mignore));
 }
 
+int srt_sendmsg_zc(SRTSOCKET u, const char * buf, int len, SRT_MSGCTRL *mctrl,
+                   srt_send_release_fn* release, void* opaque)
+{
+    if (mctrl)
+        return CUDT::sendmsg2(u, buf, len, (*mctrl), release, opaque);
+    SRT_MSGCTRL mignore = srt_msgctrl_default;
+    return CUDT::sendmsg2(u, buf, len, (mignore), release, opaque);
+}
+
 int srt_recvmsg2(SRTSOCKET u, char * buf, int len, SRT_MSGCTRL *mctrl)
 {
     if (mctrl)
@@ -239,6 +251,16 @@ int srt_recvmsg2(SRTSOCKET u, char * buf, int len, SRT_MSGCTRL *mctrl)
     return CUDT::recvmsg2(u, buf, len, (mignore));
 }
 
+int srt_recvmsg_zc(SRTSOCKET u, SRT_MSGVIEW* views, int nviews)
+{
+    return CUDT::recvmsgViews(u, views, nviews);
+}
+
+int srt_recvmsg_zc_release(SRTSOCKET u, const SRT_MSGVIEW* views, int nviews)
+{
+    return CUDT::releaseMsgViews(u, views, nviews);
+}
+
 const char* srt_getlasterror_str() { return UDT::getlasterror().getErrorMessage(); }
 
 int srt_getlasterror(int* loc_errno)
@@ -0,0 +1,274 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2024 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#include "platform_sys.h"
+
+#ifdef SRT_ENABLE_IOURING
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "uring.h"
+
+namespace srt
+{
+
+CUring::CUring()
+    : m_iFd(-1)
+    , m_uFeatures(0)
+    , m_pSqRing(NULL)
+    , m_zSqRingSize(0)
+    , m_puSqHead(NULL)
+    , m_puSqTail(NULL)
+    , m_uSqMask(0)
+    , m_uSqEntries(0)
+    , m_puSqArray(NULL)
+    , m_pSqes(NULL)
+    , m_zSqesSize(0)
+    , m_uSqLocalTail(0)
+    , m_pCqRing(NULL)
+    , m_zCqRingSize(0)
+    , m_puCqHead(NULL)
+    , m_puCqTail(NULL)
+    , m_uCqMask(0)
+    , m_pCqes(NULL)
+    , m_pBufRing(NULL)
+    , m_zBufRingSize(0)
+    , m_uBufMask(0)
+    , m_uBufTail(0)
+    , m_uBgid(0)
+    , m_zBufferSize(0)
+{
+}
+
+CUring::~CUring()
+{
+    close();
+}
+
+bool CUring::open(unsigned entries, unsigned cq_entries)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof params);
+    if (cq_entries)
+    {
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = cq_entries;
+    }
+
+    const int fd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+    if (fd == -1)
+        return false;
+
+    m_iFd       = fd;
+    m_uFeatures = params.features;
+
+    // Waiting with a timeout requires EXT_ARG (Linux 5.11), and the completions
+    // must not be lost when the completion queue is full (NODROP, Linux 5.5).
+    if ((m_uFeatures & IORING_FEAT_EXT_ARG) == 0 || (m_uFeatures & IORING_FEAT_NODROP) == 0)
+    {
+        close();
+        return false;
+    }
+
+    m_zSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_zCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (m_uFeatures & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (m_zCqRingSize > m_zSqRingSize)
+            m_zSqRingSize = m_zCqRingSize;
+        m_zCqRingSize = 0;
+    }
+
+    m_pSqRing = ::mmap(NULL, m_zSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFd, IORING_OFF_SQ_RING);
+    if (m_pSqRing == MAP_FAILED)
+    {
+        m_pSqRing = NULL;
+        close();
+        return false;
+    }
+
+    if (m_zCqRingSize == 0)
+    {
+        m_pCqRing = m_pSqRing;
+    }
+    else
+    {
+        m_pCqRing = ::mmap(NULL, m_zCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFd, IORING_OFF_CQ_RING);
+        if (m_pCqRing == MAP_FAILED)
+        {
+            m_pCqRing = NULL;
+            close();
+            return false;
+        }
+    }
+
+    m_zSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes  = ::mmap(NULL, m_zSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    m_pSqes = (io_uring_sqe*)sqes;
+
+    char* sq       = (char*)m_pSqRing;
+    m_puSqHead     = (unsigned*)(sq + params.sq_off.head);
+    m_puSqTail     = (unsigned*)(sq + params.sq_off.tail);
+    m_uSqMask      = *(unsigned*)(sq + params.sq_off.ring_mask);
+    m_uSqEntries   = *(unsigned*)(sq + params.sq_off.ring_entries);
+    m_puSqArray    = (unsigned*)(sq + params.sq_off.array);
+    m_uSqLocalTail = *m_puSqTail;
+
+    char* cq   = (char*)m_pCqRing;
+    m_puCqHead = (unsigned*)(cq + params.cq_off.head);
+    m_puCqTail = (unsigned*)(cq + params.cq_off.tail);
+    m_uCqMask  = *(unsigned*)(cq + params.cq_off.ring_mask);
+    m_pCqes    = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+void CUring::close()
+{
+    // Closing the ring cancels all pending requests
+    // and unregisters the provided buffers.
+    if (m_iFd != -1)
+    {
+        ::close(m_iFd);
+        m_iFd = -1;
+    }
+
+    if (m_pBufRing)
+    {
+        ::munmap(m_pBufRing, m_zBufRingSize);
+        m_pBufRing = NULL;
+    }
+
+    if (m_pSqes)
+    {
+        ::munmap(m_pSqes, m_zSqesSize);
+        m_pSqes = NULL;
+    }
+
+    if (m_pCqRing && m_pCqRing != m_pSqRing)
+        ::munmap(m_pCqRing, m_zCqRingSize);
+    m_pCqRing = NULL;
+
+    if (m_pSqRing)
+    {
+        ::munmap(m_pSqRing, m_zSqRingSize);
+        m_pSqRing = NULL;
+    }
+
+    std::vector<char>().swap(m_vBuffers);
+}
+
+io_uring_sqe* CUring::getSqe()
+{
+    const unsigned head = __atomic_load_n(m_puSqHead, __ATOMIC_ACQUIRE);
+    if (m_uSqLocalTail - head >= m_uSqEntries)
+        return NULL;
+
+    const unsigned index = m_uSqLocalTail & m_uSqMask;
+    io_uring_sqe*  sqe   = &m_pSqes[index];
+    memset(sqe, 0, sizeof *sqe);
+    m_puSqArray[index] = index;
+    ++m_uSqLocalTail;
+    return sqe;
+}
+
+int CUring::enter(unsigned wait_nr, int timeout_us)
+{
+    // Only this thread writes the tail.
+    const unsigned to_submit = m_uSqLocalTail - *m_puSqTail;
+    __atomic_store_n(m_puSqTail, m_uSqLocalTail, __ATOMIC_RELEASE);
+
+    unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+    if (wait_nr == 0 || timeout_us < 0)
+        return (int)::syscall(__NR_io_uring_enter, m_iFd, to_submit, wait_nr, flags, NULL, 0);
+
+    __kernel_timespec ts;
+    ts.tv_sec  = timeout_us / 1000000;
+    ts.tv_nsec = (timeout_us % 1000000) * 1000;
+
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof arg);
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts         = (__u64)(uintptr_t)&ts;
+    flags |= IORING_ENTER_EXT_ARG;
+    return (int)::syscall(__NR_io_uring_enter, m_iFd, to_submit, wait_nr, flags, &arg, sizeof arg);
+}
+
+const io_uring_cqe* CUring::peekCqe() const
+{
+    // Only this thread writes the head.
+    const unsigned head = *m_puCqHead;
+    if (head == __atomic_load_n(m_puCqTail, __ATOMIC_ACQUIRE))
+        return NULL;
+    return &m_pCqes[head & m_uCqMask];
+}
+
+void CUring::seenCqe()
+{
+    __atomic_store_n(m_puCqHead, *m_puCqHead + 1, __ATOMIC_RELEASE);
+}
+
+bool CUring::setupBufferRing(unsigned short bgid, unsigned count, size_t size)
+{
+    m_zBufRingSize = count * sizeof(io_uring_buf);
+    void* ring     = ::mmap(NULL, m_zBufRingSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ring == MAP_FAILED)
+        return false;
+    m_pBufRing = (io_uring_buf*)ring;
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof reg);
+    reg.ring_addr    = (__u64)(uintptr_t)ring;
+    reg.ring_entries = count;
+    reg.bgid         = bgid;
+    if (::syscall(__NR_io_uring_register, m_iFd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    {
+        ::munmap(m_pBufRing, m_zBufRingSize);
+        m_pBufRing = NULL;
+        return false;
+    }
+
+    m_uBufMask    = count - 1;
+    m_uBufTail    = 0;
+    m_uBgid       = bgid;
+    m_zBufferSize = size;
+    m_vBuffers.resize(count * size);
+    for (unsigned i = 0; i < count; ++i)
+        recycleBuffer((unsigned short)i);
+
+    return true;
+}
+
+void CUring::recycleBuffer(unsigned short bid)
+{
+    // The ring tail overlays the last field of the first entry, so only
+    // the other fields are written here.
+    io_uring_buf& buf = m_pBufRing[m_uBufTail & m_uBufMask];
+    buf.addr          = (__u64)(uintptr_t)buffer(bid);
+    buf.len           = (__u32)m_zBufferSize;
+    buf.bid           = bid;
+    ++m_uBufTail;
+    __atomic_store_n(&m_pBufRing[0].resv, m_uBufTail, __ATOMIC_RELEASE);
+}
+
+} // namespace srt
+
+#endif // SRT_ENABLE_IOURING
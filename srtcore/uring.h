@@ -0,0 +1,117 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2024 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_URING_H
+#define INC_SRT_URING_H
+
+#ifdef SRT_ENABLE_IOURING
+
+#include <cstddef>
+#include <vector>
+#include <linux/io_uring.h>
+
+namespace srt
+{
+
+/// A minimal io_uring instance, used by CChannel for the UDP socket I/O
+/// (SRTO_UDP_IOURING). This uses the system calls directly, so that there's
+/// no dependency on liburing. An object is used by a single thread only.
+class CUring
+{
+public:
+    CUring();
+    ~CUring();
+
+    /// Create the ring.
+    /// @param [in] entries number of submission queue entries
+    /// @param [in] cq_entries number of completion queue entries (0 for default)
+    /// @return false if io_uring isn't supported or lacks a required feature.
+    bool open(unsigned entries, unsigned cq_entries);
+
+    void close();
+
+    bool isOpen() const { return m_iFd != -1; }
+
+    /// Get the ring descriptor, which is readable when there are completions.
+    int fd() const { return m_iFd; }
+
+    /// Get a cleared submission queue entry to fill in. It's submitted by the next enter().
+    /// @return the entry, or NULL if the submission queue is full.
+    io_uring_sqe* getSqe();
+
+    /// Submit the entries obtained by getSqe() and wait for completions.
+    /// @param [in] wait_nr number of completions to wait for
+    /// @param [in] timeout_us maximum time to wait, -1 to wait without a limit
+    /// @return number of submitted entries, or -1 with errno set (ETIME on timeout).
+    int enter(unsigned wait_nr, int timeout_us);
+
+    /// Get the next completion, to be followed by seenCqe().
+    /// @return the completion, or NULL if there's none.
+    const io_uring_cqe* peekCqe() const;
+
+    /// Release the completion returned by peekCqe().
+    void seenCqe();
+
+    /// Register a ring of provided buffers, to be used by the requests with
+    /// IOSQE_BUFFER_SELECT and the given buffer group.
+    /// @param [in] bgid buffer group ID
+    /// @param [in] count number of buffers, a power of 2
+    /// @param [in] size size of a single buffer
+    /// @return false if not supported by the system.
+    bool setupBufferRing(unsigned short bgid, unsigned count, size_t size);
+
+    char*  buffer(unsigned short bid) { return &m_vBuffers[bid * m_zBufferSize]; }
+    size_t bufferSize() const { return m_zBufferSize; }
+
+    /// Give back the buffer to the system to receive data into.
+    void recycleBuffer(unsigned short bid);
+
+private:
+    int      m_iFd;
+    unsigned m_uFeatures;
+
+    // Submission queue
+    void*         m_pSqRing;
+    size_t        m_zSqRingSize;
+    unsigned*     m_puSqHead;
+    unsigned*     m_puSqTail;
+    unsigned      m_uSqMask;
+    unsigned      m_uSqEntries;
+    unsigned*     m_puSqArray;
+    io_uring_sqe* m_pSqes;
+    size_t        m_zSqesSize;
+    unsigned      m_uSqLocalTail; // including the entries not yet submitted
+
+    // Completion queue
+    void*         m_pCqRing;
+    size_t        m_zCqRingSize;
+    unsigned*     m_puCqHead;
+    unsigned*     m_puCqTail;
+    unsigned      m_uCqMask;
+    io_uring_cqe* m_pCqes;
+
+    // Provided buffers
+    io_uring_buf*     m_pBufRing;
+    size_t            m_zBufRingSize;
+    unsigned          m_uBufMask;
+    unsigned short    m_uBufTail;
+    unsigned short    m_uBgid;
+    std::vector<char> m_vBuffers;
+    size_t            m_zBufferSize;
+
+    CUring(const CUring&);
+    CUring& operator=(const CUring&);
+};
+
+} // namespace srt
+
+#endif // SRT_ENABLE_IOURING
+
+#endif
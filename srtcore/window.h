@@ -219,13 +219,15 @@ public:
    }
 
    /// Record time information of an arrived packet.
+   /// @param pktsz size of the packet
+   /// @param tsArrival arrival time of the packet
 
-   void onPktArrival(int pktsz = 0)
+   void onPktArrival(int pktsz, const sync::steady_clock::time_point& tsArrival)
    {
        SRT_ASSERT(m_zHeaderSize != 0 && m_zPayloadSize != 0);
        sync::ScopedLock cg(m_lockPktWindow);
 
-       m_tsCurrArrTime = sync::steady_clock::now();
+       m_tsCurrArrTime = tsArrival;
 
        // record the packet interval between the current and the last one
        m_aPktWindow[m_iPktWindowPtr] = (int) sync::count_microseconds(m_tsCurrArrTime - m_tsLastArrTime);
@@ -240,8 +242,19 @@ public:
        m_tsLastArrTime = m_tsCurrArrTime;
    }
 
+   /// Record the arrival of a packet received coalesced with others (UDP GRO),
+   /// whose own arrival time is unknown. Only the interval from @a tsArrival
+   /// to the next packet recorded with onPktArrival() is measured.
+   /// @param tsArrival arrival time of the buffer of coalesced packets
+
+   void onCoalescedPktArrival(const sync::steady_clock::time_point& tsArrival)
+   {
+       sync::ScopedLock cg(m_lockPktWindow);
+       m_tsLastArrTime = tsArrival;
+   }
+
    /// Shortcut to test a packet for possible probe 1 or 2
-   void probeArrival(const CPacket& pkt, bool unordered)
+   void probeArrival(const CPacket& pkt, bool unordered, const sync::steady_clock::time_point& tsArrival)
    {
        SRT_ASSERT(m_zHeaderSize != 0 && m_zPayloadSize != 0);
        const int inorder16 = pkt.seqno() & PUMASK_SEQNO_PROBE;
@@ -249,7 +262,7 @@ public:
        // for probe1, we want 16th packet
        if (inorder16 == 0)
        {
-           probe1Arrival(pkt, unordered);
+           probe1Arrival(pkt, unordered, tsArrival);
        }
 
        if (unordered)
@@ -258,12 +271,12 @@ public:
        // for probe2, we want 17th packet
        if (inorder16 == 1)
        {
-           probe2Arrival(pkt);
+           probe2Arrival(pkt, tsArrival);
        }
    }
 
    /// Record the arrival time of the first probing packet.
-   void probe1Arrival(const CPacket& pkt, bool unordered)
+   void probe1Arrival(const CPacket& pkt, bool unordered, const sync::steady_clock::time_point& tsArrival)
    {
        SRT_ASSERT(m_zHeaderSize != 0 && m_zPayloadSize != 0);
        if (unordered && pkt.seqno() == m_Probe1Sequence)
@@ -275,13 +288,13 @@ public:
            return;
        }
 
-       m_tsProbeTime = sync::steady_clock::now();
+       m_tsProbeTime = tsArrival;
        m_Probe1Sequence = pkt.seqno(); // Record the sequence where 16th packet probe was taken
    }
 
    /// Record the arrival time of the second probing packet and the interval between packet pairs.
 
-   void probe2Arrival(const CPacket& pkt)
+   void probe2Arrival(const CPacket& pkt, const sync::steady_clock::time_point& tsArrival)
    {
        SRT_ASSERT(m_zHeaderSize != 0 && m_zPayloadSize != 0);
        // Reject probes that don't refer to the very next packet
@@ -295,15 +308,10 @@ public:
        if (m_Probe1Sequence == SRT_SEQNO_NONE || CSeqNo::incseq(m_Probe1Sequence) != pkt.seqno())
            return;
 
-       // Grab the current time before trying to acquire
-       // a mutex. This might add extra delay and therefore
-       // screw up the measurement.
-       const sync::steady_clock::time_point now = sync::steady_clock::now();
-
        // Lock access to the packet Window
        sync::ScopedLock cg(m_lockProbeWindow);
 
-       m_tsCurrArrTime = now;
+       m_tsCurrArrTime = tsArrival;
 
        // Reset the starting probe to prevent checking if the
        // measurement was already taken.
@@ -458,6 +458,76 @@ TEST_F(CRcvBufferReadMsg, SmallReadBuffer)
     EXPECT_EQ(m_unit_queue->size(), m_unit_queue->capacity());
 }
 
+// Check lending the units of a message instead of reading it.
+// The lent units keep occupying the buffer space until released.
+TEST_F(CRcvBufferReadMsg, LendMessage)
+{
+    const size_t msg_pkts = 4;
+    addMessage(msg_pkts, 1, m_init_seqno, false);
+    ackPackets(msg_pkts);
+    EXPECT_EQ(getAvailBufferSize(), m_buff_size_pkts - 1 - int(msg_pkts));
+
+    // The message doesn't fit, nothing is lent.
+    vector<CUnit*> units;
+    EXPECT_EQ(m_rcv_buffer->lendMessage(units, msg_pkts - 1), -1);
+    EXPECT_TRUE(units.empty());
+    EXPECT_TRUE(m_rcv_buffer->isRcvDataReady());
+
+    SRT_MSGCTRL mctrl = srt_msgctrl_default;
+    EXPECT_EQ(m_rcv_buffer->lendMessage(units, msg_pkts, &mctrl), int(msg_pkts * m_payload_sz));
+    ASSERT_EQ(units.size(), msg_pkts);
+    EXPECT_EQ(mctrl.msgno, 1);
+    for (size_t i = 0; i < msg_pkts; ++i)
+    {
+        EXPECT_TRUE(verifyPayload(units[i]->m_Packet.data(), m_payload_sz, CSeqNo::incseq(m_init_seqno, int(i))));
+    }
+
+    // The message is gone from the buffer, but its units are still in use.
+    EXPECT_FALSE(m_rcv_buffer->isRcvDataReady());
+    EXPECT_EQ(m_rcv_buffer->countLent(), msg_pkts);
+    EXPECT_EQ(getAvailBufferSize(), m_buff_size_pkts - 1 - int(msg_pkts));
+    EXPECT_EQ(m_unit_queue->size(), m_unit_queue->capacity() - int(msg_pkts));
+
+    for (size_t i = 0; i < msg_pkts; ++i)
+        EXPECT_TRUE(m_rcv_buffer->releaseLent(units[i]));
+    EXPECT_FALSE(m_rcv_buffer->releaseLent(units[0]));
+
+    EXPECT_EQ(m_rcv_buffer->countLent(), 0u);
+    EXPECT_EQ(getAvailBufferSize(), m_buff_size_pkts - 1);
+    EXPECT_EQ(m_unit_queue->size(), m_unit_queue->capacity());
+}
+
+// The units lent and not released can't exceed the buffer capacity, as
+// they are taken from the unit queue shared with the other sockets.
+TEST_F(CRcvBufferReadMsg, LendMessageLimit)
+{
+    const int capacity = m_buff_size_pkts - 1;
+    vector<CUnit*> units;
+    int seqno = m_init_seqno;
+    for (int i = 0; i < capacity; ++i)
+    {
+        addMessage(1, i + 1, seqno, false);
+        seqno = CSeqNo::incseq(seqno);
+        ackPackets(1);
+        ASSERT_EQ(m_rcv_buffer->lendMessage(units, 1), int(m_payload_sz)) << "message " << i;
+    }
+    EXPECT_EQ(m_rcv_buffer->countLent(), size_t(capacity));
+    EXPECT_EQ(getAvailBufferSize(), 0);
+
+    // A packet in flight arrives to the free buffer space, but can't be lent.
+    addMessage(1, capacity + 1, seqno, false);
+    ackPackets(1);
+    EXPECT_EQ(m_rcv_buffer->lendMessage(units, 1), -2);
+    EXPECT_EQ(units.size(), size_t(capacity));
+    EXPECT_TRUE(m_rcv_buffer->isRcvDataReady());
+
+    EXPECT_TRUE(m_rcv_buffer->releaseLent(units[0]));
+    EXPECT_EQ(m_rcv_buffer->lendMessage(units, 1), int(m_payload_sz));
+    for (size_t i = 1; i < units.size(); ++i)
+        EXPECT_TRUE(m_rcv_buffer->releaseLent(units[i]));
+    EXPECT_EQ(m_rcv_buffer->countLent(), 0u);
+}
+
 // BUG!!!
 // Checks signaling of read-readiness of a half-acknowledged message.
 // The RCV buffer implementation has an issue here: when only half of the message is
@@ -0,0 +1,467 @@
+#include <iostream>
+#include <vector>
+#include "gtest/gtest.h"
+#include "buffer_snd.h"
+#include "sync.h"
+
+using namespace srt;
+using namespace srt::sync;
+using namespace std;
+
+namespace
+{
+
+const int     g_payload_size = 1456;
+const int32_t g_init_seqno   = 1000;
+
+// Adds the messages of the given number of packets, each packet
+// filled with its sequence number. Returns the next sequence number.
+int32_t addMessages(CSndBuffer& buf, int32_t seqno, int num_msgs, int msg_pkts, int ttl = -1)
+{
+    vector<char> data(g_payload_size * msg_pkts);
+    for (int i = 0; i < num_msgs; ++i)
+    {
+        for (int p = 0; p < msg_pkts; ++p)
+        {
+            const int32_t pkt_seqno = CSeqNo::incseq(seqno, p);
+            memcpy(&data[p * g_payload_size], &pkt_seqno, sizeof pkt_seqno);
+        }
+
+        SRT_MSGCTRL mctrl = srt_msgctrl_default;
+        mctrl.pktseq      = seqno;
+        mctrl.msgttl      = ttl;
+        buf.addBuffer(&data[0], (int)data.size(), (mctrl));
+        seqno = mctrl.pktseq;
+    }
+    return seqno;
+}
+
+// Reads the packet at the given offset from the first one for a retransmission.
+// The first packet in the buffer has @a first_seqno, which moves on with the ACKs.
+int readRexmit(CSndBuffer& buf, int offset, CPacket& w_pkt, int32_t first_seqno = g_init_seqno)
+{
+    steady_clock::time_point  origin;
+    CSndBuffer::DropRange     drop;
+    w_pkt.set_seqno(CSeqNo::incseq(first_seqno, offset));
+    return buf.readData(offset, (w_pkt), (origin), (drop));
+}
+
+} // namespace
+
+/// Packets are read for the first time in order, and then for the
+/// retransmission at any offset, also after the buffer has grown.
+TEST(CSndBuffer, ReadAndRexmit)
+{
+    CSndBuffer buf(AF_INET, 32, g_payload_size, 0);
+
+    // Grow the buffer several times, with single and multi-packet messages.
+    const int32_t end = addMessages(buf, addMessages(buf, g_init_seqno, 100, 1), 50, 3);
+    const int     num = CSeqNo::seqlen(g_init_seqno, end) - 1;
+    ASSERT_EQ(num, 250);
+    EXPECT_EQ(buf.getCurrBufSize(), num);
+
+    for (int i = 0; i < num; ++i)
+    {
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+        EXPECT_EQ(skipped, 0);
+        EXPECT_EQ(pkt.seqno(), CSeqNo::incseq(g_init_seqno, i));
+    }
+
+    CPacket                  pkt;
+    steady_clock::time_point origin;
+    int                      skipped = 0;
+    EXPECT_EQ(buf.readData((pkt), (origin), 0, (skipped)), CSndBuffer::READ_NONE);
+
+    const int offsets[] = {0, 1, 99, 100, 101, 200, num - 1};
+    for (size_t i = 0; i < sizeof offsets / sizeof offsets[0]; ++i)
+    {
+        ASSERT_EQ(readRexmit(buf, offsets[i], (pkt)), g_payload_size);
+        int32_t stamped = 0;
+        memcpy(&stamped, pkt.m_pcData, sizeof stamped);
+        EXPECT_EQ(stamped, pkt.seqno());
+        EXPECT_FALSE(is_zero(buf.getPacketRexmitTime(offsets[i])));
+    }
+    EXPECT_TRUE(is_zero(buf.getPacketRexmitTime(2)));
+    EXPECT_EQ(readRexmit(buf, num, (pkt)), CSndBuffer::READ_NONE);
+
+    // Message numbers: 100 single-packet messages, then 3 packets each.
+    EXPECT_EQ(buf.getMsgNoAt(99), 100);
+    EXPECT_EQ(buf.getMsgNoAt(100), 101);
+    EXPECT_EQ(buf.getMsgNoAt(102), 101);
+    EXPECT_EQ(buf.getMsgNoAt(103), 102);
+}
+
+/// Acknowledging releases the packets from the front, and the offsets
+/// are then counted from the new first packet.
+TEST(CSndBuffer, AckData)
+{
+    CSndBuffer buf(AF_INET, 32, g_payload_size, 0);
+    addMessages(buf, g_init_seqno, 40, 1);
+
+    // Send out half of them.
+    for (int i = 0; i < 20; ++i)
+    {
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+    }
+
+    buf.ackData(10);
+    EXPECT_EQ(buf.getCurrBufSize(), 30);
+    int bytes = 0, timespan = 0;
+    EXPECT_EQ(buf.getCurrBufSize((bytes), (timespan)), 30);
+    EXPECT_EQ(bytes, 30 * g_payload_size);
+    EXPECT_EQ(buf.getMsgNoAt(0), 11);
+
+    // Acknowledging past the packets sent moves the sending position too.
+    buf.ackData(15);
+    CPacket                  pkt;
+    steady_clock::time_point origin;
+    int                      skipped = 0;
+    ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+    EXPECT_EQ(pkt.seqno(), CSeqNo::incseq(g_init_seqno, 25));
+
+    // The ring wraps around without growing.
+    addMessages(buf, CSeqNo::incseq(g_init_seqno, 40), 10, 1);
+    EXPECT_EQ(buf.getCurrBufSize(), 25);
+    EXPECT_EQ(buf.getMsgNoAt(24), 50);
+    buf.ackData(25);
+    EXPECT_EQ(buf.getCurrBufSize((bytes), (timespan)), 0);
+    EXPECT_EQ(bytes, 0);
+}
+
+/// The packets older than the given time are dropped from the front.
+TEST(CSndBuffer, DropLateData)
+{
+    CSndBuffer buf(AF_INET, 32, g_payload_size, 0);
+    addMessages(buf, g_init_seqno, 10, 2);
+    const steady_clock::time_point mid = steady_clock::now() + milliseconds_from(1);
+    sync::this_thread::sleep_for(milliseconds_from(2));
+    addMessages(buf, CSeqNo::incseq(g_init_seqno, 20), 10, 2);
+
+    int     bytes       = 0;
+    int32_t first_msgno = 0;
+    EXPECT_EQ(buf.dropLateData((bytes), (first_msgno), mid), 20);
+    EXPECT_EQ(bytes, 20 * g_payload_size);
+    EXPECT_EQ(first_msgno, 11);
+    EXPECT_EQ(buf.getCurrBufSize(), 20);
+
+    // The sending continues from the first remaining packet.
+    CPacket                  pkt;
+    steady_clock::time_point origin;
+    int                      skipped = 0;
+    ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+    EXPECT_EQ(pkt.seqno(), CSeqNo::incseq(g_init_seqno, 20));
+}
+
+/// A message with expired TTL is reported for dropping as a whole.
+TEST(CSndBuffer, RexmitExpiredTTL)
+{
+    CSndBuffer buf(AF_INET, 32, g_payload_size, 0);
+    addMessages(buf, g_init_seqno, 4, 3, 1);
+    sync::this_thread::sleep_for(milliseconds_from(5));
+
+    CPacket                  pkt;
+    steady_clock::time_point origin;
+    CSndBuffer::DropRange    drop;
+    pkt.set_seqno(CSeqNo::incseq(g_init_seqno, 3));
+    ASSERT_EQ(buf.readData(3, (pkt), (origin), (drop)), CSndBuffer::READ_DROP);
+    EXPECT_EQ(drop.msgno, 2);
+    EXPECT_EQ(drop.seqno[CSndBuffer::DropRange::BEGIN], CSeqNo::incseq(g_init_seqno, 3));
+    EXPECT_EQ(drop.seqno[CSndBuffer::DropRange::END], CSeqNo::incseq(g_init_seqno, 5));
+}
+
+namespace
+{
+
+// Reads all packets not yet sent and checks they follow from the given sequence number.
+void expectUnsent(CSndBuffer& buf, int32_t seqno, int num)
+{
+    for (int i = 0; i < num; ++i)
+    {
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+        int32_t stamped = 0;
+        memcpy(&stamped, pkt.m_pcData, sizeof stamped);
+        EXPECT_EQ(pkt.seqno(), seqno);
+        EXPECT_EQ(stamped, seqno);
+        seqno = CSeqNo::incseq(seqno);
+    }
+}
+
+} // namespace
+
+/// After a period of low use the buffer is shrunk by halves down to the
+/// initial size, keeping the packets in it and releasing the memory.
+TEST(CSndBuffer, Reclaim)
+{
+    int64_t peak = 0;
+    const int64_t initial_mem = CSndBuffer(AF_INET, 32, g_payload_size, 0).getMemoryUse((peak));
+
+    CSndBuffer buf(AF_INET, 32, g_payload_size, 0);
+    buf.setReclaimMinSize(1);
+    addMessages(buf, g_init_seqno, 500, 1);
+    const int64_t grown_mem = buf.getMemoryUse((peak));
+    EXPECT_EQ(grown_mem, initial_mem * 16);
+    EXPECT_EQ(peak, grown_mem);
+
+    // Send all but 5 packets, and get all but 10 acknowledged.
+    expectUnsent(buf, g_init_seqno, 495);
+    buf.ackData(490);
+
+    const steady_clock::time_point  start  = steady_clock::now();
+    const steady_clock::duration    period = milliseconds_from(CSndBuffer::RECLAIM_PERIOD_MS);
+    EXPECT_FALSE(buf.reclaim(start));
+    EXPECT_FALSE(buf.reclaim(start + period / 2));
+
+    int shrinks = 0;
+    for (int i = 1; i < 10; ++i)
+    {
+        if (buf.reclaim(start + period * i))
+            ++shrinks;
+    }
+    // 512 blocks down to 32.
+    EXPECT_EQ(shrinks, 4);
+    EXPECT_EQ(buf.getMemoryUse((peak)), initial_mem);
+    EXPECT_EQ(peak, grown_mem);
+    EXPECT_EQ(buf.getCurrBufSize(), 10);
+
+    // The packets were kept, and the buffer grows again when needed.
+    for (int i = 0; i < 10; ++i)
+    {
+        CPacket pkt;
+        ASSERT_EQ(readRexmit(buf, i, (pkt), CSeqNo::incseq(g_init_seqno, 490)), g_payload_size);
+        int32_t stamped = 0;
+        memcpy(&stamped, pkt.m_pcData, sizeof stamped);
+        EXPECT_EQ(stamped, CSeqNo::incseq(g_init_seqno, 490 + i));
+    }
+    expectUnsent(buf, CSeqNo::incseq(g_init_seqno, 495), 5);
+    addMessages(buf, CSeqNo::incseq(g_init_seqno, 500), 100, 1);
+    expectUnsent(buf, CSeqNo::incseq(g_init_seqno, 500), 100);
+    EXPECT_EQ(buf.getMemoryUse((peak)), initial_mem * 4);
+}
+
+/// The buffer is not shrunk below the low watermark, nor when it was
+/// used during the period, nor when reclaiming is off.
+TEST(CSndBuffer, ReclaimLimits)
+{
+    int64_t peak = 0;
+    const int64_t initial_mem = CSndBuffer(AF_INET, 32, g_payload_size, 0).getMemoryUse((peak));
+    const steady_clock::time_point start  = steady_clock::now();
+    const steady_clock::duration   period = milliseconds_from(CSndBuffer::RECLAIM_PERIOD_MS);
+
+    CSndBuffer off(AF_INET, 32, g_payload_size, 0);
+    addMessages(off, g_init_seqno, 500, 1);
+    off.ackData(500);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_FALSE(off.reclaim(start + period * i));
+    EXPECT_EQ(off.getMemoryUse((peak)), initial_mem * 16);
+
+    // 100 packets are kept in 128 blocks.
+    CSndBuffer wm(AF_INET, 32, g_payload_size, 0);
+    wm.setReclaimMinSize(100 * g_payload_size);
+    addMessages(wm, g_init_seqno, 500, 1);
+    wm.ackData(500);
+    for (int i = 0; i < 10; ++i)
+        wm.reclaim(start + period * i);
+    EXPECT_EQ(wm.getMemoryUse((peak)), initial_mem * 4);
+
+    // Over a quarter of the buffer used within the period.
+    CSndBuffer busy(AF_INET, 32, g_payload_size, 0);
+    busy.setReclaimMinSize(1);
+    addMessages(busy, g_init_seqno, 200, 1);
+    busy.ackData(200);
+    EXPECT_FALSE(busy.reclaim(start));
+    addMessages(busy, CSeqNo::incseq(g_init_seqno, 200), 70, 1);
+    busy.ackData(70);
+    EXPECT_FALSE(busy.reclaim(start + period));
+    EXPECT_TRUE(busy.reclaim(start + period * 2));
+}
+
+/// With AES-GCM the authentication tag, stored in the buffer right after
+/// the payload, is retransmitted with it, also after the buffer is shrunk.
+TEST(CSndBuffer, ReclaimKeepsAuthTag)
+{
+    const int authtag = 16; // HAICRYPT_AUTHTAG_MAX
+    CSndBuffer buf(AF_INET, 32, g_payload_size + authtag, authtag);
+    buf.setReclaimMinSize(1);
+    addMessages(buf, g_init_seqno, 500, 1);
+
+    // The packets are encrypted in place when sent for the first
+    // time, and the tag is written past the end of the payload.
+    for (int i = 0; i < 500; ++i)
+    {
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+        memset(pkt.m_pcData + g_payload_size, char(i), authtag);
+    }
+    buf.ackData(490);
+
+    const steady_clock::time_point start  = steady_clock::now();
+    const steady_clock::duration   period = milliseconds_from(CSndBuffer::RECLAIM_PERIOD_MS);
+    int shrinks = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        if (buf.reclaim(start + period * i))
+            ++shrinks;
+    }
+    EXPECT_EQ(shrinks, 4);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        CPacket pkt;
+        ASSERT_EQ(readRexmit(buf, i, (pkt), CSeqNo::incseq(g_init_seqno, 490)), g_payload_size);
+        const vector<char> tag(pkt.m_pcData + g_payload_size, pkt.m_pcData + g_payload_size + authtag);
+        EXPECT_EQ(tag, vector<char>(authtag, char(490 + i))) << "packet " << i;
+    }
+}
+
+namespace
+{
+
+struct ReleaseLog
+{
+    vector<pair<const char*, int> > released;
+
+    static void onRelease(void* opaque, const char* buf, int len)
+    {
+        static_cast<ReleaseLog*>(opaque)->released.push_back(make_pair(buf, len));
+    }
+};
+
+} // namespace
+
+/// The packets refer to the user data, which are released some time after
+/// the last packet of the message is acknowledged or dropped, or at destruction.
+TEST(CSndBuffer, ZeroCopyRelease)
+{
+    const steady_clock::duration delay = milliseconds_from(CSndBuffer::RELEASE_DELAY_MS);
+    ReleaseLog log;
+    vector<char> data(g_payload_size * 3 * 4);
+    {
+        CSndBuffer buf(AF_INET, 32, g_payload_size, 0);
+        int32_t seqno = g_init_seqno;
+        for (int m = 0; m < 4; ++m)
+        {
+            SRT_MSGCTRL mctrl = srt_msgctrl_default;
+            mctrl.pktseq      = seqno;
+            buf.addBuffer(&data[m * 3 * g_payload_size], 3 * g_payload_size, (mctrl), &ReleaseLog::onRelease, &log);
+            seqno = mctrl.pktseq;
+        }
+
+        for (int i = 0; i < 12; ++i)
+        {
+            CPacket                  pkt;
+            steady_clock::time_point origin;
+            int                      skipped = 0;
+            ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+            EXPECT_EQ(pkt.m_pcData, &data[i * g_payload_size]);
+        }
+        CPacket pkt;
+        ASSERT_EQ(readRexmit(buf, 4, (pkt)), g_payload_size);
+        EXPECT_EQ(pkt.m_pcData, &data[4 * g_payload_size]);
+
+        // Not until the last packet of the message.
+        buf.ackData(2);
+        buf.releaseDeferred(steady_clock::now() + delay);
+        EXPECT_TRUE(log.released.empty());
+        buf.ackData(1);
+        buf.releaseDeferred(steady_clock::now() + delay);
+        ASSERT_EQ(log.released.size(), 1U);
+        EXPECT_EQ(log.released[0].first, &data[0]);
+        EXPECT_EQ(log.released[0].second, 3 * g_payload_size);
+
+        int     bytes       = 0;
+        int32_t first_msgno = 0;
+        EXPECT_EQ(buf.dropLateData((bytes), (first_msgno), steady_clock::now() + seconds_from(1)), 9);
+        EXPECT_EQ(log.released.size(), 1U);
+        buf.releaseDeferred(steady_clock::now() + delay);
+        EXPECT_EQ(log.released.size(), 4U);
+
+        SRT_MSGCTRL mctrl = srt_msgctrl_default;
+        mctrl.pktseq      = seqno;
+        buf.addBuffer(&data[0], g_payload_size, (mctrl), &ReleaseLog::onRelease, &log);
+    }
+    ASSERT_EQ(log.released.size(), 5U);
+    EXPECT_EQ(log.released[4].first, &data[0]);
+    EXPECT_EQ(log.released[4].second, g_payload_size);
+}
+
+/// A packet read for a retransmission may be still on its way to the network
+/// when the message is acknowledged, so the user data are not released
+/// until the delay has passed.
+TEST(CSndBuffer, ZeroCopyAckDuringRexmit)
+{
+    const steady_clock::duration delay = milliseconds_from(CSndBuffer::RELEASE_DELAY_MS);
+    ReleaseLog   log;
+    vector<char> data(g_payload_size * 2);
+
+    CSndBuffer  buf(AF_INET, 32, g_payload_size, 0);
+    SRT_MSGCTRL mctrl = srt_msgctrl_default;
+    mctrl.pktseq      = g_init_seqno;
+    buf.addBuffer(&data[0], (int)data.size(), (mctrl), &ReleaseLog::onRelease, &log);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        ASSERT_EQ(buf.readData((pkt), (origin), 0, (skipped)), g_payload_size);
+    }
+
+    // The retransmission is being sent when the ACK comes.
+    CPacket rexmit;
+    ASSERT_EQ(readRexmit(buf, 1, (rexmit)), g_payload_size);
+    EXPECT_EQ(rexmit.m_pcData, &data[g_payload_size]);
+    const steady_clock::time_point acked = steady_clock::now();
+    buf.ackData(2);
+    EXPECT_EQ(buf.getCurrBufSize(), 0);
+    EXPECT_TRUE(log.released.empty());
+
+    buf.releaseDeferred(acked);
+    EXPECT_TRUE(log.released.empty());
+    buf.releaseDeferred(acked + delay / 2);
+    EXPECT_TRUE(log.released.empty());
+
+    // Only now the packet has been long sent.
+    buf.releaseDeferred(acked + delay);
+    ASSERT_EQ(log.released.size(), 1U);
+    EXPECT_EQ(log.released[0].first, &data[0]);
+    EXPECT_EQ(log.released[0].second, 2 * g_payload_size);
+}
+
+// Measures the time of a retransmission lookup (readData at an offset
+// spread over the whole window) for the given number of packets in flight.
+static double measureRexmitLookup(int window, int lookups)
+{
+    CSndBuffer buf(AF_INET, 32, g_payload_size, 0);
+    addMessages(buf, g_init_seqno, window, 1);
+
+    CPacket pkt;
+    unsigned pos = 1;
+    const steady_clock::time_point start = steady_clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+        pos = pos * 1103515245 + 12345;
+        readRexmit(buf, int(pos % unsigned(window)), (pkt));
+    }
+    return double(count_microseconds(steady_clock::now() - start)) * 1000.0 / lookups;
+}
+
+TEST(CSndBuffer, DISABLED_RexmitLookupBenchmark)
+{
+    const int windows[] = {1000, 8192, 25600, 102400};
+    for (size_t i = 0; i < sizeof windows / sizeof windows[0]; ++i)
+    {
+        const double ns = measureRexmitLookup(windows[i], 200000);
+        cerr << windows[i] << " packets in flight: " << ns << " ns per rexmit lookup\n";
+    }
+}
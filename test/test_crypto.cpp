@@ -108,3 +108,77 @@ namespace srt
 } // namespace srt
 
 #endif //SRT_ENABLE_ENCRYPTION && ENABLE_AEAD_API_PREVIEW
+
+#if defined(SRT_ENABLE_ENCRYPTION)
+#include "crypto.h"
+#include "socketconfig.h"
+#include "sync.h"
+#include "test_env.h"
+
+// Encrypts packets with the keystream prepared by the shared thread (srt_setcryptothreads),
+// including over the key refreshes, and checks that they decrypt to the original payload.
+TEST(Crypto, KeystreamThread)
+{
+    srt::TestInit srtinit;
+    ASSERT_EQ(srt_setcryptothreads(1), 0);
+
+    srt::CSrtConfig cfg;
+    const std::string pwd = "abcdefghijk";
+    memset(&cfg.CryptoSecret, 0, sizeof(cfg.CryptoSecret));
+    cfg.CryptoSecret.typ = HAICRYPT_SECTYP_PASSPHRASE;
+    cfg.CryptoSecret.len = pwd.size();
+    memcpy((cfg.CryptoSecret.str), pwd.c_str(), pwd.size());
+    cfg.iSndCryptoKeyLen  = 16;
+    cfg.iCryptoMode       = srt::CSrtConfig::CIPHER_MODE_AES_CTR;
+    cfg.uKmRefreshRatePkt = 500;
+    cfg.uKmPreAnnouncePkt = 100;
+
+    srt::CCryptoControl crypt(1);
+    crypt.setCryptoSecret(cfg.CryptoSecret);
+    crypt.setCryptoKeylen(cfg.iSndCryptoKeyLen);
+    ASSERT_TRUE(crypt.init(srt::HSD_INITIATOR, cfg, true));
+
+    // Apply the key to the receiver part, as the peer would.
+    const unsigned char* kmmsg = crypt.getKmMsg_data(0);
+    const size_t km_len = crypt.getKmMsg_size(0);
+    uint32_t kmout[72];
+    size_t kmout_len = 72;
+    std::array<uint32_t, 72> km_nworder;
+    NtoHLA(km_nworder.data(), reinterpret_cast<const uint32_t*>(kmmsg), km_len);
+    crypt.processSrtMsg_KMREQ(km_nworder.data(), km_len, 5, kmout, kmout_len);
+
+    const size_t pld_size = 1316;
+    srt::CPacket pkt;
+    pkt.allocate(1500);
+    std::vector<char> payload(pld_size);
+
+    int32_t seqno = srt::CSeqNo::m_iMaxSeqNo - 700; // also over the wrap
+    for (int i = 0; i < 2000; ++i, seqno = srt::CSeqNo::incseq(seqno))
+    {
+        std::iota(payload.begin(), payload.end(), char(i));
+        std::copy(payload.begin(), payload.end(), pkt.data());
+        pkt.setLength(pld_size);
+        pkt.set_seqno(seqno);
+        pkt.set_msgflags(1 | srt::PacketBoundaryBits(srt::PB_SOLO) | srt::MSGNO_ENCKEYSPEC::wrap(crypt.getSndCryptoFlags()));
+
+        ASSERT_EQ(crypt.encrypt(pkt), srt::ENCS_CLEAR) << "at " << i;
+        EXPECT_NE(memcmp(pkt.data(), &payload[0], pld_size), 0) << "at " << i;
+        ASSERT_EQ(crypt.decrypt(pkt), srt::ENCS_CLEAR) << "at " << i;
+        ASSERT_EQ(memcmp(pkt.data(), &payload[0], pld_size), 0) << "at " << i;
+
+        // Refresh the keys, applying them to the receiver part as well.
+        crypt.regenCryptoKm(NULL, true);
+
+        // Let the thread catch up sometimes, so that the most
+        // of the packets use the prepared keystream.
+        if (i % 64 == 0)
+            srt::sync::this_thread::sleep_for(srt::sync::milliseconds_from(5));
+    }
+
+    // Not all of them, as the keys are refreshed in the meantime.
+    EXPECT_GT(crypt.keystreamPackets(), 0);
+
+    crypt.close();
+    EXPECT_EQ(srt_setcryptothreads(0), 0);
+}
+#endif // SRT_ENABLE_ENCRYPTION
@@ -1,11 +1,14 @@
 #include <iostream>
+#include <vector>
 #include "gtest/gtest.h"
 #include "test_env.h"
 #include "common.h"
 #include "list.h"
+#include "sync.h"
 
 using namespace std;
 using namespace srt;
+using namespace srt::sync;
 
 class CRcvLossListTest
     : public ::testing::Test
@@ -74,19 +77,18 @@ TEST_F(CRcvLossListTest, InsertTwoElemsEdge)
 TEST(CRcvFreshLossListTest, CheckFreshLossList)
 {
     srt::TestInit srtinit;
-    std::deque<CRcvFreshLoss> floss {
-        CRcvFreshLoss (10, 15, 5),
-        CRcvFreshLoss (25, 29, 10),
-        CRcvFreshLoss (30, 30, 3),
-        CRcvFreshLoss (45, 80, 100)
-    };
+    CRcvFreshLossList floss;
+    floss.insert(10, 15, 5);
+    floss.insert(25, 29, 10);
+    floss.insert(30, 30, 3);
+    floss.insert(45, 80, 100);
 
     EXPECT_EQ(floss.size(), 4);
 
     // Ok, now let's do element removal
 
     int had_ttl = 0;
-    bool rm = CRcvFreshLoss::removeOne((floss), 26, &had_ttl);
+    bool rm = floss.removeOne(26, &had_ttl);
 
     EXPECT_EQ(rm, true);
     EXPECT_EQ(had_ttl, 10);
@@ -96,44 +98,147 @@ TEST(CRcvFreshLossListTest, CheckFreshLossList)
     // After revoking 25 it should have removed it.
 
     // SPLIT
-    rm = CRcvFreshLoss::removeOne((floss), 27, &had_ttl);
+    rm = floss.removeOne(27, &had_ttl);
     EXPECT_EQ(rm, true);
     EXPECT_EQ(had_ttl, 10);
     EXPECT_EQ(floss.size(), 5);
 
     // STRIP
-    rm = CRcvFreshLoss::removeOne((floss), 28, &had_ttl);
+    rm = floss.removeOne(28, &had_ttl);
     EXPECT_EQ(rm, true);
     EXPECT_EQ(had_ttl, 10);
     EXPECT_EQ(floss.size(), 5);
 
     // DELETE
-    rm = CRcvFreshLoss::removeOne((floss), 25, &had_ttl);
+    rm = floss.removeOne(25, &had_ttl);
     EXPECT_EQ(rm, true);
     EXPECT_EQ(had_ttl, 10);
     EXPECT_EQ(floss.size(), 4);
 
     // SPLIT
-    rm = CRcvFreshLoss::removeOne((floss), 50, &had_ttl);
+    rm = floss.removeOne(50, &had_ttl);
     EXPECT_EQ(rm, true);
     EXPECT_EQ(had_ttl, 100);
     EXPECT_EQ(floss.size(), 5);
 
     // DELETE
-    rm = CRcvFreshLoss::removeOne((floss), 30, &had_ttl);
+    rm = floss.removeOne(30, &had_ttl);
     EXPECT_EQ(rm, true);
     EXPECT_EQ(had_ttl, 3);
     EXPECT_EQ(floss.size(), 4);
 
     // Remove nonexistent sequence, but existing before.
-    rm = CRcvFreshLoss::removeOne((floss), 25, NULL);
+    rm = floss.removeOne(25, NULL);
     EXPECT_EQ(rm, false);
     EXPECT_EQ(floss.size(), 4);
 
     // Remove nonexistent sequence that didn't exist before.
-    rm = CRcvFreshLoss::removeOne((floss), 31, &had_ttl);
+    rm = floss.removeOne(31, &had_ttl);
     EXPECT_EQ(rm, false);
     EXPECT_EQ(had_ttl, 0);
     EXPECT_EQ(floss.size(), 4);
 
 }
+
+// The TTL of all the records decreases with every expire() call, and
+// only the expired records at the front are taken.
+TEST(CRcvFreshLossListTest, ExpireAndRevoke)
+{
+    srt::TestInit srtinit;
+    CRcvFreshLossList floss;
+    typedef std::vector< std::pair<int32_t, int32_t> > ranges_t;
+
+    // Records crossing the sequence number overflow.
+    const int32_t base = CSeqNo::m_iMaxSeqNo - 5;
+    floss.insert(base, CSeqNo::incseq(base, 2), 2);
+    floss.insert(CSeqNo::incseq(base, 4), CSeqNo::incseq(base, 8), 1);
+    floss.insert(CSeqNo::incseq(base, 10), CSeqNo::incseq(base, 12), 5);
+
+    ranges_t expired;
+    floss.expire((expired));
+    floss.expire((expired));
+    EXPECT_TRUE(expired.empty());
+
+    // The second record has expired, but it must wait for the first one.
+    floss.expire((expired));
+    ASSERT_EQ(expired.size(), 2U);
+    EXPECT_EQ(expired[0], std::make_pair(base, CSeqNo::incseq(base, 2)));
+    EXPECT_EQ(expired[1], std::make_pair(CSeqNo::incseq(base, 4), CSeqNo::incseq(base, 8)));
+    EXPECT_EQ(floss.size(), 1U);
+
+    int had_ttl = 0;
+    EXPECT_TRUE(floss.removeOne(CSeqNo::incseq(base, 11), &had_ttl));
+    EXPECT_EQ(had_ttl, 2);
+    EXPECT_EQ(floss.size(), 2U);
+
+    // Add more and drop up to the middle of the new one.
+    floss.insert(20, 29, 10);
+    floss.revoke(SRT_SEQNO_NONE, 24);
+    EXPECT_EQ(floss.size(), 1U);
+    EXPECT_FALSE(floss.removeOne(24, NULL));
+    EXPECT_TRUE(floss.removeOne(25, &had_ttl));
+    EXPECT_EQ(had_ttl, 10);
+
+    // Newer than the dropped range, nothing removed.
+    floss.revoke(10, 15);
+    EXPECT_EQ(floss.size(), 1U);
+
+    expired.clear();
+    for (int i = 0; i < 10; ++i)
+        floss.expire((expired));
+    EXPECT_TRUE(expired.empty());
+    floss.expire((expired));
+    ASSERT_EQ(expired.size(), 1U);
+    EXPECT_EQ(expired[0], std::make_pair(26, 29));
+    EXPECT_TRUE(floss.empty());
+}
+
+// Measures a round of the receiver's loss handling for a window of the
+// given number of packets, where every loss burst of the given length is
+// followed by as many received packets: the losses are recorded as the
+// packets come, reported every 16 bursts, recovered one by one in the
+// order of the reports, and what remains is dropped at the end.
+static double measureRcvLossRound(int window, int burst, int rounds)
+{
+    CRcvLossList list(window);
+    int32_t      base = CSeqNo::m_iMaxSeqNo - window; // cross the wrap-around
+
+    vector<int32_t> report(1456 / 4);
+    int             len = 0;
+
+    const steady_clock::time_point start = steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (int off = 0, k = 0; off + burst <= window; off += 2 * burst, ++k)
+        {
+            list.insert(CSeqNo::incseq(base, off), CSeqNo::incseq(base, off + burst - 1));
+            if (k % 16 == 15)
+                list.getLossArray(&report[0], (len), int(report.size()));
+        }
+
+        for (int off = 0; off + burst <= window / 2; off += 2 * burst)
+        {
+            for (int i = 0; i < burst; ++i)
+                list.remove(CSeqNo::incseq(base, off + i));
+        }
+
+        list.removeUpTo(CSeqNo::incseq(base, window - 1));
+        EXPECT_EQ(list.getLossLength(), 0);
+        base = CSeqNo::incseq(base, window);
+    }
+    return double(count_microseconds(steady_clock::now() - start)) / rounds;
+}
+
+TEST(CRcvLossListBenchmark, DISABLED_BurstLoss)
+{
+    const int windows[] = {1000, 8192, 25600, 102400};
+    const int bursts[]  = {1, 16, 256};
+    for (size_t i = 0; i < sizeof windows / sizeof windows[0]; ++i)
+    {
+        for (size_t j = 0; j < sizeof bursts / sizeof bursts[0]; ++j)
+        {
+            const double us = measureRcvLossRound(windows[i], bursts[j], 20);
+            cerr << windows[i] << " packets in flight, bursts of " << bursts[j] << ": " << us << " us per round\n";
+        }
+    }
+}
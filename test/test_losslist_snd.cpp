@@ -1,10 +1,13 @@
 #include <iostream>
+#include <vector>
 #include "gtest/gtest.h"
 #include "common.h"
 #include "list.h"
+#include "sync.h"
 
 using namespace std;
 using namespace srt;
+using namespace srt::sync;
 
 class CSndLossListTest
     : public ::testing::Test
@@ -633,3 +636,49 @@ TEST_F(CSndLossListTest, InsertUpdateElement01)
     EXPECT_EQ(m_lossList->insert(2, 5), 0);
     EXPECT_EQ(m_lossList->getLossLength(), 8);
 }
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// Measures a round of the sender's loss handling for a window of the given
+// number of packets in flight, where every loss burst of the given length is
+// followed by as many delivered packets: the bursts are reported, reported
+// again by the periodic NAK while half of them is retransmitted, and then
+// the whole window is acknowledged.
+static double measureSndLossRound(int window, int burst, int rounds)
+{
+    CSndLossList list(window * 2);
+    int32_t      base = CSeqNo::m_iMaxSeqNo - window; // cross the wrap-around
+
+    const steady_clock::time_point start = steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (int off = 0; off + burst <= window; off += 2 * burst)
+            list.insert(CSeqNo::incseq(base, off), CSeqNo::incseq(base, off + burst - 1));
+
+        for (int i = 0; i < window / 4; ++i)
+            list.popLostSeq();
+
+        for (int off = 0; off + burst <= window; off += 2 * burst)
+            list.insert(CSeqNo::incseq(base, off), CSeqNo::incseq(base, off + burst - 1));
+
+        list.removeUpTo(CSeqNo::incseq(base, window - 1));
+        EXPECT_EQ(list.getLossLength(), 0);
+        base = CSeqNo::incseq(base, window);
+    }
+    return double(count_microseconds(steady_clock::now() - start)) / rounds;
+}
+
+TEST(CSndLossListBenchmark, DISABLED_BurstLoss)
+{
+    const int windows[] = {1000, 8192, 25600, 102400};
+    const int bursts[]  = {1, 16, 256};
+    for (size_t i = 0; i < sizeof windows / sizeof windows[0]; ++i)
+    {
+        for (size_t j = 0; j < sizeof bursts / sizeof bursts[0]; ++j)
+        {
+            const double us = measureSndLossRound(windows[i], bursts[j], 20);
+            cerr << windows[i] << " packets in flight, bursts of " << bursts[j] << ": " << us << " us per round\n";
+        }
+    }
+}
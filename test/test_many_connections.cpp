@@ -2,6 +2,7 @@
 
 #include <array>
 #include <chrono>
+#include <fstream>
 #include <future>
 #include <random>
 #include <gtest/gtest.h>
@@ -12,6 +13,7 @@
 #define rand_r rand_s
 #define INC_SRT_WIN_WINTIME // exclude gettimeofday from srt headers
 #else
+#include <dirent.h>
 typedef int SOCKET;
 #define INVALID_SOCKET ((SOCKET)-1)
 #define closesocket close
@@ -85,6 +87,9 @@ protected:
     {
     }
 
+    // With @a shared_io, check that the multiplexers have no own threads.
+    void MultipleConnections(bool shared_io);
+
     void AcceptLoop()
     {
         for (;;)
@@ -127,6 +132,67 @@ protected:
 // Then all connections are closed. Some sockets may potentially still have undelivered packets.
 // This test tries to reproduce the issue described in #1182, and fixed by #1315.
 TEST_F(TestConnection, Multiple)
+{
+    MultipleConnections(false);
+}
+
+// The same with every caller socket bound to its own port, and all
+// multiplexers handled by two shared threads (srt_setiothreads).
+class TestConnectionIoThreads
+    : public TestConnection
+{
+protected:
+    void setup() override
+    {
+#ifdef __linux__
+        ASSERT_EQ(srt_setiothreads(2), 0);
+#else
+        EXPECT_EQ(srt_setiothreads(2), SRT_ERROR) << "supported on Linux only";
+#endif
+        TestConnection::setup();
+    }
+
+    void teardown() override
+    {
+        srt_setiothreads(0);
+        TestConnection::teardown();
+    }
+};
+
+TEST_F(TestConnectionIoThreads, Multiple)
+{
+#ifdef __linux__
+    MultipleConnections(true);
+#else
+    MultipleConnections(false);
+#endif
+}
+
+#ifdef __linux__
+// Count the threads of this process with the name starting with @a prefix.
+static int CountThreads(const string& prefix)
+{
+    int count = 0;
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir)
+        return -1;
+
+    while (dirent* ent = readdir(dir))
+    {
+        if (ent->d_name[0] == '.')
+            continue;
+
+        ifstream comm(string("/proc/self/task/") + ent->d_name + "/comm");
+        string name;
+        if (getline(comm, name) && name.compare(0, prefix.size(), prefix) == 0)
+            ++count;
+    }
+    closedir(dir);
+    return count;
+}
+#endif
+
+void TestConnection::MultipleConnections(bool shared_io)
 {
     const sockaddr_in lsa = m_sa;
     const sockaddr* psa = reinterpret_cast<const sockaddr*>(&lsa);
@@ -170,6 +236,17 @@ TEST_F(TestConnection, Multiple)
     }
     cerr << "Sending finished, closing caller sockets\n";
 
+#ifdef __linux__
+    if (shared_io)
+    {
+        EXPECT_EQ(CountThreads("SRT:SndQ"), 0);
+        EXPECT_EQ(CountThreads("SRT:RcvQ"), 0);
+        EXPECT_EQ(CountThreads("SRT:IoW"), 2);
+    }
+#else
+    (void)shared_io;
+#endif
+
     for (size_t i = 0; i < NSOCK; i++)
     {
         EXPECT_EQ(srt_close(m_connections[i]), SRT_SUCCESS);
@@ -191,3 +268,106 @@ TEST_F(TestConnection, Multiple)
 
 
 
+
+// The TSBPD of all receiving sockets done by two shared threads (srt_settsbpdthreads).
+class TestConnectionTsbPdThreads
+    : public TestConnection
+{
+protected:
+    void setup() override
+    {
+        ASSERT_EQ(srt_settsbpdthreads(2), 0);
+        TestConnection::setup();
+    }
+
+    void teardown() override
+    {
+        srt_settsbpdthreads(0);
+        TestConnection::teardown();
+    }
+};
+
+// The accepted sockets get read-ready through epoll not earlier than the
+// latency after the packets were sent, and all of them are received in order.
+TEST_F(TestConnectionTsbPdThreads, Receive)
+{
+    const sockaddr* psa = reinterpret_cast<const sockaddr*>(&m_sa);
+    const size_t    nconn = 20;
+    const int       nmsg  = 50;
+    const int       latency_ms = 120;
+
+    vector<SRTSOCKET> callers, accepted;
+    const int eid = srt_epoll_create();
+    for (size_t i = 0; i < nconn; ++i)
+    {
+        const SRTSOCKET caller = srt_create_socket();
+        ASSERT_NE(caller, SRT_INVALID_SOCK);
+        ASSERT_NE(srt_setsockflag(caller, SRTO_LATENCY, &latency_ms, sizeof latency_ms), SRT_ERROR);
+        callers.push_back(caller);
+        ASSERT_NE(srt_connect(caller, psa, sizeof m_sa), SRT_ERROR) << srt_getlasterror_str();
+
+        sockaddr_any addr;
+        int len = sizeof addr;
+        const SRTSOCKET acp = srt_accept(m_server_sock, addr.get(), &len);
+        ASSERT_NE(acp, SRT_INVALID_SOCK) << srt_getlasterror_str();
+        accepted.push_back(acp);
+
+        int no = 0;
+        ASSERT_NE(srt_setsockflag(acp, SRTO_RCVSYN, &no, sizeof no), SRT_ERROR);
+        const int events = SRT_EPOLL_IN;
+        ASSERT_NE(srt_epoll_add_usock(eid, acp, &events), SRT_ERROR);
+    }
+
+    const auto sent_at = chrono::steady_clock::now();
+    for (int n = 0; n < nmsg; ++n)
+    {
+        for (size_t i = 0; i < nconn; ++i)
+        {
+            m_buf[0] = char(n);
+            ASSERT_EQ(srt_sendmsg(callers[i], m_buf.data(), (int) m_buf.size(), -1, true), (int) m_buf.size());
+        }
+    }
+
+    vector<int> received(nconn, 0);
+    int remaining = int(nconn) * nmsg;
+    while (remaining > 0)
+    {
+        SRT_EPOLL_EVENT ready[nconn];
+        const int nready = srt_epoll_uwait(eid, ready, int(nconn), 5000);
+        ASSERT_GT(nready, 0) << "still waiting for " << remaining << " packets";
+        if (remaining == int(nconn) * nmsg)
+        {
+            // The clocks of both sides are the same here, so no drift is expected.
+            EXPECT_GE(chrono::steady_clock::now() - sent_at, chrono::milliseconds(latency_ms - 10));
+        }
+
+        for (int r = 0; r < nready; ++r)
+        {
+            const size_t i = find(accepted.begin(), accepted.end(), ready[r].fd) - accepted.begin();
+            ASSERT_LT(i, nconn);
+            array<char, SRT_LIVE_DEF_PLSIZE> buf;
+            int rd;
+            while ((rd = srt_recvmsg(accepted[i], buf.data(), (int) buf.size())) > 0)
+            {
+                ASSERT_EQ(rd, (int) m_buf.size());
+                EXPECT_EQ(buf[0], char(received[i]));
+                ++received[i];
+                --remaining;
+            }
+        }
+    }
+
+#ifdef __linux__
+    // Only the shared threads do the TSBPD.
+    EXPECT_EQ(CountThreads("SRT:TsbPdW"), 2);
+    EXPECT_EQ(CountThreads("SRT:TsbPd"), 2);
+#endif
+
+    srt_epoll_release(eid);
+    for (size_t i = 0; i < nconn; ++i)
+    {
+        EXPECT_EQ(srt_close(accepted[i]), SRT_SUCCESS);
+        EXPECT_EQ(srt_close(callers[i]), SRT_SUCCESS);
+    }
+    EXPECT_EQ(srt_close(m_server_sock), SRT_SUCCESS);
+}
@@ -0,0 +1,97 @@
+#include <map>
+#include <random>
+#include "gtest/gtest.h"
+#include "queue.h"
+
+using namespace std;
+using namespace srt;
+
+namespace
+{
+
+// The table only stores the pointers, so any value will do.
+CUDT* fakeSocket(int32_t id)
+{
+    return reinterpret_cast<CUDT*>(uintptr_t(id) * 8 + 8);
+}
+
+} // namespace
+
+TEST(CHash, InsertLookupRemove)
+{
+    CHash hash;
+    hash.init(16);
+
+    EXPECT_EQ(hash.lookup(100), nullptr);
+    hash.insert(100, fakeSocket(100));
+    hash.insert(200, fakeSocket(200));
+    EXPECT_EQ(hash.lookup(100), fakeSocket(100));
+    EXPECT_EQ(hash.lookup(200), fakeSocket(200));
+    EXPECT_EQ(hash.size(), 2);
+
+    // Inserting the same ID again replaces the entry.
+    hash.insert(100, fakeSocket(300));
+    EXPECT_EQ(hash.lookup(100), fakeSocket(300));
+    EXPECT_EQ(hash.size(), 2);
+
+    hash.remove(100);
+    EXPECT_EQ(hash.lookup(100), nullptr);
+    EXPECT_EQ(hash.lookup(200), fakeSocket(200));
+    hash.remove(100);
+    EXPECT_EQ(hash.size(), 1);
+}
+
+/// The table grows while it is used, and all entries can be found
+/// during and after the entries are moved to the bigger table.
+TEST(CHash, GrowWhileUsed)
+{
+    CHash hash;
+    hash.init(16);
+
+    map<int32_t, CUDT*> expected;
+    mt19937             rnd(1);
+    // The socket IDs are given out in decreasing order from a random start.
+    int32_t next_id = 0x3FFFFFFF;
+
+    for (int i = 0; i < 50000; ++i)
+    {
+        const int32_t id = next_id--;
+        hash.insert(id, fakeSocket(id));
+        expected[id] = fakeSocket(id);
+
+        // Close some random socket now and then.
+        if (i % 3 == 0)
+        {
+            map<int32_t, CUDT*>::iterator victim = expected.lower_bound(id + int32_t(rnd() % (i + 1)));
+            if (victim != expected.end())
+            {
+                hash.remove(victim->first);
+                expected.erase(victim);
+            }
+        }
+
+        if (i % 1000 == 0)
+        {
+            for (map<int32_t, CUDT*>::iterator s = expected.begin(); s != expected.end(); ++s)
+                ASSERT_EQ(hash.lookup(s->first), s->second) << "socket " << s->first;
+        }
+    }
+
+    EXPECT_EQ(hash.size(), int(expected.size()));
+    EXPECT_GE(hash.capacity(), hash.size());
+    for (map<int32_t, CUDT*>::iterator s = expected.begin(); s != expected.end(); ++s)
+        ASSERT_EQ(hash.lookup(s->first), s->second) << "socket " << s->first;
+
+    // The removed ones are not there any more.
+    for (int32_t id = next_id + 1; id <= 0x3FFFFFFF; ++id)
+    {
+        if (expected.count(id) == 0)
+        {
+            ASSERT_EQ(hash.lookup(id), nullptr) << "socket " << id;
+        }
+    }
+
+    for (map<int32_t, CUDT*>::iterator s = expected.begin(); s != expected.end(); ++s)
+        hash.remove(s->first);
+    EXPECT_EQ(hash.size(), 0);
+}
@@ -20,10 +20,65 @@
 #include "any.hpp"
 #include "socketconfig.h"
 #include "srt.h"
+#include "uring.h"
+
+#ifdef __linux__
+#include <netinet/udp.h>
+#include <linux/net_tstamp.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace srt;
 
+// Check if the system supports the UDP level socket option, which SRT
+// checks for the options turning on the system offload features.
+static bool SystemHasUDPOption(int option SRT_ATR_UNUSED)
+{
+#ifdef __linux__
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1)
+        return false;
+    int       value  = 0;
+    socklen_t optlen = sizeof value;
+    const bool has   = ::getsockopt(fd, SOL_UDP, option, &value, &optlen) == 0;
+    ::close(fd);
+    return has;
+#else
+    return false;
+#endif
+}
+
+// Check if the system supports io_uring with the features that SRT
+// requires for SRTO_UDP_IOURING.
+static bool SystemHasIoUring()
+{
+#ifdef SRT_ENABLE_IOURING
+    CUring ring;
+    return ring.open(4, 8) && ring.setupBufferRing(0, 4, 2048);
+#else
+    return false;
+#endif
+}
+
+// Check if the system accepts the send time of packets (SRTO_UDP_TXTIME).
+static bool SystemHasTxTime()
+{
+#if defined(__linux__) && defined(SO_TXTIME)
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1)
+        return false;
+    sock_txtime txtime_cfg;
+    txtime_cfg.clockid = CLOCK_MONOTONIC;
+    txtime_cfg.flags   = 0;
+    const bool has     = ::setsockopt(fd, SOL_SOCKET, SO_TXTIME, &txtime_cfg, sizeof txtime_cfg) == 0;
+    ::close(fd);
+    return has;
+#else
+    return false;
+#endif
+}
+
 
 class TestSocketOptions
     : public ::srt::Test
@@ -82,6 +137,78 @@ public:
         return accepted_sock;
     }
 
+    // Send @a num_msgs messages from every sender at the same time and check
+    // that the corresponding receivers get them complete and in order. The
+    // messages carry the message number and the index of the sender.
+    void ExchangeMessages(const vector<SRTSOCKET>& senders, const vector<SRTSOCKET>& receivers, int num_msgs)
+    {
+        ASSERT_EQ(senders.size(), receivers.size());
+        char buffer[1316] = {};
+        for (int n = 0; n < num_msgs; ++n)
+        {
+            for (size_t i = 0; i < senders.size(); ++i)
+            {
+                buffer[0] = char(n);
+                buffer[1] = char(n >> 8);
+                buffer[2] = char(i);
+                ASSERT_EQ(srt_sendmsg(senders[i], buffer, sizeof buffer, -1, true), (int) sizeof buffer);
+            }
+        }
+
+        for (size_t i = 0; i < receivers.size(); ++i)
+        {
+            for (int n = 0; n < num_msgs; ++n)
+            {
+                ASSERT_EQ(srt_recvmsg(receivers[i], buffer, sizeof buffer), (int) sizeof buffer);
+                EXPECT_EQ(buffer[0], char(n));
+                EXPECT_EQ(buffer[1], char(n >> 8));
+                EXPECT_EQ(buffer[2], char(i));
+            }
+        }
+    }
+
+    void ExchangeMessages(SRTSOCKET sender, SRTSOCKET receiver, int num_msgs)
+    {
+        ExchangeMessages(vector<SRTSOCKET>(1, sender), vector<SRTSOCKET>(1, receiver), num_msgs);
+    }
+
+    // Connect @a num_callers callers, the first of which is m_caller_sock, to
+    // the listener, which must be listening already, and accept them. All the
+    // callers are created first, so that the accepted sockets get consecutive
+    // socket IDs.
+    void ConnectCallers(int num_callers, vector<SRTSOCKET>& w_callers, vector<SRTSOCKET>& w_accepted)
+    {
+        const int yes = 1;
+        w_callers.push_back(m_caller_sock);
+        for (int i = 1; i < num_callers; ++i)
+        {
+            const SRTSOCKET caller = srt_create_socket();
+            ASSERT_NE(caller, SRT_INVALID_SOCK);
+            ASSERT_EQ(srt_setsockopt(caller, 0, SRTO_RCVSYN, &yes, sizeof yes), SRT_SUCCESS);
+            w_callers.push_back(caller);
+        }
+
+        for (int i = 0; i < num_callers; ++i)
+        {
+            ASSERT_NE(srt_connect(w_callers[i], (sockaddr*)&m_sa, sizeof m_sa), SRT_ERROR);
+
+            sockaddr_in client_address;
+            int length = sizeof client_address;
+            const SRTSOCKET sock = srt_accept(m_listen_sock, (sockaddr*)&client_address, &length);
+            ASSERT_NE(sock, SRT_INVALID_SOCK);
+            w_accepted.push_back(sock);
+        }
+    }
+
+    // Close the sockets made by ConnectCallers(), except m_caller_sock.
+    void CloseCallers(const vector<SRTSOCKET>& callers, const vector<SRTSOCKET>& accepted)
+    {
+        for (size_t i = 0; i < accepted.size(); ++i)
+            EXPECT_NE(srt_close(accepted[i]), SRT_ERROR);
+        for (size_t i = 1; i < callers.size(); ++i)
+            EXPECT_NE(srt_close(callers[i]), SRT_ERROR);
+    }
+
 protected:
     // setup() is run immediately before a test starts.
     void setup()
@@ -217,9 +344,11 @@ const OptionTestEntry g_test_matrix_options[] =
     { SRTO_RCVTIMEO,           "SRTO_RCVTIMEO", RestrictionType::POST,    sizeof(int),                -1, INT32_MAX,  -1, 2000, {-2} },
     //SRTO_RENDEZVOUS
     { SRTO_RETRANSMITALGO, "SRTO_RETRANSMITALGO", RestrictionType::PRE,   sizeof(int),                 0,         1,   1,    0, {-1, 2} },
+    { SRTO_SNDBURST,       "SRTO_SNDBURST",       RestrictionType::PRE,   sizeof(int),                 1,       256,   1,    8, {-1, 0, 257} },
     //SRTO_REUSEADDR
     //SRTO_SENDER
     { SRTO_SNDBUF,              "SRTO_SNDBUF",  RestrictionType::PREBIND, sizeof(int), (int)(32 * SRT_PKT_SIZE), 2147483256, (int)(8192 * SRT_PKT_SIZE), 1000000, {-1} },
+    { SRTO_SNDBUFRECLAIM, "SRTO_SNDBUFRECLAIM", RestrictionType::PRE,     sizeof(int),                 0, INT32_MAX,         0,      100000,    {-1} },
     //SRTO_SNDDATA
     { SRTO_SNDDROPDELAY,  "SRTO_SNDDROPDELAY", RestrictionType::POST,     sizeof(int),                -1, INT32_MAX, 0, 1500, {-2} },
     //SRTO_SNDKMSTATE
@@ -230,6 +359,16 @@ const OptionTestEntry g_test_matrix_options[] =
     { SRTO_TLPKTDROP,        "SRTO_TLPKTDROP",  RestrictionType::PRE,    sizeof(bool),             false,      true,     true, false, {} },
     //SRTO_TRANSTYPE
     //SRTO_TSBPDMODE
+    { SRTO_UDP_RCVBATCH,  "SRTO_UDP_RCVBATCH", RestrictionType::PREBIND, sizeof(int),                 1,       256,   1,   32, {-1, 0, 257} },
+    { SRTO_UDP_SNDBATCH,  "SRTO_UDP_SNDBATCH", RestrictionType::PREBIND, sizeof(int),                 1,       256,   1,   32, {-1, 0, 257} },
+    { SRTO_UDP_GRO,            "SRTO_UDP_GRO", RestrictionType::PREBIND, sizeof(bool),            false,      true, false, true, {} },
+    { SRTO_UDP_GSO,            "SRTO_UDP_GSO", RestrictionType::PREBIND, sizeof(bool),            false,      true, false, true, {} },
+    { SRTO_UDP_RCVTIMESTAMP, "SRTO_UDP_RCVTIMESTAMP", RestrictionType::PREBIND, sizeof(bool),      false,      true, false, true, {} },
+    { SRTO_UDP_TXTIME,      "SRTO_UDP_TXTIME", RestrictionType::PREBIND, sizeof(bool),            false,      true, false, true, {} },
+    { SRTO_UDP_IOURING,    "SRTO_UDP_IOURING", RestrictionType::PREBIND, sizeof(bool),            false,      true, false, true, {} },
+    { SRTO_UDP_SHARDS,      "SRTO_UDP_SHARDS", RestrictionType::PREBIND, sizeof(int),                 1,        64,   1,    4, {-1, 0, 65} },
+    { SRTO_SNDWORKERS,      "SRTO_SNDWORKERS", RestrictionType::PREBIND, sizeof(int),                 1,        64,   1,    4, {-1, 0, 65} },
+    { SRTO_RCVWORKERS,      "SRTO_RCVWORKERS", RestrictionType::PREBIND, sizeof(int),                 1,        64,   1,    4, {-1, 0, 65} },
     //SRTO_UDP_RCVBUF
     //SRTO_UDP_SNDBUF
     //SRTO_VERSION
@@ -734,6 +873,346 @@ TEST_F(TestSocketOptions, LossMaxTTL)
     ASSERT_NE(srt_close(accepted_sock), SRT_ERROR);
 }
 
+// Check that data are transmitted correctly with batched sending
+// on the caller's multiplexer (SRTO_UDP_SNDBATCH) and batched reading
+// on the listener's multiplexer (SRTO_UDP_RCVBATCH).
+TEST_F(TestSocketOptions, UDPBatch)
+{
+    const int batch = 16;
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_RCVBATCH, &batch, sizeof batch), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_caller_sock, 0, SRTO_UDP_SNDBATCH, &batch, sizeof batch), SRT_SUCCESS);
+
+    StartListener();
+    const SRTSOCKET accepted_sock = EstablishConnection();
+
+    int opt_val = 0;
+    int opt_len = (int) sizeof opt_val;
+    ASSERT_EQ(srt_getsockopt(accepted_sock, 0, SRTO_UDP_RCVBATCH, &opt_val, &opt_len), SRT_SUCCESS);
+    EXPECT_EQ(opt_val, batch) << "Wrong SRTO_UDP_RCVBATCH value on the accepted socket";
+
+    const int num_msgs = 200;
+    ExchangeMessages(m_caller_sock, accepted_sock, num_msgs);
+
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(accepted_sock, &stats, 0), SRT_SUCCESS);
+#ifdef __linux__
+    EXPECT_GT(stats.muxRcvBatchCallsTotal, 0);
+    EXPECT_GE(stats.muxRcvBatchPktsTotal, num_msgs);
+    EXPECT_LE(stats.muxRcvBatchFullTotal, stats.muxRcvBatchCallsTotal);
+#endif
+
+    EXPECT_EQ(srt_bstats(m_caller_sock, &stats, 0), SRT_SUCCESS);
+#ifdef __linux__
+    EXPECT_GT(stats.muxSndBatchPktsTotal, 0);
+    EXPECT_LE(stats.muxSndBatchCallsTotal, stats.muxSndBatchPktsTotal);
+#endif
+    EXPECT_LE(stats.muxSndBatchPktsTotal, num_msgs);
+
+    ASSERT_NE(srt_close(accepted_sock), SRT_ERROR);
+}
+
+// Check that the packets are sent coalesced with UDP GSO enabled on the
+// caller's multiplexer and received coalesced with UDP GRO enabled on the
+// listener's multiplexer, if the system supports them. Otherwise they must
+// be still sent and received normally.
+TEST_F(TestSocketOptions, UDPGsoGro)
+{
+    const int  batch = 16;
+    const bool yes   = true;
+    ASSERT_EQ(srt_setsockopt(m_caller_sock, 0, SRTO_UDP_SNDBATCH, &batch, sizeof batch), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_caller_sock, 0, SRTO_UDP_GSO, &yes, sizeof yes), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_GRO, &yes, sizeof yes), SRT_SUCCESS);
+
+    StartListener();
+    const SRTSOCKET accepted_sock = EstablishConnection();
+
+    const int num_msgs = 200;
+    ExchangeMessages(m_caller_sock, accepted_sock, num_msgs);
+
+    SRT_TRACEBSTATS snd_stats, rcv_stats;
+    EXPECT_EQ(srt_bstats(m_caller_sock, &snd_stats, 0), SRT_SUCCESS);
+    EXPECT_EQ(srt_bstats(accepted_sock, &rcv_stats, 0), SRT_SUCCESS);
+    EXPECT_LE(snd_stats.muxSndGsoPktsTotal, snd_stats.muxSndBatchPktsTotal);
+    EXPECT_LE(rcv_stats.muxRcvGroBufsTotal, rcv_stats.muxRcvGroPktsTotal);
+    ASSERT_NE(srt_close(accepted_sock), SRT_ERROR);
+
+#if defined(UDP_SEGMENT) && defined(UDP_GRO)
+    if (!SystemHasUDPOption(UDP_SEGMENT) || !SystemHasUDPOption(UDP_GRO))
+#endif
+    {
+        GTEST_SKIP() << "UDP GSO or GRO is not supported by the system";
+    }
+
+    // GRO on the loopback device keeps together the packets sent with GSO.
+    EXPECT_GT(snd_stats.muxSndGsoPktsTotal, 0);
+    EXPECT_GT(rcv_stats.muxRcvGroBufsTotal, 0);
+    EXPECT_GT(rcv_stats.muxRcvGroPktsTotal, rcv_stats.muxRcvGroBufsTotal);
+}
+
+// Check that data are transmitted correctly and the RTT is measured with
+// the system receive timestamps used on both sides. The listener reads
+// in batches, the caller one packet at a time.
+TEST_F(TestSocketOptions, UDPRcvTimestamp)
+{
+    const int  batch = 16;
+    const bool yes   = true;
+    ASSERT_EQ(srt_setsockopt(m_caller_sock, 0, SRTO_UDP_RCVTIMESTAMP, &yes, sizeof yes), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_RCVTIMESTAMP, &yes, sizeof yes), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_RCVBATCH, &batch, sizeof batch), SRT_SUCCESS);
+
+    StartListener();
+    const SRTSOCKET accepted_sock = EstablishConnection();
+
+    bool opt_val = false;
+    int  opt_len = (int) sizeof opt_val;
+    ASSERT_EQ(srt_getsockopt(accepted_sock, 0, SRTO_UDP_RCVTIMESTAMP, &opt_val, &opt_len), SRT_SUCCESS);
+    EXPECT_TRUE(opt_val) << "Wrong SRTO_UDP_RCVTIMESTAMP value on the accepted socket";
+
+    ExchangeMessages(m_caller_sock, accepted_sock, 200);
+
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(accepted_sock, &stats, 0), SRT_SUCCESS);
+    EXPECT_GT(stats.msRTT, 0.0);
+    EXPECT_LT(stats.msRTT, 1000.0);
+
+    ASSERT_NE(srt_close(accepted_sock), SRT_ERROR);
+}
+
+// Check that data are transmitted correctly with the send time passed to
+// the system, both with single and batched sending, and that the packets are
+// passed ahead with their send time if the system supports it. Otherwise the
+// option must be turned off and the packets sent normally.
+TEST_F(TestSocketOptions, UDPTxTime)
+{
+    const int  batch = 16;
+    const bool yes   = true;
+    ASSERT_EQ(srt_setsockopt(m_caller_sock, 0, SRTO_UDP_TXTIME, &yes, sizeof yes), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_TXTIME, &yes, sizeof yes), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_SNDBATCH, &batch, sizeof batch), SRT_SUCCESS);
+
+    StartListener();
+    const SRTSOCKET accepted_sock = EstablishConnection();
+
+    const int num_msgs = 200;
+    ExchangeMessages(m_caller_sock, accepted_sock, num_msgs);
+    ExchangeMessages(accepted_sock, m_caller_sock, num_msgs);
+
+    const bool has_txtime = SystemHasTxTime();
+    for (SRTSOCKET sock : { m_caller_sock, accepted_sock })
+    {
+        SRT_TRACEBSTATS stats;
+        EXPECT_EQ(srt_bstats(sock, &stats, 0), SRT_SUCCESS);
+        if (has_txtime)
+            EXPECT_GT(stats.muxSndTxTimePktsTotal, 0) << "socket @" << sock;
+        else
+            EXPECT_EQ(stats.muxSndTxTimePktsTotal, 0) << "socket @" << sock;
+        EXPECT_LE(stats.muxSndTxTimePktsTotal, stats.pktSentTotal) << "socket @" << sock;
+    }
+
+    ASSERT_NE(srt_close(accepted_sock), SRT_ERROR);
+}
+
+// Check that data are transmitted correctly through io_uring, both with
+// single and batched reading and sending, and that the packets are received
+// through it if the system supports it. Otherwise the usual system calls
+// must be used.
+TEST_F(TestSocketOptions, UDPIoUring)
+{
+    const int  batch = 16;
+    const bool yes   = true;
+    ASSERT_EQ(srt_setsockopt(m_caller_sock, 0, SRTO_UDP_IOURING, &yes, sizeof yes), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_IOURING, &yes, sizeof yes), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_SNDBATCH, &batch, sizeof batch), SRT_SUCCESS);
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_RCVBATCH, &batch, sizeof batch), SRT_SUCCESS);
+
+    bool value = false;
+    int  optlen = sizeof value;
+    ASSERT_EQ(srt_getsockopt(m_caller_sock, 0, SRTO_UDP_IOURING, &value, &optlen), SRT_SUCCESS);
+    EXPECT_TRUE(value);
+
+    StartListener();
+    const SRTSOCKET accepted_sock = EstablishConnection();
+
+    const int num_msgs = 200;
+    ExchangeMessages(m_caller_sock, accepted_sock, num_msgs);
+    ExchangeMessages(accepted_sock, m_caller_sock, num_msgs);
+
+    const bool has_uring = SystemHasIoUring();
+    for (SRTSOCKET sock : { m_caller_sock, accepted_sock })
+    {
+        SRT_TRACEBSTATS stats;
+        EXPECT_EQ(srt_bstats(sock, &stats, 0), SRT_SUCCESS);
+        if (has_uring)
+            EXPECT_GE(stats.muxRcvUringPktsTotal, num_msgs) << "socket @" << sock;
+        else
+            EXPECT_EQ(stats.muxRcvUringPktsTotal, 0) << "socket @" << sock;
+    }
+
+    ASSERT_NE(srt_close(accepted_sock), SRT_ERROR);
+}
+
+// Check that connections are accepted and data are transmitted correctly
+// by a listener on a sharded multiplexer, whichever shard the packets of
+// a connection are delivered to.
+TEST_F(TestSocketOptions, UDPShards)
+{
+    const int shards = 4;
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_SHARDS, &shards, sizeof shards), SRT_SUCCESS);
+    BindListener();
+    ASSERT_NE(srt_listen(m_listen_sock, 8), SRT_ERROR);
+
+    const int num_callers = 8;
+    vector<SRTSOCKET> callers, accepted;
+    ConnectCallers(num_callers, (callers), (accepted));
+    ASSERT_EQ(accepted.size(), size_t(num_callers));
+
+    for (SRTSOCKET sock : accepted)
+    {
+        int value = 0;
+        int optlen = sizeof value;
+        ASSERT_EQ(srt_getsockopt(sock, 0, SRTO_UDP_SHARDS, &value, &optlen), SRT_SUCCESS);
+        EXPECT_EQ(value, shards);
+    }
+
+    ExchangeMessages(callers, accepted, 1);
+    ExchangeMessages(accepted, callers, 1);
+
+    CloseCallers(callers, accepted);
+}
+
+// Check that the packets sent in bursts arrive complete and in order, and
+// that the sending rate doesn't exceed the configured one. The caller sends
+// them one by one, the accepted socket in batches. The rate is high enough
+// for the next packets to be due within the burst quantum.
+TEST_F(TestSocketOptions, SndBurst)
+{
+    const int     burst = 8;
+    const int     batch = 16;
+    const int64_t maxbw = 27200000; // about 20000 packets per second
+    const bool    no    = false;
+    for (SRTSOCKET sock : { m_caller_sock, m_listen_sock })
+    {
+        ASSERT_EQ(srt_setsockopt(sock, 0, SRTO_SNDBURST, &burst, sizeof burst), SRT_SUCCESS);
+        ASSERT_EQ(srt_setsockopt(sock, 0, SRTO_MAXBW, &maxbw, sizeof maxbw), SRT_SUCCESS);
+        ASSERT_EQ(srt_setsockopt(sock, 0, SRTO_TLPKTDROP, &no, sizeof no), SRT_SUCCESS);
+        ASSERT_EQ(srt_setsockopt(sock, 0, SRTO_TSBPDMODE, &no, sizeof no), SRT_SUCCESS);
+    }
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_UDP_SNDBATCH, &batch, sizeof batch), SRT_SUCCESS);
+
+    StartListener();
+    const SRTSOCKET accepted_sock = EstablishConnection();
+
+    int value = 0;
+    int optlen = sizeof value;
+    ASSERT_EQ(srt_getsockopt(accepted_sock, 0, SRTO_SNDBURST, &value, &optlen), SRT_SUCCESS);
+    EXPECT_EQ(value, burst);
+
+    const int num_msgs = 200;
+    for (SRTSOCKET sender : { m_caller_sock, accepted_sock })
+    {
+        const SRTSOCKET receiver = sender == m_caller_sock ? accepted_sock : m_caller_sock;
+        const sync::steady_clock::time_point start = sync::steady_clock::now();
+        ExchangeMessages(sender, receiver, num_msgs);
+
+        // The pacing continues from the scheduled times, so the bursts don't
+        // make the transmission faster: 199 intervals of 50 us at least.
+        EXPECT_GE(sync::count_microseconds(sync::steady_clock::now() - start), 9000);
+    }
+
+    // The packets of a burst are sent in one batch of the accepted socket's
+    // multiplexer, about 4 per call. Without the bursts the packets are only
+    // batched when the sender thread is late, about 2 per call.
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(accepted_sock, &stats, 0), SRT_SUCCESS);
+    EXPECT_GE(stats.muxSndBatchPktsTotal, num_msgs / 2);
+    EXPECT_GE(stats.muxSndBatchPktsTotal, 3 * stats.muxSndBatchCallsTotal);
+
+    ASSERT_NE(srt_close(accepted_sock), SRT_ERROR);
+}
+
+// Check that the data of every connection accepted on a multiplexer with
+// multiple sender threads arrive complete and in order, and that all the
+// threads send them.
+TEST_F(TestSocketOptions, SndWorkers)
+{
+    const int workers = 4;
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_SNDWORKERS, &workers, sizeof workers), SRT_SUCCESS);
+    BindListener();
+    ASSERT_NE(srt_listen(m_listen_sock, 8), SRT_ERROR);
+
+    const int num_callers = 8;
+    vector<SRTSOCKET> callers, accepted;
+    ConnectCallers(num_callers, (callers), (accepted));
+    ASSERT_EQ(accepted.size(), size_t(num_callers));
+
+    for (SRTSOCKET sock : accepted)
+    {
+        int value = 0;
+        int optlen = sizeof value;
+        ASSERT_EQ(srt_getsockopt(sock, 0, SRTO_SNDWORKERS, &value, &optlen), SRT_SUCCESS);
+        EXPECT_EQ(value, workers);
+    }
+
+    // All connections send at the same time, so all the workers are busy.
+    ExchangeMessages(accepted, callers, 20);
+
+    // The accepted sockets have consecutive IDs, so they are spread over all
+    // the workers of the listener's multiplexer. The callers have one each.
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(accepted[0], &stats, 0), SRT_SUCCESS);
+    EXPECT_EQ(stats.muxSndWorkersBusy, workers);
+    EXPECT_EQ(srt_bstats(callers[0], &stats, 0), SRT_SUCCESS);
+    EXPECT_LE(stats.muxSndWorkersBusy, 1);
+
+    CloseCallers(callers, accepted);
+}
+
+// Check that the data sent to every connection accepted on a multiplexer
+// with multiple processing threads arrive complete and in order, and that
+// all the threads process them.
+TEST_F(TestSocketOptions, RcvWorkers)
+{
+    const int workers = 4;
+    ASSERT_EQ(srt_setsockopt(m_listen_sock, 0, SRTO_RCVWORKERS, &workers, sizeof workers), SRT_SUCCESS);
+    BindListener();
+    ASSERT_NE(srt_listen(m_listen_sock, 8), SRT_ERROR);
+
+    const int num_callers = 8;
+    vector<SRTSOCKET> callers, accepted;
+    ConnectCallers(num_callers, (callers), (accepted));
+    ASSERT_EQ(accepted.size(), size_t(num_callers));
+
+    for (SRTSOCKET sock : accepted)
+    {
+        int value = 0;
+        int optlen = sizeof value;
+        ASSERT_EQ(srt_getsockopt(sock, 0, SRTO_RCVWORKERS, &value, &optlen), SRT_SUCCESS);
+        EXPECT_EQ(value, workers);
+    }
+
+    // All connections send at the same time, so all the workers are busy.
+    ExchangeMessages(callers, accepted, 20);
+
+    // The accepted sockets have consecutive IDs, so they are spread over all
+    // the workers of the listener's multiplexer. The callers have none.
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(accepted[0], &stats, 0), SRT_SUCCESS);
+    EXPECT_EQ(stats.muxRcvWorkersBusy, workers);
+    EXPECT_EQ(srt_bstats(callers[0], &stats, 0), SRT_SUCCESS);
+    EXPECT_EQ(stats.muxRcvWorkersBusy, 0);
+
+    CloseCallers(callers, accepted);
+
+    // The closed sockets can only be deleted after their workers have released them.
+    for (size_t i = 0; i < accepted.size(); ++i)
+    {
+        int credit = 100; // 10 seconds
+        while (srt_getsockstate(accepted[i]) != SRTS_NONEXIST && --credit)
+            this_thread::sleep_for(chrono::milliseconds(100));
+        EXPECT_EQ(srt_getsockstate(accepted[i]), SRTS_NONEXIST) << "socket @" << accepted[i];
+    }
+}
+
 
 // Try to set/get SRTO_MININPUTBW with wrong optlen
 TEST_F(TestSocketOptions, MinInputBWWrongLen)
@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "queue.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::sync;
+
+namespace
+{
+
+unique_ptr<CSNode[]> makeNodes(size_t count)
+{
+    unique_ptr<CSNode[]> nodes(new CSNode[count]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        nodes[i].m_pUDT  = NULL;
+        nodes[i].m_pPrev = nodes[i].m_pNext = NULL;
+        nodes[i].m_iSlot = -1;
+    }
+    return nodes;
+}
+
+void insertAt(CSndTimingWheel& wheel, CSNode& node, const steady_clock::time_point& ts)
+{
+    node.m_tsTimeStamp = ts;
+    wheel.insert(&node);
+}
+
+const int64_t g_tick_us = 1 << CSndTimingWheel::TICK_SHIFT;
+
+} // namespace
+
+/// A node is not retrieved before its time, and the next time is exact.
+TEST(CSndTimingWheel, DueTime)
+{
+    CSndTimingWheel wheel;
+    unique_ptr<CSNode[]> nodes = makeNodes(1);
+
+    const steady_clock::time_point base = steady_clock::now();
+    insertAt(wheel, nodes[0], base + microseconds_from(1003));
+
+    EXPECT_EQ(wheel.nextTime(base), base + microseconds_from(1003));
+    EXPECT_EQ(wheel.pop(base), nullptr);
+    EXPECT_EQ(wheel.pop(base + microseconds_from(1002)), nullptr);
+    EXPECT_EQ(wheel.size(), 1);
+
+    EXPECT_EQ(wheel.pop(base + microseconds_from(1003)), &nodes[0]);
+    EXPECT_EQ(nodes[0].m_iSlot, -1);
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_TRUE(is_zero(wheel.nextTime(base)));
+}
+
+/// Nodes scheduled over all levels of the wheel come out in the order of time.
+TEST(CSndTimingWheel, Order)
+{
+    const size_t         count = 10000;
+    CSndTimingWheel      wheel;
+    unique_ptr<CSNode[]> nodes = makeNodes(count);
+    multiset<steady_clock::time_point> times;
+
+    mt19937                                 rnd(1);
+    uniform_int_distribution<int64_t>       offset(0, int64_t(600) * 1000000);
+    const steady_clock::time_point base = steady_clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        // Some of them in the first ticks, the rest up to 10 minutes ahead.
+        const int64_t us = i % 10 == 0 ? int64_t(i % 5000) : offset(rnd);
+        insertAt(wheel, nodes[i], base + microseconds_from(us));
+        times.insert(nodes[i].m_tsTimeStamp);
+    }
+
+    steady_clock::time_point now = base;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const steady_clock::time_point next = wheel.nextTime(now);
+        ASSERT_FALSE(is_zero(next));
+        if (next > now)
+        {
+            EXPECT_EQ(next, *times.begin());
+            now = next;
+        }
+
+        CSNode* n = wheel.pop(now);
+        ASSERT_NE(n, nullptr);
+        EXPECT_LE(n->m_tsTimeStamp, now);
+        // Within the earliest tick the order is the order of insertion.
+        EXPECT_LT(count_microseconds(n->m_tsTimeStamp - *times.begin()), g_tick_us);
+        times.erase(times.find(n->m_tsTimeStamp));
+    }
+    EXPECT_TRUE(wheel.empty());
+}
+
+/// Removed nodes don't come out, and a reinserted node comes out at the new time.
+TEST(CSndTimingWheel, RemoveAndReschedule)
+{
+    CSndTimingWheel      wheel;
+    unique_ptr<CSNode[]> nodes = makeNodes(3);
+
+    const steady_clock::time_point base = steady_clock::now();
+    insertAt(wheel, nodes[0], base + milliseconds_from(1));
+    insertAt(wheel, nodes[1], base + milliseconds_from(300));
+    insertAt(wheel, nodes[2], base + seconds_from(5));
+
+    EXPECT_FALSE(wheel.isEarliest(base + milliseconds_from(2)));
+    EXPECT_TRUE(wheel.isEarliest(base + microseconds_from(500)));
+
+    wheel.remove(&nodes[0]);
+    EXPECT_EQ(nodes[0].m_iSlot, -1);
+    EXPECT_EQ(wheel.size(), 2);
+    EXPECT_EQ(wheel.nextTime(base), base + milliseconds_from(300));
+
+    // Reschedule the last one before the others.
+    wheel.remove(&nodes[2]);
+    insertAt(wheel, nodes[2], base + milliseconds_from(200));
+    EXPECT_EQ(wheel.nextTime(base), base + milliseconds_from(200));
+
+    const steady_clock::time_point later = base + seconds_from(10);
+    EXPECT_EQ(wheel.pop(later), &nodes[2]);
+    EXPECT_EQ(wheel.pop(later), &nodes[1]);
+    EXPECT_EQ(wheel.pop(later), nullptr);
+}
+
+/// Times already passed and times beyond the range of the wheel are kept.
+TEST(CSndTimingWheel, PastAndFarFuture)
+{
+    CSndTimingWheel      wheel;
+    unique_ptr<CSNode[]> nodes = makeNodes(3);
+
+    const steady_clock::time_point base = steady_clock::now();
+    insertAt(wheel, nodes[0], base + seconds_from(3600 * 20));
+    insertAt(wheel, nodes[1], base + milliseconds_from(10));
+
+    // Move the wheel forward, then schedule something in the past.
+    EXPECT_EQ(wheel.pop(base + milliseconds_from(10)), &nodes[1]);
+    insertAt(wheel, nodes[2], base);
+    EXPECT_EQ(wheel.nextTime(base + milliseconds_from(10)), base);
+    EXPECT_EQ(wheel.pop(base + milliseconds_from(10)), &nodes[2]);
+
+    EXPECT_EQ(wheel.nextTime(base + milliseconds_from(10)), base + seconds_from(3600 * 20));
+    EXPECT_EQ(wheel.pop(base + seconds_from(3600 * 20 - 1)), nullptr);
+    EXPECT_EQ(wheel.pop(base + seconds_from(3600 * 20)), &nodes[0]);
+    EXPECT_TRUE(wheel.empty());
+}
+
+namespace
+{
+
+// The binary heap formerly used by CSndUList, for comparison.
+class CSndHeap
+{
+public:
+    bool empty() const { return m_Heap.empty(); }
+
+    void insert(CSNode* n)
+    {
+        m_Heap.push_back(n);
+        int q = int(m_Heap.size()) - 1;
+        while (q != 0)
+        {
+            const int p = (q - 1) >> 1;
+            if (m_Heap[p]->m_tsTimeStamp <= m_Heap[q]->m_tsTimeStamp)
+                break;
+            swap(m_Heap[p], m_Heap[q]);
+            m_Heap[q]->m_iSlot = q;
+            q                  = p;
+        }
+        n->m_iSlot = q;
+    }
+
+    void remove(CSNode* n)
+    {
+        const int last = int(m_Heap.size()) - 1;
+        int       q    = n->m_iSlot;
+        m_Heap[q]      = m_Heap[last];
+        m_Heap.pop_back();
+        if (q != last)
+        {
+            m_Heap[q]->m_iSlot = q;
+            int p              = q * 2 + 1;
+            while (p < last)
+            {
+                if (p + 1 < last && m_Heap[p]->m_tsTimeStamp > m_Heap[p + 1]->m_tsTimeStamp)
+                    ++p;
+                if (m_Heap[q]->m_tsTimeStamp <= m_Heap[p]->m_tsTimeStamp)
+                    break;
+                swap(m_Heap[p], m_Heap[q]);
+                m_Heap[p]->m_iSlot = p;
+                m_Heap[q]->m_iSlot = q;
+                q                  = p;
+                p                  = q * 2 + 1;
+            }
+        }
+        n->m_iSlot = -1;
+    }
+
+    CSNode* pop(const steady_clock::time_point& ts_due)
+    {
+        if (m_Heap.empty() || m_Heap[0]->m_tsTimeStamp > ts_due)
+            return NULL;
+        CSNode* n = m_Heap[0];
+        remove(n);
+        return n;
+    }
+
+    steady_clock::time_point nextTime(const steady_clock::time_point&)
+    {
+        return m_Heap.empty() ? steady_clock::time_point() : m_Heap[0]->m_tsTimeStamp;
+    }
+
+private:
+    vector<CSNode*> m_Heap;
+};
+
+// Runs the sending schedule of the given number of sockets in simulated
+// time: the earliest socket is taken and scheduled again after its period,
+// and every fourth step some other socket is rescheduled earlier (as when
+// an ACK or a loss report arrives). Returns the time of a step in ns.
+template <class Schedule>
+double runSchedule(size_t sockets, size_t steps)
+{
+    Schedule             sched;
+    unique_ptr<CSNode[]> nodes = makeNodes(sockets);
+    vector<int64_t>      periods(sockets);
+
+    mt19937                           rnd(1);
+    uniform_int_distribution<int64_t> period(10, 10000);
+    uniform_int_distribution<size_t>  pick(0, sockets - 1);
+
+    steady_clock::time_point now = steady_clock::now();
+    for (size_t i = 0; i < sockets; ++i)
+    {
+        periods[i] = period(rnd);
+        nodes[i].m_tsTimeStamp = now + microseconds_from(uniform_int_distribution<int64_t>(0, periods[i])(rnd));
+        sched.insert(&nodes[i]);
+    }
+
+    const steady_clock::time_point start = steady_clock::now();
+    for (size_t i = 0; i < steps; ++i)
+    {
+        const steady_clock::time_point next = sched.nextTime(now);
+        if (next > now)
+            now = next;
+
+        CSNode* n = sched.pop(now);
+        if (n)
+        {
+            n->m_tsTimeStamp = now + microseconds_from(periods[n - nodes.get()]);
+            sched.insert(n);
+        }
+
+        if (i % 4 == 0)
+        {
+            CSNode* r = &nodes[pick(rnd)];
+            if (r->m_iSlot != -1 && r->m_tsTimeStamp > now + microseconds_from(5))
+            {
+                sched.remove(r);
+                r->m_tsTimeStamp = now + microseconds_from(5);
+                sched.insert(r);
+            }
+        }
+    }
+    const steady_clock::duration elapsed = steady_clock::now() - start;
+    return double(count_microseconds(elapsed)) * 1000.0 / double(steps);
+}
+
+} // namespace
+
+TEST(CSndTimingWheel, DISABLED_CompareWithHeap)
+{
+    const size_t sockets[] = {1000, 10000, 50000};
+    const size_t steps     = 2000000;
+
+    for (size_t i = 0; i < sizeof sockets / sizeof sockets[0]; ++i)
+    {
+        const double heap  = runSchedule<CSndHeap>(sockets[i], steps);
+        const double wheel = runSchedule<CSndTimingWheel>(sockets[i], steps);
+        cerr << sockets[i] << " sockets: heap " << heap << " ns/step, wheel " << wheel << " ns/step\n";
+    }
+}
@@ -1,4 +1,11 @@
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <set>
+#include <thread>
 #include <vector>
 #include "gtest/gtest.h"
 #include "test_env.h"
@@ -86,3 +93,268 @@ TEST(CUnitQueue, IncreaseAndFreeGrouped)
             << "Buffer capacity should not exceed two queues of 4 units";
     }
 }
+
+/// A batch of units is taken at once, and the taken units
+/// are not available any more until freed.
+TEST(CUnitQueue, TakeUnits)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 16;
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+
+    array<CUnit*, 10> units;
+    ASSERT_EQ(unit_queue.takeUnits(units.data(), int(units.size())), int(units.size()));
+    EXPECT_EQ(unit_queue.size(), buffer_size_pkts - int(units.size()));
+
+    set<CUnit*> taken(units.begin(), units.end());
+    EXPECT_EQ(taken.size(), units.size());
+    for (size_t i = 0; i < units.size(); ++i)
+        EXPECT_TRUE(units[i]->m_bTaken);
+
+    CUnit* next = unit_queue.getNextAvailUnit();
+    ASSERT_NE(next, nullptr);
+    EXPECT_EQ(taken.count(next), 0u);
+    // Not taken yet, so the same one is returned again.
+    EXPECT_EQ(unit_queue.getNextAvailUnit(), next);
+
+    for (size_t i = 0; i < units.size(); ++i)
+        unit_queue.makeUnitFree(units[i]);
+    EXPECT_EQ(unit_queue.size(), buffer_size_pkts);
+}
+
+/// The units returned with makeUnitAvail() can be taken again in any order.
+TEST(CUnitQueue, TakeOutOfOrder)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 64;
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+
+    array<CUnit*, 8> units;
+    ASSERT_EQ(unit_queue.takeUnits(units.data(), int(units.size())), int(units.size()));
+    for (size_t i = units.size(); i > 0; --i)
+        unit_queue.makeUnitAvail(units[i - 1]);
+    EXPECT_EQ(unit_queue.size(), buffer_size_pkts);
+
+    const size_t order[] = {3, 0, 7, 5, 1, 6, 2, 4};
+    set<CUnit*> taken;
+    for (size_t i = 0; i < units.size(); ++i)
+    {
+        unit_queue.makeUnitTaken(units[order[i]]);
+        taken.insert(units[order[i]]);
+        EXPECT_EQ(unit_queue.size(), buffer_size_pkts - int(i + 1));
+
+        CUnit* next = unit_queue.getNextAvailUnit();
+        ASSERT_NE(next, nullptr);
+        EXPECT_EQ(taken.count(next), 0u);
+    }
+
+    // The other units are all still on the list, each once.
+    vector<CUnit*> rest(buffer_size_pkts - units.size());
+    ASSERT_EQ(unit_queue.takeUnits(&rest[0], int(rest.size())), int(rest.size()));
+    taken.insert(rest.begin(), rest.end());
+    EXPECT_EQ(taken.size(), size_t(buffer_size_pkts));
+
+    for (set<CUnit*>::iterator i = taken.begin(); i != taken.end(); ++i)
+        unit_queue.makeUnitFree(*i);
+    EXPECT_EQ(unit_queue.size(), unit_queue.capacity());
+}
+
+/// The units freed in another thread are taken again without growing the queue.
+TEST(CUnitQueue, FreeInOtherThread)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 64;
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+
+    for (int round = 0; round < 10; ++round)
+    {
+        vector<CUnit*> units(buffer_size_pkts / 2);
+        ASSERT_EQ(unit_queue.takeUnits(&units[0], int(units.size())), int(units.size()));
+
+        thread freeing([&]() {
+            for (size_t i = 0; i < units.size(); ++i)
+                unit_queue.makeUnitFree(units[i]);
+        });
+        freeing.join();
+    }
+
+    EXPECT_EQ(unit_queue.capacity(), buffer_size_pkts);
+    EXPECT_EQ(unit_queue.size(), buffer_size_pkts);
+}
+
+/// The blocks of units added under load are released when the load subsides.
+TEST(CUnitQueue, Shrink)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 4;
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+
+    vector<CUnit*> taken_units;
+    for (int i = 0; i < 10 * buffer_size_pkts; ++i)
+    {
+        CUnit* unit = unit_queue.getNextAvailUnit();
+        ASSERT_NE(unit, nullptr);
+        unit_queue.makeUnitTaken(unit);
+        taken_units.push_back(unit);
+    }
+    const int grown = unit_queue.capacity();
+    EXPECT_GT(grown, 10 * buffer_size_pkts);
+
+    for (size_t i = 0; i < taken_units.size(); ++i)
+        unit_queue.makeUnitFree(taken_units[i]);
+
+    // One block at most is released per check.
+    for (int i = 0; i < CUnitQueue::SHRINK_CHECK_PERIOD * grown / buffer_size_pkts; ++i)
+        ASSERT_NE(unit_queue.getNextAvailUnit(), nullptr);
+
+    // Only the first block and the one of the next available unit may stay.
+    EXPECT_LE(unit_queue.capacity(), 2 * buffer_size_pkts);
+    EXPECT_EQ(unit_queue.size(), unit_queue.capacity());
+}
+
+namespace
+{
+
+// The former CUnitQueue that scans the units for a free one, for comparison.
+class CUnitScanQueue
+{
+public:
+    explicit CUnitScanQueue(int size)
+        : m_Units(size)
+        , m_iAvail(0)
+        , m_iLongestScan(0)
+    {
+        for (size_t i = 0; i < m_Units.size(); ++i)
+            m_Units[i].m_bTaken = false;
+    }
+
+    CUnit* getNextAvailUnit()
+    {
+        for (size_t checked = 0; checked < m_Units.size(); ++checked)
+        {
+            CUnit* u = &m_Units[m_iAvail];
+            if (!u->m_bTaken)
+            {
+                m_iLongestScan = max(m_iLongestScan, checked);
+                return u;
+            }
+            m_iAvail = (m_iAvail + 1) % m_Units.size();
+        }
+        return NULL;
+    }
+
+    void makeUnitTaken(CUnit* unit) { unit->m_bTaken = true; }
+    void makeUnitFree(CUnit* unit) { unit->m_bTaken = false; }
+
+    size_t longestScan() const { return m_iLongestScan; }
+
+private:
+    vector<CUnit> m_Units;
+    size_t        m_iAvail;
+    size_t        m_iLongestScan;
+};
+
+// Simulates the sockets of a multiplexer that hold the received packets
+// for different latencies: every packet goes to a random socket and is
+// freed after that socket's latency (in packets). Returns the time per
+// packet in ns.
+template <class Queue>
+double runReceive(Queue& queue, const vector<size_t>& latencies, size_t packets)
+{
+    vector<deque<CUnit*> > held(latencies.size());
+    mt19937                rnd(1);
+    uniform_int_distribution<size_t> pick(0, latencies.size() - 1);
+
+    const auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < packets; ++i)
+    {
+        CUnit* u = queue.getNextAvailUnit();
+        if (!u)
+            return -1;
+        queue.makeUnitTaken(u);
+
+        deque<CUnit*>& sock = held[pick(rnd)];
+        sock.push_back(u);
+        const size_t s = &sock - &held[0];
+        if (sock.size() > latencies[s])
+        {
+            queue.makeUnitFree(sock.front());
+            sock.pop_front();
+        }
+    }
+    const auto elapsed = chrono::steady_clock::now() - start;
+
+    for (size_t s = 0; s < held.size(); ++s)
+    {
+        for (size_t i = 0; i < held[s].size(); ++i)
+            queue.makeUnitFree(held[s][i]);
+    }
+    return double(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()) / double(packets);
+}
+
+} // namespace
+
+TEST(CUnitQueue, DISABLED_Throughput)
+{
+    srt::TestInit srtinit;
+    const int    size    = 65536;
+    const size_t packets = 10000000;
+
+    // One socket keeps most of the units for long, the others cycle quickly.
+    const size_t long_latency[] = {size / 4, size / 2, size * 3 / 4, size * 85 / 100};
+    for (size_t i = 0; i < sizeof long_latency / sizeof long_latency[0]; ++i)
+    {
+        vector<size_t> latencies(8, 64);
+        latencies[0] = long_latency[i];
+
+        CUnitScanQueue scan(size);
+        CUnitQueue     freelist(size, 1500);
+        const double   tscan = runReceive(scan, latencies, packets);
+        const double   tlist = runReceive(freelist, latencies, packets);
+        cerr << long_latency[i] * 100 / size << "% held: scan " << tscan << " ns/pkt (up to " << scan.longestScan()
+             << " units checked at once), free list " << tlist << " ns/pkt\n";
+    }
+}
+
+// Measures makeUnitTaken() for the units returned with makeUnitAvail() and
+// taken again in the reverse order, as the packet filter does, so that every
+// one of them is past the others on the free list.
+TEST(CUnitQueue, DISABLED_TakeOutOfOrderBenchmark)
+{
+    srt::TestInit srtinit;
+    const int    size   = 65536;
+    const size_t rounds = 100000;
+
+    const int batches[] = {4, 32, 256};
+    for (size_t b = 0; b < sizeof batches / sizeof batches[0]; ++b)
+    {
+        CUnitQueue unit_queue(size, 1500);
+
+        // A quarter of the units is held by the sockets.
+        vector<CUnit*> held(size / 4);
+        ASSERT_EQ(unit_queue.takeUnits(&held[0], int(held.size())), int(held.size()));
+
+        vector<CUnit*> units(batches[b]);
+        chrono::steady_clock::duration elapsed(0);
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            ASSERT_EQ(unit_queue.takeUnits(&units[0], int(units.size())), int(units.size()));
+            for (size_t i = units.size(); i > 0; --i)
+                unit_queue.makeUnitAvail(units[i - 1]);
+
+            const auto start = chrono::steady_clock::now();
+            for (size_t i = units.size(); i > 0; --i)
+                unit_queue.makeUnitTaken(units[i - 1]);
+            elapsed += chrono::steady_clock::now() - start;
+
+            for (size_t i = 0; i < units.size(); ++i)
+                unit_queue.makeUnitFree(units[i]);
+        }
+
+        for (size_t i = 0; i < held.size(); ++i)
+            unit_queue.makeUnitFree(held[i]);
+        cerr << batches[b] << " units taken in reverse: "
+             << double(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()) / double(rounds * units.size())
+             << " ns/unit\n";
+    }
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <random>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "packet.h"
+#include "window.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::sync;
+
+namespace
+{
+
+const size_t HEADER_SIZE  = 44;
+const size_t PAYLOAD_SIZE = 1456;
+
+} // namespace
+
+// The packets received coalesced (UDP GRO) share the arrival time of their
+// buffer, so they must not add zero intervals that inflate the receiving rate.
+TEST(CPktTimeWindow, CoalescedArrivals)
+{
+    srt::TestInit srtinit;
+
+    CPktTimeWindow<16, 64> win;
+    win.initialize(HEADER_SIZE, PAYLOAD_SIZE);
+
+    // A steady stream of 10000 packets per second.
+    steady_clock::time_point now = steady_clock::now();
+    for (int i = 0; i < 32; ++i)
+    {
+        now += microseconds_from(100);
+        win.onPktArrival(int(PAYLOAD_SIZE), now);
+    }
+    int bytesps = 0;
+    EXPECT_EQ(win.getPktRcvSpeed((bytesps)), 10000);
+
+    // Buffers of 8 coalesced packets every 800 us, followed by one separate packet.
+    for (int n = 0; n < 4; ++n)
+    {
+        now += microseconds_from(800);
+        for (int i = 0; i < 8; ++i)
+            win.onCoalescedPktArrival(now);
+        EXPECT_EQ(win.getPktRcvSpeed((bytesps)), 10000);
+    }
+    now += microseconds_from(100);
+    win.onPktArrival(int(PAYLOAD_SIZE), now);
+    EXPECT_EQ(win.getPktRcvSpeed((bytesps)), 10000);
+}
+
+// Measures the packet arrivals between two full ACKs, sent every 10 ms,
+// together with the estimates queried for the ACK, at a few receiving rates.
+TEST(CPktTimeWindow, DISABLED_ArrivalsPerAckBenchmark)
+{
+    srt::TestInit srtinit;
+
+    const int    rates[] = {10000, 30000, 100000}; // packets per second
+    const size_t acks    = 2000;
+
+    for (size_t r = 0; r < sizeof rates / sizeof rates[0]; ++r)
+    {
+        CPktTimeWindow<16, 64> win;
+        win.initialize(HEADER_SIZE, PAYLOAD_SIZE);
+
+        const int per_ack  = rates[r] / 100;
+        const int interval = 1000000 / rates[r];
+
+        CPacket pkt;
+        pkt.allocate(PAYLOAD_SIZE);
+        pkt.setLength(PAYLOAD_SIZE);
+
+        mt19937 gen(42);
+        uniform_int_distribution<int> jitter(-interval / 4, interval / 4);
+
+        steady_clock::time_point now   = steady_clock::now();
+        int32_t                  seqno = 0;
+        int                      sink  = 0;
+
+        const auto start = chrono::steady_clock::now();
+        chrono::steady_clock::duration query(0);
+        for (size_t a = 0; a < acks; ++a)
+        {
+            for (int i = 0; i < per_ack; ++i, seqno = CSeqNo::incseq(seqno))
+            {
+                now += microseconds_from(interval + jitter(gen));
+                pkt.set_seqno(seqno);
+                win.onPktArrival(int(PAYLOAD_SIZE), now);
+                win.probeArrival(pkt, false, now);
+            }
+
+            const auto query_start = chrono::steady_clock::now();
+            int bytesps = 0;
+            sink += win.getPktRcvSpeed((bytesps)) + bytesps + win.getBandwidth();
+            query += chrono::steady_clock::now() - query_start;
+        }
+        const chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+
+        EXPECT_NE(sink, 0);
+        cerr << rates[r] << " pkt/s: "
+             << double(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()) / double(acks * per_ack)
+             << " ns per arrival with the ACK queries, "
+             << double(chrono::duration_cast<chrono::nanoseconds>(query).count()) / double(acks) << " ns per ACK query\n";
+    }
+}